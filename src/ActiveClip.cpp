@@ -1,5 +1,6 @@
 #include "ActiveClip.h"
 
+#include "MemoryReport.h"
 #include "Offsets.h"
 #include "OpenAnimationReplacer.h"
 #include "Settings.h"
@@ -30,6 +31,10 @@ ActiveClip::~ActiveClip()
 		}
 	}
 
+	if (_bReevaluationPending) {
+		ReevaluationBatcher::GetSingleton().Cancel(_clipGenerator);
+	}
+
 	RestoreOriginalAnimation();
 }
 
@@ -68,6 +73,10 @@ void ActiveClip::ReplaceAnimation(const ReplacementAnimation* a_replacementAnima
 		const uint16_t newBindingIndex = a_variantIndex ? *a_variantIndex : _currentReplacementAnimation->GetIndex(this);
 		_clipGenerator->animationBindingIndex = newBindingIndex;  // this is the most important part - this is what actually replaces the animation
 																  // the animation binding index is the index of an entry inside hkbCharacterStringData->animationNames, which contains the actual path to the animation file or one of the replacements
+		// stamped even while eviction is off, so turning it on doesn't evict everything that was preloaded before
+		if (const auto projectData = OpenAnimationReplacer::GetSingleton().GetReplacerProjectData(_character)) {
+			projectData->MarkAnimationUsed(newBindingIndex);
+		}
 		if (_currentReplacementAnimation->GetIgnoreDontConvertAnnotationsToTriggersFlag()) {
 			_clipGenerator->flags &= ~0x10;
 		}
@@ -131,6 +140,10 @@ void ActiveClip::ReplaceActiveAnimation(RE::hkbClipGenerator* a_clipGenerator, c
 		animationLog.LogAnimation(replacementEvent, this, a_context.character);
 	}
 
+	if (auto& animationTrace = AnimationTrace::GetSingleton(); animationTrace.IsRecording()) {
+		animationTrace.RecordEvent(replacementEvent, this, a_context.character);
+	}
+
 	a_clipGenerator->Activate(a_context);
 	SetTransitioning(false);
 }
@@ -154,13 +167,28 @@ void ActiveClip::StopBlend()
 
 void ActiveClip::PreUpdate(RE::hkbClipGenerator* a_clipGenerator, const RE::hkbContext& a_context, [[maybe_unused]] float a_timestep)
 {
+	// pick up the result of a batched re-evaluation from the previous frame
+	if (_bReevaluationPending) {
+		if (const auto result = ReevaluationBatcher::GetSingleton().TakeResult(a_clipGenerator)) {
+			_bReevaluationPending = false;
+			OnReevaluated(*result);
+		}
+	}
+
 	// check if the animation should be interrupted (queue a replacement if so)
 	if (!_queuedReplacement && IsInterruptible()) {
-		const auto newReplacementAnim = OpenAnimationReplacer::GetSingleton().GetReplacementAnimation(a_context.character, a_clipGenerator, _originalIndex);
-		// do not try to replace with other variants here
-		std::optional<uint16_t> dummy = std::nullopt;
-		if (ShouldReplaceAnimation(newReplacementAnim, false, dummy)) {
-			QueueReplacementAnimation(newReplacementAnim, Settings::fBlendTimeOnInterrupt, AnimationLogEntry::Event::kInterrupt);
+		if (CanBatchReevaluation()) {
+			if (!_bReevaluationPending) {
+				SubmitReevaluation(ReevaluationBatcher::Reason::kInterrupt);
+			}
+		} else {
+			const auto newReplacementAnim = OpenAnimationReplacer::GetSingleton().GetReplacementAnimation(a_context.character, a_clipGenerator, _originalIndex);
+			UpdateLastEvaluationStats();
+			// do not try to replace with other variants here
+			std::optional<uint16_t> dummy = std::nullopt;
+			if (ShouldReplaceAnimation(newReplacementAnim, false, dummy)) {
+				QueueReplacementAnimation(newReplacementAnim, Settings::fBlendTimeOnInterrupt, AnimationLogEntry::Event::kInterrupt);
+			}
 		}
 	}
 
@@ -195,7 +223,9 @@ void ActiveClip::OnActivate(RE::hkbClipGenerator* a_clipGenerator, const RE::hkb
 			if (!refr) {
 				refr = Utils::GetRefrFromObject(animGraph->rootNode);
 			}
-			if (const auto replacementAnimation = replacements->EvaluateConditionsAndGetReplacementAnimation(refr, a_clipGenerator)) {
+			const auto replacementAnimation = replacements->EvaluateConditionsAndGetReplacementAnimation(refr, a_clipGenerator);
+			UpdateLastEvaluationStats();
+			if (replacementAnimation) {
 				ReplaceAnimation(replacementAnimation);
 			}
 		}
@@ -265,6 +295,8 @@ void ActiveClip::OnGenerate([[maybe_unused]] RE::hkbClipGenerator* a_clipGenerat
 
 bool ActiveClip::OnEcho(RE::hkbClipGenerator* a_clipGenerator, float a_echoDuration)
 {
+	_lastEvaluationStats = {};
+
 	// clear random condition results so they reroll and another animation replacements get a chance to play
 	if (!ShouldKeepRandomResultsOnLoop()) {
 		ClearRandomFloats();
@@ -272,6 +304,7 @@ bool ActiveClip::OnEcho(RE::hkbClipGenerator* a_clipGenerator, float a_echoDurat
 
 	if (ShouldReplaceOnEcho()) {
 		const auto newReplacementAnim = OpenAnimationReplacer::GetSingleton().GetReplacementAnimation(_character, a_clipGenerator, _originalIndex);
+		UpdateLastEvaluationStats();
 		std::optional<uint16_t> variantIndex = std::nullopt;
 		if (ShouldReplaceAnimation(newReplacementAnim, !ShouldKeepRandomResultsOnLoop(), variantIndex)) {
 			QueueReplacementAnimation(newReplacementAnim, a_echoDuration, AnimationLogEntry::Event::kEchoReplace);
@@ -284,14 +317,23 @@ bool ActiveClip::OnEcho(RE::hkbClipGenerator* a_clipGenerator, float a_echoDurat
 
 bool ActiveClip::OnLoop(RE::hkbClipGenerator* a_clipGenerator)
 {
+	_lastEvaluationStats = {};
+
 	// clear random condition results so they reroll and another animation replacements get a chance to play
 	if (!ShouldKeepRandomResultsOnLoop()) {
 		ClearRandomFloats();
 	}
 
 	if (ShouldReplaceOnLoop()) {
+		// the result is handled in a later update, which also logs the loop if the animation isn't replaced
+		if (CanBatchReevaluation()) {
+			SubmitReevaluation(ReevaluationBatcher::Reason::kLoop);
+			return true;
+		}
+
 		// reevaluate conditions on loop
 		const auto newReplacementAnim = OpenAnimationReplacer::GetSingleton().GetReplacementAnimation(_character, a_clipGenerator, _originalIndex);
+		UpdateLastEvaluationStats();
 		std::optional<uint16_t> variantIndex = std::nullopt;
 		if (ShouldReplaceAnimation(newReplacementAnim, !ShouldKeepRandomResultsOnLoop(), variantIndex)) {
 			QueueReplacementAnimation(newReplacementAnim, Settings::fBlendTimeOnLoop, AnimationLogEntry::Event::kLoopReplace);
@@ -302,6 +344,53 @@ bool ActiveClip::OnLoop(RE::hkbClipGenerator* a_clipGenerator)
 	return false;
 }
 
+bool ActiveClip::CanBatchReevaluation() const
+{
+	return Settings::bBatchReevaluations && _replacements && _refr;
+}
+
+void ActiveClip::SubmitReevaluation(ReevaluationBatcher::Reason a_reason)
+{
+	ReevaluationBatcher::GetSingleton().Submit(_replacements, _clipGenerator, _refr, a_reason);
+	_bReevaluationPending = true;
+}
+
+void ActiveClip::OnReevaluated(const ReevaluationBatcher::Result& a_result)
+{
+	_lastEvaluationStats = {};
+
+	// the reference was gone, or something else already replaced the animation in the meantime
+	if (!a_result.bEvaluated || _queuedReplacement) {
+		return;
+	}
+
+	std::optional<uint16_t> variantIndex = std::nullopt;
+
+	if (a_result.reason == ReevaluationBatcher::Reason::kInterrupt) {
+		// do not try to replace with other variants here
+		if (IsInterruptible() && ShouldReplaceAnimation(a_result.replacementAnimation, false, variantIndex)) {
+			QueueReplacementAnimation(a_result.replacementAnimation, Settings::fBlendTimeOnInterrupt, AnimationLogEntry::Event::kInterrupt);
+		}
+		return;
+	}
+
+	if (ShouldReplaceAnimation(a_result.replacementAnimation, !ShouldKeepRandomResultsOnLoop(), variantIndex)) {
+		QueueReplacementAnimation(a_result.replacementAnimation, Settings::fBlendTimeOnLoop, AnimationLogEntry::Event::kLoopReplace);
+		return;
+	}
+
+	// the animation looped without being replaced
+	auto& animationLog = AnimationLog::GetSingleton();
+	constexpr auto event = AnimationLogEntry::Event::kLoop;
+	if (animationLog.ShouldLogAnimations() && animationLog.ShouldLogAnimationsForActiveClip(this, event)) {
+		animationLog.LogAnimation(event, this, _character);
+	}
+
+	if (auto& animationTrace = AnimationTrace::GetSingleton(); animationTrace.IsRecording()) {
+		animationTrace.RecordEvent(event, this, _character);
+	}
+}
+
 float ActiveClip::GetRandomFloat(const Conditions::IRandomConditionComponent* a_randomComponent)
 {
 	// Check if the condition belongs to a submod that shares random results
@@ -370,6 +459,27 @@ void ActiveClip::RegisterDestroyedCallback(std::weak_ptr<DestroyedCallback>& a_c
 	_destroyedCallbacks.emplace_back(a_callback);
 }
 
+size_t ActiveClip::GetMemoryUsage() const
+{
+	size_t bytes = sizeof(ActiveClip);
+
+	if (_blendFromClipGenerator) {
+		bytes += sizeof(FakeClipGenerator);
+	}
+
+	{
+		ReadLocker locker(_randomLock);
+		bytes += MemoryReport::GetHashMapSize(_randomFloats);
+	}
+
+	{
+		Locker locker(_callbacksLock);
+		bytes += MemoryReport::GetVectorSize(_destroyedCallbacks);
+	}
+
+	return bytes;
+}
+
 void ActiveClip::RemoveNonAnnotationTriggersFromClipTriggerArray(RE::hkRefPtr<RE::hkbClipTriggerArray>& a_clipTriggerArray)
 {
 	// create a new array
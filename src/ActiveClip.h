@@ -1,7 +1,9 @@
 #pragma once
 
 #include "AnimationLog.h"
+#include "AnimationTrace.h"
 #include "FakeClipGenerator.h"
+#include "ReevaluationBatcher.h"
 #include "ReplacementAnimation.h"
 
 // a core class of OAR - holds additional data and logic about an active clip generator, created when a clip generator is activated and destroyed when it is deactivated
@@ -55,6 +57,8 @@ public:
 	[[nodiscard]] RE::hkbBehaviorGraph* GetBehaviorGraph() const { return _behaviorGraph; }
 	[[nodiscard]] RE::TESObjectREFR* GetRefr() const { return _refr; }
 	[[nodiscard]] bool IsSynchronizedClip() const { return _bIsSynchronizedClip; }
+	[[nodiscard]] AnimationTrace::EvaluationStats GetLastEvaluationStats() const { return _lastEvaluationStats; }
+	void UpdateLastEvaluationStats() { _lastEvaluationStats = AnimationTrace::ConsumeEvaluationStats(); }
 
 	// interruptible anim
 	[[nodiscard]] bool IsInterruptible() const { return _currentReplacementAnimation ? _currentReplacementAnimation->GetInterruptible() : _bOriginalInterruptible; }
@@ -82,8 +86,16 @@ public:
 	void ClearRandomFloats();
 	void RegisterDestroyedCallback(std::weak_ptr<DestroyedCallback>& a_callback);
 
+	[[nodiscard]] size_t GetMemoryUsage() const;
+
 protected:
 	void RemoveNonAnnotationTriggersFromClipTriggerArray(RE::hkRefPtr<RE::hkbClipTriggerArray>& a_clipTriggerArray);
+
+	// batched re-evaluation, see ReevaluationBatcher
+	[[nodiscard]] bool CanBatchReevaluation() const;
+	void SubmitReevaluation(ReevaluationBatcher::Reason a_reason);
+	void OnReevaluated(const ReevaluationBatcher::Result& a_result);
+
 	AnimationReplacements* _replacements = nullptr;
 	const ReplacementAnimation* _currentReplacementAnimation = nullptr;
 	std::optional<QueuedReplacement> _queuedReplacement = std::nullopt;
@@ -103,6 +115,10 @@ protected:
 
 	bool _bTransitioning = false;
 	bool _bIsSynchronizedClip = false;
+	bool _bReevaluationPending = false;  // a batched re-evaluation was submitted and its result wasn't picked up yet
+
+	// stats of the last condition evaluation for this clip, for the animation trace
+	AnimationTrace::EvaluationStats _lastEvaluationStats{};
 
 	// interruptible anim blending
 	float _blendDuration = 0.f;
@@ -111,9 +127,9 @@ protected:
 
 	std::unique_ptr<FakeClipGenerator> _blendFromClipGenerator = nullptr;
 
-	SharedLock _randomLock;
+	mutable SharedLock _randomLock{ "ActiveClip::_randomLock" };
 	std::unordered_map<const Conditions::IRandomConditionComponent*, float> _randomFloats{};
 
-	ExclusiveLock _callbacksLock;
+	mutable ExclusiveLock _callbacksLock{ "ActiveClip::_callbacksLock" };
 	std::vector<std::weak_ptr<DestroyedCallback>> _destroyedCallbacks;
 };
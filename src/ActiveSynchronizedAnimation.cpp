@@ -37,7 +37,9 @@ void ActiveSynchronizedAnimation::OnSynchronizedClipActivate(RE::BSSynchronizedC
 			if (scene->refHandles.size() > 1) {
 				const auto sourceRef = scene->refHandles[0].get();
 				const auto targetRef = scene->refHandles[1].get();
-				if (const auto replacementAnimation = replacements->EvaluateSynchronizedConditionsAndGetReplacementAnimation(sourceRef.get(), targetRef.get(), a_synchronizedClipGenerator->clipGenerator)) {
+				const auto replacementAnimation = replacements->EvaluateSynchronizedConditionsAndGetReplacementAnimation(sourceRef.get(), targetRef.get(), a_synchronizedClipGenerator->clipGenerator);
+				activeClip->UpdateLastEvaluationStats();
+				if (replacementAnimation) {
 					if (!_variantIndex.has_value() && replacementAnimation->HasVariants()) {
 						_variantIndex = replacementAnimation->GetIndex();
 					}
@@ -53,6 +55,10 @@ void ActiveSynchronizedAnimation::OnSynchronizedClipActivate(RE::BSSynchronizedC
 	if (bAdded && animationLog.ShouldLogAnimations() && !activeClip->IsTransitioning() && animationLog.ShouldLogAnimationsForActiveClip(activeClip, event)) {
 		animationLog.LogAnimation(event, activeClip, a_context.character);
 	}
+
+	if (auto& animationTrace = AnimationTrace::GetSingleton(); bAdded && animationTrace.IsRecording() && !activeClip->IsTransitioning()) {
+		animationTrace.RecordEvent(event, activeClip, a_context.character);
+	}
 }
 
 void ActiveSynchronizedAnimation::OnSynchronizedClipDeactivate(RE::BSSynchronizedClipGenerator* a_synchronizedClipGenerator, [[maybe_unused]] const RE::hkbContext& a_context)
@@ -27,7 +27,7 @@ protected:
 
 	RE::BGSSynchronizedAnimationInstance* _synchronizedAnimationInstance;
 
-	SharedLock _clipDataLock;
+	SharedLock _clipDataLock{ "ActiveSynchronizedAnimation::_clipDataLock" };
 	std::unordered_map<RE::BSSynchronizedClipGenerator*, OriginalClipData> _originalClipDatas;
 
 	std::optional<uint16_t> _variantIndex = std::nullopt;
@@ -0,0 +1,78 @@
+#include "AnimationContentRegistry.h"
+
+#include <ranges>
+
+#include "MemoryReport.h"
+
+void AnimationContentRegistry::Register(std::string_view a_hash, std::string_view a_path, const RE::hkbCharacterStringData* a_stringData)
+{
+	WriteLocker locker(_dataLock);
+
+	auto [it, bInserted] = _entries.try_emplace(std::string(a_hash));
+	auto& entry = it->second;
+	if (bInserted) {
+		std::error_code ec;
+		const auto fileSize = std::filesystem::file_size(a_path, ec);
+		entry.fileSize = ec ? 0 : fileSize;
+	}
+
+	entry.projectPaths[a_stringData].emplace(a_path);
+}
+
+AnimationContentRegistry::Stats AnimationContentRegistry::GetStats() const
+{
+	ReadLocker locker(_dataLock);
+
+	Stats stats;
+	stats.uniqueFiles = static_cast<uint32_t>(_entries.size());
+
+	for (const auto& entry : _entries | std::views::values) {
+		for (const auto& paths : entry.projectPaths | std::views::values) {
+			const auto filtered = static_cast<uint32_t>(paths.size() - 1);
+			stats.filteredFiles += filtered;
+			stats.filteredBytes += filtered * entry.fileSize;
+		}
+
+		if (entry.projectPaths.size() > 1) {
+			const auto extraCopies = static_cast<uint32_t>(entry.projectPaths.size() - 1);
+			++stats.crossProjectFiles;
+			stats.crossProjectBytes += extraCopies * entry.fileSize;
+		}
+	}
+
+	return stats;
+}
+
+uint64_t AnimationContentRegistry::GetFilteredBytes(const RE::hkbCharacterStringData* a_stringData) const
+{
+	ReadLocker locker(_dataLock);
+
+	uint64_t bytes = 0;
+	for (const auto& entry : _entries | std::views::values) {
+		if (const auto search = entry.projectPaths.find(a_stringData); search != entry.projectPaths.end()) {
+			bytes += (search->second.size() - 1) * entry.fileSize;
+		}
+	}
+
+	return bytes;
+}
+
+size_t AnimationContentRegistry::GetMemoryUsage(size_t& a_outEntryCount) const
+{
+	ReadLocker locker(_dataLock);
+
+	a_outEntryCount = _entries.size();
+
+	size_t bytes = sizeof(AnimationContentRegistry) + MemoryReport::GetHashMapSize(_entries);
+	for (const auto& [hash, entry] : _entries) {
+		bytes += MemoryReport::GetStringSize(hash) + MemoryReport::GetHashMapSize(entry.projectPaths);
+		for (const auto& paths : entry.projectPaths | std::views::values) {
+			bytes += MemoryReport::GetHashMapSize(paths);
+			for (const auto& path : paths) {
+				bytes += MemoryReport::GetStringSize(path);
+			}
+		}
+	}
+
+	return bytes;
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <unordered_set>
+
+// tracks which replacement animation files have identical contents across all the behavior projects, see Settings::bFilterOutDuplicateAnimations
+// within a project, identical files share a single binding so only one copy is loaded. Every project binds the animations to its own character data and loads them through its own asset loader,
+// so a loaded animation can't be shared between projects - identical files used by several projects are only reported
+class AnimationContentRegistry final
+{
+public:
+	static AnimationContentRegistry& GetSingleton()
+	{
+		static AnimationContentRegistry singleton;
+		return singleton;
+	}
+
+	struct Stats
+	{
+		uint32_t uniqueFiles = 0;        // distinct file contents
+		uint32_t filteredFiles = 0;      // identical copies within a project that aren't loaded
+		uint64_t filteredBytes = 0;      // file sizes of the above
+		uint32_t crossProjectFiles = 0;  // file contents used by more than one project
+		uint64_t crossProjectBytes = 0;  // file sizes of the extra copies loaded by the other projects
+	};
+
+	void Register(std::string_view a_hash, std::string_view a_path, const RE::hkbCharacterStringData* a_stringData);
+
+	[[nodiscard]] Stats GetStats() const;
+	[[nodiscard]] uint64_t GetFilteredBytes(const RE::hkbCharacterStringData* a_stringData) const;
+	[[nodiscard]] size_t GetMemoryUsage(size_t& a_outEntryCount) const;
+
+private:
+	AnimationContentRegistry() = default;
+	AnimationContentRegistry(const AnimationContentRegistry&) = delete;
+	AnimationContentRegistry(AnimationContentRegistry&&) = delete;
+	~AnimationContentRegistry() = default;
+
+	AnimationContentRegistry& operator=(const AnimationContentRegistry&) = delete;
+	AnimationContentRegistry& operator=(AnimationContentRegistry&&) = delete;
+
+	struct Entry
+	{
+		uint64_t fileSize = 0;
+		std::unordered_map<const RE::hkbCharacterStringData*, std::unordered_set<std::string>> projectPaths;  // the distinct paths with these contents in each project
+	};
+
+	mutable SharedLock _dataLock{ "AnimationContentRegistry::_dataLock" };
+	std::unordered_map<std::string, Entry> _entries;  // by content hash
+};
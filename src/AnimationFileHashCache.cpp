@@ -5,62 +5,50 @@
 
 #include <cryptopp/sha.h>
 
+#include "AnimationFileHashCacheFormat.h"
+#include "MemoryReport.h"
 #include "Settings.h"
+#include "StartupTrace.h"
 
 void AnimationFileHashCache::ReadCacheFromDisk()
 {
-	if (!std::filesystem::exists(Settings::animationFileHashCachePath)) {
+	StartupTrace::Scope traceScope("hash", "ReadCacheFromDisk"sv);
+
+	std::error_code errorCode;
+	if (!std::filesystem::exists(Settings::animationFileHashCachePath) || std::filesystem::file_size(Settings::animationFileHashCachePath, errorCode) == 0) {
+		return;
+	}
+
+	mmio::mapped_file_source file;
+	if (!file.open(Settings::animationFileHashCachePath)) {
+		logger::error("Error opening {} file", Settings::animationFileHashCachePath);
 		return;
 	}
 
 	WriteLocker locker(_dataLock);
 
-	binary_io::file_istream in{ Settings::animationFileHashCachePath };
-	const auto readString = [&](std::string& a_dst) {
-		uint16_t len;
-		in.read(len);
-		a_dst.resize(len);
-		in.read_bytes(std::as_writable_bytes(std::span{ a_dst.data(), a_dst.size() }));
-	};
-
-	uint32_t numEntries;
-	in.read(numEntries);
-
-	for (uint32_t i = 0; i < numEntries; i++) {
-		std::string fullPath;
-		uint64_t lastWriteTime;
-		uint64_t fileSize;
-		std::string hash;
-
-		readString(fullPath);
-		in.read(lastWriteTime);
-		in.read(fileSize);
-		readString(hash);
-		_cache.emplace(fullPath, CachedAnimationHash(lastWriteTime, fileSize, hash));
-	}
+	const std::string_view data(reinterpret_cast<const char*>(file.data()), file.size());
+	const bool bComplete = AnimationFileHashCacheFormat::Read(data, [&](const AnimationFileHashCacheFormat::Entry& a_entry) {
+		_cache.emplace(a_entry.path, CachedAnimationHash(a_entry.lastWriteTime, a_entry.fileSize, a_entry.hash));
+	});
 
-	_bDirty = false;
+	// rewrite a cut off cache with the entries that could be read
+	if (!bComplete) {
+		logger::warn("{} is cut off, read {} entries", Settings::animationFileHashCachePath, _cache.size());
+	}
+	_bDirty = !bComplete;
 }
 
 void AnimationFileHashCache::WriteCacheToDisk()
 {
+	StartupTrace::Scope traceScope("hash", "WriteCacheToDisk"sv);
+
 	binary_io::file_ostream out{ Settings::animationFileHashCachePath };
-	const auto writeString = [&](const std::string_view a_str) {
-		out.write(static_cast<uint16_t>(a_str.length()));
-		out.write_bytes(std::as_bytes(std::span{ a_str.data(), a_str.length() }));
-	};
 
 	ReadLocker locker(_dataLock);
 
-	const auto numEntries = static_cast<uint32_t>(_cache.size());
-	out.write(numEntries);
-
-	for (auto& [pathStr, cachedHash] : _cache) {
-		writeString(pathStr);
-		out.write(cachedHash.lastWriteTime);
-		out.write(cachedHash.fileSize);
-		writeString(cachedHash.hash);
-	}
+	const auto data = AnimationFileHashCacheFormat::Write(_cache);
+	out.write_bytes(std::as_bytes(std::span{ data.data(), data.size() }));
 
 	_bDirty = false;
 }
@@ -79,6 +67,8 @@ void AnimationFileHashCache::DeleteCache()
 
 std::string AnimationFileHashCache::CalculateHash(std::string_view a_fullPath)
 {
+	StartupTrace::Scope traceScope("hash", a_fullPath);
+
 	// Search cached hashes first
 	WIN32_FILE_ATTRIBUTE_DATA fad;
 	uint64_t lastWriteTime = 0;
@@ -119,10 +109,24 @@ bool AnimationFileHashCache::TryGetCachedHash(const std::string_view a_path, con
 	ReadLocker locker(_dataLock);
 
 	if (const auto it = _cache.find(a_path.data()); it != _cache.end()) {
-		if (it->second.fileSize == a_fileSize && it->second.lastWriteTime == a_lastWriteTime) {
+		if (AnimationFileHashCacheFormat::IsUpToDate(it->second.lastWriteTime, it->second.fileSize, a_lastWriteTime, a_fileSize)) {
 			a_outCachedHash = it->second.hash;
 			return true;
 		}
 	}
 	return false;
 }
+
+size_t AnimationFileHashCache::GetMemoryUsage(size_t& a_outEntryCount) const
+{
+	ReadLocker locker(_dataLock);
+
+	a_outEntryCount = _cache.size();
+
+	size_t bytes = sizeof(AnimationFileHashCache) + MemoryReport::GetHashMapSize(_cache);
+	for (const auto& [path, cachedHash] : _cache) {
+		bytes += MemoryReport::GetStringSize(path) + MemoryReport::GetStringSize(cachedHash.hash);
+	}
+
+	return bytes;
+}
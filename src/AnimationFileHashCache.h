@@ -28,6 +28,7 @@ public:
 	static std::string CalculateHash(std::string_view a_fullPath);
 
 	[[nodiscard]] bool IsDirty() const { return _bDirty; }
+	[[nodiscard]] size_t GetMemoryUsage(size_t& a_outEntryCount) const;
 
 	[[nodiscard]] bool TryGetCachedHash(std::string_view a_path, uint64_t a_lastWriteTime, uint64_t a_fileSize, std::string& a_outCachedHash) const;
 
@@ -49,7 +50,7 @@ private:
 	AnimationFileHashCache& operator=(const AnimationFileHashCache&) = delete;
 	AnimationFileHashCache& operator=(AnimationFileHashCache&&) = delete;
 
-	mutable SharedLock _dataLock;
+	mutable SharedLock _dataLock{ "AnimationFileHashCache::_dataLock" };
 	std::unordered_map<std::string, CachedAnimationHash> _cache;
 	bool _bDirty = false;
 };
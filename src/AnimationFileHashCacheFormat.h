@@ -0,0 +1,125 @@
+#pragma once
+
+// the file format and the validation of the animation file hash cache. Doesn't depend on any game headers so it can be shared with tools/AnimationFileHashCacheBenchmark.cpp
+// uint32 entry count, then for every entry: uint16 path length, path, uint64 last write time, uint64 file size, uint16 hash length, hash. Little endian
+
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <string_view>
+
+namespace AnimationFileHashCacheFormat
+{
+	struct Entry
+	{
+		std::string_view path;
+		uint64_t lastWriteTime = 0;
+		uint64_t fileSize = 0;
+		std::string_view hash;
+	};
+
+	// a cached hash is only used while the file keeps the last write time and size it was hashed with
+	[[nodiscard]] constexpr bool IsUpToDate(uint64_t a_cachedLastWriteTime, uint64_t a_cachedFileSize, uint64_t a_lastWriteTime, uint64_t a_fileSize)
+	{
+		return a_cachedFileSize == a_fileSize && a_cachedLastWriteTime == a_lastWriteTime;
+	}
+
+	namespace detail
+	{
+		template <class T>
+		bool ReadInteger(std::string_view& a_data, T& a_outValue)
+		{
+			if (a_data.size() < sizeof(T)) {
+				return false;
+			}
+
+			a_outValue = 0;
+			for (size_t i = 0; i < sizeof(T); ++i) {
+				a_outValue |= static_cast<T>(static_cast<uint8_t>(a_data[i])) << (8 * i);
+			}
+			a_data.remove_prefix(sizeof(T));
+			return true;
+		}
+
+		inline bool ReadString(std::string_view& a_data, std::string_view& a_outString)
+		{
+			uint16_t length;
+			if (!ReadInteger(a_data, length) || a_data.size() < length) {
+				return false;
+			}
+
+			a_outString = a_data.substr(0, length);
+			a_data.remove_prefix(length);
+			return true;
+		}
+
+		template <class T>
+		void WriteInteger(std::string& a_out, T a_value)
+		{
+			for (size_t i = 0; i < sizeof(T); ++i) {
+				a_out += static_cast<char>((a_value >> (8 * i)) & 0xFF);
+			}
+		}
+
+		inline void WriteString(std::string& a_out, std::string_view a_string)
+		{
+			WriteInteger(a_out, static_cast<uint16_t>(a_string.size()));
+			a_out += a_string;
+		}
+	}
+
+	// a_onEntry(const Entry&) for every entry in a_data, the views point into a_data
+	// returns false if a_data is cut off, the entries before that are still read
+	template <class OnEntry>
+	bool Read(std::string_view a_data, OnEntry&& a_onEntry)
+	{
+		uint32_t entryCount;
+		if (!detail::ReadInteger(a_data, entryCount)) {
+			return a_data.empty();  // an empty file is an empty cache
+		}
+
+		for (uint32_t i = 0; i < entryCount; ++i) {
+			Entry entry;
+			if (!detail::ReadString(a_data, entry.path) ||
+				!detail::ReadInteger(a_data, entry.lastWriteTime) ||
+				!detail::ReadInteger(a_data, entry.fileSize) ||
+				!detail::ReadString(a_data, entry.hash)) {
+				return false;
+			}
+
+			a_onEntry(entry);
+		}
+
+		return true;
+	}
+
+	// a_cache is a map from the path to something with lastWriteTime, fileSize and hash, like AnimationFileHashCache::_cache
+	// entries with a path or hash too long for the format are left out, they'd break every entry after them
+	template <class Cache>
+	std::string Write(const Cache& a_cache)
+	{
+		constexpr size_t maxLength = std::numeric_limits<uint16_t>::max();
+
+		std::string data;
+		detail::WriteInteger(data, uint32_t{ 0 });
+
+		uint32_t entryCount = 0;
+		for (const auto& [path, cachedHash] : a_cache) {
+			if (path.size() > maxLength || cachedHash.hash.size() > maxLength) {
+				continue;
+			}
+
+			detail::WriteString(data, path);
+			detail::WriteInteger(data, static_cast<uint64_t>(cachedHash.lastWriteTime));
+			detail::WriteInteger(data, static_cast<uint64_t>(cachedHash.fileSize));
+			detail::WriteString(data, cachedHash.hash);
+			++entryCount;
+		}
+
+		std::string entryCountData;
+		detail::WriteInteger(entryCountData, entryCount);
+		data.replace(0, entryCountData.size(), entryCountData);
+
+		return data;
+	}
+}
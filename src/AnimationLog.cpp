@@ -1,25 +1,32 @@
 #include "AnimationLog.h"
 
 #include "ActiveClip.h"
+#include "MemoryReport.h"
 #include "OpenAnimationReplacer.h"
 #include "ReplacementAnimation.h"
 #include "Settings.h"
 #include "UI/UIManager.h"
 #include "Utils.h"
 
-AnimationLogEntry::AnimationLogEntry(Event a_event, ActiveClip* a_activeClip, RE::hkbCharacter* a_character) :
-	event(a_event)
+AnimationLogEntry::AnimationLogEntry(const AnimationLogEvent& a_logEvent) :
+	event(a_logEvent.event),
+	bInterruptible(a_logEvent.bInterruptible)
 {
-	const auto replacementAnimation = a_activeClip->GetReplacementAnimation();
+	const auto replacementAnimation = a_logEvent.replacementAnimation;
 	bOriginal = replacementAnimation == nullptr;
-	bInterruptible = a_activeClip->IsInterruptible();
-	animationName = a_activeClip->GetClipGenerator()->animationName.data();
-	clipName = a_activeClip->GetClipGenerator()->name.data();
+	if (const auto clipGenerator = a_logEvent.clipGenerator.get()) {
+		animationName = clipGenerator->animationName.data();
+		clipName = clipGenerator->name.data();
+	}
 
-	if (const auto stringData = Utils::GetStringDataFromHkbCharacter(a_character)) {
+	const auto stringData = a_logEvent.stringData.get();
+	if (stringData) {
 		projectName = stringData->name.data();
 	}
 
+	// the event might have been waiting in the queue for a bit, start fading from when it actually happened
+	timeDrawn = std::chrono::duration<float>(std::chrono::steady_clock::now() - a_logEvent.timestamp).count();
+
 	if (replacementAnimation) {
 		if (const auto subMod = replacementAnimation->GetParentSubMod()) {
 			subModName = subMod->GetName();
@@ -42,11 +49,11 @@ AnimationLogEntry::AnimationLogEntry(Event a_event, ActiveClip* a_activeClip, RE
 		// variants
 		bVariant = replacementAnimation->HasVariants();
 		if (bVariant) {
-			variantFilename = replacementAnimation->GetVariantFilename(a_activeClip->GetCurrentIndex());
+			variantFilename = replacementAnimation->GetVariantFilename(a_logEvent.currentIndex);
 		}
 	} else {
-		if (const auto stringData = Utils::GetStringDataFromHkbCharacter(a_character)) {
-			animPath = Utils::GetOriginalAnimationName(stringData, a_activeClip->GetOriginalIndex());
+		if (stringData) {
+			animPath = Utils::GetOriginalAnimationName(stringData, a_logEvent.originalIndex);
 
 			// shorten the path by removing the first directory
 			const auto slashCount = std::ranges::count(animPath, '\\');
@@ -59,47 +66,109 @@ AnimationLogEntry::AnimationLogEntry(Event a_event, ActiveClip* a_activeClip, RE
 			}
 		}
 	}
+}
 
-	if (Settings::bAnimationLogWriteToTextLog) {
-		std::string infoString = bOriginal ? "original" : std::format("{} / {}", modName, subModName);
-		std::string variantString = bVariant ? std::format(" [Variant - {}]", variantFilename) : "";
-		std::string eventString;
-		switch (event) {
-		case Event::kActivate:
-			eventString = "Activated"sv;
-			break;
-		case Event::kActivateSynchronized:
-			eventString = "Activated paired"sv;
-			break;
-		case Event::kActivateReplace:
-			eventString = "Activated (Replaced)"sv;
-			break;
-		case Event::kActivateReplaceSynchronized:
-			eventString = "Activated paired (Replaced)"sv;
-			break;
-		case Event::kEcho:
-			eventString = "Echo"sv;
-			break;
-		case Event::kEchoReplace:
-			eventString = "Echo (Replaced)"sv;
-			break;
-		case Event::kLoop:
-			eventString = "Loop"sv;
-			break;
-		case Event::kLoopReplace:
-			eventString = "Loop (Replaced)"sv;
-			break;
-		}
-		logger::info("AnimationLogEntry: {} animation \"{}\" (Project: {}, Clip: {}) - {} ({}){}", eventString, animationName, projectName, clipName, infoString, animPath, variantString);
+std::string AnimationLogEntry::GetTextLogLine() const
+{
+	std::string infoString = bOriginal ? "original" : std::format("{} / {}", modName, subModName);
+	std::string variantString = bVariant ? std::format(" [Variant - {}]", variantFilename) : "";
+	std::string eventString;
+	switch (event) {
+	case Event::kActivate:
+		eventString = "Activated"sv;
+		break;
+	case Event::kActivateSynchronized:
+		eventString = "Activated paired"sv;
+		break;
+	case Event::kActivateReplace:
+		eventString = "Activated (Replaced)"sv;
+		break;
+	case Event::kActivateReplaceSynchronized:
+		eventString = "Activated paired (Replaced)"sv;
+		break;
+	case Event::kEcho:
+		eventString = "Echo"sv;
+		break;
+	case Event::kEchoReplace:
+		eventString = "Echo (Replaced)"sv;
+		break;
+	case Event::kLoop:
+		eventString = "Loop"sv;
+		break;
+	case Event::kLoopReplace:
+		eventString = "Loop (Replaced)"sv;
+		break;
 	}
+	return std::format("AnimationLogEntry: {} animation \"{}\" (Project: {}, Clip: {}) - {} ({}){}", eventString, animationName, projectName, clipName, infoString, animPath, variantString);
 }
 
+AnimationLogEvent::AnimationLogEvent(AnimationLogEntry::Event a_event, ActiveClip* a_activeClip, RE::hkbCharacter* a_character) :
+	event(a_event),
+	bInterruptible(a_activeClip->IsInterruptible()),
+	originalIndex(a_activeClip->GetOriginalIndex()),
+	currentIndex(a_activeClip->GetCurrentIndex()),
+	replacementAnimation(a_activeClip->GetReplacementAnimation()),
+	clipGenerator(a_activeClip->GetClipGenerator()),
+	stringData(Utils::GetStringDataFromHkbCharacter(a_character)),
+	timestamp(std::chrono::steady_clock::now())
+{}
+
 void AnimationLog::LogAnimation(AnimationLogEntry::Event a_event, ActiveClip* a_activeClip, RE::hkbCharacter* a_character)
 {
+	// called from the clip generator hooks - only record the raw event here, the strings are built later by ProcessPendingEvents
+	if (!_pendingEvents.TryPush(AnimationLogEvent(a_event, a_activeClip, a_character))) {
+		_droppedEventCount.fetch_add(1, std::memory_order_relaxed);
+	}
+}
+
+void AnimationLog::Update()
+{
+	if (!_pendingEvents.IsEmpty()) {
+		ProcessPendingEvents();
+	}
+}
+
+void AnimationLog::ProcessPendingEvents()
+{
+	Locker locker(_processLock);
+
+	if (_pendingEvents.IsEmpty()) {
+		return;
+	}
+
+	const bool bWriteToTextLog = Settings::bAnimationLogWriteToTextLog;
+
+	std::vector<AnimationLogEntry> newEntries;
+	std::vector<std::string> textLogLines;
+	AnimationLogEvent logEvent;
+	while (_pendingEvents.TryPop(logEvent)) {
+		auto& newEntry = newEntries.emplace_back(logEvent);
+		if (bWriteToTextLog) {
+			textLogLines.emplace_back(newEntry.GetTextLogLine());
+		}
+		logEvent = {};  // release the references
+	}
+
+	if (const auto droppedEventCount = _droppedEventCount.exchange(0, std::memory_order_relaxed); droppedEventCount > 0 && bWriteToTextLog) {
+		textLogLines.emplace_back(std::format("AnimationLog: {} events were dropped because the pending event buffer was full", droppedEventCount));
+	}
+
+	if (!textLogLines.empty()) {
+		{
+			Locker linesLocker(_textLogLinesLock);
+			std::ranges::move(textLogLines, std::back_inserter(_pendingTextLogLines));
+		}
+
+		// writing to the log file might have been enabled after the log was opened
+		StartTextLogThread();
+	}
+
 	{
-		WriteLocker locker(_animationLogLock);
+		WriteLocker logLocker(_animationLogLock);
 
-		_animationLog.emplace_front(a_event, a_activeClip, a_character);
+		for (auto& newEntry : newEntries) {
+			_animationLog.emplace_front(std::move(newEntry));
+		}
 	}
 
 	ClampLog();
@@ -188,4 +257,69 @@ bool AnimationLog::ShouldLogAnimationsForActiveClip(ActiveClip* a_activeClip, An
 void AnimationLog::SetLogAnimations(bool a_enable)
 {
 	_bLogAnimations = a_enable;
+
+	if (a_enable && Settings::bAnimationLogWriteToTextLog) {
+		StartTextLogThread();
+	} else {
+		ProcessPendingEvents();
+		StopTextLogThread();
+	}
+}
+
+size_t AnimationLog::GetMemoryUsage(size_t& a_outEntryCount) const
+{
+	ReadLocker locker(_animationLogLock);
+
+	a_outEntryCount = _animationLog.size();
+
+	// the pending events ring buffer is part of the singleton itself
+	size_t bytes = sizeof(AnimationLog) + _animationLog.size() * sizeof(AnimationLogEntry);
+	for (const auto& logEntry : _animationLog) {
+		bytes += MemoryReport::GetStringSize(logEntry.animationName) + MemoryReport::GetStringSize(logEntry.clipName) + MemoryReport::GetStringSize(logEntry.projectName) + MemoryReport::GetStringSize(logEntry.modName) +
+		         MemoryReport::GetStringSize(logEntry.subModName) + MemoryReport::GetStringSize(logEntry.animPath) + MemoryReport::GetStringSize(logEntry.variantFilename);
+	}
+
+	return bytes;
+}
+
+void AnimationLog::StartTextLogThread()
+{
+	Locker locker(_textLogThreadLock);
+
+	if (_textLogThread.joinable()) {
+		return;
+	}
+
+	// writes the lines resolved in the main update in the background, so the file writes stay off the main thread
+	_textLogThread = std::jthread([this](std::stop_token a_stopToken) {
+		while (!a_stopToken.stop_requested()) {
+			WritePendingTextLogLines();
+			std::this_thread::sleep_for(kTextLogThreadInterval);
+		}
+	});
+}
+
+void AnimationLog::StopTextLogThread()
+{
+	Locker locker(_textLogThreadLock);
+
+	if (_textLogThread.joinable()) {
+		_textLogThread.request_stop();
+		_textLogThread.join();
+	}
+
+	WritePendingTextLogLines();
+}
+
+void AnimationLog::WritePendingTextLogLines()
+{
+	std::vector<std::string> lines;
+	{
+		Locker locker(_textLogLinesLock);
+		lines = std::exchange(_pendingTextLogLines, {});
+	}
+
+	for (const auto& line : lines) {
+		logger::info("{}", line);
+	}
 }
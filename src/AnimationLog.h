@@ -1,5 +1,11 @@
 #pragma once
 
+#include "Utils.h"
+
+class ActiveClip;
+class ReplacementAnimation;
+struct AnimationLogEvent;
+
 struct AnimationLogEntry
 {
 	enum class Event : uint8_t
@@ -17,7 +23,9 @@ struct AnimationLogEntry
 		kInterrupt
 	};
 
-	AnimationLogEntry(Event a_event, class ActiveClip* a_activeClip, RE::hkbCharacter* a_character);
+	explicit AnimationLogEntry(const AnimationLogEvent& a_logEvent);
+
+	[[nodiscard]] std::string GetTextLogLine() const;
 
 	Event event;
 	bool bOriginal = false;
@@ -34,6 +42,23 @@ struct AnimationLogEntry
 	float timeDrawn = 0.f;
 };
 
+// raw event recorded on the hot path. Only holds what's needed to build the AnimationLogEntry strings later, outside of the clip generator hooks
+// events are resolved and released on the main thread, so the havok references are never released on a thread without a havok memory router
+struct AnimationLogEvent
+{
+	AnimationLogEvent() = default;
+	AnimationLogEvent(AnimationLogEntry::Event a_event, ActiveClip* a_activeClip, RE::hkbCharacter* a_character);
+
+	AnimationLogEntry::Event event = AnimationLogEntry::Event::kNone;
+	bool bInterruptible = false;
+	uint16_t originalIndex = 0;
+	uint16_t currentIndex = 0;
+	const ReplacementAnimation* replacementAnimation = nullptr;  // replacement animations live as long as their project data, which is never removed while a graph using it is alive
+	RE::hkRefPtr<RE::hkbClipGenerator> clipGenerator = nullptr;  // keep the clip generator and string data alive until the event is resolved
+	RE::hkRefPtr<RE::hkbCharacterStringData> stringData = nullptr;
+	std::chrono::steady_clock::time_point timestamp{};
+};
+
 class AnimationLog
 {
 public:
@@ -44,6 +69,7 @@ public:
 	}
 
 	void LogAnimation(AnimationLogEntry::Event a_event, ActiveClip* a_activeClip, RE::hkbCharacter* a_character);
+	void Update();  // called every frame from the main update
 	void ClampLog();
 	[[nodiscard]] bool IsAnimationLogEmpty() const;
 	void ForEachAnimationLogEntry(const std::function<void(AnimationLogEntry&)>& a_func);
@@ -51,17 +77,38 @@ public:
 	[[nodiscard]] bool ShouldLogAnimations() const { return _bLogAnimations; }
 	[[nodiscard]] bool ShouldLogAnimationsForActiveClip(ActiveClip* a_activeClip, AnimationLogEntry::Event a_logEvent) const;
 	void SetLogAnimations(bool a_enable);
+	[[nodiscard]] size_t GetMemoryUsage(size_t& a_outEntryCount) const;
 
 private:
 	AnimationLog() = default;
 	AnimationLog(const AnimationLog&) = delete;
 	AnimationLog(AnimationLog&&) = delete;
-	virtual ~AnimationLog() = default;
+	virtual ~AnimationLog() { StopTextLogThread(); }
 
 	AnimationLog& operator=(const AnimationLog&) = delete;
 	AnimationLog& operator=(AnimationLog&&) = delete;
 
-	mutable SharedLock _animationLogLock;
+	void ProcessPendingEvents();
+
+	void StartTextLogThread();
+	void StopTextLogThread();
+	void WritePendingTextLogLines();
+
+	static constexpr size_t kPendingEventsCapacity = 256;
+	static constexpr auto kTextLogThreadInterval = 50ms;
+
+	mutable SharedLock _animationLogLock{ "AnimationLog::_animationLogLock" };
 	std::deque<AnimationLogEntry> _animationLog = {};
-	bool _bLogAnimations = false;
+	std::atomic_bool _bLogAnimations = false;
+
+	Utils::MPSCRingBuffer<AnimationLogEvent, kPendingEventsCapacity> _pendingEvents;
+	std::atomic<uint32_t> _droppedEventCount = 0;
+	ExclusiveLock _processLock;  // there can only be one consumer of _pendingEvents at a time
+
+	// the text log thread only gets the finished lines, the events are resolved on the main thread
+	ExclusiveLock _textLogLinesLock;
+	std::vector<std::string> _pendingTextLogLines;
+
+	ExclusiveLock _textLogThreadLock;
+	std::jthread _textLogThread;
 };
@@ -0,0 +1,229 @@
+#include "AnimationPrefetcher.h"
+
+#include "OpenAnimationReplacer.h"
+#include "Settings.h"
+
+namespace
+{
+	// give the actor's state a moment to settle after the event, e.g. the weapon drawn flag
+	constexpr float kEvaluationDelay = 0.25f;
+	// several events usually come in at once, e.g. entering combat and drawing the weapon
+	constexpr float kRequestCooldown = 2.f;
+	// by then the clips that actually play the animations hold their own references
+	constexpr float kHoldTime = 10.f;
+	// evaluating every original animation of a project isn't free, cap how much a single state change can load
+	constexpr size_t kMaxPrefetchedAnimations = 256;
+	// a project can have thousands of replaced animations, don't evaluate all of them in one frame
+	constexpr size_t kMaxEvaluationsPerFrame = 32;
+}
+
+void AnimationPrefetcher::Register()
+{
+	if (const auto scriptEventSourceHolder = RE::ScriptEventSourceHolder::GetSingleton()) {
+		scriptEventSourceHolder->AddEventSink<RE::TESCombatEvent>(this);
+	}
+
+	if (const auto actionEventSource = SKSE::GetActionEventSource()) {
+		actionEventSource->AddEventSink(this);
+	}
+}
+
+void AnimationPrefetcher::Update()
+{
+	if (!_bHasWork.load(std::memory_order_relaxed) && _activePrefetches.empty()) {
+		return;
+	}
+
+	const float currentTime = OpenAnimationReplacer::gameTimeCounter;
+
+	std::vector<RE::ActorHandle> dueRequests;
+	std::vector<HeldAnimations> expiredAnimations;
+	{
+		Locker locker(_lock);
+
+		std::erase_if(_pendingRequests, [&](const PendingRequest& a_request) {
+			if (a_request.dueTime <= currentTime) {
+				dueRequests.emplace_back(a_request.actorHandle);
+				return true;
+			}
+			return false;
+		});
+
+		while (!_heldAnimations.empty() && _heldAnimations.front().releaseTime <= currentTime) {
+			expiredAnimations.emplace_back(std::move(_heldAnimations.front()));
+			_heldAnimations.pop_front();
+		}
+
+		std::erase_if(_lastRequestTimes, [&](const auto& a_entry) { return currentTime - a_entry.second >= kRequestCooldown; });
+
+		_bHasWork = !_pendingRequests.empty() || !_heldAnimations.empty();
+	}
+
+	// the game's animation loading runs outside the lock
+	for (const auto& heldAnimations : expiredAnimations) {
+		for (const auto animationIndex : heldAnimations.animationIndices) {
+			OpenAnimationReplacer::UnloadAnimation(&heldAnimations.graph->characterInstance, animationIndex);
+		}
+	}
+
+	for (const auto& actorHandle : dueRequests) {
+		if (const auto actor = actorHandle.get()) {
+			StartPrefetch(actor.get());
+		}
+	}
+
+	ContinuePrefetches();
+}
+
+AnimationPrefetcher::Stats AnimationPrefetcher::GetStats() const
+{
+	Locker locker(_lock);
+
+	Stats stats;
+	stats.evaluations = _evaluations;
+	stats.prefetchedAnimations = _prefetchedAnimations;
+	for (const auto& heldAnimations : _heldAnimations) {
+		stats.heldAnimations += static_cast<uint32_t>(heldAnimations.animationIndices.size());
+	}
+
+	return stats;
+}
+
+RE::BSEventNotifyControl AnimationPrefetcher::ProcessEvent(const RE::TESCombatEvent* a_event, [[maybe_unused]] RE::BSTEventSource<RE::TESCombatEvent>* a_eventSource)
+{
+	if (Settings::bPrefetchAnimations && a_event && a_event->actor) {
+		if (const auto actor = a_event->actor->As<RE::Actor>()) {
+			RequestPrefetch(actor);
+		}
+	}
+
+	return RE::BSEventNotifyControl::kContinue;
+}
+
+RE::BSEventNotifyControl AnimationPrefetcher::ProcessEvent(const SKSE::ActionEvent* a_event, [[maybe_unused]] RE::BSTEventSource<SKSE::ActionEvent>* a_eventSource)
+{
+	if (Settings::bPrefetchAnimations && a_event && a_event->actor) {
+		switch (a_event->type.get()) {
+		case SKSE::ActionEvent::Type::kBeginDraw:
+		case SKSE::ActionEvent::Type::kBeginSheathe:
+			RequestPrefetch(a_event->actor);
+			break;
+		default:
+			break;
+		}
+	}
+
+	return RE::BSEventNotifyControl::kContinue;
+}
+
+void AnimationPrefetcher::RequestPrefetch(RE::Actor* a_actor)
+{
+	const float currentTime = OpenAnimationReplacer::gameTimeCounter;
+
+	Locker locker(_lock);
+
+	if (auto [it, bInserted] = _lastRequestTimes.try_emplace(a_actor->GetFormID(), currentTime); !bInserted) {
+		if (currentTime - it->second < kRequestCooldown) {
+			return;
+		}
+		it->second = currentTime;
+	}
+
+	_pendingRequests.emplace_back(a_actor->GetHandle(), currentTime + kEvaluationDelay);
+	_bHasWork = true;
+}
+
+void AnimationPrefetcher::StartPrefetch(RE::Actor* a_actor)
+{
+	RE::BSAnimationGraphManagerPtr graphManager = nullptr;
+	a_actor->GetAnimationGraphManager(graphManager);
+	if (!graphManager) {
+		return;
+	}
+
+	const auto& activeGraph = graphManager->graphs[graphManager->GetRuntimeData().activeGraph];
+	if (!activeGraph) {
+		return;
+	}
+
+	const auto projectData = OpenAnimationReplacer::GetSingleton().GetReplacerProjectData(&activeGraph->characterInstance);
+	if (!projectData) {
+		return;
+	}
+
+	auto& prefetch = _activePrefetches.emplace_back(a_actor->GetHandle(), activeGraph, projectData);
+	projectData->ForEach([&](AnimationReplacements* a_animationReplacements) {
+		prefetch.animationReplacements.emplace_back(a_animationReplacements);
+	});
+}
+
+void AnimationPrefetcher::ContinuePrefetches()
+{
+	size_t evaluationBudget = kMaxEvaluationsPerFrame;
+
+	while (!_activePrefetches.empty() && evaluationBudget > 0) {
+		auto& prefetch = _activePrefetches.front();
+
+		// the actor was unloaded in the meantime
+		const auto actor = prefetch.actorHandle.get();
+		if (!actor) {
+			_activePrefetches.pop_front();
+			continue;
+		}
+
+		auto addIndex = [&](uint16_t a_index) {
+			// animations the preloader still holds are loaded already
+			if (a_index != ReplacerProjectData::kInvalidIndex && !prefetch.projectData->IsAnimationPreloaded(a_index)) {
+				prefetch.animationIndices.emplace_back(a_index);
+			}
+		};
+
+		for (; prefetch.nextIndex < prefetch.animationReplacements.size() && evaluationBudget > 0 && prefetch.animationIndices.size() < kMaxPrefetchedAnimations; ++prefetch.nextIndex) {
+			--evaluationBudget;
+
+			if (const auto replacementAnimation = prefetch.animationReplacements[prefetch.nextIndex]->EvaluateConditionsAndGetReplacementAnimation(actor.get(), nullptr)) {
+				if (replacementAnimation->HasVariants()) {
+					replacementAnimation->ForEachVariant([&](const ReplacementAnimation::Variant& a_variant) {
+						if (!a_variant.IsDisabled()) {
+							addIndex(a_variant.GetIndex());
+						}
+						return RE::BSVisit::BSVisitControl::kContinue;
+					});
+				} else {
+					addIndex(replacementAnimation->GetIndex());
+				}
+			}
+		}
+
+		if (prefetch.nextIndex < prefetch.animationReplacements.size() && prefetch.animationIndices.size() < kMaxPrefetchedAnimations) {
+			// out of budget, resume next frame
+			break;
+		}
+
+		FinishPrefetch(prefetch);
+		_activePrefetches.pop_front();
+	}
+}
+
+void AnimationPrefetcher::FinishPrefetch(ActivePrefetch& a_prefetch)
+{
+	auto& animationIndices = a_prefetch.animationIndices;
+	std::ranges::sort(animationIndices);
+	const auto [first, last] = std::ranges::unique(animationIndices);
+	animationIndices.erase(first, last);
+
+	OpenAnimationReplacer::bIsPreLoading = true;
+	for (const auto animationIndex : animationIndices) {
+		OpenAnimationReplacer::LoadAnimation(&a_prefetch.graph->characterInstance, animationIndex);
+	}
+	OpenAnimationReplacer::bIsPreLoading = false;
+
+	Locker locker(_lock);
+
+	++_evaluations;
+	_prefetchedAnimations += animationIndices.size();
+	if (!animationIndices.empty()) {
+		_heldAnimations.emplace_back(std::move(a_prefetch.graph), std::move(animationIndices), OpenAnimationReplacer::gameTimeCounter + kHoldTime);
+		_bHasWork = true;
+	}
+}
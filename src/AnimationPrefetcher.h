@@ -0,0 +1,87 @@
+#pragma once
+
+class AnimationReplacements;
+class ReplacerProjectData;
+
+// loads the replacement animations an actor is likely to play next when its state changes, before they are activated
+// on combat state changes and weapon draws/sheathes, every original animation of the actor's project is evaluated and the replacement that would win right now is queued for loading
+// the evaluations are spread over several frames, at most kMaxEvaluationsPerFrame per frame, and the animations are loaded once all of them are done
+// random conditions pass without an active clip, so this is slightly optimistic. Conditions on per-frame state (e.g. movement or the current animation) aren't skipped - they're evaluated as the state is at that moment,
+// and there is no way to tell them apart from the rest. A wrong guess only costs a load that is released again, or a replacement that is loaded on demand like without prefetching
+// the loads are released again after a while, by then the clips that actually use the animations hold their own references
+class AnimationPrefetcher final :
+	public RE::BSTEventSink<RE::TESCombatEvent>,
+	public RE::BSTEventSink<SKSE::ActionEvent>
+{
+public:
+	static AnimationPrefetcher& GetSingleton()
+	{
+		static AnimationPrefetcher singleton;
+		return singleton;
+	}
+
+	struct Stats
+	{
+		uint64_t evaluations = 0;  // prefetches run for an actor
+		uint64_t prefetchedAnimations = 0;
+		uint32_t heldAnimations = 0;  // currently loaded by us and not released yet
+	};
+
+	void Register();
+	void Update();  // called every frame from the main update
+
+	[[nodiscard]] Stats GetStats() const;
+
+	RE::BSEventNotifyControl ProcessEvent(const RE::TESCombatEvent* a_event, RE::BSTEventSource<RE::TESCombatEvent>* a_eventSource) override;
+	RE::BSEventNotifyControl ProcessEvent(const SKSE::ActionEvent* a_event, RE::BSTEventSource<SKSE::ActionEvent>* a_eventSource) override;
+
+private:
+	AnimationPrefetcher() = default;
+	AnimationPrefetcher(const AnimationPrefetcher&) = delete;
+	AnimationPrefetcher(AnimationPrefetcher&&) = delete;
+	~AnimationPrefetcher() override = default;
+
+	AnimationPrefetcher& operator=(const AnimationPrefetcher&) = delete;
+	AnimationPrefetcher& operator=(AnimationPrefetcher&&) = delete;
+
+	struct PendingRequest
+	{
+		RE::ActorHandle actorHandle;
+		float dueTime;
+	};
+
+	struct HeldAnimations
+	{
+		// keeps the graph alive so the animations can be unloaded through it
+		RE::BSTSmartPointer<RE::BShkbAnimationGraph> graph;
+		std::vector<uint16_t> animationIndices;
+		float releaseTime;
+	};
+
+	// a prefetch in progress, its actor's animation replacements are evaluated a few at a time
+	struct ActivePrefetch
+	{
+		RE::ActorHandle actorHandle;
+		RE::BSTSmartPointer<RE::BShkbAnimationGraph> graph;  // keeps the graph alive until the prefetch is done
+		ReplacerProjectData* projectData;
+		std::vector<AnimationReplacements*> animationReplacements;
+		size_t nextIndex = 0;
+		std::vector<uint16_t> animationIndices;
+	};
+
+	void RequestPrefetch(RE::Actor* a_actor);
+	void StartPrefetch(RE::Actor* a_actor);
+	void ContinuePrefetches();
+	void FinishPrefetch(ActivePrefetch& a_prefetch);
+
+	mutable ExclusiveLock _lock{ "AnimationPrefetcher::_lock" };
+	std::vector<PendingRequest> _pendingRequests;
+	std::unordered_map<RE::FormID, float> _lastRequestTimes;
+	std::deque<HeldAnimations> _heldAnimations;
+	std::atomic_bool _bHasWork = false;
+
+	std::deque<ActivePrefetch> _activePrefetches;  // only used in the main update, no lock
+
+	uint64_t _evaluations = 0;
+	uint64_t _prefetchedAnimations = 0;
+};
@@ -0,0 +1,97 @@
+#include "AnimationPreloader.h"
+
+#include "OpenAnimationReplacer.h"
+#include "Settings.h"
+
+void AnimationPreloader::Enqueue(RE::BShkbAnimationGraph* a_graph, std::vector<uint16_t>&& a_animationIndices)
+{
+	if (!a_graph || a_animationIndices.empty()) {
+		return;
+	}
+
+	// no rate limit, issue everything right away
+	if (Settings::uPreloadAnimationsPerFrame == 0) {
+		LoadAnimations(a_graph, a_animationIndices);
+		return;
+	}
+
+	const size_t count = a_animationIndices.size();
+
+	Locker locker(_lock);
+	_pendingGraphs.emplace_back(RE::BSTSmartPointer<RE::BShkbAnimationGraph>(a_graph), std::move(a_animationIndices));
+	_pendingCount.fetch_add(count, std::memory_order_relaxed);
+}
+
+void AnimationPreloader::RequestEviction(RE::BShkbAnimationGraph* a_graph)
+{
+	if (!a_graph) {
+		return;
+	}
+
+	Locker locker(_lock);
+	_evictionGraphs.emplace_back(a_graph);
+	_bHasEvictions = true;
+}
+
+void AnimationPreloader::Update()
+{
+	if (_bHasEvictions.load(std::memory_order_relaxed)) {
+		std::vector<RE::BSTSmartPointer<RE::BShkbAnimationGraph>> evictionGraphs;
+		{
+			Locker locker(_lock);
+			evictionGraphs = std::exchange(_evictionGraphs, {});
+			_bHasEvictions = false;
+		}
+
+		// eviction unloads through the game's animation file manager, so it runs here rather than in the clip activation that requested it
+		for (const auto& graph : evictionGraphs) {
+			if (const auto projectData = OpenAnimationReplacer::GetSingleton().GetReplacerProjectData(&graph->characterInstance)) {
+				projectData->EvictUnusedAnimations(&graph->characterInstance);
+			}
+		}
+	}
+
+	if (_pendingCount.load(std::memory_order_relaxed) == 0) {
+		return;
+	}
+
+	// take this frame's batch under the lock, but issue it outside so the game's animation loading never runs while holding it
+	RE::BSTSmartPointer<RE::BShkbAnimationGraph> graph;
+	std::vector<uint16_t> batch;
+	{
+		Locker locker(_lock);
+
+		if (_pendingGraphs.empty()) {
+			return;
+		}
+
+		auto& pendingGraph = _pendingGraphs.front();
+		const size_t count = std::min(static_cast<size_t>(std::max(Settings::uPreloadAnimationsPerFrame, 1u)), pendingGraph.animationIndices.size() - pendingGraph.nextIndex);
+		const auto first = pendingGraph.animationIndices.begin() + static_cast<ptrdiff_t>(pendingGraph.nextIndex);
+
+		graph = pendingGraph.graph;
+		batch.assign(first, first + static_cast<ptrdiff_t>(count));
+		pendingGraph.nextIndex += count;
+
+		if (pendingGraph.nextIndex >= pendingGraph.animationIndices.size()) {
+			_pendingGraphs.pop_front();
+		}
+
+		_pendingCount.fetch_sub(count, std::memory_order_relaxed);
+	}
+
+	LoadAnimations(graph.get(), batch);
+}
+
+void AnimationPreloader::LoadAnimations(RE::BShkbAnimationGraph* a_graph, std::span<const uint16_t> a_animationIndices)
+{
+	OpenAnimationReplacer::bIsPreLoading = true;
+	for (const auto animationIndex : a_animationIndices) {
+		OpenAnimationReplacer::LoadAnimation(&a_graph->characterInstance, animationIndex);
+	}
+	OpenAnimationReplacer::bIsPreLoading = false;
+
+	if (const auto projectData = OpenAnimationReplacer::GetSingleton().GetReplacerProjectData(&a_graph->characterInstance)) {
+		projectData->MarkAnimationsPreloaded(a_animationIndices);
+	}
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+// spreads the preloading of replacement animations over several frames instead of queuing all of them the moment a behavior graph is loaded
+// the animations are issued in the order they were enqueued in (most likely to be needed first), at most Settings::uPreloadAnimationsPerFrame per frame
+// anything that isn't preloaded yet is still loaded on demand by the other hooks, so this only affects how early the animations are ready
+class AnimationPreloader final
+{
+public:
+	static AnimationPreloader& GetSingleton()
+	{
+		static AnimationPreloader singleton;
+		return singleton;
+	}
+
+	void Enqueue(RE::BShkbAnimationGraph* a_graph, std::vector<uint16_t>&& a_animationIndices);
+	void RequestEviction(RE::BShkbAnimationGraph* a_graph);  // evicts the unused animations of the graph's project in the next update, see Settings::bEvictUnusedAnimations
+	void Update();  // called every frame from the main update
+
+	[[nodiscard]] size_t GetPendingCount() const { return _pendingCount.load(std::memory_order_relaxed); }
+
+private:
+	AnimationPreloader() = default;
+	AnimationPreloader(const AnimationPreloader&) = delete;
+	AnimationPreloader(AnimationPreloader&&) = delete;
+	~AnimationPreloader() = default;
+
+	AnimationPreloader& operator=(const AnimationPreloader&) = delete;
+	AnimationPreloader& operator=(AnimationPreloader&&) = delete;
+
+	struct PendingGraph
+	{
+		// keeps the graph alive until all its animations are issued
+		RE::BSTSmartPointer<RE::BShkbAnimationGraph> graph;
+		std::vector<uint16_t> animationIndices;
+		size_t nextIndex = 0;
+	};
+
+	static void LoadAnimations(RE::BShkbAnimationGraph* a_graph, std::span<const uint16_t> a_animationIndices);
+
+	ExclusiveLock _lock{ "AnimationPreloader::_lock" };
+	std::deque<PendingGraph> _pendingGraphs;
+	std::atomic<size_t> _pendingCount = 0;
+	std::vector<RE::BSTSmartPointer<RE::BShkbAnimationGraph>> _evictionGraphs;  // keep the graphs alive so the animations can be unloaded through them
+	std::atomic_bool _bHasEvictions = false;
+};
@@ -0,0 +1,294 @@
+#include "AnimationTrace.h"
+
+#include "ActiveClip.h"
+#include "ReplacementAnimation.h"
+#include "ReplacerMods.h"
+
+static_assert(std::size(AnimationTraceFormat::kEventNames) == static_cast<size_t>(AnimationLogEntry::Event::kInterrupt) + 1);
+
+AnimationTrace::EvaluationScope::EvaluationScope() :
+	_bActive(AnimationTrace::GetSingleton().IsRecording())
+{
+	if (_bActive) {
+		_startTime = std::chrono::steady_clock::now();
+	}
+}
+
+AnimationTrace::EvaluationScope::~EvaluationScope()
+{
+	if (_bActive) {
+		const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - _startTime).count();
+		_lastEvaluationStats.evaluationTime = static_cast<uint32_t>(std::min<int64_t>(elapsed, std::numeric_limits<uint32_t>::max()));
+		_lastEvaluationStats.candidatesTested = _candidatesTested;
+		_lastEvaluationStats.candidates = std::move(_candidates);
+		_conditionCapture = {};
+	}
+}
+
+void AnimationTrace::EvaluationScope::OnCandidateTested(const ReplacementAnimation* a_replacementAnimation, const void* a_conditionSet)
+{
+	++_candidatesTested;
+
+	if (_bActive) {
+		auto& candidate = _candidates.emplace_back(a_replacementAnimation, a_conditionSet);
+		_conditionCapture = { a_conditionSet, a_conditionSet ? &candidate.conditions : nullptr };
+	}
+}
+
+AnimationTrace::EvaluationStats AnimationTrace::ConsumeEvaluationStats()
+{
+	return std::exchange(_lastEvaluationStats, {});
+}
+
+std::vector<AnimationTraceFormat::ConditionRecord>* AnimationTrace::TakeConditionCapture(const void* a_conditionSet)
+{
+	if (_conditionCapture.conditionSet != a_conditionSet) {
+		return nullptr;
+	}
+
+	return std::exchange(_conditionCapture, {}).conditions;
+}
+
+std::optional<std::filesystem::path> AnimationTrace::GetTracePath()
+{
+	auto path = logger::log_directory();
+	if (path) {
+		*path /= std::format("{}.oartrace", Plugin::NAME);
+	}
+	return path;
+}
+
+void AnimationTrace::StartRecording()
+{
+	Locker locker(_writerThreadLock);
+
+	if (_writerThread.joinable()) {
+		return;
+	}
+
+	const auto path = GetTracePath();
+	if (!path) {
+		logger::error("Animation trace: failed to find the log directory");
+		return;
+	}
+
+	{
+		Locker processLocker(_processLock);
+		_encoder.emplace(std::chrono::steady_clock::now());
+	}
+	{
+		Locker bytesLocker(_pendingBytesLock);
+		_pendingBytes.clear();
+	}
+
+	_droppedEventCount = 0;
+	_bRecording = true;
+	_writerThread = std::jthread(&AnimationTrace::WriterThread, this, *path);
+
+	logger::info("Animation trace: recording to {}", path->string());
+}
+
+void AnimationTrace::StopRecording()
+{
+	Locker locker(_writerThreadLock);
+
+	_bRecording = false;
+
+	// hand the rest of the encoded bytes to the writer thread. Events that are still pending are dropped by the next update, that's where their references are released
+	{
+		Locker processLocker(_processLock);
+		if (_encoder) {
+			auto bytes = _encoder->TakeBuffer();
+			{
+				Locker bytesLocker(_pendingBytesLock);
+				_pendingBytes.insert(_pendingBytes.end(), bytes.begin(), bytes.end());
+			}
+			logger::info("Animation trace: wrote {} events, dropped {}", _encoder->GetEventCount(), _droppedEventCount.load());
+			_encoder.reset();
+		}
+	}
+
+	if (_writerThread.joinable()) {
+		_writerThread.request_stop();
+		_writerThread.join();
+	}
+}
+
+void AnimationTrace::RecordEvent(AnimationLogEntry::Event a_event, ActiveClip* a_activeClip, RE::hkbCharacter* a_character)
+{
+	PendingEvent pendingEvent{ AnimationLogEvent(a_event, a_activeClip, a_character), 0, a_activeClip->GetLastEvaluationStats() };
+	if (const auto refr = a_activeClip->GetRefr()) {
+		pendingEvent.refrFormID = refr->GetFormID();
+	}
+
+	if (!_pendingEvents.TryPush(std::move(pendingEvent))) {
+		_droppedEventCount.fetch_add(1, std::memory_order_relaxed);
+	}
+}
+
+void AnimationTrace::Update()
+{
+	if (!_pendingEvents.IsEmpty()) {
+		ProcessPendingEvents();
+	}
+}
+
+void AnimationTrace::ProcessPendingEvents()
+{
+	Locker locker(_processLock);
+
+	PendingEvent pendingEvent;
+	while (_pendingEvents.TryPop(pendingEvent)) {
+		// events left over from a previous recording are dropped
+		if (_encoder && IsRecording() && pendingEvent.logEvent.timestamp >= _encoder->GetStartTime()) {
+			_encoder->EncodeEvent(pendingEvent);
+		}
+		pendingEvent = {};  // release the references
+	}
+
+	if (_encoder) {
+		if (auto bytes = _encoder->TakeBuffer(); !bytes.empty()) {
+			Locker bytesLocker(_pendingBytesLock);
+			_pendingBytes.insert(_pendingBytes.end(), bytes.begin(), bytes.end());
+		}
+	}
+}
+
+void AnimationTrace::WriterThread(std::stop_token a_stopToken, std::filesystem::path a_path)
+{
+	std::ofstream file(a_path, std::ios::binary | std::ios::trunc);
+	if (!file.is_open()) {
+		logger::error("Animation trace: failed to open {}", a_path.string());
+		_bRecording = false;
+		return;
+	}
+
+	auto writePendingBytes = [&]() {
+		std::vector<char> bytes;
+		{
+			Locker locker(_pendingBytesLock);
+			bytes = std::exchange(_pendingBytes, {});
+		}
+
+		if (!bytes.empty()) {
+			file.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+			file.flush();
+		}
+	};
+
+	while (!a_stopToken.stop_requested()) {
+		writePendingBytes();
+		std::this_thread::sleep_for(kWriterThreadInterval);
+	}
+
+	writePendingBytes();
+}
+
+AnimationTrace::Encoder::Encoder(std::chrono::steady_clock::time_point a_startTime) :
+	_startTime(a_startTime)
+{
+	AnimationTraceFormat::Header header{};
+	std::ranges::copy(AnimationTraceFormat::kMagic, header.magic);
+	header.version = AnimationTraceFormat::kVersion;
+	WriteRaw(&header, sizeof(header));
+}
+
+void AnimationTrace::Encoder::EncodeEvent(const PendingEvent& a_pendingEvent)
+{
+	const auto& logEvent = a_pendingEvent.logEvent;
+
+	AnimationTraceFormat::EventRecord record{};
+	record.timestamp = static_cast<uint64_t>(std::max<int64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(logEvent.timestamp - _startTime).count(), 0));
+	record.refrFormID = a_pendingEvent.refrFormID;
+	if (const auto stringData = logEvent.stringData.get()) {
+		record.projectNameId = GetStringId(stringData->name.data());
+	}
+	if (const auto clipGenerator = logEvent.clipGenerator.get()) {
+		record.animationNameId = GetStringId(clipGenerator->animationName.data());
+		record.clipNameId = GetStringId(clipGenerator->name.data());
+	}
+	record.replacementId = GetReplacementId(logEvent.replacementAnimation);
+	record.evaluationTime = a_pendingEvent.evaluationStats.evaluationTime;
+	record.candidatesTested = a_pendingEvent.evaluationStats.candidatesTested;
+	record.originalIndex = logEvent.originalIndex;
+	record.currentIndex = logEvent.currentIndex;
+	record.event = static_cast<uint8_t>(logEvent.event);
+	record.flags = AnimationTraceFormat::kNone;
+	if (logEvent.bInterruptible) {
+		record.flags |= AnimationTraceFormat::kInterruptible;
+	}
+	if (logEvent.replacementAnimation && logEvent.replacementAnimation->HasVariants()) {
+		record.flags |= AnimationTraceFormat::kVariant;
+	}
+
+	// the candidates go first, they belong to the event after them
+	for (const auto& candidate : a_pendingEvent.evaluationStats.candidates) {
+		AnimationTraceFormat::CandidateRecord candidateRecord{};
+		candidateRecord.replacementId = GetReplacementId(candidate.replacementAnimation);
+		candidateRecord.conditionSetId = GetConditionSetId(candidate.conditionSet);
+		candidateRecord.conditionCount = static_cast<uint16_t>(std::min<size_t>(candidate.conditions.size(), std::numeric_limits<uint16_t>::max()));
+
+		WriteChunk(AnimationTraceFormat::ChunkType::kCandidate, candidateRecord);
+		WriteRaw(candidate.conditions.data(), candidateRecord.conditionCount * sizeof(AnimationTraceFormat::ConditionRecord));
+	}
+
+	WriteChunk(AnimationTraceFormat::ChunkType::kEvent, record);
+	++_eventCount;
+}
+
+void AnimationTrace::Encoder::WriteRaw(const void* a_data, size_t a_size)
+{
+	const auto bytes = static_cast<const char*>(a_data);
+	_buffer.insert(_buffer.end(), bytes, bytes + a_size);
+}
+
+uint32_t AnimationTrace::Encoder::GetStringId(std::string_view a_string)
+{
+	if (a_string.empty()) {
+		return 0;
+	}
+
+	const auto [it, bInserted] = _stringIds.try_emplace(std::string(a_string), static_cast<uint32_t>(_stringIds.size() + 1));
+	if (bInserted) {
+		const AnimationTraceFormat::StringDefinition definition{ it->second, static_cast<uint16_t>(std::min<size_t>(a_string.size(), std::numeric_limits<uint16_t>::max())) };
+		WriteChunk(AnimationTraceFormat::ChunkType::kString, definition);
+		WriteRaw(a_string.data(), definition.length);
+	}
+
+	return it->second;
+}
+
+uint32_t AnimationTrace::Encoder::GetReplacementId(const ReplacementAnimation* a_replacementAnimation)
+{
+	if (!a_replacementAnimation) {
+		return 0;
+	}
+
+	if (const auto it = _replacementIds.find(a_replacementAnimation); it != _replacementIds.end()) {
+		return it->second;
+	}
+
+	AnimationTraceFormat::ReplacementDefinition definition{};
+	definition.id = static_cast<uint32_t>(_replacementIds.size() + 1);
+	if (const auto subMod = a_replacementAnimation->GetParentSubMod()) {
+		definition.subModNameId = GetStringId(subMod->GetName());
+		if (const auto parentMod = subMod->GetParentMod()) {
+			definition.modNameId = GetStringId(parentMod->GetName());
+		}
+	}
+	definition.animPathId = GetStringId(a_replacementAnimation->GetAnimPath());
+
+	WriteChunk(AnimationTraceFormat::ChunkType::kReplacement, definition);
+	_replacementIds.emplace(a_replacementAnimation, definition.id);
+
+	return definition.id;
+}
+
+uint32_t AnimationTrace::Encoder::GetConditionSetId(const void* a_conditionSet)
+{
+	if (!a_conditionSet) {
+		return 0;
+	}
+
+	return _conditionSetIds.try_emplace(a_conditionSet, static_cast<uint32_t>(_conditionSetIds.size() + 1)).first->second;
+}
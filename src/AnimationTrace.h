@@ -0,0 +1,146 @@
+#pragma once
+
+#include "AnimationLog.h"
+#include "AnimationTraceFormat.h"
+
+// records every animation event and replacement decision into a compact binary file for offline analysis (see tools/AnimationTraceSummary.cpp)
+// the hooks only push a raw event into a ring buffer. The main update resolves the events into the encoded chunks and releases their references, the writer thread only writes the bytes
+class AnimationTrace
+{
+public:
+	static AnimationTrace& GetSingleton()
+	{
+		static AnimationTrace singleton;
+		return singleton;
+	}
+
+	// the results of the top level conditions of a tested candidate, so the trace can be replayed without the game (see tools/AnimationTraceReplay.cpp)
+	struct CandidateSnapshot
+	{
+		const ReplacementAnimation* replacementAnimation = nullptr;
+		const void* conditionSet = nullptr;  // only used as an id
+		std::vector<AnimationTraceFormat::ConditionRecord> conditions;
+	};
+
+	struct EvaluationStats
+	{
+		uint32_t evaluationTime = 0;  // nanoseconds
+		uint16_t candidatesTested = 0;
+		std::vector<CandidateSnapshot> candidates;
+	};
+
+	// measures a single call evaluating the replacement animations of an AnimationReplacements, only while a trace is being recorded
+	class EvaluationScope
+	{
+	public:
+		EvaluationScope();
+		~EvaluationScope();
+
+		EvaluationScope(const EvaluationScope&) = delete;
+		EvaluationScope(EvaluationScope&&) = delete;
+		EvaluationScope& operator=(const EvaluationScope&) = delete;
+		EvaluationScope& operator=(EvaluationScope&&) = delete;
+
+		// a_conditionSet is the condition set about to be evaluated for the candidate, if any. Its results are captured by ConditionSet::EvaluateAll
+		void OnCandidateTested(const ReplacementAnimation* a_replacementAnimation, const void* a_conditionSet);
+
+	private:
+		bool _bActive;
+		uint16_t _candidatesTested = 0;
+		std::vector<CandidateSnapshot> _candidates;
+		std::chrono::steady_clock::time_point _startTime{};
+	};
+
+	// returns the stats of the last evaluation on this thread and resets them
+	static EvaluationStats ConsumeEvaluationStats();
+
+	// returns where the condition set a_conditionSet should write the results of its top level conditions, if it's the one a candidate is being tested with. Only the first call gets it, nested condition sets aren't captured
+	static std::vector<AnimationTraceFormat::ConditionRecord>* TakeConditionCapture(const void* a_conditionSet);
+
+	static std::optional<std::filesystem::path> GetTracePath();
+
+	[[nodiscard]] bool IsRecording() const { return _bRecording.load(std::memory_order_relaxed); }
+	void StartRecording();
+	void StopRecording();
+
+	void RecordEvent(AnimationLogEntry::Event a_event, ActiveClip* a_activeClip, RE::hkbCharacter* a_character);
+	void Update();  // called every frame from the main update
+
+private:
+	AnimationTrace() = default;
+	AnimationTrace(const AnimationTrace&) = delete;
+	AnimationTrace(AnimationTrace&&) = delete;
+	virtual ~AnimationTrace() { StopRecording(); }
+
+	AnimationTrace& operator=(const AnimationTrace&) = delete;
+	AnimationTrace& operator=(AnimationTrace&&) = delete;
+
+	struct PendingEvent
+	{
+		AnimationLogEvent logEvent;
+		RE::FormID refrFormID = 0;
+		EvaluationStats evaluationStats{};
+	};
+
+	// builds the bytes of the trace from the pending events, only used on the main thread under the process lock
+	class Encoder
+	{
+	public:
+		explicit Encoder(std::chrono::steady_clock::time_point a_startTime);
+
+		void EncodeEvent(const PendingEvent& a_pendingEvent);
+		[[nodiscard]] std::vector<char> TakeBuffer() { return std::exchange(_buffer, {}); }
+
+		[[nodiscard]] std::chrono::steady_clock::time_point GetStartTime() const { return _startTime; }
+		[[nodiscard]] uint64_t GetEventCount() const { return _eventCount; }
+
+	private:
+		template <class T>
+		void WriteChunk(AnimationTraceFormat::ChunkType a_chunkType, const T& a_data)
+		{
+			_buffer.push_back(static_cast<char>(a_chunkType));
+			WriteRaw(&a_data, sizeof(T));
+		}
+
+		void WriteRaw(const void* a_data, size_t a_size);
+		uint32_t GetStringId(std::string_view a_string);
+		uint32_t GetReplacementId(const ReplacementAnimation* a_replacementAnimation);
+		uint32_t GetConditionSetId(const void* a_conditionSet);
+
+		std::vector<char> _buffer;
+		std::chrono::steady_clock::time_point _startTime;
+		std::unordered_map<std::string, uint32_t> _stringIds;
+		std::unordered_map<const ReplacementAnimation*, uint32_t> _replacementIds;
+		std::unordered_map<const void*, uint32_t> _conditionSetIds;
+		uint64_t _eventCount = 0;
+	};
+
+	void ProcessPendingEvents();
+	void WriterThread(std::stop_token a_stopToken, std::filesystem::path a_path);
+
+	static constexpr size_t kPendingEventsCapacity = 4096;
+	static constexpr auto kWriterThreadInterval = 20ms;
+
+	static inline thread_local EvaluationStats _lastEvaluationStats{};
+
+	struct ConditionCapture
+	{
+		const void* conditionSet = nullptr;
+		std::vector<AnimationTraceFormat::ConditionRecord>* conditions = nullptr;
+	};
+	static inline thread_local ConditionCapture _conditionCapture{};
+
+	std::atomic_bool _bRecording = false;
+	Utils::MPSCRingBuffer<PendingEvent, kPendingEventsCapacity> _pendingEvents;
+	std::atomic<uint64_t> _droppedEventCount = 0;
+
+	ExclusiveLock _processLock;  // there can only be one consumer of _pendingEvents at a time
+	std::optional<Encoder> _encoder;
+
+	// the writer thread only gets the encoded bytes, the events are resolved on the main thread
+	ExclusiveLock _pendingBytesLock;
+	std::vector<char> _pendingBytes;
+
+	ExclusiveLock _writerThreadLock;
+	std::jthread _writerThread;
+};
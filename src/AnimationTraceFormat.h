@@ -0,0 +1,220 @@
+#pragma once
+
+// on-disk layout of the animation trace written by AnimationTrace. Doesn't depend on any game headers so it can be shared with tools/AnimationTraceSummary.cpp and tools/AnimationTraceReplay.cpp
+
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace AnimationTraceFormat
+{
+	inline constexpr char kMagic[8] = { 'O', 'A', 'R', 'T', 'R', 'A', 'C', 'E' };
+	inline constexpr uint32_t kVersion = 2;
+	inline constexpr uint32_t kMinVersion = 1;  // version 1 traces have no candidate chunks
+
+	// indexed by AnimationLogEntry::Event
+	inline constexpr const char* kEventNames[] = { "None", "Activate", "Activate paired", "Echo", "Loop", "Activate (replaced)", "Activate paired (replaced)", "Echo (replaced)", "Loop (replaced)", "Interrupt" };
+
+	// every chunk starts with one of these. Strings and replacement definitions are written once, before the first event that references them
+	enum class ChunkType : uint8_t
+	{
+		kString = 1,       // StringDefinition followed by `length` chars, not null terminated
+		kReplacement = 2,  // ReplacementDefinition
+		kEvent = 3,        // EventRecord
+		kCandidate = 4     // CandidateRecord followed by `conditionCount` ConditionRecords. The candidates tested for the next event, in the order they were tested
+	};
+
+	enum EventFlags : uint8_t
+	{
+		kNone = 0,
+		kInterruptible = 1 << 0,
+		kVariant = 1 << 1
+	};
+
+	enum ConditionFlags : uint8_t
+	{
+		kConditionNone = 0,
+		kConditionEvaluated = 1 << 0,  // conditions after the first failing one aren't evaluated
+		kConditionPassed = 1 << 1,
+		kConditionBarrier = 1 << 2  // never reordered, see IsReorderBarrier in BaseConditions.cpp
+	};
+
+	// id 0 is reserved for "none" in all id fields
+#pragma pack(push, 1)
+	struct Header
+	{
+		char magic[8];
+		uint32_t version;
+	};
+
+	struct StringDefinition
+	{
+		uint32_t id;
+		uint16_t length;
+	};
+
+	struct ReplacementDefinition
+	{
+		uint32_t id;
+		uint32_t modNameId;
+		uint32_t subModNameId;
+		uint32_t animPathId;
+	};
+
+	struct EventRecord
+	{
+		uint64_t timestamp;  // nanoseconds since the trace was started
+		uint32_t refrFormID;
+		uint32_t projectNameId;
+		uint32_t animationNameId;
+		uint32_t clipNameId;
+		uint32_t replacementId;     // 0 if the original animation is playing
+		uint32_t evaluationTime;    // nanoseconds spent evaluating conditions for this event, 0 if nothing was evaluated
+		uint16_t candidatesTested;  // number of replacement animations whose conditions were evaluated
+		uint16_t originalIndex;
+		uint16_t currentIndex;
+		uint8_t event;
+		uint8_t flags;
+	};
+
+	// the results of the top level conditions of a tested candidate, enough to replay the replacement selection without the game
+	struct CandidateRecord
+	{
+		uint32_t replacementId;
+		uint32_t conditionSetId;  // the same for every candidate of a submod, 0 if the conditions weren't recorded
+		uint16_t conditionCount;
+	};
+
+	struct ConditionRecord
+	{
+		uint32_t evaluationTime;  // nanoseconds, 0 if not evaluated
+		uint8_t flags;            // ConditionFlags
+	};
+#pragma pack(pop)
+
+	struct TracedCandidate
+	{
+		CandidateRecord record;
+		std::vector<ConditionRecord> conditions;
+	};
+
+	// a fully loaded trace, used by the replay and the summary tool
+	struct Trace
+	{
+		std::unordered_map<uint32_t, std::string> strings;
+		std::unordered_map<uint32_t, ReplacementDefinition> replacements;
+		std::vector<EventRecord> events;
+		std::vector<std::vector<TracedCandidate>> eventCandidates;  // parallel to events
+		uint32_t version = kVersion;
+		bool bTruncated = false;
+
+		[[nodiscard]] std::string GetString(uint32_t a_id) const
+		{
+			if (const auto it = strings.find(a_id); it != strings.end()) {
+				return it->second;
+			}
+			return a_id ? "<unknown string " + std::to_string(a_id) + ">" : std::string{};
+		}
+	};
+
+	namespace detail
+	{
+		template <class T>
+		bool Read(std::istream& a_stream, T& a_out)
+		{
+			return static_cast<bool>(a_stream.read(reinterpret_cast<char*>(&a_out), sizeof(T)));
+		}
+	}
+
+	// returns false and fills a_outError if the file can't be read at all, a trace that ends mid-chunk is loaded up to that point and flagged as truncated
+	inline bool LoadTrace(const std::filesystem::path& a_path, Trace& a_outTrace, std::string& a_outError)
+	{
+		std::ifstream file(a_path, std::ios::binary);
+		if (!file) {
+			a_outError = "failed to open " + a_path.string();
+			return false;
+		}
+
+		Header header{};
+		if (!detail::Read(file, header) || std::memcmp(header.magic, kMagic, sizeof(header.magic)) != 0) {
+			a_outError = a_path.string() + " is not an animation trace";
+			return false;
+		}
+
+		if (header.version < kMinVersion || header.version > kVersion) {
+			a_outError = "unsupported trace version " + std::to_string(header.version) + " (expected " + std::to_string(kMinVersion) + " to " + std::to_string(kVersion) + ")";
+			return false;
+		}
+		a_outTrace.version = header.version;
+
+		std::vector<TracedCandidate> candidates;
+		uint8_t chunkType;
+		while (detail::Read(file, chunkType)) {
+			switch (static_cast<ChunkType>(chunkType)) {
+			case ChunkType::kString:
+				{
+					StringDefinition definition{};
+					std::string string;
+					if (!detail::Read(file, definition)) {
+						a_outTrace.bTruncated = true;
+						return true;
+					}
+					string.resize(definition.length);
+					if (!file.read(string.data(), definition.length)) {
+						a_outTrace.bTruncated = true;
+						return true;
+					}
+					a_outTrace.strings[definition.id] = std::move(string);
+					break;
+				}
+			case ChunkType::kReplacement:
+				{
+					ReplacementDefinition definition{};
+					if (!detail::Read(file, definition)) {
+						a_outTrace.bTruncated = true;
+						return true;
+					}
+					a_outTrace.replacements[definition.id] = definition;
+					break;
+				}
+			case ChunkType::kEvent:
+				{
+					EventRecord record{};
+					if (!detail::Read(file, record)) {
+						a_outTrace.bTruncated = true;
+						return true;
+					}
+					a_outTrace.events.push_back(record);
+					a_outTrace.eventCandidates.push_back(std::move(candidates));
+					candidates.clear();
+					break;
+				}
+			case ChunkType::kCandidate:
+				{
+					TracedCandidate candidate{};
+					if (!detail::Read(file, candidate.record)) {
+						a_outTrace.bTruncated = true;
+						return true;
+					}
+					candidate.conditions.resize(candidate.record.conditionCount);
+					if (!file.read(reinterpret_cast<char*>(candidate.conditions.data()), static_cast<std::streamsize>(candidate.conditions.size() * sizeof(ConditionRecord)))) {
+						a_outTrace.bTruncated = true;
+						return true;
+					}
+					candidates.push_back(std::move(candidate));
+					break;
+				}
+			default:
+				// unknown chunk, can't know its size so stop here
+				a_outTrace.bTruncated = true;
+				return true;
+			}
+		}
+
+		return true;
+	}
+}
@@ -0,0 +1,176 @@
+#include "AnimationTraceReplay.h"
+
+#include "ActiveClip.h"
+#include "AnimationTrace.h"
+#include "OpenAnimationReplacer.h"
+#include "ReplacerMods.h"
+#include "Utils.h"
+
+namespace AnimationTraceReplay
+{
+	namespace
+	{
+		constexpr size_t kMaxMismatches = 50;
+
+		// the replacements of the last replay, per trace event, to compare the next replay of the same trace with
+		struct PreviousReplay
+		{
+			std::filesystem::path path;
+			std::filesystem::file_time_type writeTime;  // a trace recorded again since isn't the same trace
+			size_t events = 0;
+			std::vector<std::optional<std::string>> replacements;
+		};
+
+		PreviousReplay previousReplay;
+
+		uint64_t GetRandomSeed(size_t a_eventIndex, RE::FormID a_refrFormID)
+		{
+			return (static_cast<uint64_t>(a_eventIndex) << 32) | a_refrFormID;
+		}
+
+		std::string GetReplacementName(const AnimationTraceFormat::Trace& a_trace, uint32_t a_replacementId)
+		{
+			if (const auto it = a_trace.replacements.find(a_replacementId); it != a_trace.replacements.end()) {
+				const auto& definition = it->second;
+				return std::format("{} / {} / {}", a_trace.GetString(definition.modNameId), a_trace.GetString(definition.subModNameId), a_trace.GetString(definition.animPathId));
+			}
+			return "Original";
+		}
+
+		std::string GetReplacementName(const ReplacementAnimation* a_replacementAnimation)
+		{
+			if (!a_replacementAnimation) {
+				return "Original";
+			}
+
+			std::string_view modName;
+			std::string_view subModName;
+			if (const auto subMod = a_replacementAnimation->GetParentSubMod()) {
+				subModName = subMod->GetName();
+				if (const auto parentMod = subMod->GetParentMod()) {
+					modName = parentMod->GetName();
+				}
+			}
+
+			return std::format("{} / {} / {}", modName, subModName, a_replacementAnimation->GetAnimPath());
+		}
+	}
+
+	std::optional<Result> Replay(std::string& a_outError)
+	{
+		if (AnimationTrace::GetSingleton().IsRecording()) {
+			a_outError = "the trace is still being recorded";
+			return std::nullopt;
+		}
+
+		const auto path = AnimationTrace::GetTracePath();
+		if (!path) {
+			a_outError = "failed to find the log directory";
+			return std::nullopt;
+		}
+
+		AnimationTraceFormat::Trace trace;
+		if (!AnimationTraceFormat::LoadTrace(*path, trace, a_outError)) {
+			return std::nullopt;
+		}
+
+		std::unordered_map<std::string, ReplacerProjectData*> projects;
+		OpenAnimationReplacer::GetSingleton().ForEachReplacerProjectData([&](RE::hkbCharacterStringData* a_stringData, ReplacerProjectData* a_replacerProjectData) {
+			projects.emplace(a_stringData->name.data(), a_replacerProjectData);
+		});
+
+		Result result;
+		result.events = trace.events.size();
+		result.bTruncated = trace.bTruncated;
+		std::error_code ec;
+		const auto writeTime = std::filesystem::last_write_time(*path, ec);
+		result.bHasPreviousReplay = previousReplay.path == *path && previousReplay.writeTime == writeTime && previousReplay.events == trace.events.size();
+
+		std::vector<std::optional<std::string>> replayedReplacements(trace.events.size());
+
+		for (size_t eventIndex = 0; eventIndex < trace.events.size(); ++eventIndex) {
+			const auto& record = trace.events[eventIndex];
+			const auto event = static_cast<AnimationLogEntry::Event>(record.event);
+			if (record.candidatesTested == 0 || event == AnimationLogEntry::Event::kActivateSynchronized || event == AnimationLogEntry::Event::kActivateReplaceSynchronized) {
+				++result.skippedNotEvaluated;
+				continue;
+			}
+
+			const auto projectIt = projects.find(trace.GetString(record.projectNameId));
+			if (projectIt == projects.end()) {
+				++result.skippedMissingProject;
+				continue;
+			}
+
+			const auto refr = RE::TESForm::LookupByID<RE::TESObjectREFR>(record.refrFormID);
+			if (!refr) {
+				++result.skippedMissingRefr;
+				continue;
+			}
+
+			// conditions can read the clip generator, so the replay needs the live one of the recorded clip - it's only there while the clip is active
+			const auto clipName = trace.GetString(record.clipNameId);
+			const auto activeClip = OpenAnimationReplacer::GetSingleton().GetActiveClipWithPredicate([&](const ActiveClip* a_activeClip) {
+				return a_activeClip->GetRefr() == refr && a_activeClip->GetClipGenerator()->name.data() == clipName;
+			});
+			if (!activeClip) {
+				++result.skippedInactiveClip;
+				continue;
+			}
+
+			// the rolls don't match the recorded ones, but they're the same in every replay
+			const Utils::ScopedRandomSeed randomSeed(GetRandomSeed(eventIndex, record.refrFormID));
+
+			const auto startTime = std::chrono::steady_clock::now();
+			const auto replacementAnimation = projectIt->second->EvaluateConditionsAndGetReplacementAnimation(activeClip->GetClipGenerator(), record.originalIndex, refr);
+			result.replayedEvaluationTime += static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - startTime).count());
+			result.recordedEvaluationTime += record.evaluationTime;
+			++result.replayed;
+
+			auto& replayedReplacement = replayedReplacements[eventIndex];
+			replayedReplacement = GetReplacementName(replacementAnimation);
+
+			if (result.bHasPreviousReplay) {
+				if (const auto& previousReplacement = previousReplay.replacements[eventIndex]) {
+					++result.comparedWithPreviousReplay;
+					if (*previousReplacement == *replayedReplacement) {
+						++result.matchedPreviousReplay;
+					} else if (result.previousReplayMismatches.size() < kMaxMismatches) {
+						result.previousReplayMismatches.emplace_back(record.refrFormID, trace.GetString(record.animationNameId), *previousReplacement, *replayedReplacement);
+					}
+				}
+			}
+
+			if (event != AnimationLogEntry::Event::kActivate && event != AnimationLogEntry::Event::kActivateReplace) {
+				continue;
+			}
+
+			++result.compared;
+			auto recordedReplacement = GetReplacementName(trace, record.replacementId);
+			if (recordedReplacement == *replayedReplacement) {
+				++result.matched;
+			} else if (result.mismatches.size() < kMaxMismatches) {
+				result.mismatches.emplace_back(record.refrFormID, trace.GetString(record.animationNameId), std::move(recordedReplacement), *replayedReplacement);
+			}
+		}
+
+		previousReplay = { *path, writeTime, trace.events.size(), std::move(replayedReplacements) };
+
+		logger::info("Animation trace replay: {} events, {} replayed ({} not evaluated, {} missing project, {} missing reference, {} inactive clip), {}/{} activations matched, evaluation time {:.3f} ms recorded, {:.3f} ms replayed",
+			result.events, result.replayed, result.skippedNotEvaluated, result.skippedMissingProject, result.skippedMissingRefr, result.skippedInactiveClip, result.matched, result.compared, result.recordedEvaluationTime / 1e6, result.replayedEvaluationTime / 1e6);
+
+		for (const auto& mismatch : result.mismatches) {
+			logger::info("\t{:08X} {}: recorded {}, replayed {}", mismatch.refrFormID, mismatch.animationName, mismatch.recordedReplacement, mismatch.replayedReplacement);
+		}
+
+		if (result.bHasPreviousReplay) {
+			logger::info("Animation trace replay: {}/{} events matched the previous replay", result.matchedPreviousReplay, result.comparedWithPreviousReplay);
+
+			for (const auto& mismatch : result.previousReplayMismatches) {
+				logger::info("\t{:08X} {}: previously replayed {}, replayed {}", mismatch.refrFormID, mismatch.animationName, mismatch.recordedReplacement, mismatch.replayedReplacement);
+			}
+		}
+
+		return result;
+	}
+}
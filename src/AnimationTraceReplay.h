@@ -0,0 +1,42 @@
+#pragma once
+
+// replays the condition evaluations of a recorded animation trace against the currently loaded mods and the current state of the recorded references
+// the replay reads the live game state and the live clip generators of the recorded clips, so mismatches against the recording include whatever changed since it was recorded. Events of clips that aren't active anymore are skipped
+// the recorded condition results are replayed without the game by tools/AnimationTraceReplay.cpp instead
+// the random rolls are seeded per event, and each replay is also compared with the previous replay of the same trace - with the game state unchanged, differences there come from the settings or the mods
+namespace AnimationTraceReplay
+{
+	struct Mismatch
+	{
+		RE::FormID refrFormID = 0;
+		std::string animationName;
+		std::string recordedReplacement;
+		std::string replayedReplacement;
+	};
+
+	struct Result
+	{
+		size_t events = 0;
+		size_t replayed = 0;
+		size_t skippedNotEvaluated = 0;  // no conditions were evaluated for the event, or it was synchronized
+		size_t skippedMissingProject = 0;
+		size_t skippedMissingRefr = 0;
+		size_t skippedInactiveClip = 0;
+		size_t compared = 0;  // activations, where the recorded replacement is the evaluated one
+		size_t matched = 0;
+		uint64_t recordedEvaluationTime = 0;  // nanoseconds, of the replayed events
+		uint64_t replayedEvaluationTime = 0;  // nanoseconds
+		bool bTruncated = false;
+
+		std::vector<Mismatch> mismatches;  // first few only
+
+		bool bHasPreviousReplay = false;
+		size_t comparedWithPreviousReplay = 0;  // events replayed both now and by the previous replay
+		size_t matchedPreviousReplay = 0;
+		std::vector<Mismatch> previousReplayMismatches;  // first few only, the recorded replacement is the previous replay's
+
+		[[nodiscard]] double GetMatchRate() const { return compared ? static_cast<double>(matched) / compared : 0.0; }
+	};
+
+	std::optional<Result> Replay(std::string& a_outError);
+}
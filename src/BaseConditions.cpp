@@ -1,5 +1,10 @@
 #include "BaseConditions.h"
+#include "AnimationTrace.h"
+#include "ConfigLimits.h"
+#include "EvaluationProfiler.h"
+#include "MemoryReport.h"
 #include "OpenAnimationReplacer.h"
+#include "Settings.h"
 #include "UI/UICommon.h"
 #include "Utils.h"
 
@@ -27,6 +32,31 @@ namespace Conditions
 		return Hash(a_str, a_size);
 	}
 
+	namespace
+	{
+		// the sources ConditionEvaluation reads the actor values and graph variables of a numeric value from
+		struct ActorValueSource
+		{
+			[[nodiscard]] float GetCurrent() const { return actor->AsActorValueOwner()->GetActorValue(actorValue); }
+			[[nodiscard]] float GetBase() const { return actor->AsActorValueOwner()->GetBaseActorValue(actorValue); }
+			[[nodiscard]] float GetPermanent() const { return actor->AsActorValueOwner()->GetPermanentActorValue(actorValue); }
+			[[nodiscard]] float GetTemporary() const { return actor->GetActorValueModifier(RE::ACTOR_VALUE_MODIFIER::kTemporary, actorValue); }
+
+			RE::Actor* actor;
+			RE::ActorValue actorValue;
+		};
+
+		struct GraphVariableSource
+		{
+			void GetFloat(float& a_outValue) const { refr->GetGraphVariableFloat(name, a_outValue); }
+			void GetInt(int32_t& a_outValue) const { refr->GetGraphVariableInt(name, a_outValue); }
+			void GetBool(bool& a_outValue) const { refr->GetGraphVariableBool(name, a_outValue); }
+
+			RE::TESObjectREFR* refr;
+			std::string_view name;
+		};
+	}
+
 	float NumericValue::GetValue(RE::TESObjectREFR* a_refr) const
 	{
 		switch (_type) {
@@ -35,51 +65,17 @@ namespace Conditions
 		case Type::kGlobalVariable:
 			return _globalVariable.IsValid() ? _globalVariable.GetValue()->value : 0.f;
 		case Type::kActorValue:
-			{
-				float outValue = 0.f;
-				if (a_refr) {
-					switch (_actorValueType) {
-					case ActorValueType::kActorValue:
-						GetActorValue(a_refr, outValue);
-						break;
-					case ActorValueType::kBase:
-						GetActorValueBase(a_refr, outValue);
-						break;
-					case ActorValueType::kMax:
-						GetActorValueMax(a_refr, outValue);
-						break;
-					case ActorValueType::kPercentage:
-						GetActorValuePercentage(a_refr, outValue);
-						break;
-					}
+			if (_actorValue > RE::ActorValue::kNone && _actorValue < RE::ActorValue::kTotal && a_refr) {
+				if (const auto actor = a_refr->As<RE::Actor>()) {
+					return ConditionEvaluation::GetActorValue(_actorValueType, ActorValueSource{ actor, _actorValue });
 				}
-				return outValue;
 			}
+			return 0.f;
 		case Type::kGraphVariable:
-			{
-				if (a_refr) {
-					switch (_graphVariableType) {
-					case GraphVariableType::kFloat:
-						{
-							float outValue = 0.f;
-							a_refr->GetGraphVariableFloat(_graphVariableName.GetValue(), outValue);
-							return outValue;
-						}
-					case GraphVariableType::kInt:
-						{
-							int32_t outValue = 0;
-							a_refr->GetGraphVariableInt(_graphVariableName.GetValue(), outValue);
-							return static_cast<float>(outValue);
-						}
-					case GraphVariableType::kBool:
-						{
-							bool outValue;
-							a_refr->GetGraphVariableBool(_graphVariableName.GetValue(), outValue);
-							return outValue;
-						}
-					}
-				}
+			if (a_refr) {
+				return ConditionEvaluation::GetGraphVariable(_graphVariableType, GraphVariableSource{ a_refr, _graphVariableName.GetValue() });
 			}
+			return 0.f;
 		}
 
 		return 0.f;
@@ -355,76 +351,6 @@ namespace Conditions
 		return object;
 	}
 
-	bool NumericValue::GetActorValue(RE::TESObjectREFR* a_refr, float& a_outValue) const
-	{
-		if (_actorValue > RE::ActorValue::kNone && _actorValue < RE::ActorValue::kTotal && a_refr) {
-			if (const auto actor = a_refr->As<RE::Actor>()) {
-				const auto actorValueOwner = actor->AsActorValueOwner();
-				a_outValue = actorValueOwner->GetActorValue(_actorValue);
-				return true;
-			}
-		}
-
-		return false;
-	}
-
-	bool NumericValue::GetActorValueBase(RE::TESObjectREFR* a_refr, float& a_outValue) const
-	{
-		if (_actorValue > RE::ActorValue::kNone && _actorValue < RE::ActorValue::kTotal && a_refr) {
-			if (const auto actor = a_refr->As<RE::Actor>()) {
-				const auto actorValueOwner = actor->AsActorValueOwner();
-				a_outValue = actorValueOwner->GetBaseActorValue(_actorValue);
-				return true;
-			}
-		}
-
-		return false;
-	}
-
-	bool NumericValue::GetActorValueMax(RE::TESObjectREFR* a_refr, float& a_outValue) const
-	{
-		if (_actorValue > RE::ActorValue::kNone && _actorValue < RE::ActorValue::kTotal && a_refr) {
-			if (const auto actor = a_refr->As<RE::Actor>()) {
-				const auto actorValueOwner = actor->AsActorValueOwner();
-				const float permanentValue = actorValueOwner->GetPermanentActorValue(_actorValue);
-				const float temporaryValue = actor->GetActorValueModifier(RE::ACTOR_VALUE_MODIFIER::kTemporary, _actorValue);
-				a_outValue = permanentValue + temporaryValue;
-				return true;
-			}
-		}
-
-		return false;
-	}
-
-	bool NumericValue::GetActorValuePercentage(RE::TESObjectREFR* a_refr, float& a_outValue) const
-	{
-		if (_actorValue > RE::ActorValue::kNone && _actorValue < RE::ActorValue::kTotal && a_refr) {
-			if (const auto actor = a_refr->As<RE::Actor>()) {
-				const auto actorValueOwner = actor->AsActorValueOwner();
-				const float currentValue = actorValueOwner->GetActorValue(_actorValue);
-				const float permanentValue = actorValueOwner->GetPermanentActorValue(_actorValue);
-				float temporaryValue = temporaryValue = actor->GetActorValueModifier(RE::ACTOR_VALUE_MODIFIER::kTemporary, _actorValue);
-				const float maxValue = permanentValue + temporaryValue;
-
-				if (maxValue <= 0.f) {
-					a_outValue = 0.f;
-					return true;
-				}
-
-				if (maxValue < std::numeric_limits<float>::epsilon() && currentValue < std::numeric_limits<float>::epsilon()) {
-					a_outValue = 0.f;
-					return true;
-				}
-
-				const float percent = currentValue / maxValue;
-				a_outValue = fmin(fmax(percent, 0.f), 1.f);
-				return true;
-			}
-		}
-
-		return false;
-	}
-
 	template <typename T>
 	bool NumericValue::DisplayComboBox(std::map<int32_t, std::string_view> a_enumMap, T& a_value, float a_firstColumnWidthPercent)
 	{
@@ -484,7 +410,7 @@ namespace Conditions
 
 	void TextValue::Parse(const rapidjson::Value& a_value)
 	{
-		_text = (a_value.GetString());
+		_text = ConfigLimits::CapString({ a_value.GetString(), a_value.GetStringLength() });
 	}
 
 	rapidjson::Value TextValue::Serialize([[maybe_unused]] rapidjson::Document::AllocatorType& a_allocator) const
@@ -541,18 +467,143 @@ namespace Conditions
 		return arrayValue;
 	}
 
+	namespace
+	{
+		std::atomic<uint32_t> evaluationOrderGeneration = 0;  // see InvalidateEvaluationOrders
+
+		// conditions that consume random values or come from other plugins (and might have side effects) are never reordered, and nothing is reordered across them
+		bool IsReorderBarrier(ICondition* a_condition)
+		{
+			if (a_condition->IsCustomCondition() || Utils::ConditionHasRandomResult(a_condition)) {
+				return true;
+			}
+
+			for (uint32_t i = 0; i < a_condition->GetNumComponents(); ++i) {
+				const auto component = a_condition->GetComponent(i);
+				if (!component) {
+					continue;
+				}
+
+				if (component->GetType() == ConditionComponentType::kCustom) {
+					return true;
+				}
+
+				if (component->GetType() == ConditionComponentType::kMulti) {
+					if (const auto conditionSet = static_cast<IMultiConditionComponent*>(component)->GetConditions()) {
+						const auto result = conditionSet->ForEachCondition([](auto& a_childCondition) {
+							return IsReorderBarrier(a_childCondition.get()) ? RE::BSVisit::BSVisitControl::kStop : RE::BSVisit::BSVisitControl::kContinue;
+						});
+
+						if (result == RE::BSVisit::BSVisitControl::kStop) {
+							return true;
+						}
+					}
+				}
+			}
+
+			return false;
+		}
+
+		template <class Evaluate>
+		bool CaptureConditionResult(AnimationTraceFormat::ConditionRecord& a_record, Evaluate&& a_evaluate)
+		{
+			const auto startTime = std::chrono::steady_clock::now();
+			const bool bResult = a_evaluate();
+			const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - startTime).count();
+
+			a_record.evaluationTime = static_cast<uint32_t>(std::min<int64_t>(elapsed, std::numeric_limits<uint32_t>::max()));
+			a_record.flags |= AnimationTraceFormat::kConditionEvaluated;
+			if (bResult) {
+				a_record.flags |= AnimationTraceFormat::kConditionPassed;
+			}
+
+			return bResult;
+		}
+	}
+
 	bool ConditionSet::EvaluateAll(RE::TESObjectREFR* a_refr, RE::hkbClipGenerator* a_clipGenerator) const
 	{
-		ReadLocker locker(_lock);
+		bool bResult;
+		bool bUpdateOrder = false;
 
-		return std::ranges::all_of(_conditions, [&](auto& a_condition) { return a_condition->Evaluate(a_refr, a_clipGenerator); });
+		{
+			ReadLocker locker(_lock);
+
+			// the animation trace records the results of the top level conditions of the candidate it's testing
+			const auto capture = AnimationTrace::TakeConditionCapture(this);
+			if (capture) [[unlikely]] {
+				capture->resize(_conditions.size());
+				for (size_t i = 0; i < _conditions.size(); ++i) {
+					(*capture)[i] = { 0, IsReorderBarrier(_conditions[i].get()) ? AnimationTraceFormat::kConditionBarrier : AnimationTraceFormat::kConditionNone };
+				}
+			}
+
+			const auto evaluateCondition = [&](size_t a_index) {
+				if (capture) [[unlikely]] {
+					return CaptureConditionResult((*capture)[a_index], [&]() { return _conditions[a_index]->Evaluate(a_refr, a_clipGenerator); });
+				}
+				return _conditions[a_index]->Evaluate(a_refr, a_clipGenerator);
+			};
+
+			// the profiler measures the conditions in the authored order
+			if (EvaluationProfiler::IsEnabled()) [[unlikely]] {
+				for (size_t i = 0; i < _conditions.size(); ++i) {
+					const EvaluationProfiler::Scope profilerScope(_conditions[i].get());
+					if (!profilerScope.Finish(evaluateCondition(i))) {
+						return false;
+					}
+				}
+				return true;
+			}
+
+			const auto reordering = Settings::bReorderConditions ? &_reordering : nullptr;
+			bResult = ConditionEvaluation::EvaluateAll(reordering, _conditions.size(), evaluationOrderGeneration.load(std::memory_order_acquire), evaluateCondition, bUpdateOrder);
+		}
+
+		if (bUpdateOrder) {
+			UpdateEvaluationOrder();
+		}
+
+		return bResult;
 	}
 
 	bool ConditionSet::EvaluateAny(RE::TESObjectREFR* a_refr, RE::hkbClipGenerator* a_clipGenerator) const
 	{
 		ReadLocker locker(_lock);
 
-		return std::ranges::any_of(_conditions, [&](auto& a_condition) { return a_condition->Evaluate(a_refr, a_clipGenerator); });
+		if (EvaluationProfiler::IsEnabled()) [[unlikely]] {
+			return std::ranges::any_of(_conditions, [&](auto& a_condition) {
+				const EvaluationProfiler::Scope profilerScope(a_condition.get());
+				return profilerScope.Finish(a_condition->Evaluate(a_refr, a_clipGenerator));
+			});
+		}
+
+		return ConditionEvaluation::EvaluateAny(_conditions.size(), [&](size_t a_index) { return _conditions[a_index]->Evaluate(a_refr, a_clipGenerator); });
+	}
+
+	void ConditionSet::UpdateEvaluationOrder() const
+	{
+		// don't wait for other evaluating threads, try again on the next update
+		WriteLocker locker(_lock, std::try_to_lock);
+		if (!locker.owns_lock()) {
+			return;
+		}
+
+		const uint32_t generation = evaluationOrderGeneration.load(std::memory_order_acquire);
+		_reordering.UpdateOrder(_conditions.size(), generation, [&](size_t a_index) { return IsReorderBarrier(_conditions[a_index].get()); });
+	}
+
+	void ConditionSet::ResetEvaluationOrder()
+	{
+		_reordering.Reset();
+
+		// the barriers of the parent sets might have changed too
+		InvalidateEvaluationOrders();
+	}
+
+	void InvalidateEvaluationOrders()
+	{
+		evaluationOrderGeneration.fetch_add(1, std::memory_order_acq_rel);
 	}
 
 	bool ConditionSet::HasInvalidConditions() const
@@ -590,6 +641,7 @@ namespace Conditions
 
 		a_condition->SetParentConditionSet(this);
 		_conditions.emplace_back(std::move(a_condition));
+		ResetEvaluationOrder();
 
 		if (a_bSetDirty) {
 			SetDirty(true);
@@ -606,6 +658,7 @@ namespace Conditions
 			WriteLocker locker(_lock);
 
 			std::erase(_conditions, a_condition);
+			ResetEvaluationOrder();
 		}
 
 		SetDirty(true);
@@ -622,6 +675,7 @@ namespace Conditions
 
 		auto extracted = std::move(a_condition);
 		std::erase(_conditions, a_condition);
+		ResetEvaluationOrder();
 
 		return extracted;
 	}
@@ -634,6 +688,8 @@ namespace Conditions
 
 		WriteLocker locker(_lock);
 
+		ResetEvaluationOrder();
+
 		if (a_bSetDirty) {
 			SetDirty(true);
 		}
@@ -695,6 +751,7 @@ namespace Conditions
 
 			a_newCondition->SetParentConditionSet(this);
 			a_conditionToSubstitute = std::move(a_newCondition);
+			ResetEvaluationOrder();
 		}
 
 		SetDirty(true);
@@ -733,6 +790,7 @@ namespace Conditions
 			auto extractedCondition = std::move(a_sourceCondition);
 			_conditions.erase(_conditions.begin() + sourceIndex);
 			_conditions.insert(_conditions.begin() + targetIndex, std::move(extractedCondition));
+			ResetEvaluationOrder();
 
 			SetDirty(true);
 		} else {
@@ -756,6 +814,7 @@ namespace Conditions
 			} else {
 				_conditions.emplace_back(std::move(extractedCondition));
 			}
+			ResetEvaluationOrder();
 
 			SetDirty(true);
 		}
@@ -771,6 +830,8 @@ namespace Conditions
 		});
 
 		_conditions = std::move(a_otherSet->_conditions);
+		ResetEvaluationOrder();
+		a_otherSet->ResetEvaluationOrder();
 	}
 
 	void ConditionSet::AppendConditions(ConditionSet* a_otherSet)
@@ -787,6 +848,8 @@ namespace Conditions
 		_conditions.reserve(_conditions.size() + a_otherSet->_conditions.size());
 
 		_conditions.insert(_conditions.end(), std::make_move_iterator(a_otherSet->_conditions.begin()), std::make_move_iterator(a_otherSet->_conditions.end()));
+		ResetEvaluationOrder();
+		a_otherSet->ResetEvaluationOrder();
 
 		SetDirty(true);
 	}
@@ -797,6 +860,7 @@ namespace Conditions
 			WriteLocker locker(_lock);
 
 			_conditions.clear();
+			ResetEvaluationOrder();
 		}
 
 		SetDirty(true);
@@ -898,6 +962,64 @@ namespace Conditions
 		return nullptr;
 	}
 
+	namespace
+	{
+		size_t GetConditionComponentSize(ConditionComponentType a_type)
+		{
+			switch (a_type) {
+			case ConditionComponentType::kMulti:
+				return sizeof(MultiConditionComponent);
+			case ConditionComponentType::kForm:
+				return sizeof(FormConditionComponent);
+			case ConditionComponentType::kNumeric:
+				return sizeof(NumericConditionComponent);
+			case ConditionComponentType::kNiPoint3:
+				return sizeof(NiPoint3ConditionComponent);
+			case ConditionComponentType::kKeyword:
+				return sizeof(KeywordConditionComponent);
+			case ConditionComponentType::kText:
+				return sizeof(TextConditionComponent);
+			case ConditionComponentType::kBool:
+				return sizeof(BoolConditionComponent);
+			case ConditionComponentType::kComparison:
+				return sizeof(ComparisonConditionComponent);
+			case ConditionComponentType::kRandom:
+				return sizeof(RandomConditionComponent);
+			default:
+				return sizeof(ICustomConditionComponent);  // the real size is only known to the plugin that added it
+			}
+		}
+	}
+
+	void ConditionSet::AccumulateMemoryUsage(MemoryReport::Usage& a_usage) const
+	{
+		ReadLocker locker(_lock);
+
+		a_usage.conditions += sizeof(ConditionSet) + MemoryReport::GetVectorSize(_conditions) + _reordering.GetHeapSize();
+
+		for (const auto& condition : _conditions) {
+			// the conditions don't differ much in size apart from their components, so use the base size for all of them
+			a_usage.conditions += sizeof(ConditionBase);
+
+			const auto numComponents = condition->GetNumComponents();
+			a_usage.conditions += numComponents * sizeof(std::unique_ptr<IConditionComponent>);
+			for (uint32_t i = 0; i < numComponents; ++i) {
+				const auto component = condition->GetComponent(i);
+				if (!component) {
+					continue;
+				}
+
+				a_usage.conditions += GetConditionComponentSize(component->GetType());
+
+				if (component->GetType() == ConditionComponentType::kMulti) {
+					if (const auto childConditionSet = static_cast<IMultiConditionComponent*>(component)->GetConditions()) {
+						childConditionSet->AccumulateMemoryUsage(a_usage);
+					}
+				}
+			}
+		}
+	}
+
 	void ConditionBase::Initialize(void* a_value)
 	{
 		auto& value = *static_cast<rapidjson::Value*>(a_value);
@@ -1235,22 +1357,7 @@ namespace Conditions
 
 	bool ComparisonConditionComponent::GetComparisonResult(float a_valueA, float a_valueB) const
 	{
-		switch (comparisonOperator) {
-		case ComparisonOperator::kEqual:
-			return a_valueA == a_valueB;
-		case ComparisonOperator::kNotEqual:
-			return a_valueA != a_valueB;
-		case ComparisonOperator::kGreater:
-			return a_valueA > a_valueB;
-		case ComparisonOperator::kGreaterEqual:
-			return a_valueA >= a_valueB;
-		case ComparisonOperator::kLess:
-			return a_valueA < a_valueB;
-		case ComparisonOperator::kLessEqual:
-			return a_valueA <= a_valueB;
-		}
-
-		return false;
+		return ConditionEvaluation::Compare(comparisonOperator, a_valueA, a_valueB);
 	}
 
 	void RandomConditionComponent::InitializeComponent(void* a_value)
@@ -1322,7 +1429,7 @@ namespace Conditions
 			return true;
 		}
 
-		a_outFloat = effolkronium::random_static::get<float>(minValue, maxValue);
+		a_outFloat = Utils::GetRandomFloat(minValue, maxValue);
 		return false;
 	}
 }
@@ -4,6 +4,8 @@
 #include <rapidjson/document.h>
 #include <shared_mutex>
 
+#include "ConditionEvaluation.h"
+#include "LegacyConditions.h"
 #include "UI/UICommon.h"
 #include "Utils.h"
 
@@ -17,6 +19,11 @@ concept NonAbstract = !std::is_abstract_v<T>;
 
 class SubMod;
 
+namespace MemoryReport
+{
+	struct Usage;
+}
+
 namespace Conditions
 {
 	template <Derived<RE::TESForm> T>
@@ -124,17 +131,12 @@ namespace Conditions
 
 		void ParseLegacy(std::string_view a_argument)
 		{
-			if (const size_t splitPos = a_argument.find('|'); splitPos != std::string_view::npos) {
-				_pluginNameString = Utils::TrimQuotes(Utils::TrimWhitespace(a_argument.substr(0, splitPos)));
-				_formIdString = std::string(Utils::TrimHexPrefix(Utils::TrimWhitespace(a_argument.substr(splitPos + 1))));
-				RE::FormID formID;
-				auto [ptr, ec] = std::from_chars(_formIdString.data(), _formIdString.data() + _formIdString.size(), formID, 16);
-				if (ec == std::errc()) {
-					_formIdString = std::format("{:X}", formID);
+			if (const auto reference = LegacyConditions::ParseFormReference(a_argument)) {
+				_pluginNameString = reference->pluginName;
+				_formIdString = std::format("{:X}", reference->formID);
 
-					auto form = Utils::LookupForm<T>(formID, _pluginNameString);
-					SetValue(form);
-				}
+				auto form = Utils::LookupForm<T>(reference->formID, _pluginNameString);
+				SetValue(form);
 			}
 		}
 
@@ -297,11 +299,6 @@ namespace Conditions
 		GraphVariableType _graphVariableType = GraphVariableType::kFloat;
 		TextValue _graphVariableName;
 
-		bool GetActorValue(RE::TESObjectREFR* a_refr, float& a_outValue) const;
-		bool GetActorValueBase(RE::TESObjectREFR* a_refr, float& a_outValue) const;
-		bool GetActorValueMax(RE::TESObjectREFR* a_refr, float& a_outValue) const;
-		bool GetActorValuePercentage(RE::TESObjectREFR* a_refr, float& a_outValue) const;
-
 		static constexpr std::string_view GetActorValueTypeString(ActorValueType a_type)
 		{
 			switch (a_type) {
@@ -619,20 +616,20 @@ namespace Conditions
 		TESFormValue<T> _keywordForm;
 
 		std::string _keywordLiteral{};
-		mutable SharedLock _dataLock{};
+		mutable SharedLock _dataLock{ "KeywordValue::_dataLock" };
 		std::vector<T*> _keywordFormsMatchingLiteral{};
 	};
 
+	// called on any change that might turn a condition into a reorder barrier or back, anywhere in the tree. The barriers of a condition set depend on all the conditions nested in it,
+	// so instead of walking up to every ancestor set all the evaluation orders are rebuilt. Changes only come from the editor so that's rare
+	void InvalidateEvaluationOrders();
+
 	class ConditionBase : public ICondition
 	{
 	public:
 		bool Evaluate(RE::TESObjectREFR* a_refr, RE::hkbClipGenerator* a_clipGenerator) const override
 		{
-			if (_bDisabled) {
-				return true;
-			}
-
-			return _bNegated ? !EvaluateImpl(a_refr, a_clipGenerator) : EvaluateImpl(a_refr, a_clipGenerator);
+			return ConditionEvaluation::EvaluateCondition(_bDisabled, _bNegated, [&]() { return EvaluateImpl(a_refr, a_clipGenerator); });
 		}
 
 		void Initialize(void* a_value) override;
@@ -647,9 +644,17 @@ namespace Conditions
 		[[nodiscard]] RE::BSString GetRequiredPluginAuthor() const override { return ""sv.data(); }
 
 		[[nodiscard]] bool IsDisabled() const override { return _bDisabled; }
-		void SetDisabled(bool a_bDisabled) override { _bDisabled = a_bDisabled; }
+		void SetDisabled(bool a_bDisabled) override
+		{
+			_bDisabled = a_bDisabled;
+			InvalidateEvaluationOrders();
+		}
 		[[nodiscard]] bool IsNegated() const override { return _bNegated; }
-		void SetNegated(bool a_bNegated) override { _bNegated = a_bNegated; }
+		void SetNegated(bool a_bNegated) override
+		{
+			_bNegated = a_bNegated;
+			InvalidateEvaluationOrders();
+		}
 
 		[[nodiscard]] uint32_t GetNumComponents() const override { return static_cast<uint32_t>(_components.size()); }
 		[[nodiscard]] IConditionComponent* GetComponent(uint32_t a_index) const override;
@@ -705,7 +710,13 @@ namespace Conditions
 
 		bool IsEmpty() const { return _conditions.empty(); }
 		bool IsDirty() const { return _bDirty; }
-		void SetDirty(bool a_bDirty) { _bDirty = a_bDirty; }
+		void SetDirty(bool a_bDirty)
+		{
+			_bDirty = a_bDirty;
+			if (a_bDirty) {
+				InvalidateEvaluationOrders();  // every edit in the editor ends up here, including the component values
+			}
+		}
 		bool HasInvalidConditions() const;
 		RE::BSVisit::BSVisitControl ForEachCondition(const std::function<RE::BSVisit::BSVisitControl(std::unique_ptr<ICondition>&)>& a_func);
 		void AddCondition(std::unique_ptr<ICondition>& a_condition, bool a_bSetDirty = false);
@@ -728,11 +739,20 @@ namespace Conditions
 		[[nodiscard]] SubMod* GetParentSubMod() const;
 		[[nodiscard]] const ICondition* GetParentCondition() const;
 
+		void AccumulateMemoryUsage(MemoryReport::Usage& a_usage) const;
+
 	private:
-		mutable std::shared_mutex _lock;
+		// optional runtime reordering of the conditions, see Settings::bReorderConditions
+		// the conditions are evaluated in the order with the lowest expected cost based on measured cost and pass rate, _conditions keeps the authored order for the editor and serialization
+		void UpdateEvaluationOrder() const;
+		void ResetEvaluationOrder();  // call with the write lock held
+
+		mutable SharedLock _lock{ "ConditionSet::_lock" };
 		std::vector<std::unique_ptr<ICondition>> _conditions;
 		bool _bDirty = false;
 
+		mutable ConditionEvaluation::ReorderingEvaluator _reordering;  // the order is only updated with the write lock held
+
 		SubMod* _parentSubMod = nullptr;
 		IMultiConditionComponent* _parentMultiConditionComponent = nullptr;
 	};
@@ -0,0 +1,216 @@
+#include "ConditionBenchmark.h"
+
+#include <rapidjson/document.h>
+#include <rapidjson/filereadstream.h>
+
+#include "OpenAnimationReplacer.h"
+#include "Parsing.h"
+#include "ReplacerMods.h"
+#include "Settings.h"
+
+namespace ConditionBenchmark
+{
+	namespace
+	{
+		constexpr size_t kSlowestSubModCount = 10;
+
+		struct BenchmarkedSubMod
+		{
+			const ReplacerMod* replacerMod;
+			SubMod* subMod;
+			uint64_t totalTime = 0;
+		};
+
+		uint64_t GetPercentile(std::vector<uint64_t>& a_samples, double a_percentile)
+		{
+			if (a_samples.empty()) {
+				return 0;
+			}
+
+			const auto index = static_cast<size_t>(a_percentile * (a_samples.size() - 1));
+			std::ranges::nth_element(a_samples, a_samples.begin() + index);
+			return a_samples[index];
+		}
+
+		template <class T>
+		void ReadNumber(const rapidjson::Value& a_object, const char* a_name, T& a_outValue)
+		{
+			if (const auto it = a_object.FindMember(a_name); it != a_object.MemberEnd() && it->value.IsNumber()) {
+				if constexpr (std::is_floating_point_v<T>) {
+					a_outValue = static_cast<T>(it->value.GetDouble());
+				} else {
+					a_outValue = static_cast<T>(it->value.GetUint64());
+				}
+			}
+		}
+	}
+
+	std::optional<Result> Run(RE::TESObjectREFR* a_refr, std::chrono::milliseconds a_timeBudget)
+	{
+		if (!a_refr) {
+			return std::nullopt;
+		}
+
+		std::vector<BenchmarkedSubMod> subMods;
+		OpenAnimationReplacer::GetSingleton().ForEachReplacerMod([&](ReplacerMod* a_replacerMod) {
+			a_replacerMod->ForEachSubMod([&](SubMod* a_subMod) {
+				if (const auto conditionSet = a_subMod->GetConditionSet(); conditionSet && !conditionSet->IsEmpty()) {
+					subMods.emplace_back(a_replacerMod, a_subMod);
+				}
+				return RE::BSVisit::BSVisitControl::kContinue;
+			});
+		});
+
+		if (subMods.empty()) {
+			return std::nullopt;
+		}
+
+		Result result;
+		result.refrFormID = a_refr->GetFormID();
+		result.bReorderConditions = Settings::bReorderConditions;
+		result.subModCount = static_cast<uint32_t>(subMods.size());
+
+		std::vector<uint64_t> samples;
+		samples.reserve(subMods.size() * 16);
+
+		const auto startTime = std::chrono::steady_clock::now();
+		const auto endTime = startTime + a_timeBudget;
+
+		do {
+			for (auto& benchmarkedSubMod : subMods) {
+				const auto evaluationStartTime = std::chrono::steady_clock::now();
+				const bool bPassed = benchmarkedSubMod.subMod->GetConditionSet()->EvaluateAll(a_refr, nullptr);
+				const auto elapsed = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - evaluationStartTime).count());
+
+				samples.emplace_back(elapsed);
+				benchmarkedSubMod.totalTime += elapsed;
+				result.passedEvaluations += bPassed;
+			}
+			++result.passCount;
+		} while (std::chrono::steady_clock::now() < endTime);
+
+		result.totalTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+		result.evaluations = samples.size();
+		result.p50 = GetPercentile(samples, 0.5);
+		result.p90 = GetPercentile(samples, 0.9);
+		result.p99 = GetPercentile(samples, 0.99);
+		result.max = std::ranges::max(samples);
+
+		std::ranges::sort(subMods, [](const auto& a_lhs, const auto& a_rhs) { return a_lhs.totalTime > a_rhs.totalTime; });
+		for (size_t i = 0; i < std::min(subMods.size(), kSlowestSubModCount); ++i) {
+			const auto& benchmarkedSubMod = subMods[i];
+			result.slowestSubMods.emplace_back(std::string(benchmarkedSubMod.replacerMod->GetName()), std::string(benchmarkedSubMod.subMod->GetName()), benchmarkedSubMod.totalTime / result.passCount);
+		}
+
+		logger::info("Condition benchmark: {} submods, {} passes, {} evaluations in {:.3f} s ({:.0f}/s), p50 {} ns, p90 {} ns, p99 {} ns, max {} ns, refr {:08X}, reordering {}",
+			result.subModCount, result.passCount, result.evaluations, result.totalTime, result.GetEvaluationsPerSecond(), result.p50, result.p90, result.p99, result.max, result.refrFormID, result.bReorderConditions ? "on" : "off");
+
+		return result;
+	}
+
+	std::optional<std::filesystem::path> GetBaselinePath()
+	{
+		auto path = logger::log_directory();
+		if (!path) {
+			return std::nullopt;
+		}
+
+		*path /= std::format("{}_BenchmarkBaseline.json", Plugin::NAME);
+		return path;
+	}
+
+	bool SaveBaseline(const Result& a_result, const std::filesystem::path& a_path)
+	{
+		// keep edited tolerances
+		Baseline previousBaseline;
+		if (const auto loadedBaseline = LoadBaseline(a_path)) {
+			previousBaseline = *loadedBaseline;
+		}
+
+		rapidjson::Document doc(rapidjson::kObjectType);
+		auto& allocator = doc.GetAllocator();
+
+		doc.AddMember("subModCount", a_result.subModCount, allocator);
+		doc.AddMember("reorderConditions", a_result.bReorderConditions, allocator);
+		doc.AddMember("evaluationsPerSecond", a_result.GetEvaluationsPerSecond(), allocator);
+		doc.AddMember("p50", a_result.p50, allocator);
+		doc.AddMember("p90", a_result.p90, allocator);
+		doc.AddMember("p99", a_result.p99, allocator);
+		doc.AddMember("throughputTolerance", previousBaseline.throughputTolerance, allocator);
+		doc.AddMember("latencyTolerance", previousBaseline.latencyTolerance, allocator);
+
+		if (!Parsing::SerializeJson(a_path, doc)) {
+			return false;
+		}
+
+		logger::info("Saved condition benchmark baseline to {}", a_path.string());
+		return true;
+	}
+
+	std::optional<Baseline> LoadBaseline(const std::filesystem::path& a_path)
+	{
+		std::error_code errorCode;
+		if (!std::filesystem::exists(a_path, errorCode)) {
+			return std::nullopt;
+		}
+
+		errno_t err = 0;
+		const std::unique_ptr<FILE, decltype(&fclose)> fp{
+			[&a_path, &err] {
+				FILE* fp = nullptr;
+				err = _wfopen_s(&fp, a_path.c_str(), L"r");
+				return fp;
+			}(),
+			&fclose
+		};
+
+		if (err != 0) {
+			logger::error("Failed to open file: {}", a_path.string());
+			return std::nullopt;
+		}
+
+		char readBuffer[256]{};
+		rapidjson::FileReadStream is{ fp.get(), readBuffer, sizeof(readBuffer) };
+
+		rapidjson::Document doc;
+		doc.ParseStream<rapidjson::kParseIterativeFlag>(is);
+
+		if (doc.HasParseError() || !doc.IsObject()) {
+			logger::error("Failed to parse file: {}", a_path.string());
+			return std::nullopt;
+		}
+
+		Baseline baseline;
+		ReadNumber(doc, "subModCount", baseline.subModCount);
+		if (const auto it = doc.FindMember("reorderConditions"); it != doc.MemberEnd() && it->value.IsBool()) {
+			baseline.bReorderConditions = it->value.GetBool();
+		}
+		ReadNumber(doc, "evaluationsPerSecond", baseline.evaluationsPerSecond);
+		ReadNumber(doc, "p50", baseline.p50);
+		ReadNumber(doc, "p90", baseline.p90);
+		ReadNumber(doc, "p99", baseline.p99);
+		ReadNumber(doc, "throughputTolerance", baseline.throughputTolerance);
+		ReadNumber(doc, "latencyTolerance", baseline.latencyTolerance);
+
+		return baseline;
+	}
+
+	Comparison Compare(const Result& a_result, const Baseline& a_baseline)
+	{
+		Comparison comparison;
+		comparison.bSameSetup = a_result.subModCount == a_baseline.subModCount && a_result.bReorderConditions == a_baseline.bReorderConditions;
+
+		comparison.metrics.emplace_back(CompareMetric("Evaluations per second"sv, a_baseline.evaluationsPerSecond, a_result.GetEvaluationsPerSecond(), a_baseline.throughputTolerance, true));
+		comparison.metrics.emplace_back(CompareMetric("Latency p50 (ns)"sv, static_cast<double>(a_baseline.p50), static_cast<double>(a_result.p50), a_baseline.latencyTolerance, false));
+		comparison.metrics.emplace_back(CompareMetric("Latency p90 (ns)"sv, static_cast<double>(a_baseline.p90), static_cast<double>(a_result.p90), a_baseline.latencyTolerance, false));
+		comparison.metrics.emplace_back(CompareMetric("Latency p99 (ns)"sv, static_cast<double>(a_baseline.p99), static_cast<double>(a_result.p99), a_baseline.latencyTolerance, false));
+
+		for (const auto& metric : comparison.metrics) {
+			if (metric.bRegressed) {
+				logger::warn("Condition benchmark regression: {} {:.1f} -> {:.1f} ({:+.1f}%)", metric.name, metric.baseline, metric.current, metric.GetChange() * 100.0);
+			}
+		}
+
+		return comparison;
+	}
+}
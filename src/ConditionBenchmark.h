@@ -0,0 +1,60 @@
+#pragma once
+
+#include "ConditionBenchmarkComparison.h"
+
+// in-game benchmark of the condition engine - repeatedly evaluates the condition sets of every loaded submod against a reference and reports the throughput and latency percentiles
+// results are also written to the log so they can be compared between builds. tools/ConditionBenchmark.cpp benchmarks the evaluation core (ConditionEvaluation.h) without the game
+namespace ConditionBenchmark
+{
+	struct SubModResult
+	{
+		std::string modName;
+		std::string subModName;
+		uint64_t averageTime = 0;  // nanoseconds
+	};
+
+	struct Result
+	{
+		RE::FormID refrFormID = 0;
+		bool bReorderConditions = false;
+		uint32_t subModCount = 0;
+		uint32_t passCount = 0;
+		uint64_t evaluations = 0;
+		uint64_t passedEvaluations = 0;
+		double totalTime = 0.0;  // seconds
+
+		// latency of a single condition set evaluation, nanoseconds
+		uint64_t p50 = 0;
+		uint64_t p90 = 0;
+		uint64_t p99 = 0;
+		uint64_t max = 0;
+
+		std::vector<SubModResult> slowestSubMods;
+
+		[[nodiscard]] double GetEvaluationsPerSecond() const { return totalTime > 0.0 ? evaluations / totalTime : 0.0; }
+	};
+
+	// runs full passes over all submods until the time budget runs out, at least one
+	std::optional<Result> Run(RE::TESObjectREFR* a_refr, std::chrono::milliseconds a_timeBudget);
+
+	// a saved result that later runs are compared against, so performance regressions between versions or settings stand out
+	// the tolerances are fractions of the baseline value and can be edited in the saved file
+	struct Baseline
+	{
+		uint32_t subModCount = 0;
+		bool bReorderConditions = false;
+		double evaluationsPerSecond = 0.0;
+		uint64_t p50 = 0;
+		uint64_t p90 = 0;
+		uint64_t p99 = 0;
+
+		double throughputTolerance = 0.1;
+		double latencyTolerance = 0.25;  // percentiles are noisier than the throughput
+	};
+
+	[[nodiscard]] std::optional<std::filesystem::path> GetBaselinePath();
+	bool SaveBaseline(const Result& a_result, const std::filesystem::path& a_path);
+	[[nodiscard]] std::optional<Baseline> LoadBaseline(const std::filesystem::path& a_path);
+	// bSameSetup is false if the baseline was saved with a different number of submods or reordering setting
+	[[nodiscard]] Comparison Compare(const Result& a_result, const Baseline& a_baseline);
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+// comparison of condition benchmark results against a saved baseline. Doesn't depend on any game headers so it can be shared with tools/ConditionBenchmark.cpp
+
+#include <algorithm>
+#include <string_view>
+#include <vector>
+
+namespace ConditionBenchmark
+{
+	struct MetricComparison
+	{
+		std::string_view name;
+		double baseline = 0.0;
+		double current = 0.0;
+		bool bRegressed = false;
+
+		[[nodiscard]] double GetChange() const { return baseline != 0.0 ? current / baseline - 1.0 : 0.0; }
+	};
+
+	struct Comparison
+	{
+		bool bSameSetup = true;  // false if the baseline was saved with a different setup, so the numbers aren't directly comparable
+		std::vector<MetricComparison> metrics;
+
+		[[nodiscard]] bool HasRegressions() const { return std::ranges::any_of(metrics, [](const auto& a_metric) { return a_metric.bRegressed; }); }
+	};
+
+	// higher is better for throughputs, lower is better for latencies and costs. The tolerance is a fraction of the baseline value
+	[[nodiscard]] inline MetricComparison CompareMetric(std::string_view a_name, double a_baseline, double a_current, double a_tolerance, bool a_bHigherIsBetter)
+	{
+		MetricComparison comparison{ a_name, a_baseline, a_current };
+		if (a_baseline > 0.0) {
+			comparison.bRegressed = a_bHigherIsBetter ? a_current < a_baseline * (1.0 - a_tolerance) : a_current > a_baseline * (1.0 + a_tolerance);
+		}
+		return comparison;
+	}
+}
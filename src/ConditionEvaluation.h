@@ -0,0 +1,282 @@
+#pragma once
+
+// the game independent part of the condition evaluation. Doesn't depend on any game headers so it can be shared with tools/ConditionBenchmark.cpp
+// the conditions in BaseConditions.cpp/Conditions.cpp and the mock conditions of the benchmark both evaluate through these, the facts are read through a callback or a source - the game's references or a mock
+
+// the runtime reordering of a condition set's conditions, see Settings::bReorderConditions
+// the conditions are only known by index and evaluated through a callback
+// EvaluateAll can run on several threads at once, UpdateOrder and Reset must not run concurrently with anything else, ConditionSet uses its lock for that
+// the barriers are only known when the order is built, so it's tagged with a generation from the caller. An order from another generation is not used, the conditions are evaluated in the authored order until it's rebuilt
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <vector>
+
+namespace ConditionEvaluation
+{
+	class ReorderingEvaluator
+	{
+	public:
+		static constexpr uint32_t kSampleInterval = 8;    // measure every nth evaluation
+		static constexpr uint32_t kUpdateInterval = 256;  // update the order every nth evaluation
+		static constexpr uint32_t kMinSamples = 16;
+		static constexpr uint32_t kMaxSamples = 4096;     // older samples are decayed past this so the order follows changing conditions
+
+		// a_evaluate(index) evaluates the condition at that index of the authored order. a_bOutUpdateOrder is set when the caller should call UpdateOrder afterwards
+		template <class Evaluate>
+		bool EvaluateAll(size_t a_count, uint32_t a_generation, Evaluate&& a_evaluate, bool& a_bOutUpdateOrder)
+		{
+			const uint32_t evaluationCount = _evaluationCount.fetch_add(1, std::memory_order_relaxed) + 1;
+			a_bOutUpdateOrder = evaluationCount % kUpdateInterval == 0;
+
+			// the barriers might have changed since the order was built, rebuild it right away
+			const bool bOutdated = !_statistics.empty() && _generation != a_generation;
+			if (bOutdated) {
+				a_bOutUpdateOrder = true;
+			}
+
+			// not initialized yet, happens on the first update
+			if (_statistics.size() != a_count || bOutdated) {
+				for (size_t i = 0; i < a_count; ++i) {
+					if (!a_evaluate(i)) {
+						return false;
+					}
+				}
+				return true;
+			}
+
+			if (evaluationCount % kSampleInterval != 0) {
+				return std::ranges::all_of(_order, [&](uint16_t a_index) { return a_evaluate(a_index); });
+			}
+
+			// the pass rate is measured for the conditions that are reached in the current order
+			return std::ranges::all_of(_order, [&](uint16_t a_index) {
+				auto& statistics = _statistics[a_index];
+				const auto startTime = std::chrono::steady_clock::now();
+				const bool bResult = a_evaluate(a_index);
+				const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - startTime).count();
+
+				statistics.totalTime.fetch_add(static_cast<uint64_t>(std::max<int64_t>(elapsed, 0)), std::memory_order_relaxed);
+				statistics.evaluations.fetch_add(1, std::memory_order_relaxed);
+				if (bResult) {
+					statistics.passes.fetch_add(1, std::memory_order_relaxed);
+				}
+
+				return bResult;
+			});
+		}
+
+		// a_isBarrier(index) marks conditions that are never moved, and nothing is moved across them
+		// a_generation has to be read before the barriers are checked, so a change made while this runs outdates the new order
+		template <class IsBarrier>
+		void UpdateOrder(size_t a_count, uint32_t a_generation, IsBarrier&& a_isBarrier)
+		{
+			if (a_count > std::numeric_limits<uint16_t>::max()) {
+				return;
+			}
+
+			if (_statistics.size() != a_count) {
+				_statistics = std::vector<Statistics>(a_count);
+				_order.resize(a_count);
+				std::iota(_order.begin(), _order.end(), static_cast<uint16_t>(0));
+				_generation = a_generation;
+				return;
+			}
+
+			// expected cost of a condition per rejected evaluation, evaluating in ascending order minimizes the expected cost of the whole set
+			// conditions without enough samples (usually because they're rarely reached) or that never fail keep their relative order at the end
+			std::vector<float> ranks(a_count, std::numeric_limits<float>::infinity());
+			for (size_t i = 0; i < a_count; ++i) {
+				auto& statistics = _statistics[i];
+				const uint32_t evaluations = statistics.evaluations.load(std::memory_order_relaxed);
+				const uint32_t passes = statistics.passes.load(std::memory_order_relaxed);
+				const uint64_t totalTime = statistics.totalTime.load(std::memory_order_relaxed);
+
+				if (evaluations >= kMinSamples && passes < evaluations) {
+					const float averageTime = static_cast<float>(totalTime) / evaluations;
+					const float failRate = static_cast<float>(evaluations - passes) / evaluations;
+					ranks[i] = averageTime / failRate;
+				}
+
+				if (evaluations > kMaxSamples) {
+					statistics.evaluations.store(evaluations / 2, std::memory_order_relaxed);
+					statistics.passes.store(passes / 2, std::memory_order_relaxed);
+					statistics.totalTime.store(totalTime / 2, std::memory_order_relaxed);
+				}
+			}
+
+			// sort the runs of conditions between the barriers separately, so every barrier is reached with the same conditions evaluated before it
+			std::vector<uint16_t> order(a_count);
+			std::iota(order.begin(), order.end(), static_cast<uint16_t>(0));
+
+			auto sortRun = [&](auto a_begin, auto a_end) {
+				std::stable_sort(a_begin, a_end, [&](uint16_t a_lhs, uint16_t a_rhs) { return ranks[a_lhs] < ranks[a_rhs]; });
+			};
+
+			auto runBegin = order.begin();
+			for (size_t i = 0; i < a_count; ++i) {
+				if (a_isBarrier(i)) {
+					sortRun(runBegin, order.begin() + static_cast<ptrdiff_t>(i));
+					runBegin = order.begin() + static_cast<ptrdiff_t>(i) + 1;
+				}
+			}
+			sortRun(runBegin, order.end());
+
+			_order = std::move(order);
+			_generation = a_generation;
+		}
+
+		void Reset()
+		{
+			_statistics.clear();
+			_order.clear();
+		}
+
+		[[nodiscard]] size_t GetHeapSize() const { return _statistics.capacity() * sizeof(Statistics) + _order.capacity() * sizeof(uint16_t); }
+
+	private:
+		struct Statistics
+		{
+			std::atomic<uint32_t> evaluations = 0;
+			std::atomic<uint32_t> passes = 0;
+			std::atomic<uint64_t> totalTime = 0;  // nanoseconds
+		};
+
+		std::atomic<uint32_t> _evaluationCount = 0;
+		std::vector<Statistics> _statistics;
+		std::vector<uint16_t> _order;
+		uint32_t _generation = 0;  // of the barriers the order was built with
+	};
+
+	// ConditionSet::EvaluateAll with the profiler disabled, a_reordering is null if the conditions aren't reordered
+	template <class Evaluate>
+	[[nodiscard]] bool EvaluateAll(ReorderingEvaluator* a_reordering, size_t a_count, uint32_t a_generation, Evaluate&& a_evaluate, bool& a_bOutUpdateOrder)
+	{
+		a_bOutUpdateOrder = false;
+
+		if (!a_reordering || a_count < 2) {
+			for (size_t i = 0; i < a_count; ++i) {
+				if (!a_evaluate(i)) {
+					return false;
+				}
+			}
+			return true;
+		}
+
+		return a_reordering->EvaluateAll(a_count, a_generation, a_evaluate, a_bOutUpdateOrder);
+	}
+
+	// ConditionSet::EvaluateAny with the profiler disabled
+	template <class Evaluate>
+	[[nodiscard]] bool EvaluateAny(size_t a_count, Evaluate&& a_evaluate)
+	{
+		for (size_t i = 0; i < a_count; ++i) {
+			if (a_evaluate(i)) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	// ConditionBase::Evaluate, a disabled condition always passes
+	template <class EvaluateImpl>
+	[[nodiscard]] bool EvaluateCondition(bool a_bDisabled, bool a_bNegated, EvaluateImpl&& a_evaluateImpl)
+	{
+		if (a_bDisabled) {
+			return true;
+		}
+
+		return a_bNegated ? !a_evaluateImpl() : a_evaluateImpl();
+	}
+
+	// ComparisonConditionComponent, takes Conditions::ComparisonOperator or any enum with the same enumerators
+	template <class ComparisonOperator>
+	[[nodiscard]] constexpr bool Compare(ComparisonOperator a_operator, float a_valueA, float a_valueB)
+	{
+		switch (a_operator) {
+		case ComparisonOperator::kEqual:
+			return a_valueA == a_valueB;
+		case ComparisonOperator::kNotEqual:
+			return a_valueA != a_valueB;
+		case ComparisonOperator::kGreater:
+			return a_valueA > a_valueB;
+		case ComparisonOperator::kGreaterEqual:
+			return a_valueA >= a_valueB;
+		case ComparisonOperator::kLess:
+			return a_valueA < a_valueB;
+		case ComparisonOperator::kLessEqual:
+			return a_valueA <= a_valueB;
+		}
+
+		return false;
+	}
+
+	// the current value relative to the maximum (the permanent value plus the temporary modifier), clamped to [0, 1]
+	[[nodiscard]] inline float GetActorValuePercentage(float a_currentValue, float a_permanentValue, float a_temporaryValue)
+	{
+		const float maxValue = a_permanentValue + a_temporaryValue;
+		if (maxValue <= 0.f) {
+			return 0.f;
+		}
+
+		if (maxValue < std::numeric_limits<float>::epsilon() && a_currentValue < std::numeric_limits<float>::epsilon()) {
+			return 0.f;
+		}
+
+		const float percent = a_currentValue / maxValue;
+		return std::fmin(std::fmax(percent, 0.f), 1.f);
+	}
+
+	// NumericValue with an actor value, takes Conditions::ActorValueType or any enum with the same enumerators
+	// a_source reads one actor value of the actor through GetCurrent(), GetBase(), GetPermanent() and GetTemporary()
+	template <class ActorValueType, class Source>
+	[[nodiscard]] float GetActorValue(ActorValueType a_type, const Source& a_source)
+	{
+		switch (a_type) {
+		case ActorValueType::kActorValue:
+			return a_source.GetCurrent();
+		case ActorValueType::kBase:
+			return a_source.GetBase();
+		case ActorValueType::kMax:
+			return a_source.GetPermanent() + a_source.GetTemporary();
+		case ActorValueType::kPercentage:
+			return GetActorValuePercentage(a_source.GetCurrent(), a_source.GetPermanent(), a_source.GetTemporary());
+		}
+
+		return 0.f;
+	}
+
+	// NumericValue with a graph variable, takes Conditions::GraphVariableType or any enum with the same enumerators
+	// a_source reads one graph variable through GetFloat(float&), GetInt(int32_t&) and GetBool(bool&), and leaves the value alone if the graph doesn't have it
+	template <class GraphVariableType, class Source>
+	[[nodiscard]] float GetGraphVariable(GraphVariableType a_type, const Source& a_source)
+	{
+		switch (a_type) {
+		case GraphVariableType::kFloat:
+			{
+				float value = 0.f;
+				a_source.GetFloat(value);
+				return value;
+			}
+		case GraphVariableType::kInt:
+			{
+				int32_t value = 0;
+				a_source.GetInt(value);
+				return static_cast<float>(value);
+			}
+		case GraphVariableType::kBool:
+			{
+				bool value = false;
+				a_source.GetBool(value);
+				return value ? 1.f : 0.f;
+			}
+		}
+
+		return 0.f;
+	}
+}
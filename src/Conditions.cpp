@@ -29,6 +29,21 @@ namespace Conditions
 		return Hash(a_str, a_size);
 	}
 
+	namespace
+	{
+		// multi conditions create their children recursively, a pathologically nested config could otherwise overflow the stack
+		thread_local uint32_t conditionDepth = 0;
+
+		struct ConditionDepthGuard
+		{
+			ConditionDepthGuard() { ++conditionDepth; }
+			~ConditionDepthGuard() { --conditionDepth; }
+
+			ConditionDepthGuard(const ConditionDepthGuard&) = delete;
+			ConditionDepthGuard& operator=(const ConditionDepthGuard&) = delete;
+		};
+	}
+
 	std::string_view CorrectLegacyConditionName(std::string_view a_conditionName)
 	{
 		if (a_conditionName == "IsEquippedShout"sv) {
@@ -40,39 +55,25 @@ namespace Conditions
 
 	std::unique_ptr<ICondition> CreateConditionFromString(std::string_view a_line)
 	{
-		if (a_line.starts_with(";"sv)) {
-			return nullptr;
+		if (const auto line = LegacyConditions::ParseLine(a_line)) {
+			return CreateConditionFromLegacyLine(*line);
 		}
 
-		const bool bNOT = a_line.starts_with("NOT"sv);
-
-		if (bNOT) {
-			a_line = a_line.substr(3);
-			a_line = Utils::TrimWhitespace(a_line);
-		}
-		const size_t functionEndPos = a_line.find_first_of(" ("sv);
-		const size_t argumentStartPos = a_line.find_first_not_of(" ("sv, functionEndPos);
-		const size_t argumentEndPos = a_line.find(")"sv);
-
-		std::string conditionName;
-		std::string argument;
-		if (functionEndPos == std::string_view::npos || argumentStartPos == std::string_view::npos) {
-			conditionName = a_line;
-			argument = ""sv;
-		} else {
-			conditionName = a_line.substr(0, functionEndPos);
-			argument = a_line.substr(argumentStartPos, argumentEndPos - argumentStartPos);
-		}
+		return nullptr;
+	}
 
-		if (auto condition = OpenAnimationReplacer::GetSingleton().CreateCondition(CorrectLegacyConditionName(conditionName))) {
+	std::unique_ptr<ICondition> CreateConditionFromLegacyLine(const LegacyConditions::Line& a_line)
+	{
+		if (auto condition = OpenAnimationReplacer::GetSingleton().CreateCondition(CorrectLegacyConditionName(a_line.name))) {
+			const std::string argument(a_line.argument);
 			condition->PreInitialize();
 			condition->InitializeLegacy(argument.data());
-			condition->SetNegated(bNOT);
+			condition->SetNegated(a_line.bNegated);
 			condition->PostInitialize();
 			return std::move(condition);
 		}
 
-		auto errorStr = std::format("Invalid line: \"{}\"", a_line);
+		auto errorStr = std::format("Invalid line: \"{}\"", a_line.text);
 		return std::make_unique<InvalidCondition>(errorStr);
 	}
 
@@ -83,6 +84,14 @@ namespace Conditions
 			return std::make_unique<InvalidCondition>("Missing condition value");
 		}
 
+		if (conditionDepth >= ConfigLimits::kMaxConditionDepth) {
+			auto errorStr = std::format("Conditions nested deeper than {} levels!", ConfigLimits::kMaxConditionDepth);
+			logger::error("{}", errorStr);
+			return std::make_unique<InvalidCondition>(errorStr);
+		}
+
+		ConditionDepthGuard depthGuard;
+
 		const auto object = a_value.GetObj();
 
 		if (const auto conditionNameIt = object.FindMember("condition"); conditionNameIt != object.MemberEnd() && conditionNameIt->value.IsString()) {
@@ -90,7 +99,7 @@ namespace Conditions
 			std::string requiredPluginName;
 			if (const auto requiredPluginIt = object.FindMember("requiredPlugin"); requiredPluginIt != object.MemberEnd() && requiredPluginIt->value.IsString()) {
 				bHasRequiredPlugin = true;
-				requiredPluginName = requiredPluginIt->value.GetString();
+				requiredPluginName = ConfigLimits::CapString({ requiredPluginIt->value.GetString(), requiredPluginIt->value.GetStringLength() });
 			}
 
 			REL::Version requiredVersion;
@@ -98,7 +107,7 @@ namespace Conditions
 				requiredVersion = REL::Version(requiredVersionIt->value.GetString());
 			}
 
-			std::string conditionName = conditionNameIt->value.GetString();
+			std::string conditionName(ConfigLimits::CapString({ conditionNameIt->value.GetString(), conditionNameIt->value.GetStringLength() }));
 
 			if (bHasRequiredPlugin && !requiredPluginName.empty()) {
 				// check if required plugin is loaded and is the required version or higher
@@ -827,9 +836,8 @@ namespace Conditions
 	void CompareValues::InitializeLegacy(const char* a_argument)
 	{
 		std::string_view argument(a_argument);
-		if (const size_t splitPos = argument.find(','); splitPos != std::string_view::npos) {
-			const std::string_view firstArg = Utils::TrimWhitespace(argument.substr(0, splitPos));
-			const std::string_view secondArg = Utils::TrimWhitespace(argument.substr(splitPos + 1));
+		if (const auto arguments = LegacyConditions::SplitArguments(argument)) {
+			const auto& [firstArg, secondArg] = *arguments;
 
 			const bool bIsActorValue = numericComponentA->value.GetType() == NumericValue::Type::kActorValue;
 			numericComponentA->value.ParseLegacy(firstArg, bIsActorValue);
@@ -1328,9 +1336,8 @@ namespace Conditions
 	void FactionRankCondition::InitializeLegacy(const char* a_argument)
 	{
 		std::string_view argument(a_argument);
-		if (const size_t splitPos = argument.find(','); splitPos != std::string_view::npos) {
-			const std::string_view firstArg = Utils::TrimWhitespace(argument.substr(0, splitPos));
-			const std::string_view secondArg = Utils::TrimWhitespace(argument.substr(splitPos + 1));
+		if (const auto arguments = LegacyConditions::SplitArguments(argument)) {
+			const auto& [firstArg, secondArg] = *arguments;
 
 			numericComponent->value.ParseLegacy(firstArg);
 			factionComponent->form.ParseLegacy(secondArg);
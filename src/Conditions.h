@@ -2,11 +2,13 @@
 #include <rapidjson/document.h>
 
 #include "BaseConditions.h"
+#include "LegacyConditions.h"
 
 namespace Conditions
 {
 	[[nodiscard]] std::string_view CorrectLegacyConditionName(std::string_view a_conditionName);
 	[[nodiscard]] std::unique_ptr<ICondition> CreateConditionFromString(std::string_view a_line);
+	[[nodiscard]] std::unique_ptr<ICondition> CreateConditionFromLegacyLine(const LegacyConditions::Line& a_line);
 	[[nodiscard]] std::unique_ptr<ICondition> CreateConditionFromJson(rapidjson::Value& a_value);
 	[[nodiscard]] std::unique_ptr<ICondition> CreateCondition(std::string_view a_conditionName);
 	[[nodiscard]] std::unique_ptr<ICondition> DuplicateCondition(const std::unique_ptr<ICondition>& a_conditionToDuplicate);
@@ -0,0 +1,32 @@
+#pragma once
+
+// limits on what the config parsers accept, so a broken or malicious config can't exhaust the memory or the stack. Doesn't depend on any game headers so it can be shared with tools/ConditionsTxtHarness.h
+// real configs stay far below all of them
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace ConfigLimits
+{
+	inline constexpr size_t kMaxStringLength = 4096;       // names, descriptions, paths and condition names in json, longer ones are cut off
+	inline constexpr uint32_t kMaxConditionDepth = 64;     // multi conditions create their children recursively
+	inline constexpr size_t kMaxTxtFileSize = 1 << 20;     // legacy _conditions.txt, bigger files aren't parsed at all
+	inline constexpr size_t kMaxTxtLineLength = 4096;      // longer lines become invalid conditions
+	inline constexpr size_t kMaxTxtConditionCount = 4096;  // the rest of the file is ignored past this
+
+	// cuts a_string off at kMaxStringLength, without splitting a UTF-8 sequence
+	[[nodiscard]] constexpr std::string_view CapString(std::string_view a_string)
+	{
+		if (a_string.size() <= kMaxStringLength) {
+			return a_string;
+		}
+
+		size_t length = kMaxStringLength;
+		while (length > 0 && (static_cast<unsigned char>(a_string[length]) & 0xC0) == 0x80) {
+			--length;
+		}
+
+		return a_string.substr(0, length);
+	}
+}
@@ -1,6 +1,7 @@
 #include "DetectedProblems.h"
 
 #include "OpenAnimationReplacer.h"
+#include "StartupTrace.h"
 #include "UI/UIManager.h"
 
 #include <ranges>
@@ -43,6 +44,8 @@ void DetectedProblems::AddInvalidPluginName(std::string_view a_pluginName, REL::
 
 void DetectedProblems::CheckForSubModsSharingPriority()
 {
+	StartupTrace::Scope traceScope("problems", "CheckForSubModsSharingPriority"sv);
+
 	// check for duplicated priorities
 	WriteLocker locker(_dataLock);
 	_subModsSharingPriority.clear();
@@ -107,6 +110,8 @@ void DetectedProblems::CheckForSubModsSharingPriority()
 
 void DetectedProblems::CheckForSubModsWithInvalidConditions()
 {
+	StartupTrace::Scope traceScope("problems", "CheckForSubModsWithInvalidConditions"sv);
+
 	WriteLocker locker(_dataLock);
 	_subModsWithInvalidConditions.clear();
 
@@ -61,5 +61,5 @@ private:
 	std::map<int32_t, std::set<const SubMod*>> _subModsSharingPriority;
 	std::set<const SubMod*> _subModsWithInvalidConditions;
 
-	mutable SharedLock _dataLock;
+	mutable SharedLock _dataLock{ "DetectedProblems::_dataLock" };
 };
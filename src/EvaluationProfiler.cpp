@@ -0,0 +1,222 @@
+#include "EvaluationProfiler.h"
+
+#include "OpenAnimationReplacer.h"
+#include "ReplacerMods.h"
+
+namespace
+{
+	uint64_t ToNanoseconds(std::chrono::steady_clock::duration a_duration)
+	{
+		return static_cast<uint64_t>(std::max<int64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(a_duration).count(), 0));
+	}
+
+	void ForEachConditionRecursive(Conditions::ConditionSet* a_conditionSet, const std::function<void(const Conditions::ICondition*)>& a_func)
+	{
+		if (!a_conditionSet) {
+			return;
+		}
+
+		a_conditionSet->ForEachCondition([&](std::unique_ptr<Conditions::ICondition>& a_condition) {
+			a_func(a_condition.get());
+
+			for (uint32_t i = 0; i < a_condition->GetNumComponents(); ++i) {
+				const auto component = a_condition->GetComponent(i);
+				if (component && component->GetType() == Conditions::ConditionComponentType::kMulti) {
+					ForEachConditionRecursive(static_cast<Conditions::IMultiConditionComponent*>(component)->GetConditions(), a_func);
+				}
+			}
+
+			return RE::BSVisit::BSVisitControl::kContinue;
+		});
+	}
+
+	std::string EscapeCSV(std::string_view a_string)
+	{
+		std::string result = "\"";
+		for (const char c : a_string) {
+			if (c == '"') {
+				result += '"';
+			}
+			result += c;
+		}
+		result += '"';
+		return result;
+	}
+}
+
+void EvaluationProfiler::Record(const SubMod* a_subMod, bool a_bPassed, std::chrono::steady_clock::time_point a_startTime, std::chrono::steady_clock::time_point a_endTime)
+{
+	auto& threadCounters = GetThreadCounters();
+	Locker locker(threadCounters.lock);
+	threadCounters.subMods[a_subMod].Add(a_bPassed, ToNanoseconds(a_endTime - a_startTime));
+	MergeThreadCountersIfDue(threadCounters, a_endTime);
+}
+
+void EvaluationProfiler::Record(const Conditions::ICondition* a_condition, bool a_bPassed, std::chrono::steady_clock::time_point a_startTime, std::chrono::steady_clock::time_point a_endTime)
+{
+	auto& threadCounters = GetThreadCounters();
+	Locker locker(threadCounters.lock);
+	threadCounters.conditions[a_condition].Add(a_bPassed, ToNanoseconds(a_endTime - a_startTime));
+	MergeThreadCountersIfDue(threadCounters, a_endTime);
+}
+
+void EvaluationProfiler::MergeThreadCounters()
+{
+	const auto now = std::chrono::steady_clock::now();
+
+	Locker locker(_threadCountersLock);
+	for (const auto& threadCounters : _allThreadCounters) {
+		Locker threadLocker(threadCounters->lock);
+		MergeThreadCounters(*threadCounters, now);
+	}
+
+	// the thread is gone and everything it recorded was merged above
+	std::erase_if(_allThreadCounters, [](const auto& a_threadCounters) { return a_threadCounters.use_count() == 1; });
+}
+
+void EvaluationProfiler::Reset()
+{
+	Locker locker(_threadCountersLock);
+	for (const auto& threadCounters : _allThreadCounters) {
+		Locker threadLocker(threadCounters->lock);
+		threadCounters->subMods.clear();
+		threadCounters->conditions.clear();
+	}
+
+	Locker statsLocker(_statsLock);
+	_subModStats.clear();
+	_conditionStats.clear();
+}
+
+std::vector<EvaluationProfiler::SubModEntry> EvaluationProfiler::CollectSubModEntries() const
+{
+	std::vector<SubModEntry> entries;
+
+	std::unordered_map<const SubMod*, Stats> subModStats;
+	{
+		Locker locker(_statsLock);
+		subModStats = _subModStats;
+	}
+
+	if (subModStats.empty()) {
+		return entries;
+	}
+
+	OpenAnimationReplacer::GetSingleton().ForEachReplacerMod([&](ReplacerMod* a_replacerMod) {
+		a_replacerMod->ForEachSubMod([&](SubMod* a_subMod) {
+			if (const auto it = subModStats.find(a_subMod); it != subModStats.end()) {
+				entries.emplace_back(std::string(a_replacerMod->GetName()), std::string(a_subMod->GetName()), it->second);
+			}
+			return RE::BSVisit::BSVisitControl::kContinue;
+		});
+	});
+
+	return entries;
+}
+
+std::vector<EvaluationProfiler::ConditionEntry> EvaluationProfiler::CollectConditionEntries() const
+{
+	std::vector<ConditionEntry> entries;
+
+	std::unordered_map<const Conditions::ICondition*, Stats> conditionStats;
+	{
+		Locker locker(_statsLock);
+		conditionStats = _conditionStats;
+	}
+
+	if (conditionStats.empty()) {
+		return entries;
+	}
+
+	OpenAnimationReplacer::GetSingleton().ForEachReplacerMod([&](ReplacerMod* a_replacerMod) {
+		a_replacerMod->ForEachSubMod([&](SubMod* a_subMod) {
+			auto collect = [&](const Conditions::ICondition* a_condition) {
+				if (const auto it = conditionStats.find(a_condition); it != conditionStats.end()) {
+					const auto argument = a_condition->GetArgument();
+					auto conditionName = std::format("{}{}", a_condition->IsNegated() ? "NOT " : "", a_condition->GetName().data());
+					if (!argument.empty()) {
+						conditionName += std::format(" ({})", argument.data());
+					}
+					entries.emplace_back(std::move(conditionName), std::string(a_replacerMod->GetName()), std::string(a_subMod->GetName()), it->second);
+				}
+			};
+
+			ForEachConditionRecursive(a_subMod->GetConditionSet(), collect);
+			ForEachConditionRecursive(a_subMod->GetSynchronizedConditionSet(), collect);
+
+			return RE::BSVisit::BSVisitControl::kContinue;
+		});
+	});
+
+	return entries;
+}
+
+bool EvaluationProfiler::ExportCSV(const std::filesystem::path& a_path) const
+{
+	std::ofstream file(a_path, std::ios::trunc);
+	if (!file.is_open()) {
+		logger::error("Failed to export evaluation profile to {}", a_path.string());
+		return false;
+	}
+
+	file << "Type,Mod,Submod,Condition,Evaluations,Passes,Pass rate,Total time (ms),Average time (us),Peak time (us)\n";
+
+	auto writeStats = [&](const Stats& a_stats) {
+		file << std::format("{},{},{:.4f},{:.3f},{:.3f},{:.3f}\n", a_stats.evaluations, a_stats.passes, a_stats.GetPassRate(), a_stats.totalTime / 1e6, a_stats.GetAverageTime() / 1e3, a_stats.peakTime / 1e3);
+	};
+
+	for (const auto& entry : CollectSubModEntries()) {
+		file << std::format("Submod,{},{},,", EscapeCSV(entry.modName), EscapeCSV(entry.subModName));
+		writeStats(entry.stats);
+	}
+
+	for (const auto& entry : CollectConditionEntries()) {
+		file << std::format("Condition,{},{},{},", EscapeCSV(entry.modName), EscapeCSV(entry.subModName), EscapeCSV(entry.conditionName));
+		writeStats(entry.stats);
+	}
+
+	logger::info("Exported evaluation profile to {}", a_path.string());
+	return true;
+}
+
+EvaluationProfiler::ThreadCounters& EvaluationProfiler::GetThreadCounters()
+{
+	if (!_threadCounters) {
+		_threadCounters = std::make_shared<ThreadCounters>();
+
+		Locker locker(_threadCountersLock);
+		_allThreadCounters.push_back(_threadCounters);
+	}
+
+	return *_threadCounters;
+}
+
+void EvaluationProfiler::MergeThreadCountersIfDue(ThreadCounters& a_threadCounters, std::chrono::steady_clock::time_point a_now)
+{
+	if (a_now - a_threadCounters.lastMergeTime >= kMergeInterval) {
+		MergeThreadCounters(a_threadCounters, a_now);
+	}
+}
+
+void EvaluationProfiler::MergeThreadCounters(ThreadCounters& a_threadCounters, std::chrono::steady_clock::time_point a_now)
+{
+	a_threadCounters.lastMergeTime = a_now;
+
+	if (a_threadCounters.subMods.empty() && a_threadCounters.conditions.empty()) {
+		return;
+	}
+
+	{
+		Locker locker(_statsLock);
+
+		for (const auto& [subMod, stats] : a_threadCounters.subMods) {
+			_subModStats[subMod].Merge(stats);
+		}
+		for (const auto& [condition, stats] : a_threadCounters.conditions) {
+			_conditionStats[condition].Merge(stats);
+		}
+	}
+
+	a_threadCounters.subMods.clear();
+	a_threadCounters.conditions.clear();
+}
@@ -0,0 +1,139 @@
+#pragma once
+
+class SubMod;
+
+namespace Conditions
+{
+	class ICondition;
+}
+
+// opt-in profiler for condition evaluation - accumulates evaluation count, pass rate and total/peak time per submod and per condition instance
+// every thread accumulates into its own counters and merges them into the shared ones every so often, so the evaluating threads don't fight over a lock
+// the counters of every thread are also registered here so the UI can flush them all when it takes a snapshot, including threads that went idle or ended
+class EvaluationProfiler
+{
+public:
+	static EvaluationProfiler& GetSingleton()
+	{
+		static EvaluationProfiler singleton;
+		return singleton;
+	}
+
+	struct Stats
+	{
+		uint64_t evaluations = 0;
+		uint64_t passes = 0;
+		uint64_t totalTime = 0;  // nanoseconds
+		uint64_t peakTime = 0;   // nanoseconds
+
+		void Add(bool a_bPassed, uint64_t a_time)
+		{
+			++evaluations;
+			passes += a_bPassed;
+			totalTime += a_time;
+			peakTime = std::max(peakTime, a_time);
+		}
+
+		void Merge(const Stats& a_other)
+		{
+			evaluations += a_other.evaluations;
+			passes += a_other.passes;
+			totalTime += a_other.totalTime;
+			peakTime = std::max(peakTime, a_other.peakTime);
+		}
+
+		[[nodiscard]] double GetPassRate() const { return evaluations ? static_cast<double>(passes) / evaluations : 0.0; }
+		[[nodiscard]] double GetAverageTime() const { return evaluations ? static_cast<double>(totalTime) / evaluations : 0.0; }
+	};
+
+	// times a single evaluation of a submod or a condition, does nothing if the profiler is disabled
+	template <class T>
+	class Scope
+	{
+	public:
+		explicit Scope(const T* a_object) :
+			_object(IsEnabled() ? a_object : nullptr)
+		{
+			if (_object) {
+				_startTime = std::chrono::steady_clock::now();
+			}
+		}
+
+		bool Finish(bool a_bResult) const
+		{
+			if (_object) {
+				GetSingleton().Record(_object, a_bResult, _startTime, std::chrono::steady_clock::now());
+			}
+			return a_bResult;
+		}
+
+	private:
+		const T* _object;
+		std::chrono::steady_clock::time_point _startTime{};
+	};
+
+	struct SubModEntry
+	{
+		std::string modName;
+		std::string subModName;
+		Stats stats;
+	};
+
+	struct ConditionEntry
+	{
+		std::string conditionName;
+		std::string modName;
+		std::string subModName;
+		Stats stats;
+	};
+
+	[[nodiscard]] static bool IsEnabled() { return _bEnabled.load(std::memory_order_relaxed); }
+	static void SetEnabled(bool a_bEnabled) { _bEnabled.store(a_bEnabled, std::memory_order_relaxed); }
+
+	void Record(const SubMod* a_subMod, bool a_bPassed, std::chrono::steady_clock::time_point a_startTime, std::chrono::steady_clock::time_point a_endTime);
+	void Record(const Conditions::ICondition* a_condition, bool a_bPassed, std::chrono::steady_clock::time_point a_startTime, std::chrono::steady_clock::time_point a_endTime);
+
+	void MergeThreadCounters();  // merges the pending counters of all threads, call before collecting the entries
+	void Reset();
+
+	// entries are only collected for submods and conditions that currently exist, the stats are keyed by pointer and might outlive them
+	[[nodiscard]] std::vector<SubModEntry> CollectSubModEntries() const;
+	[[nodiscard]] std::vector<ConditionEntry> CollectConditionEntries() const;
+
+	bool ExportCSV(const std::filesystem::path& a_path) const;
+
+private:
+	EvaluationProfiler() = default;
+	EvaluationProfiler(const EvaluationProfiler&) = delete;
+	EvaluationProfiler(EvaluationProfiler&&) = delete;
+	virtual ~EvaluationProfiler() = default;
+
+	EvaluationProfiler& operator=(const EvaluationProfiler&) = delete;
+	EvaluationProfiler& operator=(EvaluationProfiler&&) = delete;
+
+	// the lock is only contended when another thread flushes or resets the counters
+	struct ThreadCounters
+	{
+		ExclusiveLock lock{ "EvaluationProfiler::ThreadCounters::lock" };
+		std::unordered_map<const SubMod*, Stats> subMods;
+		std::unordered_map<const Conditions::ICondition*, Stats> conditions;
+		std::chrono::steady_clock::time_point lastMergeTime{};
+	};
+
+	ThreadCounters& GetThreadCounters();
+	void MergeThreadCountersIfDue(ThreadCounters& a_threadCounters, std::chrono::steady_clock::time_point a_now);
+	void MergeThreadCounters(ThreadCounters& a_threadCounters, std::chrono::steady_clock::time_point a_now);  // expects the thread counters' lock to be held
+
+	static constexpr auto kMergeInterval = 250ms;
+
+	static inline std::atomic_bool _bEnabled = false;
+	static inline thread_local std::shared_ptr<ThreadCounters> _threadCounters = nullptr;
+
+	// locked before the thread counters' locks, which are locked before the stats lock
+	mutable ExclusiveLock _threadCountersLock{ "EvaluationProfiler::_threadCountersLock" };
+	std::vector<std::shared_ptr<ThreadCounters>> _allThreadCounters;  // the registry holds a reference so the counters of ended threads are still merged
+
+	mutable ExclusiveLock _statsLock{ "EvaluationProfiler::_statsLock" };
+	std::unordered_map<const SubMod*, Stats> _subModStats;
+	std::unordered_map<const Conditions::ICondition*, Stats> _conditionStats;
+};
@@ -0,0 +1,165 @@
+#include "HookProfiler.h"
+
+namespace HookProfiler
+{
+	namespace
+	{
+		// the hooks run on the havok worker threads too, so the counters of the current frame are atomics
+		struct Counters
+		{
+			std::atomic<uint64_t> calls = 0;
+			std::atomic<uint64_t> totalTime = 0;
+			std::atomic<uint64_t> originalTime = 0;
+			std::atomic<uint64_t> maxTime = 0;
+		};
+
+		struct State
+		{
+			std::array<Counters, kHookCount> counters{};
+
+			ExclusiveLock framesLock{ "HookProfiler::framesLock" };
+			std::array<std::array<HookStats, kHookCount>, kFrameHistoryCount> frames{};
+			size_t nextFrame = 0;
+			size_t frameCount = 0;
+		};
+
+		State& GetState()
+		{
+			static State state;
+			return state;
+		}
+	}
+
+	std::string_view GetHookName(Hook a_hook)
+	{
+		switch (a_hook) {
+		case Hook::kMainUpdate:
+			return "Main update (jobs)"sv;
+		case Hook::kClipGeneratorActivate:
+			return "hkbClipGenerator::Activate"sv;
+		case Hook::kClipGeneratorUpdate:
+			return "hkbClipGenerator::Update"sv;
+		case Hook::kClipGeneratorGenerate:
+			return "hkbClipGenerator::Generate"sv;
+		case Hook::kClipGeneratorDeactivate:
+			return "hkbClipGenerator::Deactivate"sv;
+		case Hook::kClipGeneratorStartEcho:
+			return "hkbClipGenerator::StartEcho"sv;
+		case Hook::kClipGeneratorComputeBeginAndEndLocalTime:
+			return "hkbClipGenerator::computeBeginAndEndLocalTime"sv;
+		case Hook::kSynchronizedClipGeneratorActivate:
+			return "BSSynchronizedClipGenerator::Activate"sv;
+		case Hook::kBehaviorGraphUpdate:
+			return "hkbBehaviorGraph::Update"sv;
+		case Hook::kBehaviorGraphGenerate:
+			return "hkbBehaviorGraph::Generate"sv;
+		default:
+			return "Unknown"sv;
+		}
+	}
+
+	double Summary::GetAverageOwnTimePerFrame() const
+	{
+		if (frameCount == 0) {
+			return 0.0;
+		}
+
+		uint64_t ownTime = 0;
+		for (const auto& hook : hooks) {
+			ownTime += hook.GetOwnTime();
+		}
+
+		return static_cast<double>(ownTime) / frameCount;
+	}
+
+	void SetEnabled(bool a_bEnabled)
+	{
+		if (a_bEnabled && !IsEnabled()) {
+			// don't start with counters left over from before
+			Reset();
+		}
+
+		bEnabled.store(a_bEnabled, std::memory_order_relaxed);
+	}
+
+	void Record(Hook a_hook, uint64_t a_totalTime, uint64_t a_originalTime)
+	{
+		auto& counters = GetState().counters[static_cast<size_t>(a_hook)];
+
+		counters.calls.fetch_add(1, std::memory_order_relaxed);
+		counters.totalTime.fetch_add(a_totalTime, std::memory_order_relaxed);
+		counters.originalTime.fetch_add(a_originalTime, std::memory_order_relaxed);
+
+		uint64_t currentMax = counters.maxTime.load(std::memory_order_relaxed);
+		while (a_totalTime > currentMax && !counters.maxTime.compare_exchange_weak(currentMax, a_totalTime, std::memory_order_relaxed)) {}
+	}
+
+	void EndFrame()
+	{
+		if (!IsEnabled()) {
+			return;
+		}
+
+		auto& state = GetState();
+
+		// calls still in flight on other threads will be counted in the next frame
+		std::array<HookStats, kHookCount> frame{};
+		for (size_t i = 0; i < kHookCount; ++i) {
+			auto& counters = state.counters[i];
+			frame[i].calls = counters.calls.exchange(0, std::memory_order_relaxed);
+			frame[i].totalTime = counters.totalTime.exchange(0, std::memory_order_relaxed);
+			frame[i].originalTime = counters.originalTime.exchange(0, std::memory_order_relaxed);
+			frame[i].maxTime = counters.maxTime.exchange(0, std::memory_order_relaxed);
+		}
+
+		Locker locker(state.framesLock);
+		state.frames[state.nextFrame] = frame;
+		state.nextFrame = (state.nextFrame + 1) % kFrameHistoryCount;
+		state.frameCount = std::min(state.frameCount + 1, kFrameHistoryCount);
+	}
+
+	Summary GetSummary()
+	{
+		auto& state = GetState();
+		Locker locker(state.framesLock);
+
+		Summary summary;
+		summary.frameCount = state.frameCount;
+		summary.ownTimePerFrame.reserve(state.frameCount);
+
+		const size_t firstFrame = (state.nextFrame + kFrameHistoryCount - state.frameCount) % kFrameHistoryCount;
+		for (size_t i = 0; i < state.frameCount; ++i) {
+			const auto& frame = state.frames[(firstFrame + i) % kFrameHistoryCount];
+
+			uint64_t ownTime = 0;
+			for (size_t j = 0; j < kHookCount; ++j) {
+				auto& hook = summary.hooks[j];
+				hook.calls += frame[j].calls;
+				hook.totalTime += frame[j].totalTime;
+				hook.originalTime += frame[j].originalTime;
+				hook.maxTime = std::max(hook.maxTime, frame[j].maxTime);
+				ownTime += frame[j].GetOwnTime();
+			}
+
+			summary.ownTimePerFrame.emplace_back(static_cast<float>(ownTime / 1e6));
+		}
+
+		return summary;
+	}
+
+	void Reset()
+	{
+		auto& state = GetState();
+
+		for (auto& counters : state.counters) {
+			counters.calls = 0;
+			counters.totalTime = 0;
+			counters.originalTime = 0;
+			counters.maxTime = 0;
+		}
+
+		Locker locker(state.framesLock);
+		state.nextFrame = 0;
+		state.frameCount = 0;
+	}
+}
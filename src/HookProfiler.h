@@ -0,0 +1,128 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <string_view>
+#include <vector>
+
+// per-frame counters for the havok hooks, splitting the time spent in each detour into our own work and the original game function, see Settings::bProfileHooks
+// the counters are collected into a frame on every main update, the last kFrameHistoryCount frames are kept so the UI can show rolling per-frame averages
+// while disabled, the only overhead is a relaxed load of a global flag per hook call
+namespace HookProfiler
+{
+	enum class Hook : uint8_t
+	{
+		kMainUpdate,
+		kClipGeneratorActivate,
+		kClipGeneratorUpdate,
+		kClipGeneratorGenerate,
+		kClipGeneratorDeactivate,
+		kClipGeneratorStartEcho,
+		kClipGeneratorComputeBeginAndEndLocalTime,
+		kSynchronizedClipGeneratorActivate,
+		kBehaviorGraphUpdate,
+		kBehaviorGraphGenerate,
+
+		kTotal
+	};
+
+	inline constexpr size_t kHookCount = static_cast<size_t>(Hook::kTotal);
+	inline constexpr size_t kFrameHistoryCount = 120;
+
+	[[nodiscard]] std::string_view GetHookName(Hook a_hook);
+
+	struct HookStats
+	{
+		uint64_t calls = 0;
+		uint64_t totalTime = 0;     // nanoseconds, including the original function
+		uint64_t originalTime = 0;  // nanoseconds
+		uint64_t maxTime = 0;       // nanoseconds, longest single call
+
+		[[nodiscard]] uint64_t GetOwnTime() const { return totalTime > originalTime ? totalTime - originalTime : 0; }
+	};
+
+	struct Summary
+	{
+		size_t frameCount = 0;
+		std::array<HookStats, kHookCount> hooks{};  // summed over all the frames, except for maxTime which is the longest call in any of them
+		std::vector<float> ownTimePerFrame;         // milliseconds, oldest frame first
+
+		[[nodiscard]] double GetAverageOwnTimePerFrame() const;
+	};
+
+	inline std::atomic_bool bEnabled = false;
+
+	[[nodiscard]] inline bool IsEnabled() { return bEnabled.load(std::memory_order_relaxed); }
+	void SetEnabled(bool a_bEnabled);
+
+	void Record(Hook a_hook, uint64_t a_totalTime, uint64_t a_originalTime);
+	void EndFrame();  // called once per frame from the main update hook
+	[[nodiscard]] Summary GetSummary();
+	void Reset();
+
+	// times the lifetime of the scope as the given hook, the original function should be called through CallOriginal so its time can be subtracted
+	class Scope
+	{
+	public:
+		explicit Scope(Hook a_hook) :
+			_hook(a_hook),
+			_bActive(IsEnabled())
+		{
+			if (_bActive) {
+				_startTime = std::chrono::steady_clock::now();
+			}
+		}
+
+		~Scope()
+		{
+			if (_bActive) {
+				Record(_hook, GetElapsed(_startTime), _originalTime);
+			}
+		}
+
+		Scope(const Scope&) = delete;
+		Scope(Scope&&) = delete;
+		Scope& operator=(const Scope&) = delete;
+		Scope& operator=(Scope&&) = delete;
+
+		template <class Original, class... Args>
+		decltype(auto) CallOriginal(const Original& a_original, Args&&... a_args)
+		{
+			OriginalTimer timer(*this);
+			return a_original(std::forward<Args>(a_args)...);
+		}
+
+	private:
+		struct OriginalTimer
+		{
+			explicit OriginalTimer(Scope& a_scope) :
+				scope(a_scope)
+			{
+				if (scope._bActive) {
+					startTime = std::chrono::steady_clock::now();
+				}
+			}
+
+			~OriginalTimer()
+			{
+				if (scope._bActive) {
+					scope._originalTime += GetElapsed(startTime);
+				}
+			}
+
+			Scope& scope;
+			std::chrono::steady_clock::time_point startTime{};
+		};
+
+		static uint64_t GetElapsed(std::chrono::steady_clock::time_point a_startTime)
+		{
+			return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - a_startTime).count());
+		}
+
+		Hook _hook;
+		bool _bActive;
+		uint64_t _originalTime = 0;
+		std::chrono::steady_clock::time_point _startTime{};
+	};
+}
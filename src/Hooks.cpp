@@ -2,9 +2,13 @@
 
 #include <xbyak/xbyak.h>
 
+#include "AnimationPrefetcher.h"
+#include "AnimationPreloader.h"
+#include "HookProfiler.h"
 #include "Jobs.h"
 #include "Offsets.h"
 #include "OpenAnimationReplacer.h"
+#include "ReevaluationBatcher.h"
 #include "UI/UIManager.h"
 #include "Utils.h"
 
@@ -28,13 +32,24 @@ namespace Hooks
 
 	void HavokHooks::Nullsub()
 	{
+		// the main update marks the frame boundary for the hook counters
+		HookProfiler::EndFrame();
+		HookProfiler::Scope profilerScope(HookProfiler::Hook::kMainUpdate);
+
 		OpenAnimationReplacer::gameTimeCounter += g_deltaTime;
 		OpenAnimationReplacer::GetSingleton().RunJobs();
-		_Nullsub();
+		AnimationLog::GetSingleton().Update();
+		AnimationTrace::GetSingleton().Update();
+		AnimationPreloader::GetSingleton().Update();
+		AnimationPrefetcher::GetSingleton().Update();
+		ReevaluationBatcher::GetSingleton().Update();
+		profilerScope.CallOriginal(_Nullsub);
 	}
 
 	void HavokHooks::hkbClipGenerator_Activate(RE::hkbClipGenerator* a_this, const RE::hkbContext& a_context)
 	{
+		HookProfiler::Scope profilerScope(HookProfiler::Hook::kClipGeneratorActivate);
+
 		bool bAdded;
 		const auto activeClip = OpenAnimationReplacer::GetSingleton().AddOrGetActiveClip(a_this, a_context, bAdded);
 
@@ -46,10 +61,21 @@ namespace Hooks
 			animationLog.LogAnimation(event, activeClip, a_context.character);
 		}
 
-		_hkbClipGenerator_Activate(a_this, a_context);
+		if (auto& animationTrace = AnimationTrace::GetSingleton(); bAdded && animationTrace.IsRecording() && !activeClip->IsTransitioning()) {
+			animationTrace.RecordEvent(event, activeClip, a_context.character);
+		}
+
+		profilerScope.CallOriginal(_hkbClipGenerator_Activate, a_this, a_context);
 
 		activeClip->OnPostActivate(a_this, a_context);
 
+		// the activating character's graph is used to unload animations that weren't needed in a while, the check itself runs in the main update
+		if (bAdded && Settings::bEvictUnusedAnimations) {
+			if (const auto projectData = OpenAnimationReplacer::GetSingleton().GetReplacerProjectData(a_context.character); projectData && projectData->IsEvictionCheckDue()) {
+				AnimationPreloader::GetSingleton().RequestEviction(SKSE::stl::adjust_pointer<RE::BShkbAnimationGraph>(a_context.character, -0xC0));
+			}
+		}
+
 		/*if (activeClip->IsInterruptible()) {
             activeClip->LoadInterruptibleReplacements(a_context.character);
         }*/
@@ -57,41 +83,47 @@ namespace Hooks
 
 	void HavokHooks::hkbClipGenerator_Update(RE::hkbClipGenerator* a_this, const RE::hkbContext& a_context, float a_timestep)
 	{
+		HookProfiler::Scope profilerScope(HookProfiler::Hook::kClipGeneratorUpdate);
+
 		const auto activeClip = OpenAnimationReplacer::GetSingleton().GetActiveClip(a_this);
 		if (activeClip) {
 			activeClip->PreUpdate(a_this, a_context, a_timestep);
 		}
 
-		_hkbClipGenerator_Update(a_this, a_context, a_timestep);
+		profilerScope.CallOriginal(_hkbClipGenerator_Update, a_this, a_context, a_timestep);
 	}
 
 	void HavokHooks::hkbClipGenerator_Deactivate(RE::hkbClipGenerator* a_this, const RE::hkbContext& a_context)
 	{
+		HookProfiler::Scope profilerScope(HookProfiler::Hook::kClipGeneratorDeactivate);
+
 		auto& openAnimationReplacer = OpenAnimationReplacer::GetSingleton();
 
 		if (openAnimationReplacer.HasActiveAnimationPreviews()) {
 			openAnimationReplacer.RemoveActiveAnimationPreview(a_context.character->behaviorGraph.get());
 		}
 
-		_hkbClipGenerator_Deactivate(a_this, a_context);
+		profilerScope.CallOriginal(_hkbClipGenerator_Deactivate, a_this, a_context);
 
 		openAnimationReplacer.RemoveActiveClip(a_this);
 	}
 
 	void HavokHooks::hkbClipGenerator_Generate(RE::hkbClipGenerator* a_this, const RE::hkbContext& a_context, const RE::hkbGeneratorOutput** a_activeChildrenOutput, RE::hkbGeneratorOutput& a_output, float a_timeOffset)
 	{
+		HookProfiler::Scope profilerScope(HookProfiler::Hook::kClipGeneratorGenerate);
+
 		const auto activeClip = OpenAnimationReplacer::GetSingleton().GetActiveClip(a_this);
 		if (activeClip && activeClip->IsBlending()) {
 			activeClip->PreGenerate(a_this, a_context, a_output);
 
 			// if the animation is not fully loaded yet, call generate with our fake clip generator containing the previous animation instead - this avoids seeing the reference pose for a frame
 			if (a_this->userData != 0xC) {
-				_hkbClipGenerator_Generate(activeClip->GetBlendFromClipGenerator(), a_context, a_activeChildrenOutput, a_output, a_timeOffset);
+				profilerScope.CallOriginal(_hkbClipGenerator_Generate, activeClip->GetBlendFromClipGenerator(), a_context, a_activeChildrenOutput, a_output, a_timeOffset);
 				return;
 			}
 		}
 
-		_hkbClipGenerator_Generate(a_this, a_context, a_activeChildrenOutput, a_output, a_timeOffset);
+		profilerScope.CallOriginal(_hkbClipGenerator_Generate, a_this, a_context, a_activeChildrenOutput, a_output, a_timeOffset);
 
 		if (activeClip && activeClip->IsBlending()) {
 			activeClip->OnGenerate(a_this, a_context, a_output);
@@ -100,6 +132,8 @@ namespace Hooks
 
 	void HavokHooks::hkbClipGenerator_StartEcho(RE::hkbClipGenerator* a_this, float a_echoDuration)
 	{
+		HookProfiler::Scope profilerScope(HookProfiler::Hook::kClipGeneratorStartEcho);
+
 		bool bReplaced = false;
 
 		const auto activeClip = OpenAnimationReplacer::GetSingleton().GetActiveClip(a_this);
@@ -107,7 +141,7 @@ namespace Hooks
 			bReplaced = activeClip->OnEcho(a_this, a_echoDuration);
 		}
 
-		_hkbClipGenerator_StartEcho(a_this, a_echoDuration);
+		profilerScope.CallOriginal(_hkbClipGenerator_StartEcho, a_this, a_echoDuration);
 
 		if (!bReplaced) {
 			auto& animationLog = AnimationLog::GetSingleton();
@@ -115,12 +149,18 @@ namespace Hooks
 			if (activeClip && animationLog.ShouldLogAnimations() && animationLog.ShouldLogAnimationsForActiveClip(activeClip, event)) {
 				animationLog.LogAnimation(event, activeClip, activeClip->GetCharacter());
 			}
+
+			if (auto& animationTrace = AnimationTrace::GetSingleton(); activeClip && animationTrace.IsRecording()) {
+				animationTrace.RecordEvent(event, activeClip, activeClip->GetCharacter());
+			}
 		}
 	}
 
 	void HavokHooks::hkbClipGenerator_computeBeginAndEndLocalTime(RE::hkbClipGenerator* a_this, const float a_timestep, float& a_outBeginLocalTime, float& a_outEndLocalTime, int32_t& a_outLoops, bool& a_outEndOfClip)
 	{
-		_hkbClipGenerator_computeBeginAndEndLocalTime(a_this, a_timestep, a_outBeginLocalTime, a_outEndLocalTime, a_outLoops, a_outEndOfClip);
+		HookProfiler::Scope profilerScope(HookProfiler::Hook::kClipGeneratorComputeBeginAndEndLocalTime);
+
+		profilerScope.CallOriginal(_hkbClipGenerator_computeBeginAndEndLocalTime, a_this, a_timestep, a_outBeginLocalTime, a_outEndLocalTime, a_outLoops, a_outEndOfClip);
 
 		if (a_this->mode == RE::hkbClipGenerator::PlaybackMode::kModeLooping && a_outLoops > 0) {
 			// if we're here, the animation just looped
@@ -132,6 +172,10 @@ namespace Hooks
 					if (animationLog.ShouldLogAnimations() && animationLog.ShouldLogAnimationsForActiveClip(activeClip, event)) {
 						animationLog.LogAnimation(event, activeClip, activeClip->GetCharacter());
 					}
+
+					if (auto& animationTrace = AnimationTrace::GetSingleton(); animationTrace.IsRecording()) {
+						animationTrace.RecordEvent(event, activeClip, activeClip->GetCharacter());
+					}
 				}
 			}
 		}
@@ -139,11 +183,13 @@ namespace Hooks
 
 	void HavokHooks::BSSynchronizedClipGenerator_Activate(RE::BSSynchronizedClipGenerator* a_this, const RE::hkbContext& a_context)
 	{
+		HookProfiler::Scope profilerScope(HookProfiler::Hook::kSynchronizedClipGeneratorActivate);
+
 		const auto activeSynchronizedAnimation = OpenAnimationReplacer::GetSingleton().AddOrGetActiveSynchronizedAnimation(a_this->synchronizedScene, a_context);
 
 		activeSynchronizedAnimation->OnSynchronizedClipActivate(a_this, a_context);
 
-		_BSSynchronizedClipGenerator_Activate(a_this, a_context);
+		profilerScope.CallOriginal(_BSSynchronizedClipGenerator_Activate, a_this, a_context);
 	}
 
 	void HavokHooks::BSSynchronizedClipGenerator_Deactivate(RE::BSSynchronizedClipGenerator* a_this, const RE::hkbContext& a_context)
@@ -162,7 +208,9 @@ namespace Hooks
 
 	void HavokHooks::hkbBehaviorGraph_Update(RE::hkbBehaviorGraph* a_this, const RE::hkbContext& a_context, float a_timestep)
 	{
-		_hkbBehaviorGraph_Update(a_this, a_context, a_timestep);
+		HookProfiler::Scope profilerScope(HookProfiler::Hook::kBehaviorGraphUpdate);
+
+		profilerScope.CallOriginal(_hkbBehaviorGraph_Update, a_this, a_context, a_timestep);
 
 		if (const auto activeAnimationPreview = OpenAnimationReplacer::GetSingleton().GetActiveAnimationPreview(a_this)) {
 			activeAnimationPreview->OnUpdate(a_this, a_context, a_timestep);
@@ -171,7 +219,9 @@ namespace Hooks
 
 	void HavokHooks::hkbBehaviorGraph_Generate(RE::hkbBehaviorGraph* a_this, const RE::hkbContext& a_context, const RE::hkbGeneratorOutput** a_activeChildrenOutput, RE::hkbGeneratorOutput& a_output, float a_timeOffset)
 	{
-		_hkbBehaviorGraph_Generate(a_this, a_context, a_activeChildrenOutput, a_output, a_timeOffset);
+		HookProfiler::Scope profilerScope(HookProfiler::Hook::kBehaviorGraphGenerate);
+
+		profilerScope.CallOriginal(_hkbBehaviorGraph_Generate, a_this, a_context, a_activeChildrenOutput, a_output, a_timeOffset);
 
 		if (const auto activeAnimationPreview = OpenAnimationReplacer::GetSingleton().GetActiveAnimationPreview(a_context.character->behaviorGraph.get())) {
 			activeAnimationPreview->OnGenerate(a_this, a_context, a_output);
@@ -189,7 +239,7 @@ namespace Hooks
 		_LoadClips(a_stringData, a_bindingSet, a_assetLoader, a_rootBehavior, a_animationPath, a_annotationToEventIdMap);
 
 		// Build list of synchronized clip indexes
-		OpenAnimationReplacer::GetSingleton().MarkSynchronizedReplacementAnimations(a_stringData, a_rootBehavior);
+		OpenAnimationReplacer::GetSingleton().MarkSynchronizedReplacementAnimations(a_animationPath, a_stringData, a_rootBehavior);
 	}
 
 	bool HavokHooks::CreateSynchronizedClips([[maybe_unused]] RE::hkbBehaviorGraph* a_behaviorGraph, [[maybe_unused]] RE::hkbCharacter* a_character, [[maybe_unused]] RE::BSTHashMap<RE::BSFixedString, uint32_t>* a_annotationToEventIdMap)
@@ -208,11 +258,12 @@ namespace Hooks
 
 	bool HavokHooks::Unk3(RE::BShkbAnimationGraph* a_graph, const char* a_fileName, bool a3)
 	{
-		// queue all the replacement animations to be preloaded
+		// queue the replacement animations to be preloaded
 		// I think this technically means they will never unload
 		// but this is how we definitely avoid the reference pose showing up
 		// in my experience this is not necessary with all the other hooks properly loading the correct animations, but it might rely on your system being fast enough to load them in time
 		// this is safer for everyone so it's enabled by default, but can be disabled in the settings
+		// the animations are issued over several frames, most likely ones first, and can be limited with a budget - see AnimationPreloader
 		const bool ret = _Unk3(a_graph, a_fileName, a3);
 
 		if (!Settings::bDisablePreloading) {
@@ -221,7 +272,7 @@ namespace Hooks
 					if (const auto& characterData = setup->data) {
 						if (const auto& stringData = characterData->stringData) {
 							if (const auto projectData = OpenAnimationReplacer::GetSingleton().GetReplacerProjectData(stringData.get())) {
-								projectData->QueueReplacementAnimations(&a_graph->characterInstance);
+								projectData->QueueReplacementAnimations(a_graph);
 							}
 						}
 					}
@@ -4,6 +4,65 @@
 
 namespace Jobs
 {
+	void LatentJobWheel::Add(QueuedLatentJob& a_queuedJob, float a_currentTime)
+	{
+		const auto job = a_queuedJob.job ? a_queuedJob.job : a_queuedJob.weakJob.lock();
+		if (!job) {
+			return;
+		}
+
+		if (_count == 0) {
+			_currentTick = ToTick(a_currentTime);
+		}
+
+		Insert({ std::move(a_queuedJob), std::max(ToTick(a_currentTime + job->_timeRemaining), _currentTick), a_currentTime });
+	}
+
+	void LatentJobWheel::Advance(float a_currentTime)
+	{
+		const uint64_t nowTick = ToTick(a_currentTime);
+		if (_count == 0 || nowTick < _currentTick) {
+			return;
+		}
+
+		// visit every slot between the last processed tick and now, but each slot only once even if a long time has passed
+		const uint64_t ticksToProcess = std::min(nowTick - _currentTick + 1, static_cast<uint64_t>(slotCount));
+		for (uint64_t i = 0; i < ticksToProcess; ++i) {
+			auto& slot = _slots[(_currentTick + i) % slotCount];
+			for (size_t j = 0; j < slot.size();) {
+				// entries further than one revolution away share the slot, skip them until their turn
+				if (slot[j].dueTick > nowTick) {
+					++j;
+					continue;
+				}
+
+				Entry entry = std::move(slot[j]);
+				if (j != slot.size() - 1) {
+					slot[j] = std::move(slot.back());
+				}
+				slot.pop_back();
+				--_count;
+
+				// jobs that have been released by their owner are simply dropped
+				const auto job = entry.queuedJob.job ? entry.queuedJob.job : entry.queuedJob.weakJob.lock();
+				if (job && !job->Run(a_currentTime - entry.scheduledTime)) {
+					// not done yet, reschedule for the remaining time, but never back into a tick that is being processed right now
+					entry.dueTick = std::max(ToTick(a_currentTime + job->_timeRemaining), nowTick + 1);
+					entry.scheduledTime = a_currentTime;
+					Insert(std::move(entry));
+				}
+			}
+		}
+
+		_currentTick = nowTick + 1;
+	}
+
+	void LatentJobWheel::Insert(Entry&& a_entry)
+	{
+		_slots[a_entry.dueTick % slotCount].emplace_back(std::move(a_entry));
+		++_count;
+	}
+
 	void BeginPreviewAnimationJob::Run()
 	{
 		RE::BSAnimationGraphManagerPtr graphManager = nullptr;
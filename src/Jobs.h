@@ -26,6 +26,105 @@ namespace Jobs
 		float _timeRemaining;
 	};
 
+	// lock-free multi-producer single-consumer queue
+	// producers push onto an intrusive stack, the consumer takes the whole stack at once and reverses it to restore FIFO order
+	template <class T>
+	class MPSCQueue
+	{
+	public:
+		MPSCQueue() = default;
+		MPSCQueue(const MPSCQueue&) = delete;
+		MPSCQueue(MPSCQueue&&) = delete;
+		~MPSCQueue() { DeleteNodes(_head.exchange(nullptr)); }
+
+		MPSCQueue& operator=(const MPSCQueue&) = delete;
+		MPSCQueue& operator=(MPSCQueue&&) = delete;
+
+		void Push(T&& a_value)
+		{
+			const auto node = new Node{ std::move(a_value), _head.load(std::memory_order_relaxed) };
+			while (!_head.compare_exchange_weak(node->next, node, std::memory_order_release, std::memory_order_relaxed)) {}
+		}
+
+		[[nodiscard]] bool IsEmpty() const { return _head.load(std::memory_order_acquire) == nullptr; }
+
+		// consumer thread only
+		template <class Func>
+		void ConsumeAll(Func&& a_func)
+		{
+			Node* node = _head.exchange(nullptr, std::memory_order_acquire);
+
+			Node* reversed = nullptr;
+			while (node) {
+				Node* next = node->next;
+				node->next = reversed;
+				reversed = node;
+				node = next;
+			}
+
+			while (reversed) {
+				Node* next = reversed->next;
+				a_func(reversed->value);
+				delete reversed;
+				reversed = next;
+			}
+		}
+
+	private:
+		struct Node
+		{
+			T value;
+			Node* next;
+		};
+
+		static void DeleteNodes(Node* a_node)
+		{
+			while (a_node) {
+				Node* next = a_node->next;
+				delete a_node;
+				a_node = next;
+			}
+		}
+
+		std::atomic<Node*> _head = nullptr;
+	};
+
+	// a latent job waiting to be scheduled - either owned, or weak so the owner can cancel it by releasing it
+	struct QueuedLatentJob
+	{
+		std::shared_ptr<LatentJob> job = nullptr;
+		std::weak_ptr<LatentJob> weakJob{};
+	};
+
+	// hashed timer wheel holding latent jobs keyed by their due time, so only the slots whose time has come are looked at each frame
+	// only touched by the thread running the jobs
+	class LatentJobWheel
+	{
+	public:
+		void Add(QueuedLatentJob& a_queuedJob, float a_currentTime);
+		void Advance(float a_currentTime);
+
+		[[nodiscard]] bool IsEmpty() const { return _count == 0; }
+
+	private:
+		static constexpr float tickLength = 1.f / 30.f;
+		static constexpr size_t slotCount = 64;
+
+		struct Entry
+		{
+			QueuedLatentJob queuedJob;
+			uint64_t dueTick;
+			float scheduledTime;
+		};
+
+		[[nodiscard]] static uint64_t ToTick(float a_time) { return static_cast<uint64_t>(std::max(a_time, 0.f) / tickLength); }
+		void Insert(Entry&& a_entry);
+
+		std::array<std::vector<Entry>, slotCount> _slots{};
+		uint64_t _currentTick = 0;
+		size_t _count = 0;
+	};
+
 	struct InsertConditionJob : GenericJob
 	{
 		InsertConditionJob(std::unique_ptr<Conditions::ICondition>& a_conditionToInsert, Conditions::ConditionSet* a_conditionSet, const std::unique_ptr<Conditions::ICondition>& a_insertAfterThisCondition) :
@@ -0,0 +1,182 @@
+#pragma once
+
+// the grammar of the legacy _conditions.txt files. Doesn't depend on any game headers so it can be shared with tools/ConditionsTxtHarness.h
+// one condition per line - [NOT] Name(argument) - lines starting with ; are comments
+// a line ending with OR starts an OR block, which takes every condition up to and including the first one whose line doesn't end with OR. OR blocks don't nest, so the parse is flat
+// the game turns the parsed lines into conditions in Parsing.cpp (ConditionsTxtBuilder) and Conditions.cpp (CreateConditionFromLegacyLine)
+
+#include "ConfigLimits.h"
+
+#include <charconv>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace LegacyConditions
+{
+	using namespace std::literals;
+
+	struct Line
+	{
+		bool bNegated = false;
+		std::string_view text;  // without the NOT
+		std::string_view name;
+		std::string_view argument;
+	};
+
+	struct FormReference
+	{
+		std::string_view pluginName;
+		uint32_t formID = 0;
+	};
+
+	// only spaces, like Utils::TrimWhitespace
+	[[nodiscard]] constexpr std::string_view TrimSpaces(std::string_view a_string)
+	{
+		const auto startPos = a_string.find_first_not_of(' ');
+		const auto endPos = a_string.find_last_not_of(' ');
+		if (startPos == std::string_view::npos || endPos == std::string_view::npos) {
+			return ""sv;
+		}
+		return a_string.substr(startPos, endPos - startPos + 1);
+	}
+
+	// returns nothing for comments
+	[[nodiscard]] constexpr std::optional<Line> ParseLine(std::string_view a_line)
+	{
+		if (a_line.starts_with(";"sv)) {
+			return std::nullopt;
+		}
+
+		Line line;
+		line.bNegated = a_line.starts_with("NOT"sv);
+		if (line.bNegated) {
+			a_line = TrimSpaces(a_line.substr(3));
+		}
+		line.text = a_line;
+
+		const size_t functionEndPos = a_line.find_first_of(" ("sv);
+		const size_t argumentStartPos = a_line.find_first_not_of(" ("sv, functionEndPos);
+		if (functionEndPos == std::string_view::npos || argumentStartPos == std::string_view::npos) {
+			line.name = a_line;
+			return line;
+		}
+
+		// the argument ends at the first closing parenthesis, even if it's before the opening one
+		const size_t argumentEndPos = a_line.find(')');
+		line.name = a_line.substr(0, functionEndPos);
+		if (argumentEndPos == std::string_view::npos || argumentEndPos >= argumentStartPos) {
+			line.argument = a_line.substr(argumentStartPos, argumentEndPos == std::string_view::npos ? std::string_view::npos : argumentEndPos - argumentStartPos);
+		} else {
+			line.argument = a_line.substr(argumentStartPos);
+		}
+
+		return line;
+	}
+
+	// "Plugin.esp" | 0x123, see FormValue::ParseLegacy
+	[[nodiscard]] constexpr std::optional<FormReference> ParseFormReference(std::string_view a_argument)
+	{
+		const size_t splitPos = a_argument.find('|');
+		if (splitPos == std::string_view::npos) {
+			return std::nullopt;
+		}
+
+		FormReference reference;
+		reference.pluginName = TrimSpaces(a_argument.substr(0, splitPos));
+		const auto quotesStartPos = reference.pluginName.find_first_not_of('"');
+		const auto quotesEndPos = reference.pluginName.find_last_not_of('"');
+		if (quotesStartPos != std::string_view::npos && quotesEndPos != std::string_view::npos) {
+			reference.pluginName = reference.pluginName.substr(quotesStartPos, quotesEndPos - quotesStartPos + 1);
+		}
+
+		auto formIDString = TrimSpaces(a_argument.substr(splitPos + 1));
+		if (formIDString.starts_with("0x"sv) || formIDString.starts_with("0X"sv)) {
+			formIDString.remove_prefix(2);
+		}
+
+		const auto [ptr, ec] = std::from_chars(formIDString.data(), formIDString.data() + formIDString.size(), reference.formID, 16);
+		if (ec != std::errc()) {
+			return std::nullopt;
+		}
+
+		return reference;
+	}
+
+	// "first, second" of the conditions with two arguments
+	[[nodiscard]] constexpr std::optional<std::pair<std::string_view, std::string_view>> SplitArguments(std::string_view a_argument)
+	{
+		const size_t splitPos = a_argument.find(',');
+		if (splitPos == std::string_view::npos) {
+			return std::nullopt;
+		}
+
+		return std::make_pair(TrimSpaces(a_argument.substr(0, splitPos)), TrimSpaces(a_argument.substr(splitPos + 1)));
+	}
+
+	// walks the lines of a whole file without recursing, the builder gets:
+	//     BeginOrBlock() and EndOrBlock() around the conditions of an OR block
+	//     AddCondition(const Line&) for every line that isn't a comment
+	//     AddInvalidCondition(std::string_view error) for lines past the limits
+	// returns false if the file was cut off at kMaxTxtConditionCount
+	template <class Builder>
+	bool Parse(std::string_view a_text, Builder& a_builder)
+	{
+		bool bInOrBlock = false;
+		size_t conditionCount = 0;
+		bool bComplete = true;
+
+		while (!a_text.empty()) {
+			const size_t lineEndPos = a_text.find('\n');
+			std::string_view line = a_text.substr(0, lineEndPos);
+			a_text = lineEndPos == std::string_view::npos ? ""sv : a_text.substr(lineEndPos + 1);
+
+			if (line.ends_with('\r')) {
+				line.remove_suffix(1);
+			}
+
+			line = TrimSpaces(line);
+			if (line.empty()) {
+				continue;
+			}
+
+			// like the original recursive parser, a comment ending with OR starts an OR block too
+			const bool bEndsWithOR = line.ends_with("OR"sv);
+			if (bEndsWithOR && !bInOrBlock) {
+				a_builder.BeginOrBlock();
+				bInOrBlock = true;
+			}
+
+			const auto parsedLine = ParseLine(line);
+			if (!parsedLine) {
+				continue;
+			}
+
+			if (conditionCount >= ConfigLimits::kMaxTxtConditionCount) {
+				a_builder.AddInvalidCondition("Too many conditions, the rest of the file was ignored"sv);
+				bComplete = false;
+				break;
+			}
+
+			if (line.size() > ConfigLimits::kMaxTxtLineLength) {
+				a_builder.AddInvalidCondition("Line too long"sv);
+			} else {
+				a_builder.AddCondition(*parsedLine);
+			}
+			++conditionCount;
+
+			if (bInOrBlock && !bEndsWithOR) {
+				a_builder.EndOrBlock();
+				bInOrBlock = false;
+			}
+		}
+
+		if (bInOrBlock) {
+			a_builder.EndOrBlock();
+		}
+
+		return bComplete;
+	}
+}
@@ -0,0 +1,124 @@
+#include "LockProfiler.h"
+
+namespace LockProfiler
+{
+	namespace
+	{
+		// the sites themselves use a plain mutex, they can't be profiled
+		struct Registry
+		{
+			std::mutex lock;
+			std::unordered_map<std::string, std::unique_ptr<Site>> sites;
+		};
+
+		Registry& GetRegistry()
+		{
+			static Registry registry;
+			return registry;
+		}
+	}
+
+	void Site::Record(bool a_bContended, uint64_t a_waitTime)
+	{
+		acquisitions.fetch_add(1, std::memory_order_relaxed);
+
+		if (!a_bContended) {
+			waitTimeHistogram[0].fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+
+		contendedAcquisitions.fetch_add(1, std::memory_order_relaxed);
+		totalWaitTime.fetch_add(a_waitTime, std::memory_order_relaxed);
+
+		uint64_t currentMax = maxWaitTime.load(std::memory_order_relaxed);
+		while (a_waitTime > currentMax && !maxWaitTime.compare_exchange_weak(currentMax, a_waitTime, std::memory_order_relaxed)) {}
+
+		const uint64_t waitTimeMicroseconds = a_waitTime / 1000;
+		const size_t bucket = waitTimeMicroseconds == 0 ? 0 : std::min<size_t>(std::bit_width(waitTimeMicroseconds), kHistogramBucketCount - 1);
+		waitTimeHistogram[bucket].fetch_add(1, std::memory_order_relaxed);
+	}
+
+	Site* GetSite(const char* a_name)
+	{
+		auto& registry = GetRegistry();
+		std::lock_guard locker(registry.lock);
+
+		const std::string name = a_name ? a_name : "Unnamed";
+		auto& site = registry.sites[name];
+		if (!site) {
+			site = std::make_unique<Site>(name);
+		}
+
+		return site.get();
+	}
+
+	std::vector<SiteSnapshot> GetSnapshots()
+	{
+		auto& registry = GetRegistry();
+		std::lock_guard locker(registry.lock);
+
+		std::vector<SiteSnapshot> snapshots;
+		snapshots.reserve(registry.sites.size());
+
+		for (const auto& site : registry.sites | std::views::values) {
+			auto& snapshot = snapshots.emplace_back();
+			snapshot.name = site->name;
+			snapshot.acquisitions = site->acquisitions.load(std::memory_order_relaxed);
+			snapshot.contendedAcquisitions = site->contendedAcquisitions.load(std::memory_order_relaxed);
+			snapshot.totalWaitTime = site->totalWaitTime.load(std::memory_order_relaxed);
+			snapshot.maxWaitTime = site->maxWaitTime.load(std::memory_order_relaxed);
+			for (size_t i = 0; i < kHistogramBucketCount; ++i) {
+				snapshot.waitTimeHistogram[i] = site->waitTimeHistogram[i].load(std::memory_order_relaxed);
+			}
+		}
+
+		return snapshots;
+	}
+
+	void Reset()
+	{
+		auto& registry = GetRegistry();
+		std::lock_guard locker(registry.lock);
+
+		// the sites are referenced by the locks, so only clear the counters
+		for (const auto& site : registry.sites | std::views::values) {
+			site->acquisitions = 0;
+			site->contendedAcquisitions = 0;
+			site->totalWaitTime = 0;
+			site->maxWaitTime = 0;
+			for (auto& bucket : site->waitTimeHistogram) {
+				bucket = 0;
+			}
+		}
+	}
+
+	bool ExportCSV(const std::filesystem::path& a_path)
+	{
+		std::ofstream file(a_path, std::ios::trunc);
+		if (!file.is_open()) {
+			logger::error("Failed to export lock statistics to {}", a_path.string());
+			return false;
+		}
+
+		file << "Lock,Acquisitions,Contended,Contended rate,Total wait (ms),Average wait (us),Max wait (us)";
+		for (size_t i = 0; i < kHistogramBucketCount; ++i) {
+			if (i == kHistogramBucketCount - 1) {
+				file << std::format(",>={}us", 1ull << (i - 1));
+			} else {
+				file << std::format(",<{}us", 1ull << i);
+			}
+		}
+		file << "\n";
+
+		for (const auto& snapshot : GetSnapshots()) {
+			file << std::format("\"{}\",{},{},{:.4f},{:.3f},{:.3f},{:.3f}", snapshot.name, snapshot.acquisitions, snapshot.contendedAcquisitions, snapshot.GetContendedRate(), snapshot.totalWaitTime / 1e6, snapshot.GetAverageWaitTime() / 1e3, snapshot.maxWaitTime / 1e3);
+			for (const auto bucket : snapshot.waitTimeHistogram) {
+				file << "," << bucket;
+			}
+			file << "\n";
+		}
+
+		logger::info("Exported lock statistics to {}", a_path.string());
+		return true;
+	}
+}
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <vector>
+
+// drop-in wrappers for the mutexes behind ExclusiveLock/SharedLock that can measure how often every named lock site is acquired, how often threads had to wait for it and for how long, see Settings::bProfileLocks
+// all locks constructed with the same name share a site (e.g. every ConditionSet), unnamed locks share a single "Unnamed" site
+// while disabled, the only overhead is a relaxed load of a global flag per acquisition
+namespace LockProfiler
+{
+	inline constexpr size_t kHistogramBucketCount = 16;  // power of two buckets of the wait time in microseconds: <1, <2, <4 ... the last one catches everything longer
+
+	struct Site
+	{
+		explicit Site(std::string_view a_name) :
+			name(a_name) {}
+
+		void Record(bool a_bContended, uint64_t a_waitTime);
+
+		std::string name;
+		std::atomic<uint64_t> acquisitions = 0;
+		std::atomic<uint64_t> contendedAcquisitions = 0;
+		std::atomic<uint64_t> totalWaitTime = 0;  // nanoseconds
+		std::atomic<uint64_t> maxWaitTime = 0;    // nanoseconds
+		std::array<std::atomic<uint64_t>, kHistogramBucketCount> waitTimeHistogram{};
+	};
+
+	struct SiteSnapshot
+	{
+		std::string name;
+		uint64_t acquisitions = 0;
+		uint64_t contendedAcquisitions = 0;
+		uint64_t totalWaitTime = 0;
+		uint64_t maxWaitTime = 0;
+		std::array<uint64_t, kHistogramBucketCount> waitTimeHistogram{};
+
+		[[nodiscard]] double GetContendedRate() const { return acquisitions ? static_cast<double>(contendedAcquisitions) / acquisitions : 0.0; }
+		[[nodiscard]] double GetAverageWaitTime() const { return contendedAcquisitions ? static_cast<double>(totalWaitTime) / contendedAcquisitions : 0.0; }
+	};
+
+	inline std::atomic_bool bEnabled = false;
+
+	[[nodiscard]] inline bool IsEnabled() { return bEnabled.load(std::memory_order_relaxed); }
+	inline void SetEnabled(bool a_bEnabled) { bEnabled.store(a_bEnabled, std::memory_order_relaxed); }
+
+	Site* GetSite(const char* a_name);
+	std::vector<SiteSnapshot> GetSnapshots();
+	void Reset();
+	bool ExportCSV(const std::filesystem::path& a_path);
+
+	template <class Mutex>
+	class ProfiledMutex
+	{
+	public:
+		ProfiledMutex() noexcept = default;
+		explicit ProfiledMutex(const char* a_name) noexcept :
+			_name(a_name) {}
+
+		ProfiledMutex(const ProfiledMutex&) = delete;
+		ProfiledMutex(ProfiledMutex&&) = delete;
+		ProfiledMutex& operator=(const ProfiledMutex&) = delete;
+		ProfiledMutex& operator=(ProfiledMutex&&) = delete;
+
+		void lock()
+		{
+			if (!IsEnabled()) [[likely]] {
+				_mutex.lock();
+				return;
+			}
+
+			ProfiledAcquire([this] { return _mutex.try_lock(); }, [this] { _mutex.lock(); });
+		}
+
+		bool try_lock() { return _mutex.try_lock(); }
+		void unlock() { _mutex.unlock(); }
+
+		void lock_shared()
+		{
+			if (!IsEnabled()) [[likely]] {
+				_mutex.lock_shared();
+				return;
+			}
+
+			ProfiledAcquire([this] { return _mutex.try_lock_shared(); }, [this] { _mutex.lock_shared(); });
+		}
+
+		bool try_lock_shared() { return _mutex.try_lock_shared(); }
+		void unlock_shared() { _mutex.unlock_shared(); }
+
+	private:
+		template <class TryLock, class Lock>
+		void ProfiledAcquire(TryLock&& a_tryLock, Lock&& a_lock)
+		{
+			Site* site = _site.load(std::memory_order_acquire);
+			if (!site) {
+				site = GetSite(_name);
+				_site.store(site, std::memory_order_release);
+			}
+
+			if (a_tryLock()) {
+				site->Record(false, 0);
+				return;
+			}
+
+			const auto startTime = std::chrono::steady_clock::now();
+			a_lock();
+			site->Record(true, static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - startTime).count()));
+		}
+
+		Mutex _mutex;
+		const char* _name = nullptr;
+		std::atomic<Site*> _site = nullptr;
+	};
+}
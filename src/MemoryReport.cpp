@@ -0,0 +1,173 @@
+#include "MemoryReport.h"
+
+#include "AnimationContentRegistry.h"
+#include "AnimationFileHashCache.h"
+#include "AnimationLog.h"
+#include "OpenAnimationReplacer.h"
+#include "Parsing.h"
+
+namespace MemoryReport
+{
+	namespace
+	{
+		void AddUsageMembers(rapidjson::Value& a_value, const Usage& a_usage, rapidjson::Document::AllocatorType& a_allocator)
+		{
+			a_value.AddMember("total", static_cast<uint64_t>(a_usage.GetTotal()), a_allocator);
+			a_value.AddMember("strings", static_cast<uint64_t>(a_usage.strings), a_allocator);
+			a_value.AddMember("conditions", static_cast<uint64_t>(a_usage.conditions), a_allocator);
+			a_value.AddMember("replacementAnimations", static_cast<uint64_t>(a_usage.replacementAnimations), a_allocator);
+			a_value.AddMember("indexMaps", static_cast<uint64_t>(a_usage.indexMaps), a_allocator);
+			a_value.AddMember("other", static_cast<uint64_t>(a_usage.other), a_allocator);
+		}
+	}
+
+	Usage Report::GetModsUsage() const
+	{
+		Usage usage;
+		for (const auto& mod : mods) {
+			usage += mod.usage;
+		}
+		return usage;
+	}
+
+	Usage Report::GetProjectsUsage() const
+	{
+		Usage usage;
+		for (const auto& project : projects) {
+			usage += project.usage;
+		}
+		return usage;
+	}
+
+	size_t Report::GetTotal() const
+	{
+		size_t total = GetModsUsage().GetTotal() + GetProjectsUsage().GetTotal();
+		for (const auto& global : globals) {
+			total += global.bytes;
+		}
+		return total;
+	}
+
+	Report Collect()
+	{
+		Report report;
+
+		auto& openAnimationReplacer = OpenAnimationReplacer::GetSingleton();
+
+		openAnimationReplacer.ForEachReplacerMod([&](ReplacerMod* a_replacerMod) {
+			auto& modEntry = report.mods.emplace_back();
+			modEntry.name = a_replacerMod->GetName();
+			a_replacerMod->AccumulateMemoryUsage(modEntry.usage);
+
+			a_replacerMod->ForEachSubMod([&](SubMod* a_subMod) {
+				auto& subModEntry = modEntry.subMods.emplace_back();
+				subModEntry.name = a_subMod->GetName();
+				a_subMod->ForEachReplacementAnimation([&](ReplacementAnimation*) {
+					++subModEntry.replacementAnimationCount;
+				});
+				a_subMod->AccumulateMemoryUsage(subModEntry.usage);
+
+				modEntry.usage += subModEntry.usage;
+				return RE::BSVisit::BSVisitControl::kContinue;
+			});
+
+			std::ranges::sort(modEntry.subMods, [](const auto& a_lhs, const auto& a_rhs) { return a_lhs.usage.GetTotal() > a_rhs.usage.GetTotal(); });
+		});
+
+		openAnimationReplacer.ForEachReplacerProjectData([&](RE::hkbCharacterStringData* a_stringData, ReplacerProjectData* a_replacerProjectData) {
+			auto& projectEntry = report.projects.emplace_back();
+			projectEntry.name = a_stringData->name.data();
+			projectEntry.animationReplacementsCount = a_replacerProjectData->GetAnimationReplacementsCount();
+			a_replacerProjectData->AccumulateMemoryUsage(projectEntry.usage);
+		});
+
+		std::ranges::sort(report.mods, [](const auto& a_lhs, const auto& a_rhs) { return a_lhs.usage.GetTotal() > a_rhs.usage.GetTotal(); });
+		std::ranges::sort(report.projects, [](const auto& a_lhs, const auto& a_rhs) { return a_lhs.usage.GetTotal() > a_rhs.usage.GetTotal(); });
+
+		size_t count = 0;
+		size_t bytes = openAnimationReplacer.GetAnimationPathMapMemoryUsage(count);
+		report.globals.push_back({ "Animation path map"sv, count, bytes });
+
+		bytes = openAnimationReplacer.GetActiveClipsMemoryUsage(count);
+		report.globals.push_back({ "Active clips"sv, count, bytes });
+
+		bytes = AnimationFileHashCache::GetSingleton().GetMemoryUsage(count);
+		report.globals.push_back({ "Animation hash cache"sv, count, bytes });
+
+		bytes = AnimationContentRegistry::GetSingleton().GetMemoryUsage(count);
+		report.globals.push_back({ "Animation content registry"sv, count, bytes });
+
+		bytes = AnimationLog::GetSingleton().GetMemoryUsage(count);
+		report.globals.push_back({ "Animation log"sv, count, bytes });
+
+		return report;
+	}
+
+	bool ExportJSON(const Report& a_report, const std::filesystem::path& a_path)
+	{
+		rapidjson::Document doc(rapidjson::kObjectType);
+		auto& allocator = doc.GetAllocator();
+
+		doc.AddMember("total", static_cast<uint64_t>(a_report.GetTotal()), allocator);
+
+		rapidjson::Value modsValue(rapidjson::kArrayType);
+		for (const auto& mod : a_report.mods) {
+			rapidjson::Value modValue(rapidjson::kObjectType);
+			modValue.AddMember("name", rapidjson::StringRef(mod.name.data(), mod.name.length()), allocator);
+			AddUsageMembers(modValue, mod.usage, allocator);
+
+			rapidjson::Value subModsValue(rapidjson::kArrayType);
+			for (const auto& subMod : mod.subMods) {
+				rapidjson::Value subModValue(rapidjson::kObjectType);
+				subModValue.AddMember("name", rapidjson::StringRef(subMod.name.data(), subMod.name.length()), allocator);
+				subModValue.AddMember("replacementAnimationCount", static_cast<uint64_t>(subMod.replacementAnimationCount), allocator);
+				AddUsageMembers(subModValue, subMod.usage, allocator);
+				subModsValue.PushBack(subModValue, allocator);
+			}
+			modValue.AddMember("subMods", subModsValue, allocator);
+
+			modsValue.PushBack(modValue, allocator);
+		}
+		doc.AddMember("mods", modsValue, allocator);
+
+		rapidjson::Value projectsValue(rapidjson::kArrayType);
+		for (const auto& project : a_report.projects) {
+			rapidjson::Value projectValue(rapidjson::kObjectType);
+			projectValue.AddMember("name", rapidjson::StringRef(project.name.data(), project.name.length()), allocator);
+			projectValue.AddMember("animationReplacementsCount", static_cast<uint64_t>(project.animationReplacementsCount), allocator);
+			AddUsageMembers(projectValue, project.usage, allocator);
+			projectsValue.PushBack(projectValue, allocator);
+		}
+		doc.AddMember("projects", projectsValue, allocator);
+
+		rapidjson::Value globalsValue(rapidjson::kArrayType);
+		for (const auto& global : a_report.globals) {
+			rapidjson::Value globalValue(rapidjson::kObjectType);
+			globalValue.AddMember("name", rapidjson::StringRef(global.name.data(), global.name.length()), allocator);
+			globalValue.AddMember("count", static_cast<uint64_t>(global.count), allocator);
+			globalValue.AddMember("total", static_cast<uint64_t>(global.bytes), allocator);
+			globalsValue.PushBack(globalValue, allocator);
+		}
+		doc.AddMember("globals", globalsValue, allocator);
+
+		if (!Parsing::SerializeJson(a_path, doc)) {
+			return false;
+		}
+
+		logger::info("Exported memory report to {}", a_path.string());
+		return true;
+	}
+
+	std::string FormatBytes(size_t a_bytes)
+	{
+		if (a_bytes >= 1024 * 1024) {
+			return std::format("{:.2f} MB", a_bytes / (1024.0 * 1024.0));
+		}
+
+		if (a_bytes >= 1024) {
+			return std::format("{:.1f} KB", a_bytes / 1024.0);
+		}
+
+		return std::format("{} B", a_bytes);
+	}
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+// approximate accounting of the memory used by our own data, broken down by replacer mod, submod and project
+// sizes are estimated from object sizes and container capacities - allocator overhead and the real size of custom conditions from other plugins aren't known, so the actual usage is somewhat higher
+namespace MemoryReport
+{
+	struct Usage
+	{
+		size_t strings = 0;
+		size_t conditions = 0;
+		size_t replacementAnimations = 0;
+		size_t indexMaps = 0;
+		size_t other = 0;
+
+		[[nodiscard]] size_t GetTotal() const { return strings + conditions + replacementAnimations + indexMaps + other; }
+
+		Usage& operator+=(const Usage& a_other)
+		{
+			strings += a_other.strings;
+			conditions += a_other.conditions;
+			replacementAnimations += a_other.replacementAnimations;
+			indexMaps += a_other.indexMaps;
+			other += a_other.other;
+			return *this;
+		}
+	};
+
+	// heap memory of a std::string holding the given text, strings that fit in the small string buffer don't allocate
+	[[nodiscard]] inline size_t GetStringSize(std::string_view a_string)
+	{
+		static const size_t smallStringCapacity = std::string().capacity();
+		return a_string.size() > smallStringCapacity ? a_string.size() + 1 : 0;
+	}
+
+	[[nodiscard]] inline size_t GetPathSize(const std::filesystem::path& a_path)
+	{
+		const auto& native = a_path.native();
+		return native.size() > std::filesystem::path::string_type().capacity() ? (native.size() + 1) * sizeof(std::filesystem::path::value_type) : 0;
+	}
+
+	template <class T>
+	[[nodiscard]] size_t GetVectorSize(const std::vector<T>& a_vector)
+	{
+		return a_vector.capacity() * sizeof(T);
+	}
+
+	// nodes hold the value and the list links, the bucket array holds two iterators per bucket
+	template <class Map>
+	[[nodiscard]] size_t GetHashMapSize(const Map& a_map)
+	{
+		return a_map.size() * (sizeof(typename Map::value_type) + 2 * sizeof(void*)) + a_map.bucket_count() * 2 * sizeof(void*);
+	}
+
+	struct SubModEntry
+	{
+		std::string name;
+		size_t replacementAnimationCount = 0;
+		Usage usage;
+	};
+
+	struct ModEntry
+	{
+		std::string name;
+		Usage usage;  // including the submods
+		std::vector<SubModEntry> subMods;
+	};
+
+	struct ProjectEntry
+	{
+		std::string name;
+		size_t animationReplacementsCount = 0;
+		Usage usage;  // the replacement animations themselves are counted in their submods
+	};
+
+	// singletons that aren't tied to a mod or a project
+	struct GlobalEntry
+	{
+		std::string_view name;
+		size_t count = 0;
+		size_t bytes = 0;
+	};
+
+	struct Report
+	{
+		std::vector<ModEntry> mods;
+		std::vector<ProjectEntry> projects;
+		std::vector<GlobalEntry> globals;
+
+		[[nodiscard]] Usage GetModsUsage() const;
+		[[nodiscard]] Usage GetProjectsUsage() const;
+		[[nodiscard]] size_t GetTotal() const;
+	};
+
+	[[nodiscard]] Report Collect();
+	bool ExportJSON(const Report& a_report, const std::filesystem::path& a_path);
+
+	[[nodiscard]] std::string FormatBytes(size_t a_bytes);
+}
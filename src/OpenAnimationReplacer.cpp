@@ -1,16 +1,24 @@
 #include "OpenAnimationReplacer.h"
 
 #include "ActiveClip.h"
+#include "AnimationContentRegistry.h"
+#include "AnimationPrefetcher.h"
+#include "AnimationTrace.h"
 #include "DetectedProblems.h"
+#include "EvaluationProfiler.h"
+#include "MemoryReport.h"
 #include "MergeMapperPluginAPI.h"
 #include "Offsets.h"
 #include "Parsing.h"
 #include "ReplacementAnimation.h"
+#include "ReplacementPlanCache.h"
 #include "Settings.h"
+#include "StartupTrace.h"
 #include "UI/UIManager.h"
 
 #include <future>
 #include <ranges>
+#include <thread>
 
 void OpenAnimationReplacer::OnDataLoaded()
 {
@@ -18,6 +26,14 @@ void OpenAnimationReplacer::OnDataLoaded()
 		UI::UIManager::GetSingleton().DisplayWelcomeBanner();
 	}
 
+	if (Settings::bRecordAnimationTrace) {
+		AnimationTrace::GetSingleton().StartRecording();
+	}
+
+	EvaluationProfiler::SetEnabled(Settings::bEnableEvaluationProfiler);
+
+	AnimationPrefetcher::GetSingleton().Register();
+
 	CreateReplacerMods();
 
 	if (Settings::bLoadDefaultBehaviorsInMainMenu && !Settings::bDisablePreloading) {
@@ -43,11 +59,10 @@ ReplacementAnimation* OpenAnimationReplacer::GetReplacementAnimation(RE::hkbChar
 	}
 
 	if (a_originalIndex != static_cast<uint16_t>(-1)) {
-		if (const auto stringData = Utils::GetStringDataFromHkbCharacter(a_character)) {
-			const RE::BShkbAnimationGraph* animGraph = SKSE::stl::adjust_pointer<RE::BShkbAnimationGraph>(a_character, -0xC0);
-			RE::Actor* actor = animGraph->holder;
-
-			return GetReplacementAnimation(stringData, a_clipGenerator, a_originalIndex, actor);
+		if (const auto projectData = GetReplacerProjectData(a_character)) {
+			if (RE::Actor* actor = Utils::GetActorFromHkbCharacter(a_character)) {
+				return projectData->EvaluateConditionsAndGetReplacementAnimation(a_clipGenerator, a_originalIndex, actor);
+			}
 		}
 	}
 
@@ -79,7 +94,12 @@ bool OpenAnimationReplacer::RemoveReplacementData(RE::hkbCharacterStringData* a_
 {
 	WriteLocker locker(_dataLock);
 
-	return _replacerProjectDatas.erase(a_stringData);
+	const bool bRemoved = _replacerProjectDatas.erase(a_stringData);
+	if (bRemoved) {
+		++_replacerProjectDatasGeneration;
+	}
+
+	return bRemoved;
 }
 
 ReplacerMod* OpenAnimationReplacer::GetReplacerMod(std::string_view a_path) const
@@ -141,25 +161,11 @@ void OpenAnimationReplacer::OnReplacerModNameChanged(std::string_view a_previous
 	_replacerModNameMap.insert(std::move(handle));
 }
 
-void OpenAnimationReplacer::InitializeReplacementAnimations(RE::hkbCharacterStringData* a_stringData) const
-{
-	if (const auto projectData = GetReplacerProjectData(a_stringData)) {
-		projectData->ForEach([](auto a_animationReplacements) {
-			a_animationReplacements->TestInterruptible();
-			a_animationReplacements->TestReplaceOnEcho();
-			a_animationReplacements->TestKeepRandomResultsOnLoop();
-			a_animationReplacements->SortByPriority();
-		});
-	}
-}
-
 AnimationReplacements* OpenAnimationReplacer::GetReplacements(RE::hkbCharacter* a_character, uint16_t a_originalIndex) const
 {
 	if (a_originalIndex != static_cast<uint16_t>(-1)) {
-		if (const auto stringData = Utils::GetStringDataFromHkbCharacter(a_character)) {
-			if (const auto replacerProjectData = GetReplacerProjectData(stringData)) {
-				return replacerProjectData->GetAnimationReplacements(a_originalIndex);
-			}
+		if (const auto replacerProjectData = GetReplacerProjectData(a_character)) {
+			return replacerProjectData->GetAnimationReplacements(a_originalIndex);
 		}
 	}
 
@@ -318,11 +324,9 @@ void OpenAnimationReplacer::RemoveActiveAnimationPreview(RE::hkbBehaviorGraph* a
 bool OpenAnimationReplacer::IsOriginalAnimationInterruptible(RE::hkbCharacter* a_character, uint16_t a_originalIndex) const
 {
 	if (a_originalIndex != static_cast<uint16_t>(-1) && a_character) {
-		if (const auto stringData = Utils::GetStringDataFromHkbCharacter(a_character)) {
-			if (const auto replacerProjectData = GetReplacerProjectData(stringData)) {
-				if (const auto animationReplacements = replacerProjectData->GetAnimationReplacements(a_originalIndex)) {
-					return animationReplacements->IsOriginalInterruptible();
-				}
+		if (const auto replacerProjectData = GetReplacerProjectData(a_character)) {
+			if (const auto animationReplacements = replacerProjectData->GetAnimationReplacements(a_originalIndex)) {
+				return animationReplacements->IsOriginalInterruptible();
 			}
 		}
 	}
@@ -333,11 +337,9 @@ bool OpenAnimationReplacer::IsOriginalAnimationInterruptible(RE::hkbCharacter* a
 bool OpenAnimationReplacer::ShouldOriginalAnimationReplaceOnEcho(RE::hkbCharacter* a_character, uint16_t a_originalIndex) const
 {
 	if (a_originalIndex != static_cast<uint16_t>(-1) && a_character) {
-		if (const auto stringData = Utils::GetStringDataFromHkbCharacter(a_character)) {
-			if (const auto replacerProjectData = GetReplacerProjectData(stringData)) {
-				if (const auto animationReplacements = replacerProjectData->GetAnimationReplacements(a_originalIndex)) {
-					return animationReplacements->ShouldOriginalReplaceOnEcho();
-				}
+		if (const auto replacerProjectData = GetReplacerProjectData(a_character)) {
+			if (const auto animationReplacements = replacerProjectData->GetAnimationReplacements(a_originalIndex)) {
+				return animationReplacements->ShouldOriginalReplaceOnEcho();
 			}
 		}
 	}
@@ -348,11 +350,9 @@ bool OpenAnimationReplacer::ShouldOriginalAnimationReplaceOnEcho(RE::hkbCharacte
 bool OpenAnimationReplacer::ShouldOriginalAnimationKeepRandomResultsOnLoop(RE::hkbCharacter* a_character, uint16_t a_originalIndex) const
 {
 	if (a_originalIndex != static_cast<uint16_t>(-1) && a_character) {
-		if (const auto stringData = Utils::GetStringDataFromHkbCharacter(a_character)) {
-			if (const auto replacerProjectData = GetReplacerProjectData(stringData)) {
-				if (const auto animationReplacements = replacerProjectData->GetAnimationReplacements(a_originalIndex)) {
-					return animationReplacements->ShouldOriginalKeepRandomResultsOnLoop();
-				}
+		if (const auto replacerProjectData = GetReplacerProjectData(a_character)) {
+			if (const auto animationReplacements = replacerProjectData->GetAnimationReplacements(a_originalIndex)) {
+				return animationReplacements->ShouldOriginalKeepRandomResultsOnLoop();
 			}
 		}
 	}
@@ -368,6 +368,8 @@ void OpenAnimationReplacer::CreateReplacerMods()
 	logger::info("Creating replacer mods...");
 	auto startTime = std::chrono::high_resolution_clock::now();
 
+	std::optional<StartupTrace::Scope> traceScope(std::in_place, "startup", "CreateReplacerMods"sv);
+
 	if (!AreFactoriesInitialized()) {
 		InitFactories();
 	}
@@ -385,6 +387,8 @@ void OpenAnimationReplacer::CreateReplacerMods()
 
 	if (parseResults.modParseResultFutures.empty() && parseResults.legacyParseResultFutures.empty()) {
 		logger::info("No replacer mods found.");
+		traceScope.reset();
+		StartupTrace::GetSingleton().Flush();
 		return;
 	}
 
@@ -392,6 +396,7 @@ void OpenAnimationReplacer::CreateReplacerMods()
 	logger::info("Adding parsed replacer mods...");
 	for (auto& future : parseResults.modParseResultFutures) {
 		auto modParseResult = future.get();
+		StartupTrace::Scope addTraceScope("add", std::string_view(modParseResult.name));
 		AddModParseResult(modParseResult);
 	}
 	logger::info("Added parsed replacer mods.");
@@ -414,14 +419,24 @@ void OpenAnimationReplacer::CreateReplacerMods()
 	detectedProblems.CheckForSubModsSharingPriority();
 	detectedProblems.CheckForSubModsWithInvalidConditions();
 
+	if (Settings::bCacheReplacementPlans) {
+		ReplacementPlanCache::GetSingleton().UpdateModSetDigest();
+	}
+
 	auto endTime = std::chrono::high_resolution_clock::now();
 
+	traceScope.reset();
+	StartupTrace::GetSingleton().Flush();
+
 	logger::info("Time spent creating replacer mods...:");
 	logger::info("  Parsing: {}ms", std::chrono::duration_cast<std::chrono::milliseconds>(endOfParsingTime - startTime).count());
 	logger::info("  Adding mods: {}ms", std::chrono::duration_cast<std::chrono::milliseconds>(endOfModsTime - endOfParsingTime).count());
 	logger::info("  Adding legacy mods: {}ms", std::chrono::duration_cast<std::chrono::milliseconds>(endOfLegacyModsTime - endOfModsTime).count());
 	logger::info("  Checking for problems: {}ms", std::chrono::duration_cast<std::chrono::milliseconds>(endTime - endOfLegacyModsTime).count());
 	logger::info("  Total: {}ms", std::chrono::duration_cast<std::chrono::milliseconds>(endTime - startTime).count());
+
+	const auto configParseStatistics = Parsing::GetConfigParseStatistics();
+	logger::info("Parsed {} config files ({:.2f} MB) in {:.1f}ms summed over all threads ({:.1f} MB/s)", configParseStatistics.files, configParseStatistics.bytes / 1e6, configParseStatistics.parseTime / 1e6, configParseStatistics.GetThroughput());
 }
 
 void OpenAnimationReplacer::CreateReplacementAnimations([[maybe_unused]] const char* a_path, RE::hkbCharacterStringData* a_stringData, RE::BShkbHkxDB::ProjectDBData* a_projectDBData)
@@ -430,72 +445,209 @@ void OpenAnimationReplacer::CreateReplacementAnimations([[maybe_unused]] const c
 		return;
 	}
 
+	// only the same project is serialized here, different projects (e.g. creatures loading alongside the player) proceed concurrently
+	Locker projectLocker(GetProjectCreationLock(a_stringData));
+
+	if (HasProcessedData(a_stringData)) {
+		return;
+	}
+
 	logger::info("Creating replacement animations for {}...", a_path);
 	auto startTime = std::chrono::high_resolution_clock::now();
 
+	std::optional<StartupTrace::Scope> traceScope(std::in_place, "project", std::string_view(a_path));
+
 	constexpr auto meshesPath = "data\\meshes\\"sv;
 	const auto projectPath = std::filesystem::path(meshesPath) / a_path;
 
-	Locker parseLocker(_animationCreationLock);
-
-	// create replacer project data and replacer animations
-	ReplacerProjectData* projectData = nullptr;
+	// match the original animations against the replacer submods, this doesn't modify anything so it's split into chunks processed in parallel
+	struct Match
+	{
+		uint16_t originalIndex;
+		std::string originalAnimationPath;
+		std::vector<SubMod*> subMods;
+	};
 
 	const auto& animationBundleNames = a_stringData->animationNames;
+	const size_t numOriginalAnims = animationBundleNames.size();
 
-	ReadLocker locker(_animationPathToSubModsLock);
+	auto matchAnimations = [&](size_t a_begin, size_t a_end) {
+		std::vector<Match> matches;
+
+		ReadLocker locker(_animationPathToSubModsLock);
 
-	std::unordered_set<SubMod*> subModsToUpdate{};
+		for (size_t i = a_begin; i < a_end; ++i) {
+			// normalize the path to handle ".." in shared killmove paths etc.
+			const auto originalAnimationPath = (projectPath / animationBundleNames[i].data()).lexically_normal();
 
-	const auto numOriginalAnims = a_stringData->animationNames.size();
+			if (const auto search = _animationPathToSubModsMap.find(originalAnimationPath); search != _animationPathToSubModsMap.end()) {
+				auto& match = matches.emplace_back(static_cast<uint16_t>(i), originalAnimationPath.string(), std::vector<SubMod*>(search->second.begin(), search->second.end()));
 
-	for (auto i = 0; i < numOriginalAnims; ++i) {
-		const auto& originalAnimation = animationBundleNames[i];
+				// the submods are kept in an unordered set, sort them so the replacement indices are assigned in the same order on every run
+				std::ranges::sort(match.subMods, [](const SubMod* a_lhs, const SubMod* a_rhs) {
+					return a_lhs->GetPath() < a_rhs->GetPath();
+				});
+			}
+		}
 
-		// normalize the path to handle ".." in shared killmove paths etc.
-		const auto originalAnimationPath = (projectPath / originalAnimation.data()).lexically_normal();
+		return matches;
+	};
 
-		const auto& search = _animationPathToSubModsMap.find(originalAnimationPath);
-		if (search != _animationPathToSubModsMap.end()) {
-			if (!projectData) {
-				projectData = GetOrAddReplacerProjectData(a_stringData, a_projectDBData);
+	// the same project with the same replacer mods always ends up with the same result, so it can be reused from the previous session
+	auto& replacementPlanCache = ReplacementPlanCache::GetSingleton();
+	const std::string planKey = Settings::bCacheReplacementPlans ? replacementPlanCache.GetProjectKey(a_stringData) : std::string();
+	std::optional<ReplacementPlan> cachedPlan = planKey.empty() ? std::nullopt : replacementPlanCache.LoadPlan(a_path, planKey);
+
+	auto endOfPlanLoadingTime = std::chrono::high_resolution_clock::now();
+
+	std::vector<Match> matches;
+	size_t chunkCount = 0;
+
+	if (cachedPlan) {
+		std::unordered_map<std::string_view, SubMod*> subModsByPath;
+		ForEachReplacerMod([&](ReplacerMod* a_replacerMod) {
+			a_replacerMod->ForEachSubMod([&](SubMod* a_subMod) {
+				subModsByPath.emplace(a_subMod->GetPath(), a_subMod);
+				return RE::BSVisit::BSVisitControl::kContinue;
+			});
+		});
+
+		matches.reserve(cachedPlan->matches.size());
+		for (auto& plannedMatch : cachedPlan->matches) {
+			auto& match = matches.emplace_back(plannedMatch.originalIndex, std::move(plannedMatch.originalAnimationPath), std::vector<SubMod*>());
+			for (const auto& subModPath : plannedMatch.subModPaths) {
+				if (const auto search = subModsByPath.find(subModPath); search != subModsByPath.end()) {
+					match.subMods.emplace_back(search->second);
+				} else {
+					// shouldn't happen as the key covers every submod, but don't apply a plan that doesn't fit
+					logger::warn("Cached replacement plan for {} references a missing submod {}, discarding it", a_path, subModPath);
+					cachedPlan.reset();
+					matches.clear();
+					break;
+				}
 			}
 
-			for (const auto& subMod : search->second) {
-				subMod->AddReplacementAnimation(originalAnimationPath.string(), static_cast<uint16_t>(i), projectData, a_stringData);
-				subModsToUpdate.emplace(subMod);
+			if (!cachedPlan) {
+				break;
 			}
 		}
 	}
 
-	auto endOfParsingTime = std::chrono::high_resolution_clock::now();
+	if (!cachedPlan) {
+		// several projects are usually created at the same time already, so each one only gets a few threads
+		constexpr size_t minAnimationsPerChunk = 1024;
+		constexpr size_t maxChunksPerProject = 4;
+		const size_t maxChunkCount = Settings::bAsyncParsing ? std::min(static_cast<size_t>(std::max(std::thread::hardware_concurrency(), 1u)), maxChunksPerProject) : 1;
+		chunkCount = std::clamp(numOriginalAnims / minAnimationsPerChunk, static_cast<size_t>(1), maxChunkCount);
+
+		if (chunkCount > 1) {
+			const size_t chunkSize = (numOriginalAnims + chunkCount - 1) / chunkCount;
+
+			// the first chunk is matched on this thread
+			std::vector<std::future<std::vector<Match>>> futures;
+			futures.reserve(chunkCount - 1);
+			for (size_t begin = chunkSize; begin < numOriginalAnims; begin += chunkSize) {
+				futures.emplace_back(std::async(std::launch::async, matchAnimations, begin, std::min(begin + chunkSize, numOriginalAnims)));
+			}
+
+			// append the chunks in order so the result is the same as matching serially
+			matches = matchAnimations(0, std::min(chunkSize, numOriginalAnims));
+			for (auto& future : futures) {
+				auto chunkMatches = future.get();
+				matches.insert(matches.end(), std::make_move_iterator(chunkMatches.begin()), std::make_move_iterator(chunkMatches.end()));
+			}
+		} else {
+			matches = matchAnimations(0, numOriginalAnims);
+		}
+	}
+
+	auto endOfMatchingTime = std::chrono::high_resolution_clock::now();
+
+	// create replacer project data and replacer animations
+	ReplacerProjectData* projectData = nullptr;
+	std::vector<std::pair<std::string, uint16_t>> addedAnimationIndices;
 
-	for (auto& subMod : subModsToUpdate) {
-		subMod->UpdateAnimations();
+	if (!matches.empty()) {
+		projectData = GetOrAddReplacerProjectData(a_stringData, a_projectDBData);
+
+		// appending to the animation names happens in match order, so the new indices are deterministic
+		// nothing here is serialized with other projects - the project data is only touched under the project's creation lock, the new animations get their submod's settings before they're added to it, and the submods lock their own lists
+		if (cachedPlan) {
+			projectData->ApplyReplacementPlan(*cachedPlan);
+		}
+
+		for (const auto& match : matches) {
+			for (const auto& subMod : match.subMods) {
+				subMod->AddReplacementAnimation(match.originalAnimationPath, match.originalIndex, projectData, a_stringData);
+			}
+		}
+
+		addedAnimationIndices = projectData->TakeAddedAnimationIndices();
+		projectData->FinishAddingAnimations();
 	}
 
-	auto endOfUpdatingTime = std::chrono::high_resolution_clock::now();
+	auto endOfAddingTime = std::chrono::high_resolution_clock::now();
+
+	if (!planKey.empty() && !cachedPlan) {
+		ReplacementPlan plan;
+		for (size_t i = numOriginalAnims; i < animationBundleNames.size(); ++i) {
+			plan.appendedAnimationNames.emplace_back(animationBundleNames[i].data());
+		}
+		plan.animationIndices = std::move(addedAnimationIndices);
+		plan.matches.reserve(matches.size());
+		for (const auto& match : matches) {
+			auto& plannedMatch = plan.matches.emplace_back(match.originalIndex, match.originalAnimationPath, std::vector<std::string>());
+			for (const auto& subMod : match.subMods) {
+				plannedMatch.subModPaths.emplace_back(subMod->GetPath());
+			}
+		}
+		plan.filteredDuplicates = projectData ? projectData->GetFilteredDuplicateCount() : 0;
+
+		replacementPlanCache.SavePlan(a_path, planKey, plan);
+	}
+
+	auto endOfPlanSavingTime = std::chrono::high_resolution_clock::now();
 
 	MarkDataAsProcessed(a_stringData);
 
-	if (projectData && !projectData->replacementIndexToOriginalIndexMap.empty()) {
+	if (projectData && projectData->HasReplacementIndices()) {
 		SetSynchronizedClipsIDOffset(a_stringData, static_cast<uint16_t>(a_stringData->animationNames.size()));
 
-		InitializeReplacementAnimations(a_stringData);
+		if (!planKey.empty()) {
+			projectData->synchronizedClipsCacheKey = replacementPlanCache.GetSynchronizedClipsKey(planKey, projectPath);
+		}
 
 		if (Settings::bFilterOutDuplicateAnimations) {
-			logger::info("Filtered out {} duplicate animations in project {}", projectData->GetFilteredDuplicateCount(), projectData->stringData->name.data());
+			logger::info("Filtered out {} duplicate animations in project {}, saving {}", projectData->GetFilteredDuplicateCount(), projectData->stringData->name.data(), MemoryReport::FormatBytes(AnimationContentRegistry::GetSingleton().GetFilteredBytes(a_stringData)));
 		}
 	}
 
 	auto endTime = std::chrono::high_resolution_clock::now();
+
+	traceScope.reset();
+	StartupTrace::GetSingleton().Flush();
+
 	logger::info("Time spent creating replacement animations for {}:", a_path);
-	logger::info("  Parsing: {}ms", std::chrono::duration_cast<std::chrono::milliseconds>(endOfParsingTime - startTime).count());
-	logger::info("  Updating animations in submods: {}ms", std::chrono::duration_cast<std::chrono::milliseconds>(endOfUpdatingTime - endOfParsingTime).count());
-	logger::info("  Initializing replacment animations: {}ms", std::chrono::duration_cast<std::chrono::milliseconds>(endTime - endOfUpdatingTime).count());
+	logger::info("  Loading replacement plan ({}): {}ms", cachedPlan ? "hit"sv : (planKey.empty() ? "disabled"sv : "miss"sv), std::chrono::duration_cast<std::chrono::milliseconds>(endOfPlanLoadingTime - startTime).count());
+	logger::info("  Matching animations{}: {}ms", cachedPlan ? " (cached plan)"s : std::format(" ({} chunks)", chunkCount), std::chrono::duration_cast<std::chrono::milliseconds>(endOfMatchingTime - endOfPlanLoadingTime).count());
+	logger::info("  Adding replacement animations: {}ms", std::chrono::duration_cast<std::chrono::milliseconds>(endOfAddingTime - endOfMatchingTime).count());
+	logger::info("  Saving replacement plan: {}ms", std::chrono::duration_cast<std::chrono::milliseconds>(endOfPlanSavingTime - endOfAddingTime).count());
+	logger::info("  Finalizing project: {}ms", std::chrono::duration_cast<std::chrono::milliseconds>(endTime - endOfPlanSavingTime).count());
 	logger::info("  Total: {}ms", std::chrono::duration_cast<std::chrono::milliseconds>(endTime - startTime).count());
 }
 
+ExclusiveLock& OpenAnimationReplacer::GetProjectCreationLock(RE::hkbCharacterStringData* a_stringData)
+{
+	Locker locker(_projectCreationLocksLock);
+
+	auto& lock = _projectCreationLocks[a_stringData];
+	if (!lock) {
+		lock = std::make_unique<ExclusiveLock>("OpenAnimationReplacer::_projectCreationLocks");
+	}
+
+	return *lock;
+}
+
 void OpenAnimationReplacer::CacheAnimationPathSubMod(std::string_view a_path, SubMod* a_subMod)
 {
 	WriteLocker locker(_animationPathToSubModsLock);
@@ -515,6 +667,35 @@ ReplacerProjectData* OpenAnimationReplacer::GetReplacerProjectData(RE::hkbCharac
 	return nullptr;
 }
 
+ReplacerProjectData* OpenAnimationReplacer::GetReplacerProjectData(RE::hkbCharacter* a_character) const
+{
+	const auto stringData = Utils::GetStringDataFromHkbCharacter(a_character);
+	if (!stringData) {
+		return nullptr;
+	}
+
+	// this is called on every activation, loop, echo and interruptible update, so cache the result per string data on each thread
+	// this way steady state lookups don't touch the project map or its lock. Misses are cached too, most characters have no replacements at all
+	struct CachedProjectData
+	{
+		RE::hkbCharacterStringData* stringData = nullptr;
+		ReplacerProjectData* projectData = nullptr;
+		uint32_t generation = 0;
+	};
+	static thread_local std::array<CachedProjectData, 16> cache{};
+
+	const uint32_t generation = _replacerProjectDatasGeneration.load(std::memory_order_acquire);
+	auto& entry = cache[(reinterpret_cast<uintptr_t>(stringData) >> 4) % cache.size()];
+	if (entry.stringData == stringData && entry.generation == generation) {
+		return entry.projectData;
+	}
+
+	const auto projectData = GetReplacerProjectData(stringData);
+	entry = { stringData, projectData, generation };
+
+	return projectData;
+}
+
 ReplacerProjectData* OpenAnimationReplacer::GetOrAddReplacerProjectData(RE::hkbCharacterStringData* a_stringData, RE::BShkbHkxDB::ProjectDBData* a_projectDBData)
 {
 	if (const auto replacerProjectData = GetReplacerProjectData(a_stringData)) {
@@ -524,6 +705,10 @@ ReplacerProjectData* OpenAnimationReplacer::GetOrAddReplacerProjectData(RE::hkbC
 	WriteLocker locker(_dataLock);
 
 	auto [it, bSuccess] = _replacerProjectDatas.emplace(a_stringData, std::make_unique<ReplacerProjectData>(a_stringData, a_projectDBData));
+	if (bSuccess) {
+		++_replacerProjectDatasGeneration;
+	}
+
 	return it->second.get();
 }
 
@@ -572,8 +757,39 @@ void OpenAnimationReplacer::ForEachSortedReplacerMod(const std::function<void(Re
 	}
 }
 
+size_t OpenAnimationReplacer::GetActiveClipsMemoryUsage(size_t& a_outActiveClipCount) const
+{
+	ReadLocker locker(_activeClipsLock);
+
+	a_outActiveClipCount = _activeClips.size();
+
+	size_t bytes = MemoryReport::GetHashMapSize(_activeClips);
+	for (const auto& activeClip : _activeClips | std::views::values) {
+		bytes += activeClip->GetMemoryUsage();
+	}
+
+	return bytes;
+}
+
+size_t OpenAnimationReplacer::GetAnimationPathMapMemoryUsage(size_t& a_outPathCount) const
+{
+	ReadLocker locker(_animationPathToSubModsLock);
+
+	a_outPathCount = _animationPathToSubModsMap.size();
+
+	size_t bytes = MemoryReport::GetHashMapSize(_animationPathToSubModsMap);
+	for (const auto& [path, subMods] : _animationPathToSubModsMap) {
+		bytes += MemoryReport::GetPathSize(path) + MemoryReport::GetHashMapSize(subMods);
+	}
+
+	return bytes;
+}
+
 void OpenAnimationReplacer::SetSynchronizedClipsIDOffset(RE::hkbCharacterStringData* a_stringData, uint16_t a_offset)
 {
+	// projects are created concurrently, so another one might be adding its project data right now
+	ReadLocker locker(_dataLock);
+
 	if (const auto search = _replacerProjectDatas.find(a_stringData); search != _replacerProjectDatas.end()) {
 		const auto& replacerProjectData = search->second;
 		replacerProjectData->synchronizedClipIDOffset = a_offset;
@@ -599,12 +815,42 @@ uint16_t OpenAnimationReplacer::GetSynchronizedClipsIDOffset(RE::hkbCharacter* a
 	return 0;
 }
 
-void OpenAnimationReplacer::MarkSynchronizedReplacementAnimations(RE::hkbCharacterStringData* a_stringData, RE::hkbBehaviorGraph* a_rootBehavior)
+void OpenAnimationReplacer::MarkSynchronizedReplacementAnimations(const char* a_path, RE::hkbCharacterStringData* a_stringData, RE::hkbBehaviorGraph* a_rootBehavior)
 {
-	if (const auto search = _replacerProjectDatas.find(a_stringData); search != _replacerProjectDatas.end()) {
-		auto& replacerProjectData = search->second;
-		replacerProjectData->MarkSynchronizedReplacementAnimations(a_rootBehavior);
+	const auto replacerProjectData = GetReplacerProjectData(a_stringData);
+	if (!replacerProjectData || !a_rootBehavior) {
+		return;
+	}
+
+	// LoadClips runs for every character loading the project, but its behavior graph is always the same
+	if (replacerProjectData->HasMarkedSynchronizedAnimations()) {
+		return;
+	}
+
+	auto startTime = std::chrono::high_resolution_clock::now();
+
+	auto& replacementPlanCache = ReplacementPlanCache::GetSingleton();
+	const auto& cacheKey = replacerProjectData->synchronizedClipsCacheKey;
+
+	auto synchronizedClipIndices = cacheKey.empty() ? std::nullopt : replacementPlanCache.LoadSynchronizedClipIndices(a_path, cacheKey);
+	const bool bCached = synchronizedClipIndices.has_value();
+	if (!bCached) {
+		synchronizedClipIndices = replacerProjectData->FindSynchronizedClipIndices(a_rootBehavior);
+	}
+
+	auto endOfFindingTime = std::chrono::high_resolution_clock::now();
+
+	replacerProjectData->MarkSynchronizedReplacementAnimations(*synchronizedClipIndices);
+
+	if (!bCached && !cacheKey.empty()) {
+		replacementPlanCache.SaveSynchronizedClipIndices(a_path, cacheKey, *synchronizedClipIndices);
 	}
+
+	auto endTime = std::chrono::high_resolution_clock::now();
+
+	logger::info("Time spent marking synchronized animations for {}:", a_path);
+	logger::info("  Finding {} synchronized clips ({}): {}ms", synchronizedClipIndices->size(), bCached ? "cached"sv : "graph walk"sv, std::chrono::duration_cast<std::chrono::milliseconds>(endOfFindingTime - startTime).count());
+	logger::info("  Marking synchronized animations: {}ms", std::chrono::duration_cast<std::chrono::milliseconds>(endTime - endOfFindingTime).count());
 }
 
 // the loading functions don't actually need a real clip generator, just access two member variables
@@ -652,6 +898,8 @@ void OpenAnimationReplacer::InitFactories()
 {
 	using namespace Conditions;
 
+	StartupTrace::Scope traceScope("startup", "InitFactories"sv);
+
 	Locker locker(_factoriesLock);
 
 	if (_bFactoriesInitialized) {
@@ -885,35 +1133,29 @@ void OpenAnimationReplacer::LoadKeywords() const
 
 void OpenAnimationReplacer::RunJobs()
 {
-	WriteLocker locker(_jobsLock);
-
-	for (const auto& job : _jobs) {
-		job->Run();
+	// called every frame - with nothing queued and no latent jobs waiting this is the only thing that runs
+	if (!_bHasPendingJobs.load(std::memory_order_acquire)) {
+		return;
 	}
 
-	_jobs.clear();
+	// clear the flag before consuming, anything queued from now on sets it again
+	_bHasPendingJobs.exchange(false, std::memory_order_acq_rel);
 
-	// we have no latent jobs right now so skip this
-	/*for (auto it = _latentJobs.begin(); it != _latentJobs.end();) {
-		if (it->get()->Run(g_deltaTime)) {
-			it = _latentJobs.erase(it);
-		} else {
-			++it;
-		}
-	}*/
-
-	for (auto it = _weakLatentJobs.begin(); it != _weakLatentJobs.end();) {
-		auto p = it->lock();
-		if (p) {
-			if (p->Run(g_deltaTime)) {
-				it = _weakLatentJobs.erase(it);
-			} else {
-				++it;
-			}
-		} else {
-			// remove if weak pointer is invalid
-			it = _weakLatentJobs.erase(it);
-		}
+	_jobs.ConsumeAll([](std::unique_ptr<Jobs::GenericJob>& a_job) {
+		a_job->Run();
+	});
+
+	const float currentTime = gameTimeCounter;
+
+	_latentJobs.ConsumeAll([&](Jobs::QueuedLatentJob& a_queuedJob) {
+		_latentJobWheel.Add(a_queuedJob, currentTime);
+	});
+
+	_latentJobWheel.Advance(currentTime);
+
+	// keep ticking while latent jobs are waiting
+	if (!_latentJobWheel.IsEmpty()) {
+		_bHasPendingJobs.store(true, std::memory_order_release);
 	}
 }
 
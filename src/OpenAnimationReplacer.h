@@ -29,7 +29,6 @@ public:
 	ReplacerMod* GetOrCreateLegacyReplacerMod();
 	void OnReplacerModNameChanged(std::string_view a_previousName, ReplacerMod* a_replacerMod);
 
-	void InitializeReplacementAnimations(RE::hkbCharacterStringData* a_stringData) const;
 	[[nodiscard]] AnimationReplacements* GetReplacements(RE::hkbCharacter* a_character, uint16_t a_originalIndex) const;
 
 	[[nodiscard]] ActiveClip* GetActiveClip(RE::hkbClipGenerator* a_clipGenerator) const;
@@ -55,20 +54,25 @@ public:
 
 	void CreateReplacerMods();
 	void CreateReplacementAnimations(const char* a_path, RE::hkbCharacterStringData* a_stringData, RE::BShkbHkxDB::ProjectDBData* a_projectDBData);
+	[[nodiscard]] ExclusiveLock& GetProjectCreationLock(RE::hkbCharacterStringData* a_stringData);
 
 	void CacheAnimationPathSubMod(std::string_view a_path, SubMod* a_subMod);
 
 	[[nodiscard]] ReplacerProjectData* GetReplacerProjectData(RE::hkbCharacterStringData* a_stringData) const;
+	[[nodiscard]] ReplacerProjectData* GetReplacerProjectData(RE::hkbCharacter* a_character) const;
 	[[nodiscard]] ReplacerProjectData* GetOrAddReplacerProjectData(RE::hkbCharacterStringData* a_stringData, RE::BShkbHkxDB::ProjectDBData* a_projectDBData);
 	void ForEachReplacerProjectData(const std::function<void(RE::hkbCharacterStringData*, ReplacerProjectData*)>& a_func) const;
 	void ForEachReplacerMod(const std::function<void(ReplacerMod*)>& a_func) const;
 	void ForEachSortedReplacerMod(const std::function<void(ReplacerMod*)>& a_func) const;
 
+	[[nodiscard]] size_t GetActiveClipsMemoryUsage(size_t& a_outActiveClipCount) const;
+	[[nodiscard]] size_t GetAnimationPathMapMemoryUsage(size_t& a_outPathCount) const;
+
 	void SetSynchronizedClipsIDOffset(RE::hkbCharacterStringData* a_stringData, uint16_t a_offset);
 	[[nodiscard]] uint16_t GetSynchronizedClipsIDOffset(RE::hkbCharacterStringData* a_stringData) const;
 	[[nodiscard]] uint16_t GetSynchronizedClipsIDOffset(RE::hkbCharacter* a_character) const;
 
-	void MarkSynchronizedReplacementAnimations(RE::hkbCharacterStringData* a_stringData, RE::hkbBehaviorGraph* a_rootBehavior);
+	void MarkSynchronizedReplacementAnimations(const char* a_path, RE::hkbCharacterStringData* a_stringData, RE::hkbBehaviorGraph* a_rootBehavior);
 
 	static void LoadAnimation(RE::hkbCharacter* a_character, uint16_t a_animationIndex);
 	static void UnloadAnimation(RE::hkbCharacter* a_character, uint16_t a_animationIndex);
@@ -91,57 +95,58 @@ public:
 	template <class T, typename... Args>
 	void QueueJob(Args&&... a_args)
 	{
-		WriteLocker locker(_jobsLock);
-
 		static_assert(std::is_base_of_v<Jobs::GenericJob, T>);
-		_jobs.push_back(std::make_unique<T>(std::forward<Args>(a_args)...));
+		_jobs.Push(std::make_unique<T>(std::forward<Args>(a_args)...));
+		_bHasPendingJobs.store(true, std::memory_order_release);
 	}
 
 	template <class T, typename... Args>
 	void QueueLatentJob(Args&&... a_args)
 	{
-		WriteLocker locker(_jobsLock);
-
 		static_assert(std::is_base_of_v<Jobs::LatentJob, T>);
-		_latentJobs.push_back(std::make_unique<T>(std::forward<Args>(a_args)...));
+		_latentJobs.Push({ std::make_shared<T>(std::forward<Args>(a_args)...), {} });
+		_bHasPendingJobs.store(true, std::memory_order_release);
 	}
 
 	void QueueWeakLatentJob(std::weak_ptr<Jobs::LatentJob> a_job)
 	{
-		_weakLatentJobs.emplace_back(a_job);
+		_latentJobs.Push({ nullptr, std::move(a_job) });
+		_bHasPendingJobs.store(true, std::memory_order_release);
 	}
 
 	static inline bool bKeywordsLoaded = false;
 	static inline RE::BGSKeyword* kywd_weapTypeWarhammer = nullptr;
 	static inline RE::BGSKeyword* kywd_weapTypeBattleaxe = nullptr;
 
-	static inline std::atomic_bool bIsPreLoading = false;
+	static inline thread_local bool bIsPreLoading = false;  // preloading is spread over frames on the main thread, so this must not affect evaluations on other threads
 	static inline float gameTimeCounter = 0.f;
 
 protected:
-	ExclusiveLock _parseLock;
-	ExclusiveLock _animationCreationLock;
-	mutable SharedLock _dataLock;
+	ExclusiveLock _parseLock{ "OpenAnimationReplacer::_parseLock" };
+	ExclusiveLock _projectCreationLocksLock{ "OpenAnimationReplacer::_projectCreationLocksLock" };
+	std::unordered_map<RE::hkbCharacterStringData*, std::unique_ptr<ExclusiveLock>> _projectCreationLocks;
+	mutable SharedLock _dataLock{ "OpenAnimationReplacer::_dataLock" };
 	std::unordered_set<RE::hkbCharacterStringData*> _processedDatas;
 	std::unordered_map<RE::hkbCharacterStringData*, std::unique_ptr<ReplacerProjectData>> _replacerProjectDatas;
+	std::atomic<uint32_t> _replacerProjectDatasGeneration = 0;  // bumped whenever _replacerProjectDatas changes, invalidates the per-thread project data caches
 
-	mutable SharedLock _modLock;
+	mutable SharedLock _modLock{ "OpenAnimationReplacer::_modLock" };
 	std::unordered_map<std::string, std::unique_ptr<ReplacerMod>> _replacerMods;
 	std::unique_ptr<ReplacerMod> _legacyReplacerMod = nullptr;
 
-	mutable SharedLock _animationPathToSubModsLock;
+	mutable SharedLock _animationPathToSubModsLock{ "OpenAnimationReplacer::_animationPathToSubModsLock" };
 	std::unordered_map<std::filesystem::path, std::unordered_set<SubMod*>, CaseInsensitivePathHash, CaseInsensitivePathEqual> _animationPathToSubModsMap;
 
-	mutable SharedLock _replacerModNameLock;
+	mutable SharedLock _replacerModNameLock{ "OpenAnimationReplacer::_replacerModNameLock" };
 	std::unordered_map<std::string, ReplacerMod*> _replacerModNameMap;
 
-	mutable SharedLock _activeClipsLock;
+	mutable SharedLock _activeClipsLock{ "OpenAnimationReplacer::_activeClipsLock" };
 	std::unordered_map<RE::hkbClipGenerator*, std::unique_ptr<ActiveClip>> _activeClips;
 
-	mutable SharedLock _activeSynchronizedAnimationsLock;
+	mutable SharedLock _activeSynchronizedAnimationsLock{ "OpenAnimationReplacer::_activeSynchronizedAnimationsLock" };
 	std::unordered_map<RE::BGSSynchronizedAnimationInstance*, std::unique_ptr<ActiveSynchronizedAnimation>> _activeSynchronizedAnimations;
 
-	mutable SharedLock _activeAnimationPreviewsLock;
+	mutable SharedLock _activeAnimationPreviewsLock{ "OpenAnimationReplacer::_activeAnimationPreviewsLock" };
 	std::unordered_map<RE::hkbBehaviorGraph*, std::unique_ptr<ActiveAnimationPreview>> _activeAnimationPreviews;
 
 	void InitDefaultProjects() const;
@@ -150,21 +155,20 @@ protected:
 	void AddModParseResult(Parsing::ModParseResult& a_parseResult);
 	void AddSubModParseResult(ReplacerMod* a_replacerMod, Parsing::SubModParseResult& a_parseResult);
 
-	ExclusiveLock _factoriesLock;
+	ExclusiveLock _factoriesLock{ "OpenAnimationReplacer::_factoriesLock" };
 	bool _bFactoriesInitialized = false;
 	std::map<std::string, std::function<std::unique_ptr<Conditions::ICondition>()>> _conditionFactories;
 	std::map<std::string, std::function<std::unique_ptr<Conditions::ICondition>()>> _hiddenConditionFactories;
 
-	mutable SharedLock _customConditionsLock;
+	mutable SharedLock _customConditionsLock{ "OpenAnimationReplacer::_customConditionsLock" };
 	std::unordered_map<std::string, REL::Version> _customConditionPlugins;
 	std::unordered_map<std::string, Conditions::ConditionFactory> _customConditionFactories;
 
-	mutable SharedLock _jobsLock;
-	std::vector<std::unique_ptr<Jobs::GenericJob>> _jobs;
-
-	std::vector<std::unique_ptr<Jobs::LatentJob>> _latentJobs;
-
-	std::vector<std::weak_ptr<Jobs::LatentJob>> _weakLatentJobs;
+	// jobs can be queued from any thread, but are only ever run on the main thread, so they don't need a lock
+	std::atomic_bool _bHasPendingJobs = false;
+	Jobs::MPSCQueue<std::unique_ptr<Jobs::GenericJob>> _jobs;
+	Jobs::MPSCQueue<Jobs::QueuedLatentJob> _latentJobs;
+	Jobs::LatentJobWheel _latentJobWheel;
 
 private:
 	OpenAnimationReplacer() = default;
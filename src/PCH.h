@@ -87,10 +87,12 @@ struct CaseInsensitivePathEqual
 	}
 };
 
-using ExclusiveLock = std::mutex;
+#include "LockProfiler.h"
+
+using ExclusiveLock = LockProfiler::ProfiledMutex<std::mutex>;
 using Locker = std::lock_guard<ExclusiveLock>;
 
-using SharedLock = std::shared_mutex;
+using SharedLock = LockProfiler::ProfiledMutex<std::shared_mutex>;
 using ReadLocker = std::shared_lock<SharedLock>;
 using WriteLocker = std::unique_lock<SharedLock>;
 
@@ -7,84 +7,143 @@
 #include <rapidjson/filewritestream.h>
 #include <rapidjson/prettywriter.h>
 
+#include "ConfigLimits.h"
+#include "LegacyConditions.h"
 #include "OpenAnimationReplacer.h"
 #include "Settings.h"
+#include "StartupTrace.h"
 
 namespace Parsing
 {
-	ConditionsTxtFile::ConditionsTxtFile(const std::filesystem::path& a_fileName) :
-		file(a_fileName),
-		filename(a_fileName.string())
+	namespace
 	{
-		if (!file.is_open()) {
-			//util::report_and_fail("Error opening _conditions.txt file");
-			logger::error("Error opening {} file", a_fileName.string());
+		std::atomic<uint32_t> parsedConfigFiles = 0;
+		std::atomic<uint64_t> parsedConfigBytes = 0;
+		std::atomic<uint64_t> configParseTime = 0;
+
+		// adds the lifetime of the scope to the config parse statistics
+		class ConfigParseTimer
+		{
+		public:
+			explicit ConfigParseTimer(uint64_t a_bytes) :
+				_bytes(a_bytes),
+				_startTime(std::chrono::steady_clock::now()) {}
+
+			~ConfigParseTimer()
+			{
+				parsedConfigFiles.fetch_add(1, std::memory_order_relaxed);
+				parsedConfigBytes.fetch_add(_bytes, std::memory_order_relaxed);
+				configParseTime.fetch_add(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - _startTime).count()), std::memory_order_relaxed);
+			}
+
+			ConfigParseTimer(const ConfigParseTimer&) = delete;
+			ConfigParseTimer& operator=(const ConfigParseTimer&) = delete;
+
+		private:
+			uint64_t _bytes;
+			std::chrono::steady_clock::time_point _startTime;
+		};
+
+		// strings from json are cut off at ConfigLimits::kMaxStringLength, the view points into the document
+		std::string_view GetCappedString(const rapidjson::Value& a_value)
+		{
+			return ConfigLimits::CapString({ a_value.GetString(), a_value.GetStringLength() });
 		}
-	}
 
-	ConditionsTxtFile::~ConditionsTxtFile()
-	{
-		file.close();
-	}
+		// builds the condition set of a legacy _conditions.txt from the lines LegacyConditions::Parse reads
+		class ConditionsTxtBuilder
+		{
+		public:
+			void BeginOrBlock()
+			{
+				_orConditions = std::make_unique<Conditions::ConditionSet>();
+			}
 
-	std::unique_ptr<Conditions::ConditionSet> ConditionsTxtFile::GetConditions(std::string& a_currentLine, bool a_bInOrBlock /*= false*/)
-	{
-		auto conditions = std::make_unique<Conditions::ConditionSet>();
+			void EndOrBlock()
+			{
+				auto orCondition = OpenAnimationReplacer::GetSingleton().CreateCondition("OR");
+				static_cast<Conditions::ORCondition*>(orCondition.get())->conditionsComponent->conditionSet = std::move(_orConditions);
+				_conditions->AddCondition(orCondition);
+			}
 
-		do {
-			if (file.fail()) {
-				if (file.eof()) {
-					break;
-				}
-				//util::report_and_fail("Error reading from _conditions.txt file");
-				logger::error("Error reading from {} file", filename);
-				return std::move(conditions);
-			}
-
-			a_currentLine = Utils::TrimWhitespace(a_currentLine);
-			if (!a_currentLine.empty()) {
-				const bool bEndsWithOR = a_currentLine.ends_with("OR"sv);
-				if (bEndsWithOR && !a_bInOrBlock) {
-					// start an OR block - create an OR condition and add all conditions to it until we reach AND
-					auto orCondition = OpenAnimationReplacer::GetSingleton().CreateCondition("OR");
-					static_cast<Conditions::ORCondition*>(orCondition.get())->conditionsComponent->conditionSet = GetConditions(a_currentLine, true);
-					conditions->AddCondition(orCondition);
-				} else {
-					// create and add a new condition
-					if (auto newCondition = Conditions::CreateConditionFromString(a_currentLine)) {
-						conditions->AddCondition(newCondition);
+			void AddCondition(const LegacyConditions::Line& a_line)
+			{
+				auto condition = Conditions::CreateConditionFromLegacyLine(a_line);
+				GetCurrentConditions().AddCondition(condition);
+			}
 
-						if (!bEndsWithOR && a_bInOrBlock) {
-							// end an OR block
-							return std::move(conditions);
-						}
-					}
-				}
+			void AddInvalidCondition(std::string_view a_error)
+			{
+				std::unique_ptr<Conditions::ICondition> condition = std::make_unique<Conditions::InvalidCondition>(a_error);
+				GetCurrentConditions().AddCondition(condition);
 			}
-		} while (std::getline(file, a_currentLine));
 
-		return std::move(conditions);
+			std::unique_ptr<Conditions::ConditionSet> TakeConditions() { return std::move(_conditions); }
+
+		private:
+			Conditions::ConditionSet& GetCurrentConditions() { return _orConditions ? *_orConditions : *_conditions; }
+
+			std::unique_ptr<Conditions::ConditionSet> _conditions = std::make_unique<Conditions::ConditionSet>();
+			std::unique_ptr<Conditions::ConditionSet> _orConditions;
+		};
+	}
+
+	ConfigParseStatistics GetConfigParseStatistics()
+	{
+		ConfigParseStatistics statistics;
+		statistics.files = parsedConfigFiles.load(std::memory_order_relaxed);
+		statistics.bytes = parsedConfigBytes.load(std::memory_order_relaxed);
+		statistics.parseTime = configParseTime.load(std::memory_order_relaxed);
+		return statistics;
 	}
 
 	std::unique_ptr<Conditions::ConditionSet> ParseConditionsTxt(const std::filesystem::path& a_txtPath)
 	{
-		ConditionsTxtFile txt(a_txtPath);
+		std::error_code errorCode;
+		const auto fileSize = std::filesystem::file_size(a_txtPath, errorCode);
+		ConfigParseTimer parseTimer(errorCode ? 0 : fileSize);
+
+		ConditionsTxtBuilder builder;
+
+		if (errorCode) {
+			logger::error("Error opening {} file", a_txtPath.string());
+			return builder.TakeConditions();
+		}
+
+		if (fileSize > ConfigLimits::kMaxTxtFileSize) {
+			logger::error("{} is bigger than {} bytes, not parsing it", a_txtPath.string(), ConfigLimits::kMaxTxtFileSize);
+			builder.AddInvalidCondition(std::format("The file is bigger than {} bytes", ConfigLimits::kMaxTxtFileSize));
+			return builder.TakeConditions();
+		}
 
-		std::string line;
-		std::getline(txt.file, line);
+		std::ifstream file(a_txtPath, std::ios::binary);
+		std::string text(fileSize, '\0');
+		if (!file.is_open() || !file.read(text.data(), static_cast<std::streamsize>(fileSize))) {
+			logger::error("Error reading from {} file", a_txtPath.string());
+			return builder.TakeConditions();
+		}
 
-		return txt.GetConditions(line);
+		if (!LegacyConditions::Parse(text, builder)) {
+			logger::error("{} has more than {} conditions, the rest were ignored", a_txtPath.string(), ConfigLimits::kMaxTxtConditionCount);
+		}
+
+		return builder.TakeConditions();
 	}
 
 	bool DeserializeMod(const std::filesystem::path& a_jsonPath, ModParseResult& a_outParseResult)
 	{
+		StartupTrace::Scope traceScope("json", a_jsonPath);
+
 		mmio::mapped_file_source file;
 		if (file.open(a_jsonPath)) {
+			ConfigParseTimer parseTimer(file.size());
+
 			//rapidjson::StringStream stream{ reinterpret_cast<const char*>(file.data()) };
 			rapidjson::MemoryStream stream{ reinterpret_cast<const char*>(file.data()), file.size() };
 
+			// iterative parsing doesn't recurse, so deeply nested json can't overflow the stack
 			rapidjson::Document doc;
-			doc.ParseStream(stream);
+			doc.ParseStream<rapidjson::kParseIterativeFlag>(stream);
 
 			if (doc.HasParseError()) {
 				logger::error("Failed to parse file: {}", a_jsonPath.string());
@@ -93,7 +152,7 @@ namespace Parsing
 
 			// read mod name (required)
 			if (const auto nameIt = doc.FindMember("name"); nameIt != doc.MemberEnd() && nameIt->value.IsString()) {
-				a_outParseResult.name = nameIt->value.GetString();
+				a_outParseResult.name = GetCappedString(nameIt->value);
 			} else {
 				logger::error("Failed to find mod name in file: {}", a_jsonPath.string());
 				return false;
@@ -101,12 +160,12 @@ namespace Parsing
 
 			// read mod author (optional)
 			if (const auto authorIt = doc.FindMember("author"); authorIt != doc.MemberEnd() && authorIt->value.IsString()) {
-				a_outParseResult.author = authorIt->value.GetString();
+				a_outParseResult.author = GetCappedString(authorIt->value);
 			}
 
 			// read mod description (optional)
 			if (const auto descriptionIt = doc.FindMember("description"); descriptionIt != doc.MemberEnd() && descriptionIt->value.IsString()) {
-				a_outParseResult.description = descriptionIt->value.GetString();
+				a_outParseResult.description = GetCappedString(descriptionIt->value);
 			}
 
 			a_outParseResult.path = a_jsonPath.parent_path().string();
@@ -121,13 +180,18 @@ namespace Parsing
 
 	bool DeserializeSubMod(std::filesystem::path a_jsonPath, DeserializeMode a_deserializeMode, SubModParseResult& a_outParseResult)
 	{
+		StartupTrace::Scope traceScope("json", a_jsonPath);
+
 		mmio::mapped_file_source file;
 		if (file.open(a_jsonPath)) {
+			ConfigParseTimer parseTimer(file.size());
+
 			//rapidjson::StringStream stream{ reinterpret_cast<const char*>(file.data()) };
 			rapidjson::MemoryStream stream{ reinterpret_cast<const char*>(file.data()), file.size() };
 
+			// iterative parsing doesn't recurse, so deeply nested json can't overflow the stack
 			rapidjson::Document doc;
-			doc.ParseStream(stream);
+			doc.ParseStream<rapidjson::kParseIterativeFlag>(stream);
 
 			if (doc.HasParseError()) {
 				logger::error("Failed to parse file: {}", a_jsonPath.string());
@@ -137,7 +201,7 @@ namespace Parsing
 			if (a_deserializeMode != DeserializeMode::kWithoutNameDescription) {
 				// read submod name (required)
 				if (auto nameIt = doc.FindMember("name"); nameIt != doc.MemberEnd() && nameIt->value.IsString()) {
-					a_outParseResult.name = nameIt->value.GetString();
+					a_outParseResult.name = GetCappedString(nameIt->value);
 				} else {
 					logger::error("Failed to find mod name in file: {}", a_jsonPath.string());
 					return false;
@@ -145,7 +209,7 @@ namespace Parsing
 
 				// read submod description (optional)
 				if (auto descriptionIt = doc.FindMember("description"); descriptionIt != doc.MemberEnd() && descriptionIt->value.IsString()) {
-					a_outParseResult.description = descriptionIt->value.GetString();
+					a_outParseResult.description = GetCappedString(descriptionIt->value);
 				}
 			}
 
@@ -173,7 +237,7 @@ namespace Parsing
 					if (disabledAnimation.IsObject()) {
 						auto projectNameIt = disabledAnimation.FindMember("projectName");
 						if (auto pathIt = disabledAnimation.FindMember("path"); projectNameIt != doc.MemberEnd() && projectNameIt->value.IsString() && pathIt != doc.MemberEnd() && pathIt->value.IsString()) {
-							a_outParseResult.replacementAnimDatas.emplace_back(projectNameIt->value.GetString(), pathIt->value.GetString(), true);
+							a_outParseResult.replacementAnimDatas.emplace_back(GetCappedString(projectNameIt->value), GetCappedString(pathIt->value), true);
 						}
 					}
 				}
@@ -196,7 +260,7 @@ namespace Parsing
 								for (auto& variantObj : variantsIt->value.GetArray()) {
 									if (variantObj.IsObject()) {
 										if (auto variantFilenameIt = variantObj.FindMember("filename"); variantFilenameIt != doc.MemberEnd() && variantFilenameIt->value.IsString()) {
-											ReplacementAnimData::Variant variant(variantFilenameIt->value.GetString());
+											ReplacementAnimData::Variant variant(GetCappedString(variantFilenameIt->value));
 
 											if (auto weightIt = variantObj.FindMember("weight"); weightIt != doc.MemberEnd() && weightIt->value.IsNumber()) {
 												variant.weight = weightIt->value.GetFloat();
@@ -215,7 +279,7 @@ namespace Parsing
 								}
 							}
 
-							a_outParseResult.replacementAnimDatas.emplace_back(projectNameIt->value.GetString(), pathIt->value.GetString(), bDisabled, variants);
+							a_outParseResult.replacementAnimDatas.emplace_back(GetCappedString(projectNameIt->value), GetCappedString(pathIt->value), bDisabled, variants);
 						}
 					}
 				}
@@ -223,12 +287,12 @@ namespace Parsing
 
 			// read override animations folder (optional)
 			if (auto overrideAnimationsFolderIt = doc.FindMember("overrideAnimationsFolder"); overrideAnimationsFolderIt != doc.MemberEnd() && overrideAnimationsFolderIt->value.IsString()) {
-				a_outParseResult.overrideAnimationsFolder = overrideAnimationsFolderIt->value.GetString();
+				a_outParseResult.overrideAnimationsFolder = GetCappedString(overrideAnimationsFolderIt->value);
 			}
 
 			// read required project name (optional)
 			if (auto requiredProjectNameIt = doc.FindMember("requiredProjectName"); requiredProjectNameIt != doc.MemberEnd() && requiredProjectNameIt->value.IsString()) {
-				a_outParseResult.requiredProjectName = requiredProjectNameIt->value.GetString();
+				a_outParseResult.requiredProjectName = GetCappedString(requiredProjectNameIt->value);
 			}
 
 			// read ignore no triggers flag (optional)
@@ -268,18 +332,31 @@ namespace Parsing
 				a_outParseResult.bShareRandomResults = shareRandomIt->value.GetBool();
 			}
 
+			// a broken config can have many invalid conditions, only dump it once
+			// the raw file contents are logged instead of writing the document back out - writing recurses through the whole document, which would overflow the stack on the deeply nested input the depth limit rejects
+			bool bDumpedJson = false;
+			auto dumpJson = [&]() {
+				if (bDumpedJson) {
+					return;
+				}
+				bDumpedJson = true;
+
+				constexpr size_t maxDumpSize = 64 * 1024;
+				const std::string_view contents{ reinterpret_cast<const char*>(file.data()), std::min(file.size(), maxDumpSize) };
+				if (file.size() > maxDumpSize) {
+					logger::error("Dumping the first {} of {} bytes of the json file: {}", maxDumpSize, file.size(), contents);
+				} else {
+					logger::error("Dumping entire json file: {}", contents);
+				}
+			};
+
 			// read conditions
 			if (auto conditionsIt = doc.FindMember("conditions"); conditionsIt != doc.MemberEnd() && conditionsIt->value.IsArray()) {
 				for (auto& conditionValue : conditionsIt->value.GetArray()) {
 					auto condition = Conditions::CreateConditionFromJson(conditionValue);
 					if (!condition->IsValid()) {
 						logger::error("Failed to parse condition in file: {}", a_jsonPath.string());
-
-						rapidjson::StringBuffer buffer;
-						rapidjson::PrettyWriter writer(buffer);
-						doc.Accept(writer);
-
-						logger::error("Dumping entire json file from memory: {}", buffer.GetString());
+						dumpJson();
 					}
 
 					a_outParseResult.conditionSet->AddCondition(condition);
@@ -291,12 +368,7 @@ namespace Parsing
 					auto condition = Conditions::CreateConditionFromJson(conditionValue);
 					if (!condition->IsValid()) {
 						logger::error("Failed to parse paired condition in file: {}", a_jsonPath.string());
-
-						rapidjson::StringBuffer buffer;
-						rapidjson::PrettyWriter writer(buffer);
-						doc.Accept(writer);
-
-						logger::error("Dumping entire json file from memory: {}", buffer.GetString());
+						dumpJson();
 					}
 
 					if (!a_outParseResult.synchronizedConditionSet) {
@@ -440,6 +512,8 @@ namespace Parsing
 			return;
 		}
 
+		StartupTrace::Scope traceScope("parsing", "ParseDirectory"sv);
+
 		static constexpr auto oarFolderName = "openanimationreplacer"sv;
 		static constexpr auto legacyFolderName = "dynamicanimationreplacer"sv;
 
@@ -525,6 +599,8 @@ namespace Parsing
 
 	ModParseResult ParseModDirectory(const std::filesystem::directory_entry& a_directory)
 	{
+		StartupTrace::Scope traceScope("mod", a_directory.path());
+
 		ModParseResult result;
 
 		// check whether the config json file exists first
@@ -568,6 +644,8 @@ namespace Parsing
 
 	SubModParseResult ParseModSubdirectory(const std::filesystem::directory_entry& a_subDirectory, bool a_bIsLegacy)
 	{
+		StartupTrace::Scope traceScope("submod", a_subDirectory.path());
+
 		SubModParseResult result;
 
 		bool bDeserializeSuccess = false;
@@ -629,6 +707,8 @@ namespace Parsing
 
 	SubModParseResult ParseLegacyCustomConditionsDirectory(const std::filesystem::directory_entry& a_directory)
 	{
+		StartupTrace::Scope traceScope("submod", a_directory.path());
+
 		SubModParseResult result;
 
 		// check whether _conditions.txt file exists first
@@ -688,6 +768,8 @@ namespace Parsing
 
 	std::vector<SubModParseResult> ParseLegacyPluginDirectory(const std::filesystem::directory_entry& a_directory)
 	{
+		StartupTrace::Scope traceScope("mod", a_directory.path());
+
 		std::vector<SubModParseResult> results;
 
 		for (const auto& subEntry : std::filesystem::directory_iterator(a_directory)) {
@@ -817,6 +899,8 @@ namespace Parsing
 
 	std::vector<ReplacementAnimationFile> ParseAnimationsInDirectory(const std::filesystem::directory_entry& a_directory, bool a_bIsLegacy /* = false*/)
 	{
+		StartupTrace::Scope traceScope("animations", a_directory.path());
+
 		std::vector<ReplacementAnimationFile> result;
 
 		if (!a_bIsLegacy) {
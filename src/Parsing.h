@@ -68,18 +68,6 @@ namespace Parsing
 		kWithoutNameDescription
 	};
 
-	struct ConditionsTxtFile
-	{
-	public:
-		ConditionsTxtFile(const std::filesystem::path& a_fileName);
-		~ConditionsTxtFile();
-
-		std::unique_ptr<Conditions::ConditionSet> GetConditions(std::string& a_currentLine, bool a_bInOrBlock = false);
-
-		std::ifstream file;
-		std::string filename;
-	};
-
 	struct SubModParseResult
 	{
 		SubModParseResult()
@@ -132,6 +120,18 @@ namespace Parsing
 		std::vector<std::future<SubModParseResult>> legacyParseResultFutures;
 	};
 
+	// totals over all the config files parsed so far, the time is summed over all the parsing threads
+	struct ConfigParseStatistics
+	{
+		uint32_t files = 0;
+		uint64_t bytes = 0;
+		uint64_t parseTime = 0;  // nanoseconds
+
+		[[nodiscard]] double GetThroughput() const { return parseTime ? (bytes / 1e6) / (parseTime / 1e9) : 0.0; }  // MB/s
+	};
+
+	[[nodiscard]] ConfigParseStatistics GetConfigParseStatistics();
+
 	[[nodiscard]] std::unique_ptr<Conditions::ConditionSet> ParseConditionsTxt(const std::filesystem::path& a_txtPath);
 	[[nodiscard]] bool DeserializeMod(const std::filesystem::path& a_jsonPath, ModParseResult& a_outParseResult);
 	[[nodiscard]] bool DeserializeSubMod(std::filesystem::path a_jsonPath, DeserializeMode a_deserializeMode, SubModParseResult& a_outParseResult);
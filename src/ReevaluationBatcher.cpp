@@ -0,0 +1,122 @@
+#include "ReevaluationBatcher.h"
+
+#include <ranges>
+
+#include "ReplacerMods.h"
+
+void ReevaluationBatcher::Submit(AnimationReplacements* a_replacements, RE::hkbClipGenerator* a_clipGenerator, RE::TESObjectREFR* a_refr, Reason a_reason)
+{
+	const auto refrHandle = a_refr->GetHandle();
+
+	Locker locker(_lock);
+
+	auto& requests = _requests[a_replacements];
+	if (const auto search = std::ranges::find_if(requests, [&](const Request& a_request) { return a_request.clipGenerator.get() == a_clipGenerator; }); search != requests.end()) {
+		search->reason = std::max(search->reason, a_reason);
+		return;
+	}
+
+	// a result that wasn't picked up yet is outdated by the new request
+	_results.erase(a_clipGenerator);
+	const uint32_t id = _nextRequestId++;
+	_pendingClips[a_clipGenerator] = id;
+	requests.push_back({ RE::hkRefPtr(a_clipGenerator), refrHandle, a_reason, id });
+
+	_bHasWork = true;
+}
+
+std::optional<ReevaluationBatcher::Result> ReevaluationBatcher::TakeResult(RE::hkbClipGenerator* a_clipGenerator)
+{
+	Locker locker(_lock);
+
+	if (const auto search = _results.find(a_clipGenerator); search != _results.end()) {
+		const auto result = search->second;
+		_results.erase(search);
+		return result;
+	}
+
+	return std::nullopt;
+}
+
+void ReevaluationBatcher::Cancel(RE::hkbClipGenerator* a_clipGenerator)
+{
+	Locker locker(_lock);
+
+	_pendingClips.erase(a_clipGenerator);
+	_results.erase(a_clipGenerator);
+	for (auto& requests : _requests | std::views::values) {
+		std::erase_if(requests, [&](const Request& a_request) { return a_request.clipGenerator.get() == a_clipGenerator; });
+	}
+}
+
+void ReevaluationBatcher::Update()
+{
+	if (!_bHasWork.load(std::memory_order_relaxed)) {
+		return;
+	}
+
+	// the requests are released here on the main thread, along with the clip generator references they hold
+	std::unordered_map<AnimationReplacements*, std::vector<Request>> requests;
+	{
+		Locker locker(_lock);
+		requests = std::exchange(_requests, {});
+		_bHasWork = false;
+	}
+
+	// the conditions are evaluated outside the lock - they can look up active clips, which are destroyed under the active clips lock and cancel their requests here
+	std::vector<AnimationReplacements::BatchedEvaluation> evaluations;
+	std::vector<RE::NiPointer<RE::TESObjectREFR>> refrs;  // keeps the references alive while evaluating
+	std::vector<size_t> evaluatedRequests;                // the request index of each evaluation
+	for (auto& [replacements, replacementRequests] : requests) {
+		// drop the requests of clips that were deactivated since they were taken out
+		{
+			Locker locker(_lock);
+			std::erase_if(replacementRequests, [&](const Request& a_request) { return !IsPending(a_request); });
+		}
+
+		if (replacementRequests.empty()) {
+			continue;
+		}
+
+		evaluations.clear();
+		refrs.clear();
+		evaluatedRequests.clear();
+		for (size_t i = 0; i < replacementRequests.size(); ++i) {
+			const auto& request = replacementRequests[i];
+			if (auto refr = request.refrHandle.get()) {
+				evaluations.push_back({ refr.get(), request.clipGenerator.get() });
+				refrs.push_back(std::move(refr));
+				evaluatedRequests.push_back(i);
+			}
+		}
+
+		replacements->EvaluateConditionsForBatch(evaluations);
+
+		std::vector<Result> results;
+		results.reserve(replacementRequests.size());
+		for (const auto& request : replacementRequests) {
+			results.push_back({ nullptr, request.reason, false });
+		}
+		for (size_t i = 0; i < evaluations.size(); ++i) {
+			auto& result = results[evaluatedRequests[i]];
+			result.replacementAnimation = evaluations[i].result;
+			result.bEvaluated = true;
+		}
+
+		Locker locker(_lock);
+		for (size_t i = 0; i < replacementRequests.size(); ++i) {
+			const auto& request = replacementRequests[i];
+			// skip clips that were cancelled or submitted a newer request while evaluating
+			if (IsPending(request)) {
+				_pendingClips.erase(request.clipGenerator.get());
+				_results[request.clipGenerator.get()] = results[i];
+			}
+		}
+	}
+}
+
+bool ReevaluationBatcher::IsPending(const Request& a_request) const
+{
+	const auto search = _pendingClips.find(a_request.clipGenerator.get());
+	return search != _pendingClips.end() && search->second == a_request.id;
+}
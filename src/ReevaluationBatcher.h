@@ -0,0 +1,64 @@
+#pragma once
+
+class AnimationReplacements;
+class ReplacementAnimation;
+
+// collects the condition re-evaluations of interruptible and looping clips during the frame and evaluates them together in the main update, see Settings::bBatchReevaluations
+// the requests are grouped per animation replacements, and each candidate's conditions are evaluated for all the requesting clips in a row instead of walking the candidates once per clip
+// the clips pick up their results in their next update, so they're a frame late. Activations and echoes still evaluate immediately
+class ReevaluationBatcher final
+{
+public:
+	static ReevaluationBatcher& GetSingleton()
+	{
+		static ReevaluationBatcher singleton;
+		return singleton;
+	}
+
+	// ordered so a loop takes over an interrupt check that's still waiting
+	enum class Reason : uint8_t
+	{
+		kInterrupt,
+		kLoop
+	};
+
+	struct Result
+	{
+		ReplacementAnimation* replacementAnimation;
+		Reason reason;
+		bool bEvaluated = true;  // false if the reference was gone by the time the request was evaluated, the clip keeps its current animation
+	};
+
+	void Submit(AnimationReplacements* a_replacements, RE::hkbClipGenerator* a_clipGenerator, RE::TESObjectREFR* a_refr, Reason a_reason);
+	[[nodiscard]] std::optional<Result> TakeResult(RE::hkbClipGenerator* a_clipGenerator);
+	void Cancel(RE::hkbClipGenerator* a_clipGenerator);  // called when the active clip is destroyed
+
+	void Update();  // called every frame from the main update
+
+private:
+	ReevaluationBatcher() = default;
+	ReevaluationBatcher(const ReevaluationBatcher&) = delete;
+	ReevaluationBatcher(ReevaluationBatcher&&) = delete;
+	~ReevaluationBatcher() = default;
+
+	ReevaluationBatcher& operator=(const ReevaluationBatcher&) = delete;
+	ReevaluationBatcher& operator=(ReevaluationBatcher&&) = delete;
+
+	// the clip generator is referenced so it stays alive until the request is evaluated, the reference is resolved from its handle when it's evaluated
+	struct Request
+	{
+		RE::hkRefPtr<RE::hkbClipGenerator> clipGenerator;
+		RE::ObjectRefHandle refrHandle;
+		Reason reason;
+		uint32_t id;
+	};
+
+	[[nodiscard]] bool IsPending(const Request& a_request) const;  // expects the lock to be held
+
+	mutable ExclusiveLock _lock{ "ReevaluationBatcher::_lock" };
+	std::unordered_map<AnimationReplacements*, std::vector<Request>> _requests;
+	std::unordered_map<RE::hkbClipGenerator*, uint32_t> _pendingClips;  // the latest request of each clip that wasn't cancelled, results for anything else are dropped
+	std::unordered_map<RE::hkbClipGenerator*, Result> _results;
+	uint32_t _nextRequestId = 0;
+	std::atomic_bool _bHasWork = false;
+};
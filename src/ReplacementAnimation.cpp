@@ -2,6 +2,8 @@
 
 #include "ActiveClip.h"
 #include "AnimationFileHashCache.h"
+#include "EvaluationProfiler.h"
+#include "MemoryReport.h"
 #include "Parsing.h"
 #include "ReplacerMods.h"
 #include "Settings.h"
@@ -191,6 +193,64 @@ SubMod* ReplacementAnimation::GetParentSubMod() const
 	return _parentSubMod;
 }
 
+void ReplacementAnimation::SetPriority(int32_t a_priority)
+{
+	if (_priority != a_priority) {
+		_priority = a_priority;
+		if (_parentReplacements) {
+			_parentReplacements->OnPriorityChanged(this);
+		}
+	}
+}
+
+void ReplacementAnimation::SetDisabled(bool a_bDisable)
+{
+	const bool bWasDisabled = IsDisabled();
+	_bDisabled = a_bDisable;
+	if (_parentReplacements && IsDisabled() != bWasDisabled) {
+		_parentReplacements->OnDisabledChanged();
+	}
+}
+
+void ReplacementAnimation::SetDisabledByParent(bool a_bDisable)
+{
+	const bool bWasDisabled = IsDisabled();
+	_bDisabledByParent = a_bDisable;
+	if (_parentReplacements && IsDisabled() != bWasDisabled) {
+		_parentReplacements->OnDisabledChanged();
+	}
+}
+
+void ReplacementAnimation::SetInterruptible(bool a_bEnable)
+{
+	if (_bInterruptible != a_bEnable) {
+		_bInterruptible = a_bEnable;
+		if (_parentReplacements) {
+			_parentReplacements->OnInterruptibleChanged(a_bEnable);
+		}
+	}
+}
+
+void ReplacementAnimation::SetReplaceOnEcho(bool a_bEnable)
+{
+	if (_bReplaceOnEcho != a_bEnable) {
+		_bReplaceOnEcho = a_bEnable;
+		if (_parentReplacements) {
+			_parentReplacements->OnReplaceOnEchoChanged(a_bEnable);
+		}
+	}
+}
+
+void ReplacementAnimation::SetKeepRandomResultsOnLoop(bool a_bEnable)
+{
+	if (_bKeepRandomResultsOnLoop != a_bEnable) {
+		_bKeepRandomResultsOnLoop = a_bEnable;
+		if (_parentReplacements) {
+			_parentReplacements->OnKeepRandomResultsOnLoopChanged(a_bEnable);
+		}
+	}
+}
+
 void ReplacementAnimation::MarkAsSynchronizedAnimation(bool a_bSynchronized)
 {
 	_bSynchronized = a_bSynchronized;
@@ -287,7 +347,8 @@ bool ReplacementAnimation::EvaluateConditions(RE::TESObjectREFR* a_refr, RE::hkb
 		return true;
 	}
 
-	return _conditionSet->EvaluateAll(a_refr, a_clipGenerator);
+	const EvaluationProfiler::Scope profilerScope(_parentSubMod);
+	return profilerScope.Finish(_conditionSet->EvaluateAll(a_refr, a_clipGenerator));
 }
 
 bool ReplacementAnimation::EvaluateSynchronizedConditions(RE::TESObjectREFR* a_sourceRefr, RE::TESObjectREFR* a_targetRefr, RE::hkbClipGenerator* a_clipGenerator) const
@@ -296,8 +357,26 @@ bool ReplacementAnimation::EvaluateSynchronizedConditions(RE::TESObjectREFR* a_s
 		return false;
 	}
 
+	const EvaluationProfiler::Scope profilerScope(_parentSubMod);
+
 	const bool bPassingSourceConditions = _conditionSet->IsEmpty() || _conditionSet->EvaluateAll(a_sourceRefr, a_clipGenerator);
 	const bool bPassingTargetConditions = !_synchronizedConditionSet || _synchronizedConditionSet->IsEmpty() || _synchronizedConditionSet->EvaluateAll(a_targetRefr, a_clipGenerator);
 
-	return bPassingSourceConditions && bPassingTargetConditions;
+	return profilerScope.Finish(bPassingSourceConditions && bPassingTargetConditions);
+}
+
+void ReplacementAnimation::AccumulateMemoryUsage(MemoryReport::Usage& a_usage) const
+{
+	a_usage.replacementAnimations += sizeof(ReplacementAnimation);
+	a_usage.strings += MemoryReport::GetStringSize(_path) + MemoryReport::GetStringSize(_projectName);
+
+	if (HasVariants()) {
+		const auto& variants = std::get<Variants>(_index);
+
+		ReadLocker locker(variants._lock);
+		a_usage.replacementAnimations += MemoryReport::GetVectorSize(variants._variants) + MemoryReport::GetVectorSize(variants._activeVariants) + MemoryReport::GetVectorSize(variants._cumulativeWeights);
+		for (const auto& variant : variants._variants) {
+			a_usage.strings += MemoryReport::GetStringSize(variant.GetFilename());
+		}
+	}
 }
@@ -73,7 +73,7 @@ public:
 		ReplacementAnimation* _parentReplacementAnimation = nullptr;
 		std::vector<Variant> _variants;
 
-		mutable SharedLock _lock;
+		mutable SharedLock _lock{ "ReplacementAnimation::Variants::_lock" };
 		std::vector<Variant*> _activeVariants;
 		float _totalWeight = 0.f;
 		std::vector<float> _cumulativeWeights;
@@ -100,15 +100,15 @@ public:
 	bool GetReplaceOnEcho() const { return _bReplaceOnEcho; }
 	bool GetKeepRandomResultsOnLoop() const { return _bKeepRandomResultsOnLoop; }
 	bool GetShareRandomResults() const { return _bShareRandomResults; }
-	void SetPriority(int32_t a_priority) { _priority = a_priority; }
-	void SetDisabled(bool a_bDisable) { _bDisabled = a_bDisable; }
-	void SetDisabledByParent(bool a_bDisable) { _bDisabledByParent = a_bDisable; }
+	void SetPriority(int32_t a_priority);
+	void SetDisabled(bool a_bDisable);
+	void SetDisabledByParent(bool a_bDisable);
 	void SetIgnoreDontConvertAnnotationsToTriggersFlag(bool a_enable) { _bIgnoreDontConvertAnnotationsToTriggersFlag = a_enable; }
 	void SetTriggersFromAnnotationsOnly(bool a_enable) { _bTriggersFromAnnotationsOnly = a_enable; }
-	void SetInterruptible(bool a_bEnable) { _bInterruptible = a_bEnable; }
+	void SetInterruptible(bool a_bEnable);
 	void SetReplaceOnLoop(bool a_bEnable) { _bReplaceOnLoop = a_bEnable; }
-	void SetReplaceOnEcho(bool a_bEnable) { _bReplaceOnEcho = a_bEnable; }
-	void SetKeepRandomResultsOnLoop(bool a_bEnable) { _bKeepRandomResultsOnLoop = a_bEnable; }
+	void SetReplaceOnEcho(bool a_bEnable);
+	void SetKeepRandomResultsOnLoop(bool a_bEnable);
 	void SetShareRandomResults(bool a_bEnable) { _bShareRandomResults = a_bEnable; }
 	std::string_view GetAnimPath() const { return _path; }
 	std::string_view GetProjectName() const { return _projectName; }
@@ -129,6 +129,8 @@ public:
 	bool EvaluateConditions(RE::TESObjectREFR* a_refr, RE::hkbClipGenerator* a_clipGenerator) const;
 	bool EvaluateSynchronizedConditions(RE::TESObjectREFR* a_sourceRefr, RE::TESObjectREFR* a_targetRefr, RE::hkbClipGenerator* a_clipGenerator) const;
 
+	void AccumulateMemoryUsage(MemoryReport::Usage& a_usage) const;
+
 protected:
 	std::variant<uint16_t, Variants> _index;
 	uint16_t _originalIndex;
@@ -151,5 +153,8 @@ protected:
 	friend class SubMod;
 	SubMod* _parentSubMod = nullptr;
 
+	friend class AnimationReplacements;
+	class AnimationReplacements* _parentReplacements = nullptr;
+
 	bool _bDisabledByParent = false;
 };
@@ -0,0 +1,389 @@
+#include "ReplacementPlanCache.h"
+
+#include <binary_io/binary_io.hpp>
+
+#include <cryptopp/sha.h>
+
+#include "OpenAnimationReplacer.h"
+#include "Settings.h"
+#include "StartupTrace.h"
+#include "Utils.h"
+
+namespace
+{
+	void UpdateDigest(CryptoPP::SHA256& a_sha, std::string_view a_str)
+	{
+		// prefix the length so consecutive strings can't run into each other
+		const auto length = static_cast<uint32_t>(a_str.length());
+		a_sha.Update(reinterpret_cast<const CryptoPP::byte*>(&length), sizeof(length));
+		a_sha.Update(reinterpret_cast<const CryptoPP::byte*>(a_str.data()), a_str.length());
+	}
+
+	std::string FinalDigest(CryptoPP::SHA256& a_sha)
+	{
+		CryptoPP::byte digest[CryptoPP::SHA256::DIGESTSIZE];
+		a_sha.Final(digest);
+		return std::string(reinterpret_cast<char*>(digest), CryptoPP::SHA256::DIGESTSIZE);
+	}
+}
+
+void ReplacementPlanCache::UpdateModSetDigest()
+{
+	StartupTrace::Scope traceScope("startup", "UpdateModSetDigest"sv);
+
+	struct SubModFiles
+	{
+		std::string path;
+		std::vector<std::string> files;
+	};
+
+	std::vector<SubModFiles> subMods;
+
+	OpenAnimationReplacer::GetSingleton().ForEachReplacerMod([&](ReplacerMod* a_replacerMod) {
+		a_replacerMod->ForEachSubMod([&](SubMod* a_subMod) {
+			auto& entry = subMods.emplace_back(std::string(a_subMod->GetPath()));
+			a_subMod->ForEachReplacementAnimationFile([&](const ReplacementAnimationFile& a_file) {
+				std::string file = a_file.fullPath;
+				if (a_file.hash) {
+					file += '|';
+					file += *a_file.hash;
+				}
+				if (a_file.variants) {
+					for (const auto& variant : *a_file.variants) {
+						file += '|';
+						file += variant.fullPath;
+						if (variant.hash) {
+							file += '|';
+							file += *variant.hash;
+						}
+					}
+				}
+				entry.files.emplace_back(std::move(file));
+			});
+			std::ranges::sort(entry.files);
+			return RE::BSVisit::BSVisitControl::kContinue;
+		});
+	});
+
+	std::ranges::sort(subMods, [](const SubModFiles& a_lhs, const SubModFiles& a_rhs) { return a_lhs.path < a_rhs.path; });
+
+	CryptoPP::SHA256 sha;
+	sha.Update(reinterpret_cast<const CryptoPP::byte*>(&kVersion), sizeof(kVersion));
+	const bool bFilterOutDuplicateAnimations = Settings::bFilterOutDuplicateAnimations;
+	sha.Update(reinterpret_cast<const CryptoPP::byte*>(&bFilterOutDuplicateAnimations), sizeof(bFilterOutDuplicateAnimations));
+	sha.Update(reinterpret_cast<const CryptoPP::byte*>(&Settings::uAnimationLimit), sizeof(Settings::uAnimationLimit));
+
+	for (const auto& subMod : subMods) {
+		UpdateDigest(sha, subMod.path);
+		for (const auto& file : subMod.files) {
+			UpdateDigest(sha, file);
+		}
+	}
+
+	WriteLocker locker(_dataLock);
+	_modSetDigest = subMods.empty() ? std::string() : FinalDigest(sha);
+}
+
+std::string ReplacementPlanCache::GetProjectKey(const RE::hkbCharacterStringData* a_stringData) const
+{
+	CryptoPP::SHA256 sha;
+
+	{
+		ReadLocker locker(_dataLock);
+		if (_modSetDigest.empty()) {
+			return {};
+		}
+
+		UpdateDigest(sha, _modSetDigest);
+	}
+
+	for (const auto& animationName : a_stringData->animationNames) {
+		UpdateDigest(sha, animationName.data());
+	}
+
+	return FinalDigest(sha);
+}
+
+std::optional<ReplacementPlan> ReplacementPlanCache::LoadPlan(std::string_view a_projectName, std::string_view a_key) const
+{
+	StartupTrace::Scope traceScope("project", "LoadReplacementPlan"sv);
+
+	const auto path = GetCachePath(a_projectName, ".bin"sv);
+	if (a_key.empty() || !std::filesystem::is_regular_file(path)) {
+		return std::nullopt;
+	}
+
+	try {
+		binary_io::file_istream in{ path };
+		const auto readString = [&](std::string& a_dst) {
+			uint16_t len;
+			in.read(len);
+			a_dst.resize(len);
+			in.read_bytes(std::as_writable_bytes(std::span{ a_dst.data(), a_dst.size() }));
+		};
+
+		uint32_t version;
+		in.read(version);
+		if (version != kVersion) {
+			return std::nullopt;
+		}
+
+		std::string key;
+		readString(key);
+		if (key != a_key) {
+			return std::nullopt;
+		}
+
+		ReplacementPlan plan;
+		in.read(plan.filteredDuplicates);
+
+		uint32_t numAppendedNames;
+		in.read(numAppendedNames);
+		plan.appendedAnimationNames.resize(numAppendedNames);
+		for (auto& name : plan.appendedAnimationNames) {
+			readString(name);
+		}
+
+		uint32_t numAnimationIndices;
+		in.read(numAnimationIndices);
+		plan.animationIndices.resize(numAnimationIndices);
+		for (auto& [animationPath, index] : plan.animationIndices) {
+			readString(animationPath);
+			in.read(index);
+		}
+
+		uint32_t numMatches;
+		in.read(numMatches);
+		plan.matches.resize(numMatches);
+		for (auto& match : plan.matches) {
+			in.read(match.originalIndex);
+			readString(match.originalAnimationPath);
+			uint16_t numSubMods;
+			in.read(numSubMods);
+			match.subModPaths.resize(numSubMods);
+			for (auto& subModPath : match.subModPaths) {
+				readString(subModPath);
+			}
+		}
+
+		return plan;
+	} catch (const std::exception& e) {
+		logger::warn("Failed to read the cached replacement plan {}: {}", path.string(), e.what());
+	}
+
+	return std::nullopt;
+}
+
+void ReplacementPlanCache::SavePlan(std::string_view a_projectName, std::string_view a_key, const ReplacementPlan& a_plan) const
+{
+	StartupTrace::Scope traceScope("project", "SaveReplacementPlan"sv);
+
+	if (a_key.empty()) {
+		return;
+	}
+
+	const auto path = GetCachePath(a_projectName, ".bin"sv);
+
+	try {
+		std::filesystem::create_directories(path.parent_path());
+
+		binary_io::file_ostream out{ path };
+		const auto writeString = [&](const std::string_view a_str) {
+			out.write(static_cast<uint16_t>(a_str.length()));
+			out.write_bytes(std::as_bytes(std::span{ a_str.data(), a_str.length() }));
+		};
+
+		out.write(kVersion);
+		writeString(a_key);
+		out.write(a_plan.filteredDuplicates);
+
+		out.write(static_cast<uint32_t>(a_plan.appendedAnimationNames.size()));
+		for (const auto& name : a_plan.appendedAnimationNames) {
+			writeString(name);
+		}
+
+		out.write(static_cast<uint32_t>(a_plan.animationIndices.size()));
+		for (const auto& [animationPath, index] : a_plan.animationIndices) {
+			writeString(animationPath);
+			out.write(index);
+		}
+
+		out.write(static_cast<uint32_t>(a_plan.matches.size()));
+		for (const auto& match : a_plan.matches) {
+			out.write(match.originalIndex);
+			writeString(match.originalAnimationPath);
+			out.write(static_cast<uint16_t>(match.subModPaths.size()));
+			for (const auto& subModPath : match.subModPaths) {
+				writeString(subModPath);
+			}
+		}
+	} catch (const std::exception& e) {
+		logger::warn("Failed to write the replacement plan cache {}: {}", path.string(), e.what());
+	}
+}
+
+std::string ReplacementPlanCache::GetSynchronizedClipsKey(std::string_view a_planKey, const std::filesystem::path& a_projectPath) const
+{
+	CryptoPP::SHA256 sha;
+	UpdateDigest(sha, a_planKey);
+
+	// a behavior from an archive can change without the animation names changing, e.g. a mod updating its archive or the load order changing which archive wins
+	UpdateDigest(sha, GetArchiveDigest());
+
+	const auto behaviorsPath = a_projectPath.parent_path() / "behaviors";
+	std::vector<std::string> behaviorFiles;
+
+	std::error_code ec;
+	for (const auto& entry : std::filesystem::directory_iterator(behaviorsPath, ec)) {
+		std::error_code entryEc;
+		if (!entry.is_regular_file(entryEc)) {
+			continue;
+		}
+
+		const auto fileSize = entry.file_size(entryEc);
+		const auto lastWriteTime = entry.last_write_time(entryEc).time_since_epoch().count();
+		behaviorFiles.emplace_back(std::format("{}|{}|{}", entry.path().filename().string(), fileSize, lastWriteTime));
+	}
+
+	std::ranges::sort(behaviorFiles);
+	for (const auto& behaviorFile : behaviorFiles) {
+		UpdateDigest(sha, behaviorFile);
+	}
+
+	return FinalDigest(sha);
+}
+
+std::string ReplacementPlanCache::GetArchiveDigest() const
+{
+	{
+		ReadLocker locker(_dataLock);
+		if (!_archiveDigest.empty()) {
+			return _archiveDigest;
+		}
+	}
+
+	CryptoPP::SHA256 sha;
+
+	// the archives are loaded in plugin order, plus the ones from the ini
+	bool bHasLoadOrder = false;
+	if (const auto dataHandler = RE::TESDataHandler::GetSingleton()) {
+		for (const auto file : dataHandler->files) {
+			if (file) {
+				UpdateDigest(sha, file->GetFilename());
+				bHasLoadOrder = true;
+			}
+		}
+	}
+
+	// every archive in the data directory rather than only the loaded ones, an unused archive changing only costs a rebuild
+	std::vector<std::string> archives;
+
+	std::error_code ec;
+	for (const auto& entry : std::filesystem::directory_iterator("data", ec)) {
+		std::error_code entryEc;
+		if (!entry.is_regular_file(entryEc) || !Utils::CompareStringsIgnoreCase(entry.path().extension().string(), ".bsa"sv)) {
+			continue;
+		}
+
+		const auto fileSize = entry.file_size(entryEc);
+		const auto lastWriteTime = entry.last_write_time(entryEc).time_since_epoch().count();
+		archives.emplace_back(std::format("{}|{}|{}", entry.path().filename().string(), fileSize, lastWriteTime));
+	}
+
+	std::ranges::sort(archives);
+	for (const auto& archive : archives) {
+		UpdateDigest(sha, archive);
+	}
+
+	auto digest = FinalDigest(sha);
+
+	// a project created before the plugins are loaded doesn't get to keep the digest for the rest of the session
+	if (bHasLoadOrder) {
+		WriteLocker locker(_dataLock);
+		_archiveDigest = digest;
+	}
+
+	return digest;
+}
+
+std::optional<std::vector<uint16_t>> ReplacementPlanCache::LoadSynchronizedClipIndices(std::string_view a_projectName, std::string_view a_key) const
+{
+	const auto path = GetCachePath(a_projectName, "_synchronizedClips.bin"sv);
+	if (a_key.empty() || !std::filesystem::is_regular_file(path)) {
+		return std::nullopt;
+	}
+
+	try {
+		binary_io::file_istream in{ path };
+
+		uint32_t version;
+		in.read(version);
+		if (version != kVersion) {
+			return std::nullopt;
+		}
+
+		uint16_t keyLength;
+		in.read(keyLength);
+		std::string key(keyLength, '\0');
+		in.read_bytes(std::as_writable_bytes(std::span{ key.data(), key.size() }));
+		if (key != a_key) {
+			return std::nullopt;
+		}
+
+		uint32_t numIndices;
+		in.read(numIndices);
+		std::vector<uint16_t> indices(numIndices);
+		for (auto& index : indices) {
+			in.read(index);
+		}
+
+		return indices;
+	} catch (const std::exception& e) {
+		logger::warn("Failed to read the cached synchronized clips {}: {}", path.string(), e.what());
+	}
+
+	return std::nullopt;
+}
+
+void ReplacementPlanCache::SaveSynchronizedClipIndices(std::string_view a_projectName, std::string_view a_key, std::span<const uint16_t> a_indices) const
+{
+	if (a_key.empty()) {
+		return;
+	}
+
+	const auto path = GetCachePath(a_projectName, "_synchronizedClips.bin"sv);
+
+	try {
+		std::filesystem::create_directories(path.parent_path());
+
+		binary_io::file_ostream out{ path };
+		out.write(kVersion);
+		out.write(static_cast<uint16_t>(a_key.length()));
+		out.write_bytes(std::as_bytes(std::span{ a_key.data(), a_key.length() }));
+
+		out.write(static_cast<uint32_t>(a_indices.size()));
+		for (const auto index : a_indices) {
+			out.write(index);
+		}
+	} catch (const std::exception& e) {
+		logger::warn("Failed to write the synchronized clips cache {}: {}", path.string(), e.what());
+	}
+}
+
+void ReplacementPlanCache::DeleteCache() const
+{
+	std::error_code ec;
+	std::filesystem::remove_all(Settings::replacementPlanCacheDirectory, ec);
+	if (ec) {
+		logger::warn("Failed to delete the replacement plan cache: {}", ec.message());
+	}
+}
+
+std::filesystem::path ReplacementPlanCache::GetCachePath(std::string_view a_projectName, std::string_view a_suffix)
+{
+	std::string fileName(a_projectName);
+	std::ranges::replace_if(fileName, [](const char a_char) { return std::string_view("\\/:*?\"<>|").find(a_char) != std::string_view::npos; }, '_');
+	fileName += a_suffix;
+
+	return std::filesystem::path(Settings::replacementPlanCacheDirectory) / fileName;
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+// the result of matching a behavior project's animations against the replacer mods, see OpenAnimationReplacer::CreateReplacementAnimations
+struct ReplacementPlan
+{
+	struct Match
+	{
+		uint16_t originalIndex;
+		std::string originalAnimationPath;
+		std::vector<std::string> subModPaths;  // sorted by path, same order as the submods were added in
+	};
+
+	std::vector<std::string> appendedAnimationNames;                 // in the order they were appended to the project's animation names
+	std::vector<std::pair<std::string, uint16_t>> animationIndices;  // the index every replacement animation file got, including duplicates mapped to another file's index
+	std::vector<Match> matches;                                      // in original index order
+	uint32_t filteredDuplicates = 0;
+};
+
+// saves the replacement plan of each behavior project to disk, so the next session can skip matching when nothing changed, see Settings::bCacheReplacementPlans
+// a plan is keyed by a digest of the project's original animation names and a digest of all the replacer submods' animation files
+// the synchronized clips found in the project's behavior graph are saved separately, as they're only known after the clips are loaded. Their key adds the loose behavior files' sizes and write times,
+// and the plugin load order and the archives' sizes and write times, as the behavior files can also come from archives
+class ReplacementPlanCache final
+{
+public:
+	static ReplacementPlanCache& GetSingleton()
+	{
+		static ReplacementPlanCache singleton;
+		return singleton;
+	}
+
+	void UpdateModSetDigest();  // called after the replacer mods are created
+
+	[[nodiscard]] std::string GetProjectKey(const RE::hkbCharacterStringData* a_stringData) const;
+	[[nodiscard]] std::optional<ReplacementPlan> LoadPlan(std::string_view a_projectName, std::string_view a_key) const;
+	void SavePlan(std::string_view a_projectName, std::string_view a_key, const ReplacementPlan& a_plan) const;
+
+	[[nodiscard]] std::string GetSynchronizedClipsKey(std::string_view a_planKey, const std::filesystem::path& a_projectPath) const;
+	[[nodiscard]] std::optional<std::vector<uint16_t>> LoadSynchronizedClipIndices(std::string_view a_projectName, std::string_view a_key) const;
+	void SaveSynchronizedClipIndices(std::string_view a_projectName, std::string_view a_key, std::span<const uint16_t> a_indices) const;
+
+	void DeleteCache() const;
+
+private:
+	ReplacementPlanCache() = default;
+	ReplacementPlanCache(const ReplacementPlanCache&) = delete;
+	ReplacementPlanCache(ReplacementPlanCache&&) = delete;
+	~ReplacementPlanCache() = default;
+
+	ReplacementPlanCache& operator=(const ReplacementPlanCache&) = delete;
+	ReplacementPlanCache& operator=(ReplacementPlanCache&&) = delete;
+
+	static constexpr uint32_t kVersion = 1;
+
+	[[nodiscard]] static std::filesystem::path GetCachePath(std::string_view a_projectName, std::string_view a_suffix);
+	[[nodiscard]] std::string GetArchiveDigest() const;
+
+	mutable SharedLock _dataLock{ "ReplacementPlanCache::_dataLock" };
+	std::string _modSetDigest;
+	mutable std::string _archiveDigest;  // computed on first use after the plugins are loaded
+};
@@ -0,0 +1,58 @@
+#pragma once
+
+// the choice of a replacement animation from the candidates of an AnimationReplacements. Doesn't depend on any game headers so it can be shared with tools/ConditionBenchmark.cpp
+// the candidates are in priority order, the first one without conditions or whose conditions pass wins
+
+#include <span>
+#include <vector>
+
+namespace ReplacementSelection
+{
+	// a_isUnconditional(candidate) is asked every time since conditions can be edited in place, a_onCandidateTested(candidate) is called for every candidate that's looked at
+	template <class Candidate, class IsUnconditional, class Evaluate, class OnCandidateTested>
+	[[nodiscard]] const Candidate* SelectCandidate(std::span<const Candidate> a_candidates, IsUnconditional&& a_isUnconditional, Evaluate&& a_evaluate, OnCandidateTested&& a_onCandidateTested)
+	{
+		for (const auto& candidate : a_candidates) {
+			a_onCandidateTested(candidate);
+
+			if (a_isUnconditional(candidate) || a_evaluate(candidate)) {
+				return &candidate;
+			}
+		}
+
+		return nullptr;
+	}
+
+	// the same for several requests at once, each candidate is evaluated for all the requests it hasn't been decided for yet before moving on to the next one
+	// a_evaluate(candidate, request) evaluates the candidate's conditions for the request, a_select(request, candidate) is called once for every request that gets a candidate
+	template <class Candidate, class Request, class IsUnconditional, class Evaluate, class Select>
+	void SelectCandidatesForBatch(std::span<const Candidate> a_candidates, std::span<Request> a_requests, IsUnconditional&& a_isUnconditional, Evaluate&& a_evaluate, Select&& a_select)
+	{
+		std::vector<Request*> undecided;
+		undecided.reserve(a_requests.size());
+		for (auto& request : a_requests) {
+			undecided.push_back(&request);
+		}
+
+		for (const auto& candidate : a_candidates) {
+			if (undecided.empty()) {
+				break;
+			}
+
+			if (a_isUnconditional(candidate)) {
+				for (const auto request : undecided) {
+					a_select(*request, candidate);
+				}
+				break;
+			}
+
+			std::erase_if(undecided, [&](Request* a_request) {
+				if (a_evaluate(candidate, *a_request)) {
+					a_select(*a_request, candidate);
+					return true;
+				}
+				return false;
+			});
+		}
+	}
+}
@@ -2,9 +2,16 @@
 
 #include <ranges>
 
+#include "AnimationContentRegistry.h"
+#include "AnimationPreloader.h"
+#include "AnimationTrace.h"
 #include "DetectedProblems.h"
+#include "EvaluationProfiler.h"
+#include "MemoryReport.h"
 #include "Offsets.h"
 #include "OpenAnimationReplacer.h"
+#include "ReplacementPlanCache.h"
+#include "ReplacementSelection.h"
 #include "Settings.h"
 
 bool SubMod::AddReplacementAnimation(std::string_view a_animPath, uint16_t a_originalIndex, ReplacerProjectData* a_replacerProjectData, RE::hkbCharacterStringData* a_stringData)
@@ -32,13 +39,19 @@ bool SubMod::AddReplacementAnimation(std::string_view a_animPath, uint16_t a_ori
 			bAdded = true;
 			newReplacementAnimation->_parentSubMod = this;
 
+			// the new animation isn't in any animation replacements yet, so this doesn't touch anything another project could be using
+			ApplySettings(newReplacementAnimation.get());
+
 			{
 				WriteLocker locker(_dataLock);
 				_replacementAnimations.emplace_back(newReplacementAnimation.get());
 
-				// sort replacement animations by path
+				// sort replacement animations by path, projects add theirs concurrently so the project breaks ties
 				std::ranges::sort(_replacementAnimations, [](const auto& a_lhs, const auto& a_rhs) {
-					return a_lhs->_path < a_rhs->_path;
+					if (a_lhs->_path != a_rhs->_path) {
+						return a_lhs->_path < a_rhs->_path;
+					}
+					return a_lhs->GetProjectName() < a_rhs->GetProjectName();
 				});
 			}
 
@@ -127,33 +140,36 @@ void SubMod::ResetAnimations()
 
 void SubMod::UpdateAnimations() const
 {
+	// changing the priority or flags of an anim updates the animation replacements it's in, so only the lists this submod is part of are touched
+	// the setters lock those lists, so don't hold our own lock while calling them
+	std::vector<ReplacementAnimation*> replacementAnimations;
+	{
+		ReadLocker locker(_dataLock);
+		replacementAnimations = _replacementAnimations;
+	}
+
 	// Update stuff in each anim
-	for (const auto& anim : _replacementAnimations) {
-		anim->SetPriority(_priority);
-		anim->SetDisabledByParent(_bDisabled);
-		anim->SetIgnoreDontConvertAnnotationsToTriggersFlag(_bIgnoreDontConvertAnnotationsToTriggersFlag);
-		anim->SetTriggersFromAnnotationsOnly(_bTriggersFromAnnotationsOnly);
-		anim->SetInterruptible(_bInterruptible);
-		anim->SetReplaceOnLoop(_bReplaceOnLoop);
-		anim->SetReplaceOnEcho(_bReplaceOnEcho);
-		anim->SetKeepRandomResultsOnLoop(_bKeepRandomResultsOnLoop);
-		anim->SetShareRandomResults(_bShareRandomResults);
-		anim->UpdateVariantCache();
+	for (const auto& anim : replacementAnimations) {
+		ApplySettings(anim);
 	}
 
-	// Update stuff in each anim replacements struct
 	if (_parentMod) {
 		_parentMod->SortSubMods();
 	}
+}
 
-	ForEachReplacerProject([](const auto a_replacerProject) {
-		a_replacerProject->ForEach([](auto a_animReplacements) {
-			a_animReplacements->TestInterruptible();
-			a_animReplacements->TestReplaceOnEcho();
-			a_animReplacements->TestKeepRandomResultsOnLoop();
-			a_animReplacements->SortByPriority();
-		});
-	});
+void SubMod::ApplySettings(ReplacementAnimation* a_replacementAnimation) const
+{
+	a_replacementAnimation->SetPriority(_priority);
+	a_replacementAnimation->SetDisabledByParent(_bDisabled);
+	a_replacementAnimation->SetIgnoreDontConvertAnnotationsToTriggersFlag(_bIgnoreDontConvertAnnotationsToTriggersFlag);
+	a_replacementAnimation->SetTriggersFromAnnotationsOnly(_bTriggersFromAnnotationsOnly);
+	a_replacementAnimation->SetInterruptible(_bInterruptible);
+	a_replacementAnimation->SetReplaceOnLoop(_bReplaceOnLoop);
+	a_replacementAnimation->SetReplaceOnEcho(_bReplaceOnEcho);
+	a_replacementAnimation->SetKeepRandomResultsOnLoop(_bKeepRandomResultsOnLoop);
+	a_replacementAnimation->SetShareRandomResults(_bShareRandomResults);
+	a_replacementAnimation->UpdateVariantCache();
 }
 
 bool SubMod::DoesUserConfigExist() const
@@ -624,6 +640,57 @@ void SubMod::ClearSharedRandom(const RE::hkbBehaviorGraph* a_behaviorGraph)
 	_sharedRandomFloats.erase(a_behaviorGraph);
 }
 
+void SubMod::AccumulateMemoryUsage(MemoryReport::Usage& a_usage) const
+{
+	using namespace MemoryReport;
+
+	a_usage.other += sizeof(SubMod);
+	a_usage.strings += GetStringSize(_name) + GetStringSize(_description) + GetStringSize(_path) + GetStringSize(_overrideAnimationsFolder) + GetStringSize(_requiredProjectName);
+
+	a_usage.other += GetVectorSize(_replacementAnimDatas);
+	for (const auto& replacementAnimData : _replacementAnimDatas) {
+		a_usage.strings += GetStringSize(replacementAnimData.projectName) + GetStringSize(replacementAnimData.path);
+		if (replacementAnimData.variants) {
+			a_usage.other += GetVectorSize(*replacementAnimData.variants);
+			for (const auto& variant : *replacementAnimData.variants) {
+				a_usage.strings += GetStringSize(variant.filename);
+			}
+		}
+	}
+
+	a_usage.other += GetHashMapSize(_replacementAnimationFiles);
+	for (const auto& [path, animationFile] : _replacementAnimationFiles) {
+		a_usage.strings += GetPathSize(path) + GetStringSize(animationFile.fullPath) + (animationFile.hash ? GetStringSize(*animationFile.hash) : 0);
+		if (animationFile.variants) {
+			a_usage.other += GetVectorSize(*animationFile.variants);
+			for (const auto& variant : *animationFile.variants) {
+				a_usage.strings += GetStringSize(variant.fullPath) + (variant.hash ? GetStringSize(*variant.hash) : 0);
+			}
+		}
+	}
+
+	_conditionSet->AccumulateMemoryUsage(a_usage);
+	if (_synchronizedConditionSet) {
+		_synchronizedConditionSet->AccumulateMemoryUsage(a_usage);
+	}
+
+	{
+		ReadLocker locker(_dataLock);
+
+		a_usage.other += GetVectorSize(_replacerProjects) + GetVectorSize(_replacementAnimations);
+		for (const auto replacementAnimation : _replacementAnimations) {
+			replacementAnimation->AccumulateMemoryUsage(a_usage);
+		}
+	}
+
+	{
+		ReadLocker locker(_randomLock);
+
+		// the per-graph random values are short-lived, only count the map itself
+		a_usage.other += GetHashMapSize(_sharedRandomFloats);
+	}
+}
+
 float SubMod::SharedRandomFloats::GetRandomFloat(ActiveClip* a_activeClip, const Conditions::IRandomConditionComponent* a_randomComponent)
 {
 	AddActiveClip(a_activeClip);
@@ -803,118 +870,198 @@ void ReplacerMod::SortSubMods()
 	});
 }
 
+void ReplacerMod::AccumulateMemoryUsage(MemoryReport::Usage& a_usage) const
+{
+	using namespace MemoryReport;
+
+	a_usage.other += sizeof(ReplacerMod);
+	a_usage.strings += GetStringSize(_name) + GetStringSize(_author) + GetStringSize(_description) + GetStringSize(_path);
+
+	ReadLocker locker(_dataLock);
+	a_usage.other += GetVectorSize(_subMods);
+}
+
 ReplacementAnimation* AnimationReplacements::EvaluateConditionsAndGetReplacementAnimation(RE::TESObjectREFR* a_refr, RE::hkbClipGenerator* a_clipGenerator) const
 {
 	ReadLocker locker(_lock);
 
-	if (!_replacements.empty()) {
-		for (auto& replacementAnimation : _replacements) {
-			if (replacementAnimation->EvaluateConditions(a_refr, a_clipGenerator)) {
-				return replacementAnimation.get();
-			}
-		}
-	}
+	AnimationTrace::EvaluationScope traceScope;
 
-	return nullptr;
+	const auto candidate = ReplacementSelection::SelectCandidate(
+		std::span(_candidates),
+		[](const Candidate& a_candidate) { return a_candidate.conditionSet->IsEmpty(); },
+		[&](const Candidate& a_candidate) {
+			const EvaluationProfiler::Scope profilerScope(a_candidate.parentSubMod);
+			return profilerScope.Finish(a_candidate.conditionSet->EvaluateAll(a_refr, a_clipGenerator));
+		},
+		[&](const Candidate& a_candidate) { traceScope.OnCandidateTested(a_candidate.replacementAnimation, a_candidate.conditionSet); });
+
+	return candidate ? candidate->replacementAnimation : nullptr;
 }
 
 ReplacementAnimation* AnimationReplacements::EvaluateSynchronizedConditionsAndGetReplacementAnimation(RE::TESObjectREFR* a_sourceRefr, RE::TESObjectREFR* a_targetRefr, RE::hkbClipGenerator* a_clipGenerator) const
 {
 	ReadLocker locker(_lock);
 
-	if (!_replacements.empty()) {
-		for (auto& replacementAnimation : _replacements) {
-			if (replacementAnimation->EvaluateSynchronizedConditions(a_sourceRefr, a_targetRefr, a_clipGenerator)) {
-				return replacementAnimation.get();
-			}
+	AnimationTrace::EvaluationScope traceScope;
+
+	for (const auto& candidate : _candidates) {
+		traceScope.OnCandidateTested(candidate.replacementAnimation, nullptr);
+		if (candidate.replacementAnimation->EvaluateSynchronizedConditions(a_sourceRefr, a_targetRefr, a_clipGenerator)) {
+			return candidate.replacementAnimation;
 		}
 	}
 
 	return nullptr;
 }
 
+void AnimationReplacements::EvaluateConditionsForBatch(std::span<BatchedEvaluation> a_evaluations) const
+{
+	ReadLocker locker(_lock);
+
+	ReplacementSelection::SelectCandidatesForBatch(
+		std::span(_candidates),
+		a_evaluations,
+		[](const Candidate& a_candidate) { return a_candidate.conditionSet->IsEmpty(); },
+		[](const Candidate& a_candidate, const BatchedEvaluation& a_evaluation) {
+			const EvaluationProfiler::Scope profilerScope(a_candidate.parentSubMod);
+			return profilerScope.Finish(a_candidate.conditionSet->EvaluateAll(a_evaluation.refr, a_evaluation.clipGenerator));
+		},
+		[](BatchedEvaluation& a_evaluation, const Candidate& a_candidate) { a_evaluation.result = a_candidate.replacementAnimation; });
+}
+
 void AnimationReplacements::AddReplacementAnimation(std::unique_ptr<ReplacementAnimation>& a_replacementAnimation)
 {
 	WriteLocker locker(_lock);
 
-	_replacements.emplace_back(std::move(a_replacementAnimation));
+	a_replacementAnimation->_parentReplacements = this;
+
+	if (a_replacementAnimation->GetInterruptible()) {
+		AdjustInterruptibleCount(true);
+	}
+	if (a_replacementAnimation->GetReplaceOnEcho()) {
+		AdjustReplaceOnEchoCount(true);
+	}
+	if (a_replacementAnimation->GetKeepRandomResultsOnLoop()) {
+		AdjustKeepRandomResultsOnLoopCount(true);
+	}
+
+	InsertByPriority(std::move(a_replacementAnimation));
+	RebuildCandidates();
 }
 
-void AnimationReplacements::SortByPriority()
+void AnimationReplacements::OnPriorityChanged(const ReplacementAnimation* a_replacementAnimation)
 {
 	WriteLocker locker(_lock);
 
-	if (!_replacements.empty()) {
-		std::ranges::sort(_replacements, [](const auto& a_lhs, const auto& a_rhs) {
-			return a_lhs->GetPriority() > a_rhs->GetPriority();
-		});
+	const auto it = std::ranges::find_if(_replacements, [&](const auto& a_replacement) { return a_replacement.get() == a_replacementAnimation; });
+	if (it == _replacements.end()) {
+		return;
 	}
+
+	// already in the right spot, e.g. the whole submod moved but kept its place relative to the others here
+	const int32_t priority = a_replacementAnimation->GetPriority();
+	const bool bOrderedBefore = it == _replacements.begin() || (*std::prev(it))->GetPriority() >= priority;
+	const bool bOrderedAfter = std::next(it) == _replacements.end() || (*std::next(it))->GetPriority() <= priority;
+	if (bOrderedBefore && bOrderedAfter) {
+		return;
+	}
+
+	auto replacementAnimation = std::move(*it);
+	_replacements.erase(it);
+	InsertByPriority(std::move(replacementAnimation));
+	RebuildCandidates();
 }
 
-void AnimationReplacements::ForEachReplacementAnimation(const std::function<void(ReplacementAnimation*)>& a_func, bool a_bReverse /*= false*/) const
+void AnimationReplacements::OnDisabledChanged()
 {
-	ReadLocker locker(_lock);
+	WriteLocker locker(_lock);
+	RebuildCandidates();
+}
 
-	if (a_bReverse) {
-		for (const auto& replacementAnimation : std::ranges::reverse_view(_replacements)) {
-			a_func(replacementAnimation.get());
-		}
-	} else {
-		for (auto& replacementAnimation : _replacements) {
-			a_func(replacementAnimation.get());
-		}
-	}
+void AnimationReplacements::OnInterruptibleChanged(bool a_bInterruptible)
+{
+	WriteLocker locker(_lock);
+	AdjustInterruptibleCount(a_bInterruptible);
 }
 
-void AnimationReplacements::TestInterruptible()
+void AnimationReplacements::OnReplaceOnEchoChanged(bool a_bReplaceOnEcho)
 {
-	ReadLocker locker(_lock);
+	WriteLocker locker(_lock);
+	AdjustReplaceOnEchoCount(a_bReplaceOnEcho);
+}
+
+void AnimationReplacements::OnKeepRandomResultsOnLoopChanged(bool a_bKeepRandomResultsOnLoop)
+{
+	WriteLocker locker(_lock);
+	AdjustKeepRandomResultsOnLoopCount(a_bKeepRandomResultsOnLoop);
+}
 
+void AnimationReplacements::InsertByPriority(std::unique_ptr<ReplacementAnimation>&& a_replacementAnimation)
+{
+	// after every replacement with the same or higher priority, so ties keep the order they were added in
+	const auto position = std::ranges::upper_bound(_replacements, a_replacementAnimation->GetPriority(), std::greater{}, [](const auto& a_replacement) {
+		return a_replacement->GetPriority();
+	});
+	_replacements.insert(position, std::move(a_replacementAnimation));
+}
+
+void AnimationReplacements::RebuildCandidates()
+{
+	_candidates.clear();
 	for (const auto& replacementAnimation : _replacements) {
-		if (replacementAnimation->GetInterruptible()) {
-			if (!_bOriginalInterruptible) {
-				logger::info("original animation {} will be treated as interruptible because there are interruptible potential replacements", _originalPath);
-			}
-			_bOriginalInterruptible = true;
-			return;
+		if (!replacementAnimation->IsDisabled()) {
+			_candidates.push_back({ replacementAnimation->GetConditionSet(), replacementAnimation->GetParentSubMod(), replacementAnimation.get() });
 		}
 	}
-
-	_bOriginalInterruptible = false;
 }
 
-void AnimationReplacements::TestReplaceOnEcho()
+void AnimationReplacements::AdjustInterruptibleCount(bool a_bIncrement)
 {
-	ReadLocker locker(_lock);
+	if (a_bIncrement) {
+		if (_interruptibleCount++ == 0) {
+			logger::info("original animation {} will be treated as interruptible because there are interruptible potential replacements", _originalPath);
+		}
+	} else if (_interruptibleCount > 0) {
+		--_interruptibleCount;
+	}
+}
 
-	for (const auto& replacementAnimation : _replacements) {
-		if (replacementAnimation->GetReplaceOnEcho()) {
-			if (!_bOriginalReplaceOnEcho) {
-				logger::info("original animation {} will replace on echo because there are potential replacements that do", _originalPath);
-			}
-			_bOriginalReplaceOnEcho = true;
-			return;
+void AnimationReplacements::AdjustReplaceOnEchoCount(bool a_bIncrement)
+{
+	if (a_bIncrement) {
+		if (_replaceOnEchoCount++ == 0) {
+			logger::info("original animation {} will replace on echo because there are potential replacements that do", _originalPath);
 		}
+	} else if (_replaceOnEchoCount > 0) {
+		--_replaceOnEchoCount;
 	}
+}
 
-	_bOriginalReplaceOnEcho = false;
+void AnimationReplacements::AdjustKeepRandomResultsOnLoopCount(bool a_bIncrement)
+{
+	if (a_bIncrement) {
+		if (_keepRandomResultsOnLoopCount++ == 0) {
+			logger::info("original animation {} will keep random condition results on loop because there are potential replacements that do", _originalPath);
+		}
+	} else if (_keepRandomResultsOnLoopCount > 0) {
+		--_keepRandomResultsOnLoopCount;
+	}
 }
 
-void AnimationReplacements::TestKeepRandomResultsOnLoop()
+void AnimationReplacements::ForEachReplacementAnimation(const std::function<void(ReplacementAnimation*)>& a_func, bool a_bReverse /*= false*/) const
 {
 	ReadLocker locker(_lock);
 
-	for (const auto& replacementAnimation : _replacements) {
-		if (replacementAnimation->GetKeepRandomResultsOnLoop()) {
-			if (!_bOriginalKeepRandomResultsOnLoop) {
-				logger::info("original animation {} will keep random condition results on loop because there are potential replacements that do", _originalPath);
-			}
-			_bOriginalKeepRandomResultsOnLoop = true;
-			return;
+	if (a_bReverse) {
+		for (const auto& replacementAnimation : std::ranges::reverse_view(_replacements)) {
+			a_func(replacementAnimation.get());
+		}
+	} else {
+		for (auto& replacementAnimation : _replacements) {
+			a_func(replacementAnimation.get());
 		}
 	}
-
-	_bOriginalKeepRandomResultsOnLoop = false;
 }
 
 void AnimationReplacements::MarkAsSynchronizedAnimation(bool a_bSynchronized)
@@ -928,6 +1075,14 @@ void AnimationReplacements::MarkAsSynchronizedAnimation(bool a_bSynchronized)
 	}
 }
 
+void AnimationReplacements::AccumulateMemoryUsage(MemoryReport::Usage& a_usage) const
+{
+	ReadLocker locker(_lock);
+
+	a_usage.indexMaps += sizeof(AnimationReplacements) + MemoryReport::GetVectorSize(_replacements) + MemoryReport::GetVectorSize(_candidates);
+	a_usage.strings += MemoryReport::GetStringSize(_originalPath);
+}
+
 ReplacementAnimation* ReplacerProjectData::EvaluateConditionsAndGetReplacementAnimation(RE::hkbClipGenerator* a_clipGenerator, uint16_t a_originalIndex, RE::TESObjectREFR* a_refr) const
 {
 	if (const auto replacementAnimations = GetAnimationReplacements(a_originalIndex)) {
@@ -939,13 +1094,51 @@ ReplacementAnimation* ReplacerProjectData::EvaluateConditionsAndGetReplacementAn
 
 uint16_t ReplacerProjectData::GetOriginalAnimationIndex(uint16_t a_currentIndex) const
 {
-	if (const auto it = replacementIndexToOriginalIndexMap.find(a_currentIndex); it != replacementIndexToOriginalIndexMap.end()) {
-		return it->second;
+	if (a_currentIndex < _replacementIndexToOriginalIndex.size()) {
+		if (const uint16_t originalIndex = _replacementIndexToOriginalIndex[a_currentIndex]; originalIndex != kInvalidIndex) {
+			return originalIndex;
+		}
 	}
 	return a_currentIndex;
 }
 
 uint16_t ReplacerProjectData::TryAddAnimationToAnimationBundleNames(std::string_view a_path, const std::optional<std::string>& a_hash)
+{
+	if (Settings::bFilterOutDuplicateAnimations && a_hash) {
+		AnimationContentRegistry::GetSingleton().Register(*a_hash, a_path, stringData.get());
+	}
+
+	// the plan already knows the index, no need to check for duplicates
+	if (!_plannedAnimationIndices.empty()) {
+		if (const auto search = _plannedAnimationIndices.find(std::string(a_path)); search != _plannedAnimationIndices.end()) {
+			return search->second;
+		}
+	}
+
+	const uint16_t index = TryAddAnimationToAnimationBundleNamesImpl(a_path, a_hash);
+
+	if (Settings::bCacheReplacementPlans && index != static_cast<uint16_t>(-1)) {
+		_addedAnimationIndices.emplace_back(a_path, index);
+	}
+
+	return index;
+}
+
+void ReplacerProjectData::ApplyReplacementPlan(const ReplacementPlan& a_plan)
+{
+	for (const auto& animationName : a_plan.appendedAnimationNames) {
+		stringData->animationNames.push_back(animationName.data());
+	}
+
+	_plannedAnimationIndices.reserve(a_plan.animationIndices.size());
+	for (const auto& [animationPath, index] : a_plan.animationIndices) {
+		_plannedAnimationIndices.try_emplace(animationPath, index);
+	}
+
+	_filteredDuplicates = a_plan.filteredDuplicates;
+}
+
+uint16_t ReplacerProjectData::TryAddAnimationToAnimationBundleNamesImpl(std::string_view a_path, const std::optional<std::string>& a_hash)
 {
 	std::optional<std::string> hash = std::nullopt;
 
@@ -960,12 +1153,18 @@ uint16_t ReplacerProjectData::TryAddAnimationToAnimationBundleNames(std::string_
 	}
 
 	// Check if the animation is already in the list and return the index if it is
-	for (uint16_t i = 0; i < stringData->animationNames.size(); i++) {
-		if (stringData->animationNames[i].data() == a_path) {
-			return i;
+	// the lookup is built on first use instead of scanning the whole list for every added animation
+	if (_animationNameToIndexMap.empty()) {
+		_animationNameToIndexMap.reserve(stringData->animationNames.size());
+		for (uint16_t i = 0; i < stringData->animationNames.size(); i++) {
+			_animationNameToIndexMap.try_emplace(stringData->animationNames[i].data(), i);
 		}
 	}
 
+	if (const auto search = _animationNameToIndexMap.find(std::string(a_path)); search != _animationNameToIndexMap.end()) {
+		return search->second;
+	}
+
 	// Check if the animation can be added to the list
 	const auto newIndex = static_cast<uint16_t>(stringData->animationNames.size());
 	if (newIndex >= Settings::uAnimationLimit) {
@@ -976,6 +1175,7 @@ uint16_t ReplacerProjectData::TryAddAnimationToAnimationBundleNames(std::string_
 
 	// Add the animation to the list
 	stringData->animationNames.push_back(a_path.data());
+	_animationNameToIndexMap.try_emplace(std::string(a_path), newIndex);
 
 	if (Settings::bFilterOutDuplicateAnimations && hash) {
 		_fileHashToIndexMap[*hash] = newIndex;
@@ -987,8 +1187,16 @@ uint16_t ReplacerProjectData::TryAddAnimationToAnimationBundleNames(std::string_
 void ReplacerProjectData::AddReplacementAnimation(RE::hkbCharacterStringData* a_stringData, uint16_t a_originalIndex, std::unique_ptr<ReplacementAnimation>& a_replacementAnimation)
 {
 	auto addReplacementIndex = [&](uint16_t a_index) {
-		replacementIndexToOriginalIndexMap.emplace(a_index, a_originalIndex);
-		animationsToQueue.emplace_back(a_index);
+		if (a_index >= _replacementIndexToOriginalIndex.size()) {
+			_replacementIndexToOriginalIndex.resize(std::max(static_cast<size_t>(a_index) + 1, static_cast<size_t>(stringData->animationNames.size())), kInvalidIndex);
+		}
+
+		// the first original animation to claim a replacement index keeps it (duplicates filtered by hash share an index)
+		if (auto& originalIndex = _replacementIndexToOriginalIndex[a_index]; originalIndex == kInvalidIndex) {
+			originalIndex = a_originalIndex;
+			++_replacementIndexCount;
+		}
+		animationsToQueue.emplace_back(a_index, a_replacementAnimation.get());
 	};
 
 	if (a_replacementAnimation->HasVariants()) {
@@ -1003,69 +1211,282 @@ void ReplacerProjectData::AddReplacementAnimation(RE::hkbCharacterStringData* a_
 		}
 	}
 
-	if (const auto it = originalIndexToAnimationReplacementsMap.find(a_originalIndex); it != originalIndexToAnimationReplacementsMap.end()) {
-		it->second->AddReplacementAnimation(a_replacementAnimation);
+	if (const auto animationReplacements = GetAnimationReplacements(a_originalIndex)) {
+		animationReplacements->AddReplacementAnimation(a_replacementAnimation);
 	} else {
+		if (a_originalIndex >= _originalIndexToAnimationReplacementsSlot.size()) {
+			_originalIndexToAnimationReplacementsSlot.resize(static_cast<size_t>(a_originalIndex) + 1, kInvalidIndex);
+		}
+
 		auto newReplacementAnimations = std::make_unique<AnimationReplacements>(Utils::GetOriginalAnimationName(a_stringData, a_originalIndex));
 		newReplacementAnimations->AddReplacementAnimation(a_replacementAnimation);
-		originalIndexToAnimationReplacementsMap.emplace(a_originalIndex, std::move(newReplacementAnimations));
+		_originalIndexToAnimationReplacementsSlot[a_originalIndex] = static_cast<uint16_t>(_animationReplacements.size());
+		_animationReplacements.emplace_back(std::move(newReplacementAnimations));
 	}
 }
 
-void ReplacerProjectData::SortReplacementAnimationsByPriority(uint16_t a_originalIndex)
+void ReplacerProjectData::QueueReplacementAnimations(RE::BShkbAnimationGraph* a_graph)
 {
-	if (const auto it = originalIndexToAnimationReplacementsMap.find(a_originalIndex); it != originalIndexToAnimationReplacementsMap.end()) {
-		const auto& replacementAnimations = it->second;
-		replacementAnimations->SortByPriority();
+	if (animationsToQueue.empty()) {
+		return;
 	}
+
+	// preload the animations most likely to play first - the ones that have no conditions or whose conditions already pass for the actor that loaded the graph, then by priority
+	// disabled animations come last
+	enum class PreloadTier : uint8_t
+	{
+		kLikely,
+		kConditional,
+		kDisabled
+	};
+
+	const auto actor = Utils::GetActorFromHkbCharacter(&a_graph->characterInstance);
+	std::unordered_map<const Conditions::ConditionSet*, bool> passingConditionSets;  // replacement animations in a submod share the condition set, evaluate each one once
+
+	auto getTier = [&](const ReplacementAnimation* a_replacementAnimation) {
+		if (a_replacementAnimation->IsDisabled()) {
+			return PreloadTier::kDisabled;
+		}
+
+		const auto conditionSet = a_replacementAnimation->GetConditionSet();
+		if (!conditionSet || conditionSet->IsEmpty()) {
+			return PreloadTier::kLikely;
+		}
+
+		auto [it, bInserted] = passingConditionSets.try_emplace(conditionSet, false);
+		if (bInserted && actor) {
+			it->second = a_replacementAnimation->EvaluateConditions(actor, nullptr);
+		}
+
+		return it->second ? PreloadTier::kLikely : PreloadTier::kConditional;
+	};
+
+	struct PrioritizedAnimation
+	{
+		uint16_t index;
+		PreloadTier tier;
+		int32_t priority;
+	};
+
+	std::vector<PrioritizedAnimation> prioritizedAnimations;
+	prioritizedAnimations.reserve(animationsToQueue.size());
+	for (const auto& [index, replacementAnimation] : animationsToQueue) {
+		prioritizedAnimations.emplace_back(index, getTier(replacementAnimation), replacementAnimation->GetPriority());
+	}
+	animationsToQueue.clear();
+
+	std::ranges::stable_sort(prioritizedAnimations, [](const auto& a_lhs, const auto& a_rhs) {
+		if (a_lhs.tier != a_rhs.tier) {
+			return a_lhs.tier < a_rhs.tier;
+		}
+		return a_lhs.priority > a_rhs.priority;
+	});
+
+	// duplicates filtered by hash share an index, only queue each index once
+	std::vector<uint16_t> animationIndices;
+	animationIndices.reserve(prioritizedAnimations.size());
+	std::vector<bool> queuedIndices(_replacementIndexToOriginalIndex.size());
+	for (const auto& prioritizedAnimation : prioritizedAnimations) {
+		if (prioritizedAnimation.index < queuedIndices.size()) {
+			if (queuedIndices[prioritizedAnimation.index]) {
+				continue;
+			}
+			queuedIndices[prioritizedAnimation.index] = true;
+		}
+		animationIndices.emplace_back(prioritizedAnimation.index);
+	}
+
+	if (Settings::uPreloadBudget > 0 && animationIndices.size() > Settings::uPreloadBudget) {
+		logger::info("Preloading {} of {} replacement animations for {} (preload budget)", Settings::uPreloadBudget, animationIndices.size(), stringData->name.data());
+		animationIndices.resize(Settings::uPreloadBudget);
+	}
+
+	AnimationPreloader::GetSingleton().Enqueue(a_graph, std::move(animationIndices));
 }
 
-void ReplacerProjectData::QueueReplacementAnimations(RE::hkbCharacter* a_character)
+void ReplacerProjectData::MarkAnimationsPreloaded(std::span<const uint16_t> a_indices)
 {
-	OpenAnimationReplacer::bIsPreLoading = true;
-	for (const auto& animIndex : animationsToQueue) {
-		OpenAnimationReplacer::LoadAnimation(a_character, animIndex);
+	const float currentTime = OpenAnimationReplacer::gameTimeCounter;
+
+	WriteLocker locker(_residencyLock);
+
+	if (_residency.empty()) {
+		const size_t size = std::max(_replacementIndexToOriginalIndex.size(), static_cast<size_t>(stringData->animationNames.size()));
+		_residency.resize(size, Residency::kNotPreloaded);
+		_evictedFileSizes.resize(size, 0);
+		_lastUseTimes = std::make_unique<std::atomic<float>[]>(size);
 	}
-	OpenAnimationReplacer::bIsPreLoading = false;
 
-	animationsToQueue.clear();
+	for (const auto index : a_indices) {
+		if (index < _residency.size()) {
+			_residency[index] = Residency::kPreloaded;
+			_lastUseTimes[index].store(currentTime, std::memory_order_relaxed);
+		}
+	}
 }
 
-void ReplacerProjectData::MarkSynchronizedReplacementAnimations(RE::hkbGenerator* a_rootGenerator)
+void ReplacerProjectData::MarkAnimationUsed(uint16_t a_index)
 {
-	if (!a_rootGenerator) {
+	ReadLocker locker(_residencyLock);
+
+	if (a_index < _residency.size()) {
+		_lastUseTimes[a_index].store(OpenAnimationReplacer::gameTimeCounter, std::memory_order_relaxed);
+	}
+}
+
+bool ReplacerProjectData::IsAnimationPreloaded(uint16_t a_index) const
+{
+	ReadLocker locker(_residencyLock);
+
+	return a_index < _residency.size() && _residency[a_index] == Residency::kPreloaded;
+}
+
+bool ReplacerProjectData::IsEvictionCheckDue()
+{
+	// asked on every clip activation, only actually look for unused animations every now and then
+	constexpr float evictionCheckInterval = 10.f;
+
+	const float currentTime = OpenAnimationReplacer::gameTimeCounter;
+	float nextEvictionTime = _nextEvictionTime.load(std::memory_order_relaxed);
+	return currentTime >= nextEvictionTime && _nextEvictionTime.compare_exchange_strong(nextEvictionTime, currentTime + evictionCheckInterval, std::memory_order_relaxed);
+}
+
+void ReplacerProjectData::EvictUnusedAnimations(RE::hkbCharacter* a_character)
+{
+	const float currentTime = OpenAnimationReplacer::gameTimeCounter;
+
+	std::vector<uint16_t> animationsToEvict;
+	{
+		WriteLocker locker(_residencyLock);
+
+		struct ResidentAnimation
+		{
+			uint16_t index;
+			float lastUseTime;
+		};
+
+		std::vector<ResidentAnimation> residentAnimations;
+		for (size_t i = 0; i < _residency.size(); ++i) {
+			if (_residency[i] == Residency::kPreloaded) {
+				residentAnimations.emplace_back(static_cast<uint16_t>(i), _lastUseTimes[i].load(std::memory_order_relaxed));
+			}
+		}
+
+		if (residentAnimations.size() <= Settings::uResidentAnimationsHotSetSize) {
+			return;
+		}
+
+		// the most recently used animations are the hot set and stay loaded regardless of how long ago they were used
+		const auto hotSetEnd = residentAnimations.begin() + Settings::uResidentAnimationsHotSetSize;
+		std::ranges::nth_element(residentAnimations, hotSetEnd, [](const auto& a_lhs, const auto& a_rhs) { return a_lhs.lastUseTime > a_rhs.lastUseTime; });
+
+		for (auto it = hotSetEnd; it != residentAnimations.end(); ++it) {
+			if (currentTime - it->lastUseTime >= Settings::fEvictUnusedAnimationsAfter) {
+				_residency[it->index] = Residency::kEvicted;
+				animationsToEvict.emplace_back(it->index);
+			}
+		}
+	}
+
+	if (animationsToEvict.empty()) {
 		return;
 	}
 
+	// release the reference taken when preloading - animations still played by a clip generator stay loaded until it deactivates, the rest are loaded on demand again
+	// unloading happens outside the lock as it calls into the game's animation file manager
+	// the size in memory isn't known, the file size is a close enough estimate of what was freed
+	std::vector<uint32_t> fileSizes;
+	fileSizes.reserve(animationsToEvict.size());
+	uint64_t evictedBytes = 0;
+	for (const auto index : animationsToEvict) {
+		OpenAnimationReplacer::UnloadAnimation(a_character, index);
+
+		std::error_code errorCode;
+		const auto fileSize = std::filesystem::file_size(stringData->animationNames[index].data(), errorCode);
+		fileSizes.emplace_back(errorCode ? 0 : static_cast<uint32_t>(std::min<uintmax_t>(fileSize, std::numeric_limits<uint32_t>::max())));
+		evictedBytes += fileSizes.back();
+	}
+
+	{
+		WriteLocker locker(_residencyLock);
+		for (size_t i = 0; i < animationsToEvict.size(); ++i) {
+			_evictedFileSizes[animationsToEvict[i]] = fileSizes[i];
+		}
+	}
+
+	logger::info("Evicted {} unused replacement animations from {} ({:.2f} MB)", animationsToEvict.size(), stringData->name.data(), evictedBytes / (1024.0 * 1024.0));
+}
+
+ReplacerProjectData::ResidencyStats ReplacerProjectData::GetResidencyStats() const
+{
+	ReadLocker locker(_residencyLock);
+
+	ResidencyStats stats;
+	for (size_t i = 0; i < _residency.size(); ++i) {
+		switch (_residency[i]) {
+		case Residency::kPreloaded:
+			++stats.preloaded;
+			break;
+		case Residency::kEvicted:
+			++stats.evicted;
+			stats.evictedBytes += _evictedFileSizes[i];
+			break;
+		default:
+			break;
+		}
+	}
+
+	return stats;
+}
+
+std::vector<uint16_t> ReplacerProjectData::FindSynchronizedClipIndices(RE::hkbGenerator* a_rootGenerator) const
+{
+	std::vector<uint16_t> synchronizedClipIndices;
+
+	if (!a_rootGenerator) {
+		return synchronizedClipIndices;
+	}
+
 	RE::hkbNode::GetChildrenFlagBits getChildrenFlags = RE::hkbNode::GetChildrenFlagBits::kGeneratorsOnly;
 
 	RE::UnkIteratorStruct iter;
 	UnkNodeIterator_ctor(&iter, getChildrenFlags, a_rootGenerator);
 
-	std::unordered_set<uint16_t> synchronizedClipIndexes;
-
 	if (auto node = UnkNodeIterator_GetNext(&iter)) {
 		do {
 			const auto classType = node->GetClassType();
 			if (classType->name == *g_str_BSSynchronizedClipGenerator) {
 				const auto synchronizedClipGenerator = static_cast<RE::BSSynchronizedClipGenerator*>(node);
-				synchronizedClipIndexes.emplace(synchronizedClipGenerator->clipGenerator->animationBindingIndex);
+				synchronizedClipIndices.emplace_back(synchronizedClipGenerator->clipGenerator->animationBindingIndex);
 			}
 			node = UnkNodeIterator_GetNext(&iter);
 		} while (node);
 	}
 
-	for (const auto& index : synchronizedClipIndexes) {
+	std::ranges::sort(synchronizedClipIndices);
+	const auto [first, last] = std::ranges::unique(synchronizedClipIndices);
+	synchronizedClipIndices.erase(first, last);
+
+	return synchronizedClipIndices;
+}
+
+void ReplacerProjectData::MarkSynchronizedReplacementAnimations(std::span<const uint16_t> a_synchronizedClipIndices)
+{
+	for (const auto& index : a_synchronizedClipIndices) {
 		if (const auto replacementAnimations = GetAnimationReplacements(index)) {
 			replacementAnimations->MarkAsSynchronizedAnimation(true);
 		}
 	}
+
+	_bSynchronizedAnimationsMarked.store(true, std::memory_order_release);
 }
 
 AnimationReplacements* ReplacerProjectData::GetAnimationReplacements(uint16_t a_originalIndex) const
 {
-	if (const auto search = originalIndexToAnimationReplacementsMap.find(a_originalIndex); search != originalIndexToAnimationReplacementsMap.end()) {
-		return search->second.get();
+	if (a_originalIndex < _originalIndexToAnimationReplacementsSlot.size()) {
+		if (const uint16_t slot = _originalIndexToAnimationReplacementsSlot[a_originalIndex]; slot != kInvalidIndex) {
+			return _animationReplacements[slot].get();
+		}
 	}
 
 	return nullptr;
@@ -1073,8 +1494,28 @@ AnimationReplacements* ReplacerProjectData::GetAnimationReplacements(uint16_t a_
 
 void ReplacerProjectData::ForEach(const std::function<void(AnimationReplacements*)>& a_func)
 {
-	for (auto& val : originalIndexToAnimationReplacementsMap | std::views::values) {
-		auto& replacementAnimations = val;
+	for (auto& replacementAnimations : _animationReplacements) {
 		a_func(replacementAnimations.get());
 	}
 }
+
+void ReplacerProjectData::AccumulateMemoryUsage(MemoryReport::Usage& a_usage) const
+{
+	using namespace MemoryReport;
+
+	a_usage.indexMaps += sizeof(ReplacerProjectData) + GetVectorSize(animationsToQueue) + GetVectorSize(_originalIndexToAnimationReplacementsSlot) + GetVectorSize(_animationReplacements) + GetVectorSize(_replacementIndexToOriginalIndex);
+
+	{
+		ReadLocker locker(_residencyLock);
+		a_usage.indexMaps += GetVectorSize(_residency) + _residency.size() * sizeof(std::atomic<float>) + GetVectorSize(_evictedFileSizes);
+	}
+
+	a_usage.indexMaps += GetHashMapSize(_fileHashToIndexMap);
+	for (const auto& hash : _fileHashToIndexMap | std::views::keys) {
+		a_usage.strings += GetStringSize(hash);
+	}
+
+	for (const auto& animationReplacements : _animationReplacements) {
+		animationReplacements->AccumulateMemoryUsage(a_usage);
+	}
+}
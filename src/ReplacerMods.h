@@ -123,7 +123,11 @@ public:
 	float GetVariantRandom(ActiveClip* a_activeClip);
 	void ClearSharedRandom(const RE::hkbBehaviorGraph* a_behaviorGraph);
 
+	void AccumulateMemoryUsage(MemoryReport::Usage& a_usage) const;
+
 private:
+	void ApplySettings(ReplacementAnimation* a_replacementAnimation) const;
+
 	friend class ReplacerMod;
 	ReplacerMod* _parentMod = nullptr;
 
@@ -150,7 +154,7 @@ private:
 	std::unique_ptr<Conditions::ConditionSet> _synchronizedConditionSet = nullptr;
 	bool _bDirty = false;
 
-	mutable SharedLock _dataLock;
+	mutable SharedLock _dataLock{ "SubMod::_dataLock" };
 	std::vector<ReplacerProjectData*> _replacerProjects;
 	std::vector<ReplacementAnimation*> _replacementAnimations;
 
@@ -167,11 +171,11 @@ private:
 
 		void RemoveActiveClip(ActiveClip* a_activeClip);
 
-		SharedLock _randomLock;
+		SharedLock _randomLock{ "SubMod::SharedRandomFloats::_randomLock" };
 		std::unordered_map<const Conditions::IRandomConditionComponent*, float> _randomFloats{};
 		std::optional<float> _variantFloat = std::nullopt;
 
-		ExclusiveLock _clipLock;
+		ExclusiveLock _clipLock{ "SubMod::SharedRandomFloats::_clipLock" };
 		std::unordered_map<ActiveClip*, std::shared_ptr<ActiveClip::DestroyedCallback>> _registeredCallbacks;
 
 		SubMod* _parentSubMod = nullptr;
@@ -180,7 +184,7 @@ private:
 		std::shared_ptr<Jobs::RemoveSharedRandomFloatJob> _queuedRemovalJob = nullptr;
 	};
 
-	SharedLock _randomLock;
+	SharedLock _randomLock{ "SubMod::_randomLock" };
 	std::unordered_map<const RE::hkbBehaviorGraph*, SharedRandomFloats> _sharedRandomFloats{};
 };
 
@@ -219,6 +223,8 @@ public:
 
 	void SortSubMods();
 
+	void AccumulateMemoryUsage(MemoryReport::Usage& a_usage) const;  // only the mod itself, without the submods
+
 private:
 	std::string _name;
 	std::string _author;
@@ -226,7 +232,7 @@ private:
 	bool _bIsLegacy = false;
 	std::string _path;
 
-	mutable SharedLock _dataLock;
+	mutable SharedLock _dataLock{ "ReplacerMod::_dataLock" };
 	std::vector<std::unique_ptr<SubMod>> _subMods;
 
 	bool _bDirty = false;
@@ -241,70 +247,173 @@ public:
 
 	bool IsEmpty() const { return _replacements.empty(); }
 	std::string_view GetOriginalPath() const { return _originalPath; }
-	bool IsOriginalInterruptible() const { return _bOriginalInterruptible; }
-	bool ShouldOriginalReplaceOnEcho() const { return _bOriginalReplaceOnEcho; }
-	bool ShouldOriginalKeepRandomResultsOnLoop() const { return _bOriginalKeepRandomResultsOnLoop; }
+	bool IsOriginalInterruptible() const { return _interruptibleCount > 0; }
+	bool ShouldOriginalReplaceOnEcho() const { return _replaceOnEchoCount > 0; }
+	bool ShouldOriginalKeepRandomResultsOnLoop() const { return _keepRandomResultsOnLoopCount > 0; }
 
 	ReplacementAnimation* EvaluateConditionsAndGetReplacementAnimation(RE::TESObjectREFR* a_refr, RE::hkbClipGenerator* a_clipGenerator) const;
 	ReplacementAnimation* EvaluateSynchronizedConditionsAndGetReplacementAnimation(RE::TESObjectREFR* a_sourceRefr, RE::TESObjectREFR* a_targetRefr, RE::hkbClipGenerator* a_clipGenerator) const;
 
+	struct BatchedEvaluation
+	{
+		RE::TESObjectREFR* refr;
+		RE::hkbClipGenerator* clipGenerator;
+		ReplacementAnimation* result = nullptr;
+	};
+
+	// same as EvaluateConditionsAndGetReplacementAnimation for several clips at once, each candidate is evaluated for all the clips it hasn't been decided for yet before moving on to the next one
+	void EvaluateConditionsForBatch(std::span<BatchedEvaluation> a_evaluations) const;
+
 	void AddReplacementAnimation(std::unique_ptr<ReplacementAnimation>& a_replacementAnimation);
-	void SortByPriority();
 
-	void ForEachReplacementAnimation(const std::function<void(ReplacementAnimation*)>& a_func, bool a_bReverse = false) const;
+	// called by the replacement animations when their settings change, the replacements are kept sorted by priority and the flags are counted instead of rescanned
+	void OnPriorityChanged(const ReplacementAnimation* a_replacementAnimation);
+	void OnDisabledChanged();
+	void OnInterruptibleChanged(bool a_bInterruptible);
+	void OnReplaceOnEchoChanged(bool a_bReplaceOnEcho);
+	void OnKeepRandomResultsOnLoopChanged(bool a_bKeepRandomResultsOnLoop);
 
-	void TestInterruptible();
-	void TestReplaceOnEcho();
-	void TestKeepRandomResultsOnLoop();
+	void ForEachReplacementAnimation(const std::function<void(ReplacementAnimation*)>& a_func, bool a_bReverse = false) const;
 
 	void MarkAsSynchronizedAnimation(bool a_bSynchronized);
 
+	void AccumulateMemoryUsage(MemoryReport::Usage& a_usage) const;
+
 protected:
-	mutable SharedLock _lock;
+	mutable SharedLock _lock{ "AnimationReplacements::_lock" };
 
 	std::string _originalPath;
 	std::vector<std::unique_ptr<ReplacementAnimation>> _replacements;
 
+	// what evaluation needs from each enabled replacement, in priority order, so it doesn't have to go through the replacement animations themselves
+	struct Candidate
+	{
+		Conditions::ConditionSet* conditionSet;
+		const SubMod* parentSubMod;
+		ReplacementAnimation* replacementAnimation;
+	};
+	std::vector<Candidate> _candidates;
+
 	bool _bSynchronized = false;
 
-	bool _bOriginalInterruptible = false;
-	bool _bOriginalReplaceOnEcho = false;
-	bool _bOriginalKeepRandomResultsOnLoop = false;
+	// number of replacements with each flag set
+	uint32_t _interruptibleCount = 0;
+	uint32_t _replaceOnEchoCount = 0;
+	uint32_t _keepRandomResultsOnLoopCount = 0;
+
+	// these expect the lock to be held
+	void InsertByPriority(std::unique_ptr<ReplacementAnimation>&& a_replacementAnimation);
+	void RebuildCandidates();
+	void AdjustInterruptibleCount(bool a_bIncrement);
+	void AdjustReplaceOnEchoCount(bool a_bIncrement);
+	void AdjustKeepRandomResultsOnLoopCount(bool a_bIncrement);
 };
 
 // this is a class holding our data per behavior project
 class ReplacerProjectData
 {
 public:
+	static constexpr uint16_t kInvalidIndex = static_cast<uint16_t>(-1);
+
 	ReplacerProjectData(RE::hkbCharacterStringData* a_stringData, RE::BShkbHkxDB::ProjectDBData* a_projectDBData) :
 		stringData(a_stringData),
-		projectDBData(a_projectDBData) {}
+		projectDBData(a_projectDBData)
+	{
+		// the original animations are all in the string data at this point, so the dense tables can be sized once up front
+		_originalIndexToAnimationReplacementsSlot.resize(a_stringData->animationNames.size(), kInvalidIndex);
+		_replacementIndexToOriginalIndex.resize(a_stringData->animationNames.size(), kInvalidIndex);
+	}
 
 	ReplacementAnimation* EvaluateConditionsAndGetReplacementAnimation(RE::hkbClipGenerator* a_clipGenerator, uint16_t a_originalIndex, RE::TESObjectREFR* a_refr) const;
 	[[nodiscard]] uint16_t GetOriginalAnimationIndex(uint16_t a_currentIndex) const;
 
 	uint16_t TryAddAnimationToAnimationBundleNames(std::string_view a_path, const std::optional<std::string>& a_hash);
+	void ApplyReplacementPlan(const struct ReplacementPlan& a_plan);
+	[[nodiscard]] std::vector<std::pair<std::string, uint16_t>> TakeAddedAnimationIndices() { return std::exchange(_addedAnimationIndices, {}); }
+
+	// frees the lookups only needed while the replacement animations are created
+	void FinishAddingAnimations()
+	{
+		_animationNameToIndexMap = {};
+		_plannedAnimationIndices = {};
+		_addedAnimationIndices = {};
+	}
+
 	void AddReplacementAnimation(RE::hkbCharacterStringData* a_stringData, uint16_t a_originalIndex, std::unique_ptr<ReplacementAnimation>& a_replacementAnimation);
-	void SortReplacementAnimationsByPriority(uint16_t a_originalIndex);
-	void QueueReplacementAnimations(RE::hkbCharacter* a_character);
-	void MarkSynchronizedReplacementAnimations(RE::hkbGenerator* a_rootGenerator);
+	void QueueReplacementAnimations(RE::BShkbAnimationGraph* a_graph);
+	[[nodiscard]] std::vector<uint16_t> FindSynchronizedClipIndices(RE::hkbGenerator* a_rootGenerator) const;
+	void MarkSynchronizedReplacementAnimations(std::span<const uint16_t> a_synchronizedClipIndices);
+	[[nodiscard]] bool HasMarkedSynchronizedAnimations() const { return _bSynchronizedAnimationsMarked.load(std::memory_order_acquire); }
 
 	[[nodiscard]] uint32_t GetFilteredDuplicateCount() const { return _filteredDuplicates; }
+	[[nodiscard]] bool HasReplacementIndices() const { return _replacementIndexCount > 0; }
+	[[nodiscard]] size_t GetAnimationReplacementsCount() const { return _animationReplacements.size(); }
 
 	[[nodiscard]] AnimationReplacements* GetAnimationReplacements(uint16_t a_originalIndex) const;
 
 	void ForEach(const std::function<void(AnimationReplacements*)>& a_func);
 
-	std::unordered_map<uint16_t, std::unique_ptr<AnimationReplacements>> originalIndexToAnimationReplacementsMap;
-	std::unordered_map<uint16_t, uint16_t> replacementIndexToOriginalIndexMap;
-	std::vector<uint16_t> animationsToQueue;
+	void AccumulateMemoryUsage(MemoryReport::Usage& a_usage) const;
+
+	// residency of the preloaded replacement animations, see Settings::bEvictUnusedAnimations
+	struct ResidencyStats
+	{
+		uint32_t preloaded = 0;     // animations we still hold the preload reference for
+		uint32_t evicted = 0;       // animations we released the preload reference for, they are loaded on demand again
+		uint64_t evictedBytes = 0;  // file sizes of the evicted animations
+	};
+
+	void MarkAnimationsPreloaded(std::span<const uint16_t> a_indices);
+	void MarkAnimationUsed(uint16_t a_index);
+	[[nodiscard]] bool IsAnimationPreloaded(uint16_t a_index) const;
+	[[nodiscard]] bool IsEvictionCheckDue();  // true at most once per check interval, the caller then has EvictUnusedAnimations run from the main update
+	void EvictUnusedAnimations(RE::hkbCharacter* a_character);
+	[[nodiscard]] ResidencyStats GetResidencyStats() const;
+
+	struct AnimationToQueue
+	{
+		uint16_t index;
+		const ReplacementAnimation* replacementAnimation;
+	};
+
+	std::vector<AnimationToQueue> animationsToQueue;
 
 	RE::hkRefPtr<RE::hkbCharacterStringData> stringData;
 	RE::hkRefPtr<RE::BShkbHkxDB::ProjectDBData> projectDBData;
 
 	uint16_t synchronizedClipIDOffset = 0;
+	std::string synchronizedClipsCacheKey;  // empty unless the synchronized clips can be cached, see ReplacementPlanCache
 
 protected:
+	// binding indices are small and contiguous, so these are dense tables indexed directly by binding index instead of hash maps
+	// kInvalidIndex marks an original animation without replacements / a binding index that isn't a replacement
+	std::vector<uint16_t> _originalIndexToAnimationReplacementsSlot;
+	std::vector<std::unique_ptr<AnimationReplacements>> _animationReplacements;
+	std::vector<uint16_t> _replacementIndexToOriginalIndex;
+	uint32_t _replacementIndexCount = 0;
+
+	uint16_t TryAddAnimationToAnimationBundleNamesImpl(std::string_view a_path, const std::optional<std::string>& a_hash);
+
 	std::unordered_map<std::string, uint16_t> _fileHashToIndexMap;
+	std::unordered_map<std::string, uint16_t> _animationNameToIndexMap;
+	std::unordered_map<std::string, uint16_t> _plannedAnimationIndices;    // from a cached replacement plan, see Settings::bCacheReplacementPlans
+	std::vector<std::pair<std::string, uint16_t>> _addedAnimationIndices;  // recorded to save the replacement plan
 	uint32_t _filteredDuplicates = 0;
+
+	std::atomic_bool _bSynchronizedAnimationsMarked = false;
+
+	enum class Residency : uint8_t
+	{
+		kNotPreloaded,
+		kPreloaded,
+		kEvicted
+	};
+
+	// indexed by binding index, allocated when the first animations are preloaded
+	// the last use times are written under the read lock by every thread that replaces an animation, whether eviction is enabled or not, the rest only changes under the write lock
+	mutable SharedLock _residencyLock{ "ReplacerProjectData::_residencyLock" };
+	std::vector<Residency> _residency;
+	std::unique_ptr<std::atomic<float>[]> _lastUseTimes;
+	std::vector<uint32_t> _evictedFileSizes;
+	std::atomic<float> _nextEvictionTime = 0.f;
 };
@@ -19,7 +19,14 @@ void Settings::ReadSettings()
 			ReadUInt16Setting(ini, "General", "uAnimationLimit", uAnimationLimit);
 			ReadUInt32Setting(ini, "General", "uHavokHeapSize", uHavokHeapSize);
 			ReadBoolSetting(ini, "General", "bAsyncParsing", bAsyncParsing);
+			ReadBoolSetting(ini, "General", "bCacheReplacementPlans", bCacheReplacementPlans);
 			ReadBoolSetting(ini, "General", "bLoadDefaultBehaviorsInMainMenu", bLoadDefaultBehaviorsInMainMenu);
+			ReadUInt32Setting(ini, "General", "uPreloadAnimationsPerFrame", uPreloadAnimationsPerFrame);
+			ReadUInt32Setting(ini, "General", "uPreloadBudget", uPreloadBudget);
+			ReadBoolSetting(ini, "General", "bEvictUnusedAnimations", bEvictUnusedAnimations);
+			ReadFloatSetting(ini, "General", "fEvictUnusedAnimationsAfter", fEvictUnusedAnimationsAfter);
+			ReadUInt32Setting(ini, "General", "uResidentAnimationsHotSetSize", uResidentAnimationsHotSetSize);
+			ReadBoolSetting(ini, "General", "bPrefetchAnimations", bPrefetchAnimations);
 
 			// Duplicate filtering
 			ReadBoolSetting(ini, "Filtering", "bFilterOutDuplicateAnimations", bFilterOutDuplicateAnimations);
@@ -49,9 +56,18 @@ void Settings::ReadSettings()
 			// Workarounds
 			ReadBoolSetting(ini, "Workarounds", "bLegacyKeepRandomResultsByDefault", bLegacyKeepRandomResultsByDefault);
 
+			// Debug
+			ReadBoolSetting(ini, "Debug", "bRecordAnimationTrace", bRecordAnimationTrace);
+			ReadBoolSetting(ini, "Debug", "bEnableEvaluationProfiler", bEnableEvaluationProfiler);
+			ReadBoolSetting(ini, "Debug", "bRecordStartupTrace", bRecordStartupTrace);
+			ReadBoolSetting(ini, "Debug", "bProfileLocks", bProfileLocks);
+			ReadBoolSetting(ini, "Debug", "bProfileHooks", bProfileHooks);
+
 			// Experimental
 			ReadBoolSetting(ini, "Experimental", "bDisablePreloading", bDisablePreloading);
 			ReadBoolSetting(ini, "Experimental", "bIncreaseAnimationLimit", bIncreaseAnimationLimit);
+			ReadBoolSetting(ini, "Experimental", "bReorderConditions", bReorderConditions);
+			ReadBoolSetting(ini, "Experimental", "bBatchReevaluations", bBatchReevaluations);
 
 			return true;
 		}
@@ -82,7 +98,14 @@ void Settings::WriteSettings()
 	ini.SetLongValue("General", "uAnimationLimit", uAnimationLimit);
 	ini.SetLongValue("General", "uHavokHeapSize", uHavokHeapSize);
 	ini.SetBoolValue("General", "bAsyncParsing", bAsyncParsing);
+	ini.SetBoolValue("General", "bCacheReplacementPlans", bCacheReplacementPlans);
 	ini.SetBoolValue("General", "bLoadDefaultBehaviorsInMainMenu", bLoadDefaultBehaviorsInMainMenu);
+	ini.SetLongValue("General", "uPreloadAnimationsPerFrame", uPreloadAnimationsPerFrame);
+	ini.SetLongValue("General", "uPreloadBudget", uPreloadBudget);
+	ini.SetBoolValue("General", "bEvictUnusedAnimations", bEvictUnusedAnimations);
+	ini.SetDoubleValue("General", "fEvictUnusedAnimationsAfter", fEvictUnusedAnimationsAfter);
+	ini.SetLongValue("General", "uResidentAnimationsHotSetSize", uResidentAnimationsHotSetSize);
+	ini.SetBoolValue("General", "bPrefetchAnimations", bPrefetchAnimations);
 
 	// Duplicate filtering
 	ini.SetBoolValue("Filtering", "bFilterOutDuplicateAnimations", bFilterOutDuplicateAnimations);
@@ -112,9 +135,18 @@ void Settings::WriteSettings()
 	// Workarounds
 	ini.SetBoolValue("Workarounds", "bLegacyKeepRandomResultsByDefault", bLegacyKeepRandomResultsByDefault);
 
+	// Debug
+	ini.SetBoolValue("Debug", "bRecordAnimationTrace", bRecordAnimationTrace);
+	ini.SetBoolValue("Debug", "bEnableEvaluationProfiler", bEnableEvaluationProfiler);
+	ini.SetBoolValue("Debug", "bRecordStartupTrace", bRecordStartupTrace);
+	ini.SetBoolValue("Debug", "bProfileLocks", bProfileLocks);
+	ini.SetBoolValue("Debug", "bProfileHooks", bProfileHooks);
+
 	// Experimental
 	ini.SetBoolValue("Experimental", "bDisablePreloading", bDisablePreloading);
 	ini.SetBoolValue("Experimental", "bIncreaseAnimationLimit", bIncreaseAnimationLimit);
+	ini.SetBoolValue("Experimental", "bReorderConditions", bReorderConditions);
+	ini.SetBoolValue("Experimental", "bBatchReevaluations", bBatchReevaluations);
 
 	ini.SaveFile(iniPath.data());
 
@@ -29,7 +29,14 @@ struct Settings
 	static inline uint16_t uAnimationLimit = 0x7FFF;
 	static inline uint32_t uHavokHeapSize = 0x40000000;
 	static inline bool bAsyncParsing = true;
+	static inline bool bCacheReplacementPlans = true;
 	static inline bool bLoadDefaultBehaviorsInMainMenu = true;
+	static inline uint32_t uPreloadAnimationsPerFrame = 100;  // 0 = all at once
+	static inline uint32_t uPreloadBudget = 0;               // max animations preloaded per project, 0 = no limit
+	static inline bool bEvictUnusedAnimations = false;
+	static inline float fEvictUnusedAnimationsAfter = 300.f;  // seconds
+	static inline uint32_t uResidentAnimationsHotSetSize = 256;  // per project, the most recently used preloaded animations are never evicted
+	static inline bool bPrefetchAnimations = false;
 
 	// Duplicate filtering
 	static inline bool bFilterOutDuplicateAnimations = true;
@@ -56,9 +63,18 @@ struct Settings
 	// Workarounds
 	static inline bool bLegacyKeepRandomResultsByDefault = true;
 
+	// Debug
+	static inline bool bRecordAnimationTrace = false;
+	static inline bool bEnableEvaluationProfiler = false;
+	static inline bool bRecordStartupTrace = false;
+	static inline bool bProfileLocks = false;
+	static inline bool bProfileHooks = false;
+
 	// Experimental
 	static inline bool bDisablePreloading = false;
 	static inline bool bIncreaseAnimationLimit = false;
+	static inline bool bReorderConditions = false;
+	static inline bool bBatchReevaluations = false;
 
 	// Internal
 	static inline float fBlendTimeOnInterrupt = 0.3f;
@@ -77,6 +93,7 @@ struct Settings
 	constexpr static inline std::string_view iniPath = "Data/SKSE/Plugins/OpenAnimationReplacer.ini";
 	constexpr static inline std::string_view imguiIni = "Data/SKSE/Plugins/OpenAnimationReplacer_ImGui.ini";
 	constexpr static inline std::string_view animationFileHashCachePath = "Data/SKSE/Plugins/OpenAnimationReplacer_animFileHashCache.bin";
+	constexpr static inline std::string_view replacementPlanCacheDirectory = "Data/SKSE/Plugins/OpenAnimationReplacer_ReplacementPlans";
 
 	constexpr static inline std::string_view synchronizedClipSourcePrefix = "NPC";
 	constexpr static inline std::string_view synchronizedClipTargetPrefix = "2_";
@@ -0,0 +1,129 @@
+#include "StartupTrace.h"
+
+namespace
+{
+	std::string EscapeJson(std::string_view a_string)
+	{
+		std::string result;
+		result.reserve(a_string.size());
+		for (const char c : a_string) {
+			switch (c) {
+			case '"':
+				result += "\\\"";
+				break;
+			case '\\':
+				result += "\\\\";
+				break;
+			default:
+				if (static_cast<unsigned char>(c) < 0x20) {
+					result += std::format("\\u{:04x}", static_cast<unsigned char>(c));
+				} else {
+					result += c;
+				}
+				break;
+			}
+		}
+		return result;
+	}
+}
+
+StartupTrace::Scope::Scope(std::string_view a_category, std::string_view a_name) :
+	_bActive(IsRecording())
+{
+	if (_bActive) {
+		_category = a_category;
+		_name = a_name;
+		_startTime = std::chrono::steady_clock::now();
+	}
+}
+
+StartupTrace::Scope::Scope(std::string_view a_category, const std::filesystem::path& a_path) :
+	_bActive(IsRecording())
+{
+	if (_bActive) {
+		_category = a_category;
+		const auto path = a_path.u8string();
+		_name.assign(reinterpret_cast<const char*>(path.data()), path.size());
+		_startTime = std::chrono::steady_clock::now();
+	}
+}
+
+StartupTrace::Scope::~Scope()
+{
+	if (_bActive) {
+		auto& startupTrace = GetSingleton();
+		const auto startTime = startupTrace.GetTimestamp(_startTime);
+		const auto endTime = startupTrace.GetTimestamp(std::chrono::steady_clock::now());
+		startupTrace.AddEvent({ _category, std::move(_name), startTime, endTime - startTime, static_cast<uint32_t>(GetCurrentThreadId()) });
+	}
+}
+
+void StartupTrace::StartRecording()
+{
+	Locker locker(_fileLock);
+
+	if (_bRecording) {
+		return;
+	}
+
+	auto path = logger::log_directory();
+	if (!path) {
+		logger::error("Startup trace: failed to find the log directory");
+		return;
+	}
+
+	*path /= std::format("{}_StartupTrace.json", Plugin::NAME);
+
+	_file.open(*path, std::ios::trunc);
+	if (!_file.is_open()) {
+		logger::error("Startup trace: failed to open {}", path->string());
+		return;
+	}
+
+	_file << "[\n";
+	_file << std::format(R"({{"name":"process_name","ph":"M","pid":0,"args":{{"name":"{}"}}}})", Plugin::NAME);
+	_file.flush();
+
+	_startTime = std::chrono::steady_clock::now();
+	_bRecording = true;
+
+	logger::info("Startup trace: recording to {}", path->string());
+}
+
+void StartupTrace::Flush()
+{
+	if (!IsRecording()) {
+		return;
+	}
+
+	std::vector<Event> events;
+	{
+		Locker locker(_eventsLock);
+		events.swap(_events);
+	}
+
+	if (events.empty()) {
+		return;
+	}
+
+	Locker locker(_fileLock);
+
+	std::string buffer;
+	for (const auto& event : events) {
+		buffer += std::format(",\n{{\"name\":\"{}\",\"cat\":\"{}\",\"ph\":\"X\",\"ts\":{},\"dur\":{},\"pid\":0,\"tid\":{}}}", EscapeJson(event.name), event.category, event.startTime, event.duration, event.threadId);
+	}
+
+	_file << buffer;
+	_file.flush();
+}
+
+void StartupTrace::AddEvent(Event&& a_event)
+{
+	Locker locker(_eventsLock);
+	_events.emplace_back(std::move(a_event));
+}
+
+uint64_t StartupTrace::GetTimestamp(std::chrono::steady_clock::time_point a_time) const
+{
+	return static_cast<uint64_t>(std::max<int64_t>(std::chrono::duration_cast<std::chrono::microseconds>(a_time - _startTime).count(), 0));
+}
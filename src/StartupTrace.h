@@ -0,0 +1,68 @@
+#pragma once
+
+// opt-in timeline of the startup work (parsing, hashing, creating projects...) written as a chrome://tracing / Perfetto compatible json file, see Settings::bRecordStartupTrace
+// events are written out in batches, the closing bracket of the json array is optional in the trace event format so the file is valid at any point
+class StartupTrace
+{
+public:
+	static StartupTrace& GetSingleton()
+	{
+		static StartupTrace singleton;
+		return singleton;
+	}
+
+	// records a complete event spanning the lifetime of the scope, does nothing if the trace isn't being recorded
+	class Scope
+	{
+	public:
+		Scope(std::string_view a_category, std::string_view a_name);
+		Scope(std::string_view a_category, const std::filesystem::path& a_path);
+		~Scope();
+
+		Scope(const Scope&) = delete;
+		Scope(Scope&&) = delete;
+		Scope& operator=(const Scope&) = delete;
+		Scope& operator=(Scope&&) = delete;
+
+	private:
+		bool _bActive;
+		std::string_view _category;
+		std::string _name;
+		std::chrono::steady_clock::time_point _startTime{};
+	};
+
+	[[nodiscard]] static bool IsRecording() { return _bRecording.load(std::memory_order_relaxed); }
+	void StartRecording();
+	void Flush();  // writes the events recorded so far
+
+private:
+	StartupTrace() = default;
+	StartupTrace(const StartupTrace&) = delete;
+	StartupTrace(StartupTrace&&) = delete;
+	virtual ~StartupTrace() = default;
+
+	StartupTrace& operator=(const StartupTrace&) = delete;
+	StartupTrace& operator=(StartupTrace&&) = delete;
+
+	struct Event
+	{
+		std::string_view category;
+		std::string name;
+		uint64_t startTime;  // microseconds since the trace was started
+		uint64_t duration;   // microseconds
+		uint32_t threadId;
+	};
+
+	void AddEvent(Event&& a_event);
+	[[nodiscard]] uint64_t GetTimestamp(std::chrono::steady_clock::time_point a_time) const;
+
+	static inline std::atomic_bool _bRecording = false;
+
+	std::chrono::steady_clock::time_point _startTime{};
+
+	ExclusiveLock _eventsLock;
+	std::vector<Event> _events;
+
+	ExclusiveLock _fileLock;
+	std::ofstream _file;
+};
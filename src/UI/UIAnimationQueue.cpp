@@ -1,4 +1,6 @@
 #include "UIAnimationQueue.h"
+
+#include "AnimationPreloader.h"
 #include "Settings.h"
 
 namespace UI
@@ -7,7 +9,7 @@ namespace UI
 	{
 		if (Settings::bEnableAnimationQueueProgressBar && !Settings::bDisablePreloading) {
 			if (const auto animationFileManagerSingleton = RE::AnimationFileManagerSingleton::GetSingleton()) {
-				if (_fLingerTime > 0.f || animationFileManagerSingleton->queuedAnimations.size() > Settings::uQueueMinSize) {
+				if (_fLingerTime > 0.f || animationFileManagerSingleton->queuedAnimations.size() + AnimationPreloader::GetSingleton().GetPendingCount() > Settings::uQueueMinSize) {
 					return true;
 				}
 			}
@@ -19,7 +21,8 @@ namespace UI
 	void UIAnimationQueue::DrawImpl()
 	{
 		const auto animationFileManager = RE::AnimationFileManagerSingleton::GetSingleton();
-		const uint32_t queuedCount = animationFileManager->queuedAnimations.size();
+		// animations still waiting in the preloader haven't reached the game's queue yet
+		const uint32_t queuedCount = animationFileManager->queuedAnimations.size() + static_cast<uint32_t>(AnimationPreloader::GetSingleton().GetPendingCount());
 
 		if (queuedCount == 0) {
 			const ImGuiIO& io = ImGui::GetIO();
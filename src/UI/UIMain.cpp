@@ -4,10 +4,14 @@
 #include <imgui_stdlib.h>
 
 #include "ActiveClip.h"
+#include "AnimationContentRegistry.h"
+#include "AnimationPrefetcher.h"
 #include "DetectedProblems.h"
+#include "HookProfiler.h"
 #include "Jobs.h"
 #include "OpenAnimationReplacer.h"
 #include "Parsing.h"
+#include "ReplacementPlanCache.h"
 #include "UICommon.h"
 #include "UIManager.h"
 
@@ -107,6 +111,10 @@ namespace UI
 						DrawReplacementAnimations();
 						ImGui::EndTabItem();
 					}
+					if (ImGui::BeginTabItem("Performance")) {
+						DrawPerformance();
+						ImGui::EndTabItem();
+					}
 
 					ImGui::EndTabBar();
 				}
@@ -374,6 +382,17 @@ namespace UI
 			ImGui::SameLine();
 			UICommon::HelpMarker("Enable to asynchronously parse all the replacer mods on load. This dramatically speeds up the process. No real reason to disable this setting.");
 
+			if (ImGui::Checkbox("Cache replacement plans", &Settings::bCacheReplacementPlans)) {
+				Settings::WriteSettings();
+			}
+			ImGui::SameLine();
+			UICommon::HelpMarker("Enable to save which replacement animations were added to each behavior project, so they can be added directly the next time the same project loads with the same set of replacer mods. The plans are saved to a folder next to the .dll and are discarded automatically whenever the replacer mods change.");
+			ImGui::SameLine();
+			if (ImGui::Button("Clear cache##ReplacementPlans")) {
+				ReplacementPlanCache::GetSingleton().DeleteCache();
+			}
+			UICommon::AddTooltip("Delete the cached replacement plans. They will be created again the next time each behavior project loads.");
+
 			if (Settings::bDisablePreloading) {
 				ImGui::BeginDisabled();
 				bool bDummy = false;
@@ -387,6 +406,52 @@ namespace UI
 			ImGui::SameLine();
 			UICommon::HelpMarker("Enable to start loading default male/female behaviors in the main menu. Ignored with animation preloading disabled as there's no benefit in doing so in that case.");
 
+			ImGui::BeginDisabled(Settings::bDisablePreloading);
+			constexpr uint32_t preloadRateMin = 0;
+			constexpr uint32_t preloadRateMax = 1000;
+			if (ImGui::SliderScalar("Preloaded animations per frame", ImGuiDataType_U32, &Settings::uPreloadAnimationsPerFrame, &preloadRateMin, &preloadRateMax, "%d", ImGuiSliderFlags_AlwaysClamp)) {
+				Settings::WriteSettings();
+			}
+			ImGui::SameLine();
+			UICommon::HelpMarker("Set how many replacement animations are queued for preloading per frame after a behavior is loaded. Lower values avoid a stall when a behavior with a lot of replacement animations loads. Set to 0 to queue them all at once.");
+
+			constexpr uint32_t preloadBudgetMin = 0;
+			constexpr uint32_t preloadBudgetMax = 0x7FFF;
+			if (ImGui::SliderScalar("Preload budget", ImGuiDataType_U32, &Settings::uPreloadBudget, &preloadBudgetMin, &preloadBudgetMax, "%d", ImGuiSliderFlags_AlwaysClamp)) {
+				Settings::WriteSettings();
+			}
+			ImGui::SameLine();
+			UICommon::HelpMarker("Set the maximum number of replacement animations preloaded per behavior project. Animations without conditions or with conditions that pass for the character that loaded the behavior are preloaded first, then the rest by priority. Animations over the budget are loaded when they're needed instead, which saves memory with large animation packs. Set to 0 to preload everything.");
+
+			if (ImGui::Checkbox("Evict unused animations", &Settings::bEvictUnusedAnimations)) {
+				Settings::WriteSettings();
+			}
+			ImGui::SameLine();
+			UICommon::HelpMarker("Enable to unload preloaded replacement animations that haven't been played for a while. They are loaded again on demand when they're needed, the same way as with preloading disabled. Saves memory with large animation packs. The resident and evicted animations are shown in the Performance tab.");
+
+			ImGui::BeginDisabled(!Settings::bEvictUnusedAnimations);
+			if (ImGui::SliderFloat("Evict after", &Settings::fEvictUnusedAnimationsAfter, 30.f, 3600.f, "%.0f s", ImGuiSliderFlags_AlwaysClamp)) {
+				Settings::WriteSettings();
+			}
+			ImGui::SameLine();
+			UICommon::HelpMarker("Set how long a preloaded animation has to go unused before it's evicted.");
+
+			constexpr uint32_t hotSetMin = 0;
+			constexpr uint32_t hotSetMax = 4096;
+			if (ImGui::SliderScalar("Hot set size", ImGuiDataType_U32, &Settings::uResidentAnimationsHotSetSize, &hotSetMin, &hotSetMax, "%d", ImGuiSliderFlags_AlwaysClamp)) {
+				Settings::WriteSettings();
+			}
+			ImGui::SameLine();
+			UICommon::HelpMarker("Set how many of the most recently used preloaded animations per behavior project are never evicted, no matter how long ago they were used.");
+			ImGui::EndDisabled();
+			ImGui::EndDisabled();
+
+			if (ImGui::Checkbox("Prefetch animations", &Settings::bPrefetchAnimations)) {
+				Settings::WriteSettings();
+			}
+			ImGui::SameLine();
+			UICommon::HelpMarker("Enable to load the replacement animations an actor is likely to play next when it enters or leaves combat or draws or sheathes a weapon, before they are needed. Useful with preloading disabled, or with a preload budget or evicting enabled.");
+
 			ImGui::Spacing();
 			ImGui::Separator();
 
@@ -507,6 +572,33 @@ namespace UI
 			ImGui::Spacing();
 			ImGui::Separator();
 
+			// Debug settings
+			ImGui::AlignTextToFramePadding();
+			ImGui::TextUnformatted("Debug Settings");
+			ImGui::SameLine();
+			UICommon::HelpMarker("These settings are meant for troubleshooting and performance analysis. They might have a small performance cost while enabled.");
+			ImGui::Spacing();
+
+			if (ImGui::Checkbox("Record animation trace", &Settings::bRecordAnimationTrace)) {
+				if (Settings::bRecordAnimationTrace) {
+					AnimationTrace::GetSingleton().StartRecording();
+				} else {
+					AnimationTrace::GetSingleton().StopRecording();
+				}
+				Settings::WriteSettings();
+			}
+			ImGui::SameLine();
+			UICommon::HelpMarker("Enable to record every animation clip activation, echo, loop and replacement into a binary trace file at 'Documents\\My Games\\Skyrim Special Edition\\SKSE\\OpenAnimationReplacer.oartrace'. The file is overwritten every time recording starts. Use the AnimationTraceSummary tool to analyze it.");
+
+			if (ImGui::Checkbox("Record startup trace", &Settings::bRecordStartupTrace)) {
+				Settings::WriteSettings();
+			}
+			ImGui::SameLine();
+			UICommon::HelpMarker("Enable to record the time spent parsing mods, hashing animations and creating replacement animations for each project into 'Documents\\My Games\\Skyrim Special Edition\\SKSE\\OpenAnimationReplacer_StartupTrace.json'. Open the file in chrome://tracing or ui.perfetto.dev. Takes effect after restarting the game.");
+
+			ImGui::Spacing();
+			ImGui::Separator();
+
 			// Experimental settings
 			ImGui::AlignTextToFramePadding();
 			ImGui::TextUnformatted("Experimental Settings");
@@ -529,6 +621,18 @@ namespace UI
 			}
 			ImGui::SameLine();
 			UICommon::HelpMarker("Enable to increase the animation limit to double the default value. Should generally work fine, but I might have missed some places to patch in the game code so this is still considered to be experimental. There's no benefit in enabling this if you're not going over the limit.");
+
+			if (ImGui::Checkbox("Reorder conditions", &Settings::bReorderConditions)) {
+				Settings::WriteSettings();
+			}
+			ImGui::SameLine();
+			UICommon::HelpMarker("Enable to evaluate the conditions of each condition set in the order that is measured to be the cheapest - conditions that are fast and often fail are evaluated first. The order displayed in the editor and saved to the config files is not affected. Random conditions and conditions added by other plugins are never moved, and no conditions are moved across them, so the results stay the same. Takes effect immediately.");
+
+			if (ImGui::Checkbox("Batch re-evaluations", &Settings::bBatchReevaluations)) {
+				Settings::WriteSettings();
+			}
+			ImGui::SameLine();
+			UICommon::HelpMarker("Enable to collect the condition re-evaluations of interruptible and looping animations over the frame and evaluate them together once per frame, grouped by the original animation. With many actors playing the same animations, the same conditions are evaluated back to back. The results are applied a frame later. Activations and echoes are still evaluated immediately. Takes effect immediately.");
 		}
 
 		ImGui::End();
@@ -1487,22 +1591,20 @@ namespace UI
 					const std::string animPercentStr = std::format("{} ({} + {}) / {}", totalCount, animCount, totalCount - animCount, Settings::uAnimationLimit);
 					ImGui::ProgressBar(animPercent, ImVec2(0.f, 0.f), animPercentStr.data());
 
-					auto& map = a_projectData->originalIndexToAnimationReplacementsMap;
-
 					std::vector<AnimationReplacements*> sortedReplacements;
-					sortedReplacements.reserve(map.size());
+					sortedReplacements.reserve(a_projectData->GetAnimationReplacementsCount());
 
-					for (auto& [index, animReplacements] : map) {
+					a_projectData->ForEach([&](AnimationReplacements* a_animReplacements) {
 						// Filter
-						if (std::strlen(animPathFilterBuf) && !Utils::ContainsStringIgnoreCase(animReplacements->GetOriginalPath(), animPathFilterBuf)) {
-							continue;
+						if (std::strlen(animPathFilterBuf) && !Utils::ContainsStringIgnoreCase(a_animReplacements->GetOriginalPath(), animPathFilterBuf)) {
+							return;
 						}
 
-						auto it = std::lower_bound(sortedReplacements.begin(), sortedReplacements.end(), animReplacements, [](const auto& a_lhs, const auto& a_rhs) {
+						auto it = std::lower_bound(sortedReplacements.begin(), sortedReplacements.end(), a_animReplacements, [](const auto& a_lhs, const auto& a_rhs) {
 							return a_lhs->GetOriginalPath() < a_rhs->GetOriginalPath();
 						});
-						sortedReplacements.insert(it, animReplacements.get());
-					}
+						sortedReplacements.insert(it, a_animReplacements);
+					});
 
 					for (auto& animReplacements : sortedReplacements) {
 						ImGui::PushID(animReplacements);
@@ -1636,6 +1738,718 @@ namespace UI
 		}
 	}
 
+	void UIMain::DrawPerformance()
+	{
+		auto& profiler = EvaluationProfiler::GetSingleton();
+
+		if (ImGui::Checkbox("Enable profiling", &Settings::bEnableEvaluationProfiler)) {
+			EvaluationProfiler::SetEnabled(Settings::bEnableEvaluationProfiler);
+			Settings::WriteSettings();
+		}
+		ImGui::SameLine();
+		UICommon::HelpMarker("Enable to measure how often the conditions of each submod and each condition are evaluated, how often they pass and how long that takes. Times of conditions include their child conditions. Has a small performance cost while enabled.");
+
+		ImGui::SameLine();
+		if (ImGui::Button("Reset")) {
+			profiler.Reset();
+			_performanceRefreshTimer = 0.f;
+		}
+
+		ImGui::SameLine();
+		if (ImGui::Button("Export CSV")) {
+			if (auto path = logger::log_directory()) {
+				*path /= std::format("{}_Performance.csv", Plugin::NAME);
+				profiler.MergeThreadCounters();
+				profiler.ExportCSV(*path);
+			}
+		}
+		ImGui::SameLine();
+		UICommon::HelpMarker("Export the collected data to 'Documents\\My Games\\Skyrim Special Edition\\SKSE\\OpenAnimationReplacer_Performance.csv'.");
+
+		ImGui::Separator();
+
+		bool bRefreshed = false;
+		_performanceRefreshTimer -= ImGui::GetIO().DeltaTime;
+		if (_performanceRefreshTimer <= 0.f) {
+			profiler.MergeThreadCounters();
+			_performanceSubModEntries = profiler.CollectSubModEntries();
+			_performanceConditionEntries = profiler.CollectConditionEntries();
+			_performanceRefreshTimer = kPerformanceRefreshInterval;
+			bRefreshed = true;
+		}
+
+		DrawConditionBenchmark();
+		DrawTraceReplay();
+		DrawLockProfiler();
+		DrawHookProfiler();
+		DrawMemoryReport();
+		DrawAnimationResidency();
+
+		if (_performanceSubModEntries.empty() && _performanceConditionEntries.empty()) {
+			UICommon::TextUnformattedDisabled(Settings::bEnableEvaluationProfiler ? "No data collected yet" : "Profiling is disabled");
+			return;
+		}
+
+		enum StatsColumn : int
+		{
+			kEvaluations,
+			kPassRate,
+			kTotalTime,
+			kAverageTime,
+			kPeakTime,
+
+			kTotal
+		};
+
+		auto getStatsValue = [](const EvaluationProfiler::Stats& a_stats, int a_column) -> double {
+			switch (a_column) {
+			case kEvaluations:
+				return static_cast<double>(a_stats.evaluations);
+			case kPassRate:
+				return a_stats.GetPassRate();
+			case kTotalTime:
+				return static_cast<double>(a_stats.totalTime);
+			case kAverageTime:
+				return a_stats.GetAverageTime();
+			case kPeakTime:
+				return static_cast<double>(a_stats.peakTime);
+			}
+			return 0.0;
+		};
+
+		// text columns come first, followed by the stats columns
+		auto sortEntries = [&](auto& a_entries, int a_textColumnCount, auto&& a_getText) {
+			const ImGuiTableSortSpecs* sortSpecs = ImGui::TableGetSortSpecs();
+			if (!sortSpecs || sortSpecs->SpecsCount == 0 || (!sortSpecs->SpecsDirty && !bRefreshed)) {
+				return;
+			}
+
+			const auto& spec = sortSpecs->Specs[0];
+			const bool bAscending = spec.SortDirection == ImGuiSortDirection_Ascending;
+			std::ranges::stable_sort(a_entries, [&](const auto& a_lhs, const auto& a_rhs) {
+				if (spec.ColumnIndex < a_textColumnCount) {
+					const auto cmp = a_getText(a_lhs, spec.ColumnIndex).compare(a_getText(a_rhs, spec.ColumnIndex));
+					return bAscending ? cmp < 0 : cmp > 0;
+				}
+				const double lhs = getStatsValue(a_lhs.stats, spec.ColumnIndex - a_textColumnCount);
+				const double rhs = getStatsValue(a_rhs.stats, spec.ColumnIndex - a_textColumnCount);
+				return bAscending ? lhs < rhs : lhs > rhs;
+			});
+
+			const_cast<ImGuiTableSortSpecs*>(sortSpecs)->SpecsDirty = false;
+		};
+
+		auto setupStatsColumns = []() {
+			ImGui::TableSetupColumn("Evaluations", ImGuiTableColumnFlags_WidthFixed | ImGuiTableColumnFlags_PreferSortDescending, 80.f);
+			ImGui::TableSetupColumn("Pass rate", ImGuiTableColumnFlags_WidthFixed | ImGuiTableColumnFlags_PreferSortDescending, 65.f);
+			ImGui::TableSetupColumn("Total (ms)", ImGuiTableColumnFlags_WidthFixed | ImGuiTableColumnFlags_PreferSortDescending | ImGuiTableColumnFlags_DefaultSort, 75.f);
+			ImGui::TableSetupColumn("Avg (us)", ImGuiTableColumnFlags_WidthFixed | ImGuiTableColumnFlags_PreferSortDescending, 65.f);
+			ImGui::TableSetupColumn("Peak (us)", ImGuiTableColumnFlags_WidthFixed | ImGuiTableColumnFlags_PreferSortDescending, 65.f);
+		};
+
+		auto drawStatsColumns = [](const EvaluationProfiler::Stats& a_stats) {
+			ImGui::TableNextColumn();
+			ImGui::Text("%llu", a_stats.evaluations);
+			ImGui::TableNextColumn();
+			ImGui::Text("%.1f%%", a_stats.GetPassRate() * 100.0);
+			ImGui::TableNextColumn();
+			ImGui::Text("%.2f", a_stats.totalTime / 1e6);
+			ImGui::TableNextColumn();
+			ImGui::Text("%.2f", a_stats.GetAverageTime() / 1e3);
+			ImGui::TableNextColumn();
+			ImGui::Text("%.2f", a_stats.peakTime / 1e3);
+		};
+
+		constexpr ImGuiTableFlags tableFlags = ImGuiTableFlags_Sortable | ImGuiTableFlags_Resizable | ImGuiTableFlags_BordersOuter | ImGuiTableFlags_RowBg | ImGuiTableFlags_ScrollY | ImGuiTableFlags_NoSavedSettings;
+		const float tableHeight = ImGui::GetTextLineHeightWithSpacing() * 15;
+
+		if (ImGui::CollapsingHeader("Submods", ImGuiTreeNodeFlags_DefaultOpen)) {
+			if (ImGui::BeginTable("PerformanceSubMods", 2 + kTotal, tableFlags, ImVec2(0.f, tableHeight))) {
+				ImGui::TableSetupColumn("Mod", ImGuiTableColumnFlags_WidthStretch);
+				ImGui::TableSetupColumn("Submod", ImGuiTableColumnFlags_WidthStretch);
+				setupStatsColumns();
+				ImGui::TableSetupScrollFreeze(0, 1);
+				ImGui::TableHeadersRow();
+
+				sortEntries(_performanceSubModEntries, 2, [](const EvaluationProfiler::SubModEntry& a_entry, int a_column) -> std::string_view {
+					return a_column == 0 ? a_entry.modName : a_entry.subModName;
+				});
+
+				ImGuiListClipper clipper;
+				clipper.Begin(static_cast<int>(_performanceSubModEntries.size()));
+				while (clipper.Step()) {
+					for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; ++i) {
+						const auto& entry = _performanceSubModEntries[i];
+						ImGui::TableNextRow();
+						ImGui::TableNextColumn();
+						UICommon::TextUnformattedEllipsis(entry.modName.data());
+						ImGui::TableNextColumn();
+						UICommon::TextUnformattedEllipsis(entry.subModName.data());
+						drawStatsColumns(entry.stats);
+					}
+				}
+
+				ImGui::EndTable();
+			}
+		}
+
+		if (ImGui::CollapsingHeader("Conditions", ImGuiTreeNodeFlags_DefaultOpen)) {
+			if (ImGui::BeginTable("PerformanceConditions", 3 + kTotal, tableFlags, ImVec2(0.f, tableHeight))) {
+				ImGui::TableSetupColumn("Condition", ImGuiTableColumnFlags_WidthStretch);
+				ImGui::TableSetupColumn("Mod", ImGuiTableColumnFlags_WidthStretch);
+				ImGui::TableSetupColumn("Submod", ImGuiTableColumnFlags_WidthStretch);
+				setupStatsColumns();
+				ImGui::TableSetupScrollFreeze(0, 1);
+				ImGui::TableHeadersRow();
+
+				sortEntries(_performanceConditionEntries, 3, [](const EvaluationProfiler::ConditionEntry& a_entry, int a_column) -> std::string_view {
+					switch (a_column) {
+					case 0:
+						return a_entry.conditionName;
+					case 1:
+						return a_entry.modName;
+					default:
+						return a_entry.subModName;
+					}
+				});
+
+				ImGuiListClipper clipper;
+				clipper.Begin(static_cast<int>(_performanceConditionEntries.size()));
+				while (clipper.Step()) {
+					for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; ++i) {
+						const auto& entry = _performanceConditionEntries[i];
+						ImGui::TableNextRow();
+						ImGui::TableNextColumn();
+						UICommon::TextUnformattedEllipsis(entry.conditionName.data());
+						ImGui::TableNextColumn();
+						UICommon::TextUnformattedEllipsis(entry.modName.data());
+						ImGui::TableNextColumn();
+						UICommon::TextUnformattedEllipsis(entry.subModName.data());
+						drawStatsColumns(entry.stats);
+					}
+				}
+
+				ImGui::EndTable();
+			}
+		}
+	}
+
+	void UIMain::DrawConditionBenchmark()
+	{
+		if (!ImGui::CollapsingHeader("Benchmark")) {
+			return;
+		}
+
+		const auto refrToEvaluate = UIManager::GetSingleton().GetRefrToEvaluate();
+
+		ImGui::BeginDisabled(!refrToEvaluate);
+		if (ImGui::Button("Run benchmark")) {
+			_conditionBenchmarkResult = ConditionBenchmark::Run(refrToEvaluate, 500ms);
+			_conditionBenchmarkComparison = std::nullopt;
+			if (_conditionBenchmarkResult) {
+				if (const auto path = ConditionBenchmark::GetBaselinePath()) {
+					if (const auto baseline = ConditionBenchmark::LoadBaseline(*path)) {
+						_conditionBenchmarkComparison = ConditionBenchmark::Compare(*_conditionBenchmarkResult, *baseline);
+					}
+				}
+			}
+		}
+		ImGui::EndDisabled();
+		ImGui::SameLine();
+		ImGui::BeginDisabled(!_conditionBenchmarkResult);
+		if (ImGui::Button("Save as baseline")) {
+			if (const auto path = ConditionBenchmark::GetBaselinePath()) {
+				if (ConditionBenchmark::SaveBaseline(*_conditionBenchmarkResult, *path)) {
+					_conditionBenchmarkComparison = std::nullopt;
+				}
+			}
+		}
+		ImGui::EndDisabled();
+		ImGui::SameLine();
+		UICommon::HelpMarker("Repeatedly evaluates the conditions of every submod against the selected reference for half a second and measures how long that takes. The game will freeze while the benchmark is running. The results are also written to the log, so they can be compared between versions or with different settings.\n\nSaving a result as the baseline writes it to 'Documents\\My Games\\Skyrim Special Edition\\SKSE\\OpenAnimationReplacer_BenchmarkBaseline.json'. Later runs are compared against it, and metrics that got worse by more than the tolerances in that file are marked as regressions.");
+
+		if (!_conditionBenchmarkResult) {
+			return;
+		}
+
+		const auto& result = *_conditionBenchmarkResult;
+
+		ImGui::Text("Reference: %08X, condition reordering %s", result.refrFormID, result.bReorderConditions ? "enabled" : "disabled");
+		ImGui::Text("%u submods, %u passes, %llu evaluations (%.1f%% passed) in %.3f s", result.subModCount, result.passCount, result.evaluations, result.evaluations ? 100.0 * result.passedEvaluations / result.evaluations : 0.0, result.totalTime);
+		ImGui::Text("%.0f evaluations per second", result.GetEvaluationsPerSecond());
+		ImGui::Text("Latency (us): p50 %.2f, p90 %.2f, p99 %.2f, max %.2f", result.p50 / 1e3, result.p90 / 1e3, result.p99 / 1e3, result.max / 1e3);
+
+		if (!result.slowestSubMods.empty() && ImGui::BeginTable("BenchmarkSlowestSubMods", 3, ImGuiTableFlags_NoSavedSettings | ImGuiTableFlags_BordersOuter | ImGuiTableFlags_RowBg)) {
+			ImGui::TableSetupColumn("Mod", ImGuiTableColumnFlags_WidthStretch);
+			ImGui::TableSetupColumn("Submod", ImGuiTableColumnFlags_WidthStretch);
+			ImGui::TableSetupColumn("Avg (us)", ImGuiTableColumnFlags_WidthFixed, 65.f);
+			ImGui::TableHeadersRow();
+
+			for (const auto& subModResult : result.slowestSubMods) {
+				ImGui::TableNextRow();
+				ImGui::TableNextColumn();
+				UICommon::TextUnformattedEllipsis(subModResult.modName.data());
+				ImGui::TableNextColumn();
+				UICommon::TextUnformattedEllipsis(subModResult.subModName.data());
+				ImGui::TableNextColumn();
+				ImGui::Text("%.2f", subModResult.averageTime / 1e3);
+			}
+
+			ImGui::EndTable();
+		}
+
+		if (_conditionBenchmarkComparison) {
+			const auto& comparison = *_conditionBenchmarkComparison;
+
+			ImGui::Spacing();
+			if (comparison.HasRegressions()) {
+				ImGui::TextColored(UICommon::ERROR_TEXT_COLOR, "Regressed compared to the baseline!");
+			} else {
+				ImGui::TextColored(UICommon::SUCCESS_COLOR, "Within the tolerances of the baseline.");
+			}
+			if (!comparison.bSameSetup) {
+				ImGui::TextColored(UICommon::WARNING_TEXT_COLOR, "The baseline was saved with a different number of submods or condition reordering setting.");
+			}
+
+			if (ImGui::BeginTable("BenchmarkBaselineComparison", 4, ImGuiTableFlags_NoSavedSettings | ImGuiTableFlags_BordersOuter | ImGuiTableFlags_RowBg)) {
+				ImGui::TableSetupColumn("Metric", ImGuiTableColumnFlags_WidthStretch);
+				ImGui::TableSetupColumn("Baseline", ImGuiTableColumnFlags_WidthFixed, 80.f);
+				ImGui::TableSetupColumn("Current", ImGuiTableColumnFlags_WidthFixed, 80.f);
+				ImGui::TableSetupColumn("Change", ImGuiTableColumnFlags_WidthFixed, 65.f);
+				ImGui::TableHeadersRow();
+
+				for (const auto& metric : comparison.metrics) {
+					ImGui::TableNextRow();
+					ImGui::TableNextColumn();
+					ImGui::TextUnformatted(metric.name.data(), metric.name.data() + metric.name.length());
+					ImGui::TableNextColumn();
+					ImGui::Text("%.1f", metric.baseline);
+					ImGui::TableNextColumn();
+					ImGui::Text("%.1f", metric.current);
+					ImGui::TableNextColumn();
+					if (metric.bRegressed) {
+						ImGui::TextColored(UICommon::ERROR_TEXT_COLOR, "%+.1f%%", metric.GetChange() * 100.0);
+					} else {
+						ImGui::Text("%+.1f%%", metric.GetChange() * 100.0);
+					}
+				}
+
+				ImGui::EndTable();
+			}
+		}
+
+		ImGui::Spacing();
+	}
+
+	void UIMain::DrawTraceReplay()
+	{
+		if (!ImGui::CollapsingHeader("Trace replay")) {
+			return;
+		}
+
+		ImGui::BeginDisabled(Settings::bRecordAnimationTrace);
+		if (ImGui::Button("Replay animation trace")) {
+			_traceReplayError.clear();
+			_traceReplayResult = AnimationTraceReplay::Replay(_traceReplayError);
+		}
+		ImGui::EndDisabled();
+		ImGui::SameLine();
+		UICommon::HelpMarker("Re-evaluates the conditions for every animation event in the recorded animation trace, using the references from the trace in their current state. Compares the time spent with the recorded time, and the chosen replacement animations with the recorded ones. Only the replacements are recorded, not the game state the conditions read, so differences from the recording are expected if the game state changed since. Random rolls are seeded per event, and each replay is compared with the previous replay of the same trace, so replaying again with different settings or mods without changing the game state shows what they changed. Stop recording the trace first. The game will freeze while the replay is running.");
+
+		if (!_traceReplayError.empty()) {
+			ImGui::TextColored(UICommon::ERROR_TEXT_COLOR, "Replay failed: %s", _traceReplayError.data());
+		}
+
+		if (!_traceReplayResult) {
+			return;
+		}
+
+		const auto& result = *_traceReplayResult;
+
+		ImGui::Text("%zu events, %zu replayed%s", result.events, result.replayed, result.bTruncated ? " (trace is truncated)" : "");
+		ImGui::Text("Skipped: %zu not evaluated, %zu missing project, %zu missing reference, %zu inactive clip", result.skippedNotEvaluated, result.skippedMissingProject, result.skippedMissingRefr, result.skippedInactiveClip);
+		ImGui::Text("Evaluation time: %.3f ms recorded, %.3f ms replayed", result.recordedEvaluationTime / 1e6, result.replayedEvaluationTime / 1e6);
+		ImGui::Text("Activations matching the recording: %zu / %zu (%.1f%%)", result.matched, result.compared, result.GetMatchRate() * 100.0);
+		DrawTraceReplayMismatches("TraceReplayMismatches", "Recorded", result.mismatches);
+
+		if (result.bHasPreviousReplay) {
+			ImGui::Text("Events matching the previous replay: %zu / %zu", result.matchedPreviousReplay, result.comparedWithPreviousReplay);
+			DrawTraceReplayMismatches("TraceReplayPreviousMismatches", "Previous replay", result.previousReplayMismatches);
+		} else {
+			ImGui::TextUnformatted("Replay again to compare with this replay.");
+		}
+
+		ImGui::Spacing();
+	}
+
+	void UIMain::DrawTraceReplayMismatches(const char* a_tableId, const char* a_comparedColumnName, const std::vector<AnimationTraceReplay::Mismatch>& a_mismatches)
+	{
+		if (!a_mismatches.empty() && ImGui::BeginTable(a_tableId, 4, ImGuiTableFlags_NoSavedSettings | ImGuiTableFlags_BordersOuter | ImGuiTableFlags_RowBg | ImGuiTableFlags_ScrollY, ImVec2(0.f, ImGui::GetTextLineHeightWithSpacing() * 10))) {
+			ImGui::TableSetupColumn("Reference", ImGuiTableColumnFlags_WidthFixed, 70.f);
+			ImGui::TableSetupColumn("Animation", ImGuiTableColumnFlags_WidthStretch);
+			ImGui::TableSetupColumn(a_comparedColumnName, ImGuiTableColumnFlags_WidthStretch);
+			ImGui::TableSetupColumn("Replayed", ImGuiTableColumnFlags_WidthStretch);
+			ImGui::TableSetupScrollFreeze(0, 1);
+			ImGui::TableHeadersRow();
+
+			for (const auto& mismatch : a_mismatches) {
+				ImGui::TableNextRow();
+				ImGui::TableNextColumn();
+				ImGui::Text("%08X", mismatch.refrFormID);
+				ImGui::TableNextColumn();
+				UICommon::TextUnformattedEllipsis(mismatch.animationName.data());
+				ImGui::TableNextColumn();
+				UICommon::TextUnformattedEllipsis(mismatch.recordedReplacement.data());
+				ImGui::TableNextColumn();
+				UICommon::TextUnformattedEllipsis(mismatch.replayedReplacement.data());
+			}
+
+			ImGui::EndTable();
+		}
+	}
+
+	void UIMain::DrawLockProfiler()
+	{
+		if (!ImGui::CollapsingHeader("Locks")) {
+			return;
+		}
+
+		if (ImGui::Checkbox("Profile locks", &Settings::bProfileLocks)) {
+			LockProfiler::SetEnabled(Settings::bProfileLocks);
+			Settings::WriteSettings();
+		}
+		ImGui::SameLine();
+		UICommon::HelpMarker("Enable to count how often each lock is acquired, how often a thread had to wait for it and for how long. Locks with the same name are counted together, e.g. the locks of all condition sets. Has a performance cost while enabled.");
+
+		ImGui::SameLine();
+		if (ImGui::Button("Reset##Locks")) {
+			LockProfiler::Reset();
+		}
+
+		ImGui::SameLine();
+		if (ImGui::Button("Export CSV##Locks")) {
+			if (auto path = logger::log_directory()) {
+				*path /= std::format("{}_Locks.csv", Plugin::NAME);
+				LockProfiler::ExportCSV(*path);
+			}
+		}
+
+		auto snapshots = LockProfiler::GetSnapshots();
+		std::erase_if(snapshots, [](const auto& a_snapshot) { return a_snapshot.acquisitions == 0; });
+		std::ranges::sort(snapshots, [](const auto& a_lhs, const auto& a_rhs) { return a_lhs.totalWaitTime > a_rhs.totalWaitTime; });
+
+		if (snapshots.empty()) {
+			UICommon::TextUnformattedDisabled(Settings::bProfileLocks ? "No data collected yet" : "Lock profiling is disabled");
+			return;
+		}
+
+		if (ImGui::BeginTable("LockProfiler", 7, ImGuiTableFlags_NoSavedSettings | ImGuiTableFlags_BordersOuter | ImGuiTableFlags_RowBg | ImGuiTableFlags_Resizable | ImGuiTableFlags_ScrollY, ImVec2(0.f, ImGui::GetTextLineHeightWithSpacing() * 15))) {
+			ImGui::TableSetupColumn("Lock", ImGuiTableColumnFlags_WidthStretch);
+			ImGui::TableSetupColumn("Acquisitions", ImGuiTableColumnFlags_WidthFixed, 85.f);
+			ImGui::TableSetupColumn("Contended", ImGuiTableColumnFlags_WidthFixed, 75.f);
+			ImGui::TableSetupColumn("Rate", ImGuiTableColumnFlags_WidthFixed, 55.f);
+			ImGui::TableSetupColumn("Wait (ms)", ImGuiTableColumnFlags_WidthFixed, 70.f);
+			ImGui::TableSetupColumn("Avg (us)", ImGuiTableColumnFlags_WidthFixed, 65.f);
+			ImGui::TableSetupColumn("Max (us)", ImGuiTableColumnFlags_WidthFixed, 65.f);
+			ImGui::TableSetupScrollFreeze(0, 1);
+			ImGui::TableHeadersRow();
+
+			for (const auto& snapshot : snapshots) {
+				ImGui::TableNextRow();
+				ImGui::TableNextColumn();
+				UICommon::TextUnformattedEllipsisNoTooltip(snapshot.name.data(), nullptr, 0.f);
+				if (ImGui::IsItemHovered(ImGuiHoveredFlags_DelayNormal)) {
+					// wait time histogram, the first bucket also contains the uncontended acquisitions so it's left out
+					std::array<float, LockProfiler::kHistogramBucketCount - 1> buckets{};
+					for (size_t i = 1; i < LockProfiler::kHistogramBucketCount; ++i) {
+						buckets[i - 1] = static_cast<float>(snapshot.waitTimeHistogram[i]);
+					}
+					ImGui::BeginTooltip();
+					ImGui::TextUnformatted(snapshot.name.data());
+					ImGui::PlotHistogram("##WaitTimes", buckets.data(), static_cast<int>(buckets.size()), 0, "Wait time, 1us to 16ms+", 0.f, FLT_MAX, ImVec2(300.f, 80.f));
+					ImGui::EndTooltip();
+				}
+				ImGui::TableNextColumn();
+				ImGui::Text("%llu", snapshot.acquisitions);
+				ImGui::TableNextColumn();
+				ImGui::Text("%llu", snapshot.contendedAcquisitions);
+				ImGui::TableNextColumn();
+				ImGui::Text("%.2f%%", snapshot.GetContendedRate() * 100.0);
+				ImGui::TableNextColumn();
+				ImGui::Text("%.2f", snapshot.totalWaitTime / 1e6);
+				ImGui::TableNextColumn();
+				ImGui::Text("%.2f", snapshot.GetAverageWaitTime() / 1e3);
+				ImGui::TableNextColumn();
+				ImGui::Text("%.2f", snapshot.maxWaitTime / 1e3);
+			}
+
+			ImGui::EndTable();
+		}
+	}
+
+	void UIMain::DrawHookProfiler()
+	{
+		if (!ImGui::CollapsingHeader("Hooks")) {
+			return;
+		}
+
+		if (ImGui::Checkbox("Profile hooks", &Settings::bProfileHooks)) {
+			HookProfiler::SetEnabled(Settings::bProfileHooks);
+			Settings::WriteSettings();
+		}
+		ImGui::SameLine();
+		UICommon::HelpMarker("Enable to measure how much frame time is spent in each of the animation hooks, split into the time spent by Open Animation Replacer itself and the time spent in the original game function. Values are averaged over the last frames. The original time of the behavior graph hooks includes the clip generator hooks called inside them. Has a small performance cost while enabled.");
+
+		ImGui::SameLine();
+		if (ImGui::Button("Reset##Hooks")) {
+			HookProfiler::Reset();
+		}
+
+		const auto summary = HookProfiler::GetSummary();
+		if (summary.frameCount == 0) {
+			UICommon::TextUnformattedDisabled(Settings::bProfileHooks ? "No data collected yet" : "Hook profiling is disabled");
+			return;
+		}
+
+		const double frameCount = static_cast<double>(summary.frameCount);
+		const auto overlay = std::format("Own time: {:.3f} ms/frame over {} frames", summary.GetAverageOwnTimePerFrame() / 1e6, summary.frameCount);
+		ImGui::PlotLines("##OwnTimePerFrame", summary.ownTimePerFrame.data(), static_cast<int>(summary.ownTimePerFrame.size()), 0, overlay.data(), 0.f, FLT_MAX, ImVec2(-FLT_MIN, 60.f));
+
+		if (ImGui::BeginTable("HookProfiler", 6, ImGuiTableFlags_NoSavedSettings | ImGuiTableFlags_BordersOuter | ImGuiTableFlags_RowBg | ImGuiTableFlags_Resizable)) {
+			ImGui::TableSetupColumn("Hook", ImGuiTableColumnFlags_WidthStretch);
+			ImGui::TableSetupColumn("Calls/frame", ImGuiTableColumnFlags_WidthFixed, 80.f);
+			ImGui::TableSetupColumn("Own (ms/frame)", ImGuiTableColumnFlags_WidthFixed, 100.f);
+			ImGui::TableSetupColumn("Original (ms/frame)", ImGuiTableColumnFlags_WidthFixed, 120.f);
+			ImGui::TableSetupColumn("Own (%)", ImGuiTableColumnFlags_WidthFixed, 60.f);
+			ImGui::TableSetupColumn("Max (us)", ImGuiTableColumnFlags_WidthFixed, 65.f);
+			ImGui::TableHeadersRow();
+
+			for (size_t i = 0; i < HookProfiler::kHookCount; ++i) {
+				const auto& stats = summary.hooks[i];
+
+				ImGui::TableNextRow();
+				ImGui::TableNextColumn();
+				const auto hookName = HookProfiler::GetHookName(static_cast<HookProfiler::Hook>(i));
+				ImGui::TextUnformatted(hookName.data(), hookName.data() + hookName.size());
+				ImGui::TableNextColumn();
+				ImGui::Text("%.1f", stats.calls / frameCount);
+				ImGui::TableNextColumn();
+				ImGui::Text("%.3f", stats.GetOwnTime() / 1e6 / frameCount);
+				ImGui::TableNextColumn();
+				ImGui::Text("%.3f", stats.originalTime / 1e6 / frameCount);
+				ImGui::TableNextColumn();
+				ImGui::Text("%.1f%%", stats.totalTime ? static_cast<double>(stats.GetOwnTime()) / stats.totalTime * 100.0 : 0.0);
+				ImGui::TableNextColumn();
+				ImGui::Text("%.2f", stats.maxTime / 1e3);
+			}
+
+			ImGui::EndTable();
+		}
+	}
+
+	void UIMain::DrawAnimationResidency()
+	{
+		if (!ImGui::CollapsingHeader("Animation residency")) {
+			return;
+		}
+
+		if (Settings::bPrefetchAnimations) {
+			const auto prefetcherStats = AnimationPrefetcher::GetSingleton().GetStats();
+			ImGui::Text("Prefetched %llu animations for %llu state changes, %u currently held", prefetcherStats.prefetchedAnimations, prefetcherStats.evaluations, prefetcherStats.heldAnimations);
+		}
+
+		if (Settings::bFilterOutDuplicateAnimations) {
+			const auto contentStats = AnimationContentRegistry::GetSingleton().GetStats();
+			ImGui::Text("Duplicate filtering: %u identical files not loaded, saving %s", contentStats.filteredFiles, MemoryReport::FormatBytes(contentStats.filteredBytes).data());
+			ImGui::Text("%u files are used by more than one project, their extra copies take %s", contentStats.crossProjectFiles, MemoryReport::FormatBytes(contentStats.crossProjectBytes).data());
+			ImGui::SameLine();
+			UICommon::HelpMarker("Identical replacement animation files are only loaded once per behavior project. Every project loads its own copy of an animation though, as the game binds the animations separately for each project, so identical files used by several projects (e.g. male and female) can't be shared.");
+		}
+
+		if (!Settings::bEvictUnusedAnimations) {
+			UICommon::TextUnformattedDisabled("Evicting unused animations is disabled");
+			ImGui::Spacing();
+			return;
+		}
+
+		if (ImGui::BeginTable("AnimationResidency", 4, ImGuiTableFlags_NoSavedSettings | ImGuiTableFlags_BordersOuter | ImGuiTableFlags_RowBg)) {
+			ImGui::TableSetupColumn("Project", ImGuiTableColumnFlags_WidthStretch);
+			ImGui::TableSetupColumn("Preloaded", ImGuiTableColumnFlags_WidthFixed, 70.f);
+			ImGui::TableSetupColumn("Evicted", ImGuiTableColumnFlags_WidthFixed, 70.f);
+			ImGui::TableSetupColumn("Saved", ImGuiTableColumnFlags_WidthFixed, 80.f);
+			ImGui::TableHeadersRow();
+
+			ReplacerProjectData::ResidencyStats totalStats;
+			OpenAnimationReplacer::GetSingleton().ForEachReplacerProjectData([&](RE::hkbCharacterStringData* a_stringData, ReplacerProjectData* a_replacerProjectData) {
+				const auto stats = a_replacerProjectData->GetResidencyStats();
+				if (stats.preloaded == 0 && stats.evicted == 0) {
+					return;
+				}
+
+				totalStats.preloaded += stats.preloaded;
+				totalStats.evicted += stats.evicted;
+				totalStats.evictedBytes += stats.evictedBytes;
+
+				ImGui::TableNextRow();
+				ImGui::TableNextColumn();
+				UICommon::TextUnformattedEllipsis(a_stringData->name.data());
+				ImGui::TableNextColumn();
+				ImGui::Text("%u", stats.preloaded);
+				ImGui::TableNextColumn();
+				ImGui::Text("%u", stats.evicted);
+				ImGui::TableNextColumn();
+				ImGui::TextUnformatted(MemoryReport::FormatBytes(stats.evictedBytes).data());
+			});
+
+			ImGui::TableNextRow();
+			ImGui::TableNextColumn();
+			ImGui::TextUnformatted("Total");
+			ImGui::TableNextColumn();
+			ImGui::Text("%u", totalStats.preloaded);
+			ImGui::TableNextColumn();
+			ImGui::Text("%u", totalStats.evicted);
+			ImGui::TableNextColumn();
+			ImGui::TextUnformatted(MemoryReport::FormatBytes(totalStats.evictedBytes).data());
+
+			ImGui::EndTable();
+		}
+
+		ImGui::Spacing();
+	}
+
+	void UIMain::DrawMemoryReport()
+	{
+		if (!ImGui::CollapsingHeader("Memory")) {
+			return;
+		}
+
+		if (ImGui::Button("Collect##Memory")) {
+			_memoryReport = MemoryReport::Collect();
+		}
+		ImGui::SameLine();
+		UICommon::HelpMarker("Estimate the memory used by the data of Open Animation Replacer, broken down by replacer mod, submod and behavior project. The estimate is based on object sizes and container capacities, so the real usage is somewhat higher. Replacement animations are counted in their submods, the projects only contain their lookup tables.");
+
+		if (!_memoryReport) {
+			return;
+		}
+
+		const auto& report = *_memoryReport;
+
+		ImGui::SameLine();
+		if (ImGui::Button("Export JSON##Memory")) {
+			if (auto path = logger::log_directory()) {
+				*path /= std::format("{}_Memory.json", Plugin::NAME);
+				MemoryReport::ExportJSON(report, *path);
+			}
+		}
+		ImGui::SameLine();
+		UICommon::HelpMarker("Export the report to 'Documents\\My Games\\Skyrim Special Edition\\SKSE\\OpenAnimationReplacer_Memory.json'.");
+
+		ImGui::Text("Total: %s", MemoryReport::FormatBytes(report.GetTotal()).data());
+
+		constexpr ImGuiTableFlags tableFlags = ImGuiTableFlags_NoSavedSettings | ImGuiTableFlags_BordersOuter | ImGuiTableFlags_RowBg | ImGuiTableFlags_Resizable;
+
+		auto setupUsageColumns = []() {
+			ImGui::TableSetupColumn("Total", ImGuiTableColumnFlags_WidthFixed, 70.f);
+			ImGui::TableSetupColumn("Strings", ImGuiTableColumnFlags_WidthFixed, 70.f);
+			ImGui::TableSetupColumn("Conditions", ImGuiTableColumnFlags_WidthFixed, 70.f);
+			ImGui::TableSetupColumn("Replacements", ImGuiTableColumnFlags_WidthFixed, 85.f);
+			ImGui::TableSetupColumn("Index maps", ImGuiTableColumnFlags_WidthFixed, 70.f);
+			ImGui::TableSetupColumn("Other", ImGuiTableColumnFlags_WidthFixed, 70.f);
+		};
+
+		auto drawUsageColumns = [](const MemoryReport::Usage& a_usage) {
+			for (const size_t bytes : { a_usage.GetTotal(), a_usage.strings, a_usage.conditions, a_usage.replacementAnimations, a_usage.indexMaps, a_usage.other }) {
+				ImGui::TableNextColumn();
+				ImGui::TextUnformatted(MemoryReport::FormatBytes(bytes).data());
+			}
+		};
+
+		if (ImGui::BeginTable("MemoryGlobals", 3, tableFlags)) {
+			ImGui::TableSetupColumn("Data", ImGuiTableColumnFlags_WidthStretch);
+			ImGui::TableSetupColumn("Count", ImGuiTableColumnFlags_WidthFixed, 70.f);
+			ImGui::TableSetupColumn("Total", ImGuiTableColumnFlags_WidthFixed, 70.f);
+			ImGui::TableHeadersRow();
+
+			auto drawRow = [](std::string_view a_name, size_t a_count, size_t a_bytes) {
+				ImGui::TableNextRow();
+				ImGui::TableNextColumn();
+				ImGui::TextUnformatted(a_name.data(), a_name.data() + a_name.size());
+				ImGui::TableNextColumn();
+				ImGui::Text("%zu", a_count);
+				ImGui::TableNextColumn();
+				ImGui::TextUnformatted(MemoryReport::FormatBytes(a_bytes).data());
+			};
+
+			drawRow("Replacer mods"sv, report.mods.size(), report.GetModsUsage().GetTotal());
+			drawRow("Projects"sv, report.projects.size(), report.GetProjectsUsage().GetTotal());
+			for (const auto& global : report.globals) {
+				drawRow(global.name, global.count, global.bytes);
+			}
+
+			ImGui::EndTable();
+		}
+
+		if (ImGui::TreeNode("Replacer mods##Memory")) {
+			if (ImGui::BeginTable("MemoryMods", 8, tableFlags | ImGuiTableFlags_ScrollY, ImVec2(0.f, ImGui::GetTextLineHeightWithSpacing() * 15))) {
+				ImGui::TableSetupColumn("Name", ImGuiTableColumnFlags_WidthStretch);
+				ImGui::TableSetupColumn("Animations", ImGuiTableColumnFlags_WidthFixed, 75.f);
+				setupUsageColumns();
+				ImGui::TableSetupScrollFreeze(0, 1);
+				ImGui::TableHeadersRow();
+
+				for (const auto& mod : report.mods) {
+					ImGui::TableNextRow();
+					ImGui::TableNextColumn();
+					const bool bNodeOpen = ImGui::TreeNodeEx(&mod, ImGuiTreeNodeFlags_SpanFullWidth, "%s", mod.name.data());
+					ImGui::TableNextColumn();
+					size_t replacementAnimationCount = 0;
+					for (const auto& subMod : mod.subMods) {
+						replacementAnimationCount += subMod.replacementAnimationCount;
+					}
+					ImGui::Text("%zu", replacementAnimationCount);
+					drawUsageColumns(mod.usage);
+
+					if (bNodeOpen) {
+						for (const auto& subMod : mod.subMods) {
+							ImGui::TableNextRow();
+							ImGui::TableNextColumn();
+							ImGui::TreeNodeEx(&subMod, ImGuiTreeNodeFlags_SpanFullWidth | ImGuiTreeNodeFlags_Leaf | ImGuiTreeNodeFlags_NoTreePushOnOpen, "%s", subMod.name.data());
+							ImGui::TableNextColumn();
+							ImGui::Text("%zu", subMod.replacementAnimationCount);
+							drawUsageColumns(subMod.usage);
+						}
+						ImGui::TreePop();
+					}
+				}
+
+				ImGui::EndTable();
+			}
+			ImGui::TreePop();
+		}
+
+		if (ImGui::TreeNode("Projects##Memory")) {
+			if (ImGui::BeginTable("MemoryProjects", 8, tableFlags)) {
+				ImGui::TableSetupColumn("Project", ImGuiTableColumnFlags_WidthStretch);
+				ImGui::TableSetupColumn("Replaced", ImGuiTableColumnFlags_WidthFixed, 75.f);
+				setupUsageColumns();
+				ImGui::TableHeadersRow();
+
+				for (const auto& project : report.projects) {
+					ImGui::TableNextRow();
+					ImGui::TableNextColumn();
+					ImGui::TextUnformatted(project.name.data());
+					ImGui::TableNextColumn();
+					ImGui::Text("%zu", project.animationReplacementsCount);
+					drawUsageColumns(project.usage);
+				}
+
+				ImGui::EndTable();
+			}
+			ImGui::TreePop();
+		}
+	}
+
 	bool UIMain::DrawConditionSet(Conditions::ConditionSet* a_conditionSet, ConditionEditMode a_editMode, RE::TESObjectREFR* a_refrToEvaluate, bool a_bDrawLines, const ImVec2& a_drawStartPos)
 	{
 		//ImGui::TableNextRow();
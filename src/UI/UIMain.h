@@ -1,6 +1,10 @@
 #pragma once
 #include "UIWindow.h"
 
+#include "AnimationTraceReplay.h"
+#include "ConditionBenchmark.h"
+#include "EvaluationProfiler.h"
+#include "MemoryReport.h"
 #include "OpenAnimationReplacer.h"
 #include <imgui_internal.h>
 
@@ -98,6 +102,14 @@ namespace UI
 		void DrawSubMod(ReplacerMod* a_replacerMod, SubMod* a_subMod, bool a_bAddPathToName = false);
 		void DrawReplacementAnimations();
 		void DrawReplacementAnimation(ReplacementAnimation* a_replacementAnimation);
+		void DrawPerformance();
+		void DrawConditionBenchmark();
+		void DrawTraceReplay();
+		void DrawTraceReplayMismatches(const char* a_tableId, const char* a_comparedColumnName, const std::vector<AnimationTraceReplay::Mismatch>& a_mismatches);
+		void DrawLockProfiler();
+		void DrawHookProfiler();
+		void DrawMemoryReport();
+		void DrawAnimationResidency();
 		bool DrawConditionSet(Conditions::ConditionSet* a_conditionSet, ConditionEditMode a_editMode, RE::TESObjectREFR* a_refrToEvaluate, bool a_bDrawLines, const ImVec2& a_drawStartPos);
 		ImRect DrawCondition(std::unique_ptr<Conditions::ICondition>& a_condition, Conditions::ConditionSet* a_conditionSet, ConditionEditMode a_editMode, RE::TESObjectREFR* a_refrToEvaluate, bool& a_bOutSetDirty);
 		ImRect DrawBlankCondition(Conditions::ConditionSet* a_conditionSet, ConditionEditMode a_editMode);
@@ -125,6 +137,17 @@ namespace UI
 
 		bool _bShowSettings = false;
 
+		// performance tab, collected periodically as it walks through every condition
+		static constexpr float kPerformanceRefreshInterval = 0.5f;
+		float _performanceRefreshTimer = 0.f;
+		std::vector<EvaluationProfiler::SubModEntry> _performanceSubModEntries{};
+		std::vector<EvaluationProfiler::ConditionEntry> _performanceConditionEntries{};
+		std::optional<ConditionBenchmark::Result> _conditionBenchmarkResult = std::nullopt;
+		std::optional<ConditionBenchmark::Comparison> _conditionBenchmarkComparison = std::nullopt;
+		std::optional<AnimationTraceReplay::Result> _traceReplayResult = std::nullopt;
+		std::string _traceReplayError;
+		std::optional<MemoryReport::Report> _memoryReport = std::nullopt;
+
 		// modified from imgui so it allows setting tooltip size
 		static bool BeginDragDropSourceEx(ImGuiDragDropFlags a_flags = 0, ImVec2 a_tooltipSize = ImVec2(0, 0));
 
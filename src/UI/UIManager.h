@@ -89,7 +89,7 @@ namespace UI
 
 		std::array<std::unique_ptr<UIWindow>, static_cast<size_t>(WindowID::kMax)> _windows;
 
-		mutable SharedLock _inputEventLock;
+		mutable SharedLock _inputEventLock{ "UIManager::_inputEventLock" };
 		std::vector<KeyEvent> _keyEventQueue{};
 		bool _bFocusLost = false;
 
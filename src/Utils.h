@@ -32,7 +32,41 @@ namespace Utils
 	[[nodiscard]] std::string GetFormKeywords(RE::TESForm* a_form);
 	[[nodiscard]] std::string GetFormKeywords(RE::BGSKeywordForm* a_keywordForm);
 
-	[[nodiscard]] inline float GetRandomFloat(float a_min, float a_max) { return effolkronium::random_static::get<float>(a_min, a_max); }
+	namespace detail
+	{
+		inline thread_local std::mt19937_64* seededRandomEngine = nullptr;
+	}
+
+	// while alive, GetRandomFloat on this thread draws from an engine with the given seed instead of the shared one, so the rolls can be reproduced (e.g. by the trace replay)
+	class ScopedRandomSeed
+	{
+	public:
+		explicit ScopedRandomSeed(uint64_t a_seed) :
+			_engine(a_seed),
+			_previousEngine(std::exchange(detail::seededRandomEngine, &_engine))
+		{}
+
+		~ScopedRandomSeed() { detail::seededRandomEngine = _previousEngine; }
+
+		ScopedRandomSeed(const ScopedRandomSeed&) = delete;
+		ScopedRandomSeed(ScopedRandomSeed&&) = delete;
+		ScopedRandomSeed& operator=(const ScopedRandomSeed&) = delete;
+		ScopedRandomSeed& operator=(ScopedRandomSeed&&) = delete;
+
+	private:
+		std::mt19937_64 _engine;
+		std::mt19937_64* _previousEngine;
+	};
+
+	[[nodiscard]] inline float GetRandomFloat(float a_min, float a_max)
+	{
+		if (detail::seededRandomEngine) {
+			const auto [min, max] = std::minmax(a_min, a_max);
+			return std::uniform_real_distribution<float>(min, max)(*detail::seededRandomEngine);
+		}
+
+		return effolkronium::random_static::get<float>(a_min, a_max);
+	}
 
 	[[nodiscard]] inline RE::Actor* GetActorFromHkbCharacter(RE::hkbCharacter* a_hkbCharacter)
 	{
@@ -135,4 +169,75 @@ namespace Utils
 			return form->Is(T::FORMTYPE) ? static_cast<T*>(form) : nullptr;
 		}
 	}
+
+	// fixed-capacity lock-free ring buffer, many producers and a single consumer. Each slot carries a sequence number that tells the producers and the consumer whose turn it is.
+	// pushing into a full buffer fails instead of blocking or allocating
+	template <class T, size_t Capacity>
+	class MPSCRingBuffer
+	{
+		static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+	public:
+		MPSCRingBuffer()
+		{
+			for (size_t i = 0; i < Capacity; ++i) {
+				_slots[i].sequence.store(i, std::memory_order_relaxed);
+			}
+		}
+
+		MPSCRingBuffer(const MPSCRingBuffer&) = delete;
+		MPSCRingBuffer(MPSCRingBuffer&&) = delete;
+		MPSCRingBuffer& operator=(const MPSCRingBuffer&) = delete;
+		MPSCRingBuffer& operator=(MPSCRingBuffer&&) = delete;
+
+		bool TryPush(T&& a_value)
+		{
+			size_t pos = _writePos.load(std::memory_order_relaxed);
+			while (true) {
+				Slot& slot = _slots[pos & (Capacity - 1)];
+				const size_t sequence = slot.sequence.load(std::memory_order_acquire);
+				const auto diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+				if (diff == 0) {
+					if (_writePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+						slot.value = std::move(a_value);
+						slot.sequence.store(pos + 1, std::memory_order_release);
+						return true;
+					}
+				} else if (diff < 0) {
+					return false;  // full
+				} else {
+					pos = _writePos.load(std::memory_order_relaxed);
+				}
+			}
+		}
+
+		// consumer thread only
+		bool TryPop(T& a_outValue)
+		{
+			const size_t pos = _readPos.load(std::memory_order_relaxed);
+			Slot& slot = _slots[pos & (Capacity - 1)];
+			if (slot.sequence.load(std::memory_order_acquire) != pos + 1) {
+				return false;
+			}
+
+			a_outValue = std::move(slot.value);
+			slot.value = T{};
+			slot.sequence.store(pos + Capacity, std::memory_order_release);
+			_readPos.store(pos + 1, std::memory_order_relaxed);
+			return true;
+		}
+
+		[[nodiscard]] bool IsEmpty() const { return _writePos.load(std::memory_order_acquire) == _readPos.load(std::memory_order_acquire); }
+
+	private:
+		struct Slot
+		{
+			std::atomic<size_t> sequence;
+			T value{};
+		};
+
+		std::array<Slot, Capacity> _slots;
+		alignas(64) std::atomic<size_t> _writePos = 0;
+		alignas(64) std::atomic<size_t> _readPos = 0;
+	};
 }
@@ -1,6 +1,8 @@
+#include "HookProfiler.h"
 #include "Hooks.h"
 #include "OpenAnimationReplacer.h"
 #include "Settings.h"
+#include "StartupTrace.h"
 #include "UI/UIManager.h"
 
 #include "API/OpenAnimationReplacerAPI-Animations.h"
@@ -132,6 +134,13 @@ extern "C" DLLEXPORT bool SKSEAPI SKSEPlugin_Load(const SKSE::LoadInterface* a_s
 	Settings::Initialize();
 	Settings::ReadSettings();
 
+	if (Settings::bRecordStartupTrace) {
+		StartupTrace::GetSingleton().StartRecording();
+	}
+
+	LockProfiler::SetEnabled(Settings::bProfileLocks);
+	HookProfiler::SetEnabled(Settings::bProfileHooks);
+
 	Hooks::Install();
 
 	return true;
@@ -0,0 +1,337 @@
+// Benchmarks the animation file hash cache without the game: writing and reading the cache file and looking up the cached hashes, through the same code as AnimationFileHashCache (AnimationFileHashCacheFormat.h)
+// The cache is filled with generated paths of OAR animations, some of the lookups are for files that changed since they were hashed or were never hashed
+// Hashing the animation files themselves (SHA-256 from Crypto++) isn't measured, the host build doesn't have the library
+// Usage:
+//     AnimationFileHashCacheBenchmark [--entries N] [--passes N] [--seed N] [--save-baseline <file>]
+//     AnimationFileHashCacheBenchmark --baseline <file>
+// With --baseline, runs with the setup saved in the AnimationFileHashCacheBenchmark section of the baseline (BenchmarkBaseline.json) and exits with 1 if the result changed
+// Only the machine independent metrics are compared, the time is too noisy to gate on
+
+#include "AnimationFileHashCacheFormat.h"
+#include "BenchmarkBaseline.h"
+#include "ConditionBenchmarkComparison.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+	// the same as CachedAnimationHash in AnimationFileHashCache.h
+	struct CachedAnimationHash
+	{
+		uint64_t lastWriteTime;
+		uint64_t fileSize;
+		std::string hash;
+	};
+
+	using Cache = std::unordered_map<std::string, CachedAnimationHash>;
+
+	struct Setup
+	{
+		size_t entries = 20000;  // a big mod list has tens of thousands of replacement animations
+		size_t passes = 20;
+		uint32_t seed = 1;
+	};
+
+	struct Result
+	{
+		uint64_t fileBytes = 0;
+		uint64_t readEntries = 0;
+		uint64_t hits = 0;
+		uint64_t outdated = 0;  // the file changed since it was hashed
+		uint64_t misses = 0;
+		double bytesPerEntry = 0.0;
+	};
+
+	struct Baseline
+	{
+		Setup setup;
+		Result result;
+		double tolerance = 0.0;  // nothing here depends on timing
+	};
+
+	constexpr const char* kBaselineSection = "AnimationFileHashCacheBenchmark";
+
+	struct Lookup
+	{
+		std::string path;
+		uint64_t lastWriteTime;
+		uint64_t fileSize;
+	};
+
+	// paths like the ones ReplacementAnimation hashes, with a SHA-256 sized hash
+	Cache GenerateCache(size_t a_entries, std::mt19937& a_rng)
+	{
+		Cache cache;
+		cache.reserve(a_entries);
+
+		char path[256];
+		for (size_t i = 0; i < a_entries; ++i) {
+			std::snprintf(path, sizeof(path), "Data\\meshes\\actors\\character\\animations\\OpenAnimationReplacer\\Mod %u\\Submod %u\\animation_%zu.hkx", static_cast<unsigned>(a_rng() % 300), static_cast<unsigned>(a_rng() % 20), i);
+
+			std::string hash(32, '\0');
+			for (auto& byte : hash) {
+				byte = static_cast<char>(a_rng() & 0xFF);
+			}
+
+			const uint64_t lastWriteTime = 133000000000000000ull + (static_cast<uint64_t>(a_rng()) << 16);
+			const uint64_t fileSize = 4000 + a_rng() % 400000;
+			cache.emplace(path, CachedAnimationHash{ lastWriteTime, fileSize, std::move(hash) });
+		}
+
+		return cache;
+	}
+
+	// mostly unchanged files, like every start after the first one
+	std::vector<Lookup> GenerateLookups(const Cache& a_cache, std::mt19937& a_rng)
+	{
+		std::vector<Lookup> lookups;
+		lookups.reserve(a_cache.size() + a_cache.size() / 10);
+
+		for (const auto& [path, cachedHash] : a_cache) {
+			switch (a_rng() % 20) {
+			case 0:
+				lookups.push_back({ path, cachedHash.lastWriteTime + 1, cachedHash.fileSize });
+				break;
+			case 1:
+				lookups.push_back({ path, cachedHash.lastWriteTime, cachedHash.fileSize + 16 });
+				break;
+			default:
+				lookups.push_back({ path, cachedHash.lastWriteTime, cachedHash.fileSize });
+				break;
+			}
+		}
+
+		for (size_t i = 0; i < a_cache.size() / 10; ++i) {
+			lookups.push_back({ "Data\\meshes\\actors\\character\\animations\\OpenAnimationReplacer\\New Mod\\" + std::to_string(i) + ".hkx", 1, 1 });
+		}
+
+		std::ranges::shuffle(lookups, a_rng);
+		return lookups;
+	}
+
+	// like AnimationFileHashCache::TryGetCachedHash
+	bool TryGetCachedHash(const Cache& a_cache, std::string_view a_path, uint64_t a_lastWriteTime, uint64_t a_fileSize, std::string& a_outCachedHash)
+	{
+		if (const auto it = a_cache.find(a_path.data()); it != a_cache.end()) {
+			if (AnimationFileHashCacheFormat::IsUpToDate(it->second.lastWriteTime, it->second.fileSize, a_lastWriteTime, a_fileSize)) {
+				a_outCachedHash = it->second.hash;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	// like AnimationFileHashCache::ReadCacheFromDisk
+	bool ReadCache(std::string_view a_data, Cache& a_outCache)
+	{
+		return AnimationFileHashCacheFormat::Read(a_data, [&](const AnimationFileHashCacheFormat::Entry& a_entry) {
+			a_outCache.emplace(a_entry.path, CachedAnimationHash{ a_entry.lastWriteTime, a_entry.fileSize, std::string(a_entry.hash) });
+		});
+	}
+
+	bool SaveBaseline(const Baseline& a_baseline, const char* a_path)
+	{
+		BenchmarkBaseline::Section section;
+		section.setup = {
+			{ "entries", static_cast<double>(a_baseline.setup.entries) },
+			{ "passes", static_cast<double>(a_baseline.setup.passes) },
+			{ "seed", static_cast<double>(a_baseline.setup.seed) }
+		};
+		section.tolerance = a_baseline.tolerance;
+		section.metrics = {
+			{ "readEntries", static_cast<double>(a_baseline.result.readEntries) },
+			{ "hits", static_cast<double>(a_baseline.result.hits) },
+			{ "outdated", static_cast<double>(a_baseline.result.outdated) },
+			{ "misses", static_cast<double>(a_baseline.result.misses) },
+			{ "bytesPerEntry", a_baseline.result.bytesPerEntry }
+		};
+
+		return BenchmarkBaseline::SaveSection(a_path, kBaselineSection, section);
+	}
+
+	bool LoadBaseline(const char* a_path, Baseline& a_outBaseline)
+	{
+		BenchmarkBaseline::Section section;
+		if (!BenchmarkBaseline::LoadSection(a_path, kBaselineSection, section)) {
+			return false;
+		}
+
+		const auto entries = section.GetSetup("entries");
+		const auto passes = section.GetSetup("passes");
+		const auto seed = section.GetSetup("seed");
+		const auto readEntries = section.GetMetric("readEntries");
+		const auto hits = section.GetMetric("hits");
+		const auto outdated = section.GetMetric("outdated");
+		const auto misses = section.GetMetric("misses");
+		const auto bytesPerEntry = section.GetMetric("bytesPerEntry");
+		if (!entries || !passes || !seed || !readEntries || !hits || !outdated || !misses || !bytesPerEntry) {
+			return false;
+		}
+
+		a_outBaseline.setup = { static_cast<size_t>(*entries), static_cast<size_t>(*passes), static_cast<uint32_t>(*seed) };
+		a_outBaseline.tolerance = section.tolerance;
+		a_outBaseline.result = { 0, static_cast<uint64_t>(*readEntries), static_cast<uint64_t>(*hits), static_cast<uint64_t>(*outdated), static_cast<uint64_t>(*misses), *bytesPerEntry };
+		return true;
+	}
+
+	ConditionBenchmark::Comparison Compare(const Result& a_result, const Baseline& a_baseline)
+	{
+		const auto& baseline = a_baseline.result;
+		const auto exact = [](std::string_view a_name, uint64_t a_baselineValue, uint64_t a_currentValue) {
+			return ConditionBenchmark::MetricComparison{ a_name, static_cast<double>(a_baselineValue), static_cast<double>(a_currentValue), a_baselineValue != a_currentValue };
+		};
+
+		ConditionBenchmark::Comparison comparison;
+		comparison.metrics.push_back(exact("Read entries", baseline.readEntries, a_result.readEntries));
+		comparison.metrics.push_back(exact("Hits", baseline.hits, a_result.hits));
+		comparison.metrics.push_back(exact("Outdated", baseline.outdated, a_result.outdated));
+		comparison.metrics.push_back(exact("Misses", baseline.misses, a_result.misses));
+		comparison.metrics.push_back(ConditionBenchmark::CompareMetric("Bytes per entry", baseline.bytesPerEntry, a_result.bytesPerEntry, a_baseline.tolerance, false));
+
+		return comparison;
+	}
+
+	double GetElapsedSeconds(std::chrono::steady_clock::time_point a_startTime)
+	{
+		return std::chrono::duration<double>(std::chrono::steady_clock::now() - a_startTime).count();
+	}
+}
+
+int main(int a_argc, char* a_argv[])
+{
+	Setup setup;
+	const char* baselinePath = nullptr;
+	const char* saveBaselinePath = nullptr;
+
+	for (int i = 1; i < a_argc; ++i) {
+		if (std::strcmp(a_argv[i], "--entries") == 0 && i + 1 < a_argc) {
+			setup.entries = std::stoul(a_argv[++i]);
+		} else if (std::strcmp(a_argv[i], "--passes") == 0 && i + 1 < a_argc) {
+			setup.passes = std::stoul(a_argv[++i]);
+		} else if (std::strcmp(a_argv[i], "--seed") == 0 && i + 1 < a_argc) {
+			setup.seed = static_cast<uint32_t>(std::stoul(a_argv[++i]));
+		} else if (std::strcmp(a_argv[i], "--baseline") == 0 && i + 1 < a_argc) {
+			baselinePath = a_argv[++i];
+		} else if (std::strcmp(a_argv[i], "--save-baseline") == 0 && i + 1 < a_argc) {
+			saveBaselinePath = a_argv[++i];
+		} else {
+			std::fprintf(stderr, "Usage: AnimationFileHashCacheBenchmark [--entries N] [--passes N] [--seed N] [--save-baseline <file>]\n       AnimationFileHashCacheBenchmark --baseline <file>\n");
+			return 1;
+		}
+	}
+
+	Baseline baseline;
+	if (baselinePath) {
+		if (!LoadBaseline(baselinePath, baseline)) {
+			std::fprintf(stderr, "Failed to load the baseline: %s\n", baselinePath);
+			return 1;
+		}
+		setup = baseline.setup;
+	}
+
+	if (setup.entries == 0 || setup.passes == 0) {
+		std::fprintf(stderr, "--entries and --passes must be at least 1\n");
+		return 1;
+	}
+
+	std::mt19937 rng(setup.seed);
+	const auto cache = GenerateCache(setup.entries, rng);
+	const auto lookups = GenerateLookups(cache, rng);
+
+	Result result;
+	std::string data;
+	Cache readCache;
+
+	// AnimationFileHashCache::WriteCacheToDisk
+	auto startTime = std::chrono::steady_clock::now();
+	for (size_t pass = 0; pass < setup.passes; ++pass) {
+		data = AnimationFileHashCacheFormat::Write(cache);
+	}
+	const double writeTime = GetElapsedSeconds(startTime);
+	result.fileBytes = data.size();
+
+	// AnimationFileHashCache::ReadCacheFromDisk, has to read back what was written
+	startTime = std::chrono::steady_clock::now();
+	for (size_t pass = 0; pass < setup.passes; ++pass) {
+		readCache.clear();
+		if (!ReadCache(data, readCache)) {
+			std::fprintf(stderr, "The written cache couldn't be read back\n");
+			return 1;
+		}
+	}
+	const double readTime = GetElapsedSeconds(startTime);
+	result.readEntries = readCache.size();
+
+	for (const auto& [path, cachedHash] : cache) {
+		const auto it = readCache.find(path);
+		if (it == readCache.end() || it->second.lastWriteTime != cachedHash.lastWriteTime || it->second.fileSize != cachedHash.fileSize || it->second.hash != cachedHash.hash) {
+			std::fprintf(stderr, "The cache read back differs from the written one: %s\n", path.c_str());
+			return 1;
+		}
+	}
+
+	// a cut off file keeps the entries before the cut
+	for (const size_t cutPos : { size_t{ 0 }, size_t{ 3 }, data.size() / 3, data.size() - 1 }) {
+		Cache cutCache;
+		if (ReadCache(std::string_view(data).substr(0, cutPos), cutCache) != (cutPos == 0) || cutCache.size() >= cache.size()) {
+			std::fprintf(stderr, "A cache cut off after %zu bytes was read as complete\n", cutPos);
+			return 1;
+		}
+	}
+
+	// AnimationFileHashCache::CalculateHash before hashing a file
+	startTime = std::chrono::steady_clock::now();
+	std::string cachedHash;
+	for (size_t pass = 0; pass < setup.passes; ++pass) {
+		for (const auto& lookup : lookups) {
+			if (TryGetCachedHash(readCache, lookup.path, lookup.lastWriteTime, lookup.fileSize, cachedHash)) {
+				++result.hits;
+			} else if (readCache.contains(lookup.path)) {
+				++result.outdated;
+			} else {
+				++result.misses;
+			}
+		}
+	}
+	const double lookupTime = GetElapsedSeconds(startTime);
+	result.hits /= setup.passes;
+	result.outdated /= setup.passes;
+	result.misses /= setup.passes;
+	result.bytesPerEntry = static_cast<double>(result.fileBytes) / static_cast<double>(result.readEntries);
+
+	const double megabytes = static_cast<double>(result.fileBytes) * setup.passes / 1e6;
+	std::printf("%zu entries, %zu passes, seed %u, %.2f MB cache file\n", setup.entries, setup.passes, setup.seed, result.fileBytes / 1e6);
+	std::printf("Write: %.1f MB/s, %.0f entries/s\n", megabytes / writeTime, static_cast<double>(setup.entries * setup.passes) / writeTime);
+	std::printf("Read: %.1f MB/s, %.0f entries/s\n", megabytes / readTime, static_cast<double>(setup.entries * setup.passes) / readTime);
+	std::printf("Lookups: %.0f/s, %llu hits, %llu outdated, %llu misses per pass\n", static_cast<double>(lookups.size() * setup.passes) / lookupTime, static_cast<unsigned long long>(result.hits), static_cast<unsigned long long>(result.outdated), static_cast<unsigned long long>(result.misses));
+
+	if (saveBaselinePath) {
+		if (!SaveBaseline({ setup, result, baseline.tolerance }, saveBaselinePath)) {
+			std::fprintf(stderr, "Failed to save the baseline: %s\n", saveBaselinePath);
+			return 1;
+		}
+		std::printf("Saved the baseline to %s\n", saveBaselinePath);
+	}
+
+	if (baselinePath) {
+		const auto comparison = Compare(result, baseline);
+
+		std::printf("\nCompared to the baseline (tolerance %.0f%%)\n", baseline.tolerance * 100.0);
+		for (const auto& metric : comparison.metrics) {
+			std::printf("%-26s %12.2f %12.2f %+7.1f%%%s\n", metric.name.data(), metric.baseline, metric.current, metric.GetChange() * 100.0, metric.bRegressed ? "  REGRESSED" : "");
+		}
+
+		if (comparison.HasRegressions()) {
+			return 1;
+		}
+	}
+
+	return 0;
+}
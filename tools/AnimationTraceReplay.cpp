@@ -0,0 +1,206 @@
+// Replays the condition results recorded in an animation trace without the game (Debug Settings -> Record animation trace)
+// The trace has the results and times of the top level conditions of every tested candidate. They stand in for the facts the conditions read, and go through the same selection and evaluation code as the game (ReplacementSelection.h, ConditionEvaluation.h)
+// A condition the recording never got to (it comes after the first failing one) is taken as passing, so its set still fails on the recorded failing condition
+// The recorded time of a condition is spent in a busy loop, so the reordering measures the same costs it did in the game
+// Standalone, only needs a C++20 compiler (or the AnimationTraceReplay target in tools/CMakeLists.txt):
+//     g++ -std=c++20 -O2 -I../src -o AnimationTraceReplay AnimationTraceReplay.cpp
+// Usage:
+//     AnimationTraceReplay <OpenAnimationReplacer.oartrace>
+// Replays the trace with the conditions in the authored order and reordered, and exits with 1 if either picks a different replacement than the recording did
+
+#include "AnimationTraceFormat.h"
+#include "ConditionEvaluation.h"
+#include "ReplacementSelection.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+	using AnimationTraceFormat::ConditionRecord;
+	using AnimationTraceFormat::TracedCandidate;
+
+	// the average recorded time of every condition, for the ones the recording never got to
+	class ConditionTimes
+	{
+	public:
+		explicit ConditionTimes(const AnimationTraceFormat::Trace& a_trace)
+		{
+			for (const auto& candidates : a_trace.eventCandidates) {
+				for (const auto& candidate : candidates) {
+					auto& times = _times[candidate.record.conditionSetId];
+					if (times.size() < candidate.conditions.size()) {
+						times.resize(candidate.conditions.size());
+					}
+					for (size_t i = 0; i < candidate.conditions.size(); ++i) {
+						if (candidate.conditions[i].flags & AnimationTraceFormat::kConditionEvaluated) {
+							times[i].total += candidate.conditions[i].evaluationTime;
+							++times[i].count;
+						}
+					}
+				}
+			}
+		}
+
+		[[nodiscard]] uint32_t GetAverageTime(uint32_t a_conditionSetId, size_t a_index) const
+		{
+			if (const auto it = _times.find(a_conditionSetId); it != _times.end() && a_index < it->second.size() && it->second[a_index].count > 0) {
+				return static_cast<uint32_t>(it->second[a_index].total / it->second[a_index].count);
+			}
+			return 0;
+		}
+
+	private:
+		struct Time
+		{
+			uint64_t total = 0;
+			uint64_t count = 0;
+		};
+
+		std::unordered_map<uint32_t, std::vector<Time>> _times;
+	};
+
+	struct Result
+	{
+		uint64_t events = 0;
+		uint64_t mismatches = 0;
+		uint64_t candidates = 0;
+		uint64_t conditions = 0;
+		uint64_t unrecordedConditions = 0;  // evaluated by the replay but not by the recording
+		uint64_t conditionTime = 0;         // nanoseconds, recorded or estimated
+	};
+
+	void SpinFor(uint32_t a_nanoseconds)
+	{
+		const auto endTime = std::chrono::steady_clock::now() + std::chrono::nanoseconds(a_nanoseconds);
+		while (std::chrono::steady_clock::now() < endTime) {}
+	}
+
+	// the replacement the recording picked, the last tested candidate if it passed
+	const TracedCandidate* GetRecordedSelection(const std::vector<TracedCandidate>& a_candidates)
+	{
+		if (a_candidates.empty()) {
+			return nullptr;
+		}
+
+		const auto& last = a_candidates.back();
+		const bool bPassed = std::ranges::all_of(last.conditions, [](const ConditionRecord& a_condition) {
+			return (a_condition.flags & AnimationTraceFormat::kConditionEvaluated) && (a_condition.flags & AnimationTraceFormat::kConditionPassed);
+		});
+
+		return bPassed ? &last : nullptr;
+	}
+
+	Result Replay(const AnimationTraceFormat::Trace& a_trace, const ConditionTimes& a_conditionTimes, bool a_bReorder, bool a_bPrintMismatches)
+	{
+		Result result;
+		std::unordered_map<uint32_t, std::unique_ptr<ConditionEvaluation::ReorderingEvaluator>> reorderings;  // per condition set, like ConditionSet::_reordering
+
+		for (size_t eventIndex = 0; eventIndex < a_trace.events.size(); ++eventIndex) {
+			const auto& candidates = a_trace.eventCandidates[eventIndex];
+
+			// synchronized evaluations don't record their conditions
+			if (candidates.empty() || std::ranges::any_of(candidates, [](const TracedCandidate& a_candidate) { return a_candidate.record.conditionSetId == 0; })) {
+				continue;
+			}
+
+			++result.events;
+
+			const auto evaluate = [&](const TracedCandidate& a_candidate) {
+				const auto& conditions = a_candidate.conditions;
+				auto& reordering = reorderings[a_candidate.record.conditionSetId];
+				if (a_bReorder && !reordering) {
+					reordering = std::make_unique<ConditionEvaluation::ReorderingEvaluator>();
+				}
+
+				bool bUpdateOrder = false;
+				const bool bResult = ConditionEvaluation::EvaluateAll(a_bReorder ? reordering.get() : nullptr, conditions.size(), 0, [&](size_t a_index) {
+					++result.conditions;
+
+					const auto& condition = conditions[a_index];
+					if (condition.flags & AnimationTraceFormat::kConditionEvaluated) {
+						result.conditionTime += condition.evaluationTime;
+						SpinFor(condition.evaluationTime);
+						return (condition.flags & AnimationTraceFormat::kConditionPassed) != 0;
+					}
+
+					++result.unrecordedConditions;
+					const uint32_t estimatedTime = a_conditionTimes.GetAverageTime(a_candidate.record.conditionSetId, a_index);
+					result.conditionTime += estimatedTime;
+					SpinFor(estimatedTime);
+					return true;
+				}, bUpdateOrder);
+
+				if (bUpdateOrder) {
+					reordering->UpdateOrder(conditions.size(), 0, [&](size_t a_index) { return (conditions[a_index].flags & AnimationTraceFormat::kConditionBarrier) != 0; });
+				}
+
+				return bResult;
+			};
+
+			const auto selected = ReplacementSelection::SelectCandidate(
+				std::span(candidates),
+				[](const TracedCandidate& a_candidate) { return a_candidate.conditions.empty(); },
+				evaluate,
+				[&](const TracedCandidate&) { ++result.candidates; });
+
+			const auto recorded = GetRecordedSelection(candidates);
+			if (selected != recorded) {
+				++result.mismatches;
+				if (a_bPrintMismatches && result.mismatches <= 20) {
+					const auto& record = a_trace.events[eventIndex];
+					std::printf("  event %zu, %08X %s: recorded replacement %u, replayed %u\n", eventIndex, record.refrFormID, a_trace.GetString(record.animationNameId).c_str(), recorded ? recorded->record.replacementId : 0, selected ? selected->record.replacementId : 0);
+				}
+			}
+		}
+
+		return result;
+	}
+
+	void PrintResult(const char* a_name, const Result& a_result)
+	{
+		const double events = a_result.events ? static_cast<double>(a_result.events) : 1.0;
+		std::printf("%-10s %10llu %10llu %10.2f %10.2f %10.2f %12.3f %10.2f\n", a_name, static_cast<unsigned long long>(a_result.events), static_cast<unsigned long long>(a_result.mismatches), a_result.candidates / events, a_result.conditions / events, a_result.unrecordedConditions / events, a_result.conditionTime / 1e6, a_result.conditionTime / events / 1000.0);
+	}
+}
+
+int main(int a_argc, char* a_argv[])
+{
+	if (a_argc != 2) {
+		std::fprintf(stderr, "Usage: AnimationTraceReplay <OpenAnimationReplacer.oartrace>\n");
+		return 1;
+	}
+
+	AnimationTraceFormat::Trace trace;
+	std::string error;
+	if (!AnimationTraceFormat::LoadTrace(a_argv[1], trace, error)) {
+		std::fprintf(stderr, "%s\n", error.c_str());
+		return 1;
+	}
+
+	if (trace.version < 2) {
+		std::fprintf(stderr, "The trace was recorded without condition results (version %u), record it again with a newer version\n", trace.version);
+		return 1;
+	}
+
+	std::printf("%zu events%s\n", trace.events.size(), trace.bTruncated ? " (trace is truncated)" : "");
+
+	const ConditionTimes conditionTimes(trace);
+
+	std::printf("\nMismatches in the authored order:\n");
+	const auto authored = Replay(trace, conditionTimes, false, true);
+	std::printf("\nMismatches reordered:\n");
+	const auto reordered = Replay(trace, conditionTimes, true, true);
+
+	std::printf("\n%-10s %10s %10s %10s %10s %10s %12s %10s\n", "order", "events", "mismatch", "avg cand", "avg cond", "avg unrec", "total ms", "avg us");
+	PrintResult("authored", authored);
+	PrintResult("reordered", reordered);
+
+	return authored.mismatches == 0 && reordered.mismatches == 0 ? 0 : 1;
+}
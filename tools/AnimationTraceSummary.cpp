@@ -0,0 +1,117 @@
+// Summarizes an animation trace recorded by Open Animation Replacer (Debug Settings -> Record animation trace)
+// Standalone, only needs a C++20 compiler (or the AnimationTraceSummary target in tools/CMakeLists.txt):
+//     g++ -std=c++20 -O2 -I../src -o AnimationTraceSummary AnimationTraceSummary.cpp
+// Usage:
+//     AnimationTraceSummary <OpenAnimationReplacer.oartrace> [--top N]
+
+#include "AnimationTraceFormat.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+	struct Stats
+	{
+		uint64_t events = 0;
+		uint64_t evaluations = 0;
+		uint64_t replaced = 0;
+		uint64_t candidatesTested = 0;
+		uint64_t evaluationTime = 0;
+
+		void Add(const AnimationTraceFormat::EventRecord& a_record)
+		{
+			++events;
+			if (a_record.candidatesTested > 0) {
+				++evaluations;
+				candidatesTested += a_record.candidatesTested;
+				evaluationTime += a_record.evaluationTime;
+				if (a_record.replacementId != 0) {
+					++replaced;
+				}
+			}
+		}
+
+		[[nodiscard]] double HitRate() const { return evaluations ? 100.0 * replaced / evaluations : 0.0; }
+		[[nodiscard]] double AverageEvaluationTime() const { return evaluations ? static_cast<double>(evaluationTime) / evaluations / 1000.0 : 0.0; }
+		[[nodiscard]] double AverageCandidates() const { return evaluations ? static_cast<double>(candidatesTested) / evaluations : 0.0; }
+	};
+
+	std::vector<std::pair<std::string, Stats>> SortedBy(const std::unordered_map<std::string, Stats>& a_map, auto&& a_key, size_t a_count)
+	{
+		std::vector<std::pair<std::string, Stats>> sorted(a_map.begin(), a_map.end());
+		std::ranges::sort(sorted, [&](const auto& a_lhs, const auto& a_rhs) { return a_key(a_lhs.second) > a_key(a_rhs.second); });
+		if (sorted.size() > a_count) {
+			sorted.resize(a_count);
+		}
+		return sorted;
+	}
+
+	void PrintTable(const char* a_title, const std::vector<std::pair<std::string, Stats>>& a_rows)
+	{
+		std::printf("\n%s\n", a_title);
+		std::printf("%9s %9s %8s %11s %11s %10s  %s\n", "events", "evals", "hit %", "avg us", "total ms", "avg cand", "name");
+		for (const auto& [name, stats] : a_rows) {
+			std::printf("%9llu %9llu %7.1f%% %11.2f %11.2f %10.1f  %s\n", static_cast<unsigned long long>(stats.events), static_cast<unsigned long long>(stats.evaluations), stats.HitRate(), stats.AverageEvaluationTime(), stats.evaluationTime / 1e6, stats.AverageCandidates(), name.c_str());
+		}
+	}
+}
+
+int main(int a_argc, char* a_argv[])
+{
+	if (a_argc < 2) {
+		std::fprintf(stderr, "Usage: AnimationTraceSummary <trace file> [--top N]\n");
+		return 1;
+	}
+
+	size_t topCount = 20;
+	for (int i = 2; i < a_argc; ++i) {
+		if (std::strcmp(a_argv[i], "--top") == 0 && i + 1 < a_argc) {
+			topCount = std::stoul(a_argv[++i]);
+		}
+	}
+
+	AnimationTraceFormat::Trace trace;
+	std::string error;
+	if (!AnimationTraceFormat::LoadTrace(a_argv[1], trace, error)) {
+		std::fprintf(stderr, "Failed to load the trace: %s\n", error.c_str());
+		return 1;
+	}
+
+	auto getString = [&](uint32_t a_id) { return trace.GetString(a_id); };
+
+	Stats total;
+	std::unordered_map<std::string, Stats> eventStats;
+	std::unordered_map<std::string, Stats> animationStats;
+	std::unordered_map<std::string, Stats> subModStats;
+
+	for (const auto& record : trace.events) {
+		total.Add(record);
+
+		const char* eventName = record.event < std::size(AnimationTraceFormat::kEventNames) ? AnimationTraceFormat::kEventNames[record.event] : "Unknown";
+		eventStats[eventName].Add(record);
+
+		animationStats[getString(record.animationNameId) + " (" + getString(record.projectNameId) + ")"].Add(record);
+
+		// the trace only records the total time of an evaluation, so all of it is charged to the submod that won it, including the time spent on the higher priority candidates that failed before it
+		if (const auto it = trace.replacements.find(record.replacementId); it != trace.replacements.end()) {
+			subModStats[getString(it->second.modNameId) + " / " + getString(it->second.subModNameId)].Add(record);
+		}
+	}
+
+	const double durationSeconds = trace.events.empty() ? 0.0 : (trace.events.back().timestamp - trace.events.front().timestamp) / 1e9;
+	std::printf("%llu events over %.1f s, %zu distinct replacement animations%s\n", static_cast<unsigned long long>(total.events), durationSeconds, trace.replacements.size(), trace.bTruncated ? " (trace is truncated)" : "");
+	std::printf("Evaluations: %llu, replaced: %llu (%.1f%%), average %.2f us and %.1f candidates per evaluation, %.2f ms total\n", static_cast<unsigned long long>(total.evaluations), static_cast<unsigned long long>(total.replaced), total.HitRate(), total.AverageEvaluationTime(), total.AverageCandidates(), total.evaluationTime / 1e6);
+
+	PrintTable("Events by type", SortedBy(eventStats, [](const Stats& a_stats) { return a_stats.events; }, eventStats.size()));
+	PrintTable("Hottest animations", SortedBy(animationStats, [](const Stats& a_stats) { return a_stats.events; }, topCount));
+	PrintTable("Most expensive animations (total evaluation time)", SortedBy(animationStats, [](const Stats& a_stats) { return a_stats.evaluationTime; }, topCount));
+	PrintTable("Slowest evaluations by winning submod (the whole evaluation, including the candidates tested before the winner)", SortedBy(subModStats, [](const Stats& a_stats) { return a_stats.AverageEvaluationTime(); }, topCount));
+	PrintTable("Lowest replacement hit rates", SortedBy(animationStats, [](const Stats& a_stats) { return a_stats.evaluations ? 100.0 - a_stats.HitRate() : -1.0; }, topCount));
+
+	return 0;
+}
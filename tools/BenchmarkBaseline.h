@@ -0,0 +1,248 @@
+#pragma once
+
+// The checked in benchmark baseline (tools/BenchmarkBaseline.json), shared by the benchmarks gated in tools/CMakeLists.txt
+// Every benchmark has its own section with the setup it ran with, the tolerance and its machine independent metrics:
+//     { "ConditionBenchmark": { "setup": { "sets": 200, ... }, "tolerance": 0.05, "metrics": { "passedEvaluations": 39968, ... } }, ... }
+// Only reads what it writes, objects of numbers, there's no json library in the host build
+
+#include <charconv>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace BenchmarkBaseline
+{
+	using Values = std::vector<std::pair<std::string, double>>;  // in the order they're written
+
+	struct Section
+	{
+		Values setup;
+		double tolerance = 0.05;
+		Values metrics;
+
+		[[nodiscard]] std::optional<double> GetSetup(std::string_view a_name) const { return Find(setup, a_name); }
+		[[nodiscard]] std::optional<double> GetMetric(std::string_view a_name) const { return Find(metrics, a_name); }
+
+	private:
+		[[nodiscard]] static std::optional<double> Find(const Values& a_values, std::string_view a_name)
+		{
+			for (const auto& [name, value] : a_values) {
+				if (name == a_name) {
+					return value;
+				}
+			}
+			return std::nullopt;
+		}
+	};
+
+	using Sections = std::vector<std::pair<std::string, Section>>;
+
+	namespace detail
+	{
+		class Reader
+		{
+		public:
+			explicit Reader(std::string_view a_text) :
+				_text(a_text)
+			{}
+
+			bool ReadSections(Sections& a_outSections)
+			{
+				return ReadObject([&](std::string_view a_key) {
+					Section section;
+					if (!ReadSection(section)) {
+						return false;
+					}
+					a_outSections.emplace_back(a_key, std::move(section));
+					return true;
+				}) && (SkipSpaces(), _pos == _text.size());
+			}
+
+		private:
+			bool ReadSection(Section& a_outSection)
+			{
+				return ReadObject([&](std::string_view a_key) {
+					if (a_key == "setup") {
+						return ReadValues(a_outSection.setup);
+					}
+					if (a_key == "metrics") {
+						return ReadValues(a_outSection.metrics);
+					}
+					if (a_key == "tolerance") {
+						return ReadNumber(a_outSection.tolerance);
+					}
+					return false;
+				});
+			}
+
+			bool ReadValues(Values& a_outValues)
+			{
+				return ReadObject([&](std::string_view a_key) {
+					double value = 0.0;
+					if (!ReadNumber(value)) {
+						return false;
+					}
+					a_outValues.emplace_back(a_key, value);
+					return true;
+				});
+			}
+
+			// a_readMember(key) reads the value after the colon
+			template <class ReadMember>
+			bool ReadObject(ReadMember&& a_readMember)
+			{
+				if (!Consume('{')) {
+					return false;
+				}
+				if (Consume('}')) {
+					return true;
+				}
+
+				do {
+					std::string_view key;
+					if (!ReadString(key) || !Consume(':') || !a_readMember(key)) {
+						return false;
+					}
+				} while (Consume(','));
+
+				return Consume('}');
+			}
+
+			bool ReadString(std::string_view& a_outString)
+			{
+				if (!Consume('"')) {
+					return false;
+				}
+
+				const size_t endPos = _text.find('"', _pos);
+				if (endPos == std::string_view::npos) {
+					return false;
+				}
+
+				a_outString = _text.substr(_pos, endPos - _pos);
+				_pos = endPos + 1;
+				return true;
+			}
+
+			bool ReadNumber(double& a_outNumber)
+			{
+				SkipSpaces();
+				const auto [ptr, ec] = std::from_chars(_text.data() + _pos, _text.data() + _text.size(), a_outNumber);
+				if (ec != std::errc()) {
+					return false;
+				}
+				_pos = static_cast<size_t>(ptr - _text.data());
+				return true;
+			}
+
+			bool Consume(char a_char)
+			{
+				SkipSpaces();
+				if (_pos < _text.size() && _text[_pos] == a_char) {
+					++_pos;
+					return true;
+				}
+				return false;
+			}
+
+			void SkipSpaces()
+			{
+				while (_pos < _text.size() && (_text[_pos] == ' ' || _text[_pos] == '\t' || _text[_pos] == '\n' || _text[_pos] == '\r')) {
+					++_pos;
+				}
+			}
+
+			std::string_view _text;
+			size_t _pos = 0;
+		};
+
+		inline void WriteValues(std::string& a_out, const Values& a_values)
+		{
+			a_out += "{\n";
+			for (size_t i = 0; i < a_values.size(); ++i) {
+				char number[64];
+				std::snprintf(number, sizeof(number), "%.9g", a_values[i].second);
+				a_out += "\t\t\t\"" + a_values[i].first + "\": " + number + (i + 1 < a_values.size() ? ",\n" : "\n");
+			}
+			a_out += "\t\t}";
+		}
+	}
+
+	inline bool Load(const char* a_path, Sections& a_outSections)
+	{
+		std::ifstream file(a_path, std::ios::binary);
+		if (!file) {
+			return false;
+		}
+
+		const std::string text((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+		return detail::Reader(text).ReadSections(a_outSections);
+	}
+
+	inline bool Save(const char* a_path, const Sections& a_sections)
+	{
+		std::string text = "{\n";
+		for (size_t i = 0; i < a_sections.size(); ++i) {
+			const auto& [name, section] = a_sections[i];
+			char tolerance[64];
+			std::snprintf(tolerance, sizeof(tolerance), "%.9g", section.tolerance);
+
+			text += "\t\"" + name + "\": {\n\t\t\"setup\": ";
+			detail::WriteValues(text, section.setup);
+			text += ",\n\t\t\"tolerance\": ";
+			text += tolerance;
+			text += ",\n\t\t\"metrics\": ";
+			detail::WriteValues(text, section.metrics);
+			text += i + 1 < a_sections.size() ? "\n\t},\n" : "\n\t}\n";
+		}
+		text += "}\n";
+
+		std::ofstream file(a_path, std::ios::binary);
+		return file && file.write(text.data(), static_cast<std::streamsize>(text.size()));
+	}
+
+	// the section of a_name in the baseline at a_path
+	inline bool LoadSection(const char* a_path, std::string_view a_name, Section& a_outSection)
+	{
+		Sections sections;
+		if (!Load(a_path, sections)) {
+			return false;
+		}
+
+		for (auto& [name, section] : sections) {
+			if (name == a_name) {
+				a_outSection = std::move(section);
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	// replaces or adds the section of a_name, keeping the other benchmarks' sections
+	inline bool SaveSection(const char* a_path, std::string_view a_name, const Section& a_section)
+	{
+		Sections sections;
+		if (!Load(a_path, sections)) {
+			sections.clear();  // a new file, or one that isn't a baseline
+		}
+
+		bool bReplaced = false;
+		for (auto& [name, section] : sections) {
+			if (name == a_name) {
+				section = a_section;
+				bReplaced = true;
+			}
+		}
+		if (!bReplaced) {
+			sections.emplace_back(a_name, a_section);
+		}
+
+		return Save(a_path, sections);
+	}
+}
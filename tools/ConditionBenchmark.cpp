@@ -0,0 +1,895 @@
+// Benchmarks the condition evaluation and the replacement selection of Open Animation Replacer without the game
+// The conditions mirror the game's CompareValues, InventoryCount, HasKeyword, IsEquipped, Random, AND and OR conditions. They evaluate through the same code as the game's (ConditionEvaluation.h, ReplacementSelection.h),
+// but read their facts from a mock reference with settable actor values, graph variables, keywords, equipped items and inventory instead of the game's references
+// Standalone, only needs a C++20 compiler:
+//     g++ -std=c++20 -O2 -I../src -o ConditionBenchmark ConditionBenchmark.cpp
+// Usage:
+//     ConditionBenchmark [--sets N] [--clips N] [--passes N] [--seed N] [--no-reorder] [--save-baseline <file>]
+//     ConditionBenchmark --baseline <file>
+// With --baseline, runs with the setup saved in the ConditionBenchmark section of the baseline (BenchmarkBaseline.json) and exits with 1 if the result regressed past its tolerance (the ConditionBenchmark test in tools/CMakeLists.txt)
+// --save-baseline only replaces its own section of the file
+// Only the machine independent metrics are compared, the time is too noisy to gate on
+
+#include "BenchmarkBaseline.h"
+#include "ConditionBenchmarkComparison.h"
+#include "ConditionEvaluation.h"
+#include "ReplacementSelection.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <optional>
+#include <random>
+#include <span>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+	// mirror Conditions::ComparisonOperator, Conditions::ActorValueType and Conditions::GraphVariableType (API/OpenAnimationReplacer-ConditionTypes.h)
+	enum class ComparisonOperator : uint8_t
+	{
+		kEqual,
+		kNotEqual,
+		kGreater,
+		kGreaterEqual,
+		kLess,
+		kLessEqual,
+
+		kInvalid
+	};
+
+	enum class ActorValueType : int
+	{
+		kActorValue,
+		kBase,
+		kMax,
+		kPercentage
+	};
+
+	enum class GraphVariableType : int
+	{
+		kFloat,
+		kInt,
+		kBool
+	};
+
+	// the standard distributions are implemented differently by every standard library, the checked in baseline has to match on all of them
+	float GetRandomFloat(std::mt19937& a_rng, float a_min, float a_max)
+	{
+		return a_min + (a_max - a_min) * static_cast<float>(a_rng() >> 8) / static_cast<float>(1u << 24);
+	}
+
+	uint32_t GetRandomInt(std::mt19937& a_rng, uint32_t a_min, uint32_t a_max)
+	{
+		return a_min + static_cast<uint32_t>(a_rng() % (a_max - a_min + 1));
+	}
+
+	bool GetRandomChance(std::mt19937& a_rng, float a_chance)
+	{
+		return GetRandomFloat(a_rng, 0.f, 1.f) < a_chance;
+	}
+
+	constexpr uint32_t kActorValueCount = 16;
+	constexpr uint32_t kGlobalCount = 8;
+	constexpr uint32_t kKeywordCount = 32;
+	constexpr uint32_t kItemCount = 64;
+	constexpr std::array kGraphVariableNames = { "iState", "bIsBlocking", "fSpeed", "iWantBlock", "bInJumpState", "fDirection", "IsAttackReady", "iLeftHandType", "iRightHandType", "bWantCastLeft", "Speed", "TurnDelta" };
+
+	// stands in for the game's reference, everything a condition reads is settable and redrawn between passes like the state of an actor changing between frames
+	// every read is counted, the count doesn't depend on the machine
+	class MockRefr
+	{
+	public:
+		struct ActorValue
+		{
+			float current = 0.f;
+			float base = 0.f;
+			float permanent = 0.f;
+			float temporary = 0.f;
+		};
+
+		struct InventoryEntry
+		{
+			uint32_t itemId;
+			int32_t count;
+		};
+
+		// the sources ConditionEvaluation reads a numeric value from, like ActorValueSource and GraphVariableSource in BaseConditions.cpp
+		struct ActorValueSource
+		{
+			[[nodiscard]] float GetCurrent() const { return refr.ReadActorValue(actorValueId).current; }
+			[[nodiscard]] float GetBase() const { return refr.ReadActorValue(actorValueId).base; }
+			[[nodiscard]] float GetPermanent() const { return refr.ReadActorValue(actorValueId).permanent; }
+			[[nodiscard]] float GetTemporary() const { return refr.ReadActorValue(actorValueId).temporary; }
+
+			const MockRefr& refr;
+			uint32_t actorValueId;
+		};
+
+		struct GraphVariableSource
+		{
+			void GetFloat(float& a_outValue) const { refr.GetGraphVariable(name, a_outValue); }
+			void GetInt(int32_t& a_outValue) const
+			{
+				float value;
+				if (refr.GetGraphVariable(name, value)) {
+					a_outValue = static_cast<int32_t>(value);
+				}
+			}
+			void GetBool(bool& a_outValue) const
+			{
+				float value;
+				if (refr.GetGraphVariable(name, value)) {
+					a_outValue = value != 0.f;
+				}
+			}
+
+			const MockRefr& refr;
+			const std::string& name;
+		};
+
+		[[nodiscard]] bool IsActor() const { return _bActor; }
+
+		[[nodiscard]] const ActorValue& ReadActorValue(uint32_t a_actorValueId) const
+		{
+			++_factReads;
+			return _actorValues[a_actorValueId];
+		}
+
+		[[nodiscard]] float GetGlobal(uint32_t a_globalId) const
+		{
+			++_factReads;
+			return _globals[a_globalId];
+		}
+
+		bool GetGraphVariable(const std::string& a_name, float& a_outValue) const
+		{
+			++_factReads;
+			if (const auto it = _graphVariables.find(a_name); it != _graphVariables.end()) {
+				a_outValue = it->second;
+				return true;
+			}
+			return false;
+		}
+
+		// keyword forms are searched linearly in the game too
+		[[nodiscard]] bool HasKeyword(uint32_t a_keywordId) const
+		{
+			++_factReads;
+			return std::ranges::find(_keywords, a_keywordId) != _keywords.end();
+		}
+
+		[[nodiscard]] uint32_t GetEquippedItem(bool a_bLeftHand) const
+		{
+			++_factReads;
+			return a_bLeftHand ? _leftHand : _rightHand;
+		}
+
+		// like walking the inventory changes
+		[[nodiscard]] int32_t GetItemCount(uint32_t a_itemId) const
+		{
+			++_factReads;
+			int32_t count = 0;
+			for (const auto& entry : _inventory) {
+				if (entry.itemId == a_itemId) {
+					count += entry.count;
+				}
+			}
+			return count;
+		}
+
+		// a random value that's the same for the same condition until the next pass, so the results don't depend on the evaluation order
+		[[nodiscard]] float GetRandom(uint32_t a_conditionId) const
+		{
+			++_factReads;
+			uint64_t hash = (static_cast<uint64_t>(_randomSeed) << 32 | a_conditionId) * 0x9E3779B97F4A7C15ull;
+			hash ^= hash >> 29;
+			return static_cast<float>(hash >> 40) / static_cast<float>(1u << 24);
+		}
+
+		[[nodiscard]] uint64_t GetFactReads() const { return _factReads; }
+
+		void Advance(std::mt19937& a_rng)
+		{
+			_bActor = !GetRandomChance(a_rng, 0.05f);
+
+			for (auto& actorValue : _actorValues) {
+				actorValue.permanent = GetRandomFloat(a_rng, 50.f, 100.f);
+				actorValue.base = GetRandomFloat(a_rng, 50.f, actorValue.permanent);
+				actorValue.temporary = GetRandomFloat(a_rng, -10.f, 10.f);
+				actorValue.current = GetRandomFloat(a_rng, 0.f, actorValue.permanent + actorValue.temporary);
+			}
+
+			for (auto& global : _globals) {
+				global = GetRandomFloat(a_rng, 0.f, 10.f);
+			}
+
+			_graphVariables.clear();
+			for (const auto name : kGraphVariableNames) {
+				// not every graph has every variable
+				if (GetRandomChance(a_rng, 0.9f)) {
+					_graphVariables.emplace(name, static_cast<float>(GetRandomInt(a_rng, 0, 4)) + (GetRandomChance(a_rng, 0.5f) ? GetRandomFloat(a_rng, 0.f, 1.f) : 0.f));
+				}
+			}
+
+			_keywords.clear();
+			for (uint32_t i = 0; i < kKeywordCount; ++i) {
+				if (GetRandomChance(a_rng, 0.3f)) {
+					_keywords.push_back(i);
+				}
+			}
+
+			_rightHand = GetRandomInt(a_rng, 0, 15);
+			_leftHand = GetRandomInt(a_rng, 0, 15);
+
+			_inventory.clear();
+			const uint32_t inventorySize = GetRandomInt(a_rng, 20, 60);
+			for (uint32_t i = 0; i < inventorySize; ++i) {
+				_inventory.push_back({ GetRandomInt(a_rng, 0, kItemCount - 1), static_cast<int32_t>(GetRandomInt(a_rng, 1, 3)) });
+			}
+
+			_randomSeed = static_cast<uint32_t>(a_rng());
+		}
+
+	private:
+		bool _bActor = true;
+		std::array<ActorValue, kActorValueCount> _actorValues{};
+		std::array<float, kGlobalCount> _globals{};
+		std::unordered_map<std::string, float> _graphVariables;
+		std::vector<uint32_t> _keywords;
+		uint32_t _rightHand = 0;
+		uint32_t _leftHand = 0;
+		std::vector<InventoryEntry> _inventory;
+		uint32_t _randomSeed = 0;
+		mutable uint64_t _factReads = 0;
+	};
+
+	struct EvaluationContext
+	{
+		bool bReorder = true;
+		uint64_t conditionEvaluations = 0;
+	};
+
+	// mirrors ConditionBase
+	class MockCondition
+	{
+	public:
+		virtual ~MockCondition() = default;
+
+		bool Evaluate(const MockRefr& a_refr, EvaluationContext& a_context) const
+		{
+			++a_context.conditionEvaluations;
+			return ConditionEvaluation::EvaluateCondition(bDisabled, bNegated, [&]() { return EvaluateImpl(a_refr, a_context); });
+		}
+
+		// see IsReorderBarrier in BaseConditions.cpp
+		[[nodiscard]] virtual bool IsReorderBarrier() const { return false; }
+
+		bool bDisabled = false;
+		bool bNegated = false;
+
+	protected:
+		virtual bool EvaluateImpl(const MockRefr& a_refr, EvaluationContext& a_context) const = 0;
+	};
+
+	// mirrors ConditionSet with the profiler disabled, minus the lock
+	class MockConditionSet
+	{
+	public:
+		[[nodiscard]] bool IsEmpty() const { return conditions.empty(); }
+
+		bool EvaluateAll(const MockRefr& a_refr, EvaluationContext& a_context) const
+		{
+			bool bUpdateOrder = false;
+			const bool bResult = ConditionEvaluation::EvaluateAll(a_context.bReorder ? &_reordering : nullptr, conditions.size(), 0, [&](size_t a_index) { return conditions[a_index]->Evaluate(a_refr, a_context); }, bUpdateOrder);
+
+			if (bUpdateOrder) {
+				_reordering.UpdateOrder(conditions.size(), 0, [&](size_t a_index) { return conditions[a_index]->IsReorderBarrier(); });
+			}
+
+			return bResult;
+		}
+
+		bool EvaluateAny(const MockRefr& a_refr, EvaluationContext& a_context) const
+		{
+			return ConditionEvaluation::EvaluateAny(conditions.size(), [&](size_t a_index) { return conditions[a_index]->Evaluate(a_refr, a_context); });
+		}
+
+		[[nodiscard]] bool HasReorderBarrier() const
+		{
+			return std::ranges::any_of(conditions, [](const auto& a_condition) { return a_condition->IsReorderBarrier(); });
+		}
+
+		std::vector<std::unique_ptr<MockCondition>> conditions;
+
+	private:
+		mutable ConditionEvaluation::ReorderingEvaluator _reordering;
+	};
+
+	// mirrors NumericValue
+	struct MockNumericValue
+	{
+		enum class Type
+		{
+			kStaticValue,
+			kGlobalVariable,
+			kActorValue,
+			kGraphVariable
+		};
+
+		[[nodiscard]] float GetValue(const MockRefr& a_refr) const
+		{
+			switch (type) {
+			case Type::kStaticValue:
+				return staticValue;
+			case Type::kGlobalVariable:
+				return a_refr.GetGlobal(id);
+			case Type::kActorValue:
+				return a_refr.IsActor() ? ConditionEvaluation::GetActorValue(actorValueType, MockRefr::ActorValueSource{ a_refr, id }) : 0.f;
+			case Type::kGraphVariable:
+				return ConditionEvaluation::GetGraphVariable(graphVariableType, MockRefr::GraphVariableSource{ a_refr, graphVariableName });
+			}
+
+			return 0.f;
+		}
+
+		Type type = Type::kStaticValue;
+		float staticValue = 0.f;
+		uint32_t id = 0;  // of the global or actor value
+		ActorValueType actorValueType = ActorValueType::kActorValue;
+		GraphVariableType graphVariableType = GraphVariableType::kFloat;
+		std::string graphVariableName;
+	};
+
+	class CompareValuesCondition final : public MockCondition
+	{
+	public:
+		MockNumericValue valueA;
+		ComparisonOperator comparisonOperator = ComparisonOperator::kEqual;
+		MockNumericValue valueB;
+
+	protected:
+		bool EvaluateImpl(const MockRefr& a_refr, [[maybe_unused]] EvaluationContext& a_context) const override
+		{
+			return ConditionEvaluation::Compare(comparisonOperator, valueA.GetValue(a_refr), valueB.GetValue(a_refr));
+		}
+	};
+
+	class InventoryCountCondition final : public MockCondition
+	{
+	public:
+		uint32_t itemId = 0;
+		ComparisonOperator comparisonOperator = ComparisonOperator::kEqual;
+		MockNumericValue count;
+
+	protected:
+		bool EvaluateImpl(const MockRefr& a_refr, [[maybe_unused]] EvaluationContext& a_context) const override
+		{
+			return ConditionEvaluation::Compare(comparisonOperator, static_cast<float>(a_refr.GetItemCount(itemId)), count.GetValue(a_refr));
+		}
+	};
+
+	class HasKeywordCondition final : public MockCondition
+	{
+	public:
+		uint32_t keywordId = 0;
+
+	protected:
+		bool EvaluateImpl(const MockRefr& a_refr, [[maybe_unused]] EvaluationContext& a_context) const override { return a_refr.HasKeyword(keywordId); }
+	};
+
+	class IsEquippedCondition final : public MockCondition
+	{
+	public:
+		uint32_t itemId = 0;
+		bool bLeftHand = false;
+
+	protected:
+		bool EvaluateImpl(const MockRefr& a_refr, [[maybe_unused]] EvaluationContext& a_context) const override { return a_refr.GetEquippedItem(bLeftHand) == itemId; }
+	};
+
+	class RandomCondition final : public MockCondition
+	{
+	public:
+		[[nodiscard]] bool IsReorderBarrier() const override { return true; }
+
+		uint32_t conditionId = 0;
+		float chance = 0.5f;
+
+	protected:
+		bool EvaluateImpl(const MockRefr& a_refr, [[maybe_unused]] EvaluationContext& a_context) const override { return a_refr.GetRandom(conditionId) < chance; }
+	};
+
+	class ANDCondition final : public MockCondition
+	{
+	public:
+		[[nodiscard]] bool IsReorderBarrier() const override { return conditionSet.HasReorderBarrier(); }
+
+		MockConditionSet conditionSet;
+
+	protected:
+		bool EvaluateImpl(const MockRefr& a_refr, EvaluationContext& a_context) const override { return conditionSet.EvaluateAll(a_refr, a_context); }
+	};
+
+	class ORCondition final : public MockCondition
+	{
+	public:
+		[[nodiscard]] bool IsReorderBarrier() const override { return conditionSet.HasReorderBarrier(); }
+
+		MockConditionSet conditionSet;
+
+	protected:
+		bool EvaluateImpl(const MockRefr& a_refr, EvaluationContext& a_context) const override { return conditionSet.EvaluateAny(a_refr, a_context); }
+	};
+
+	// synthesizes condition trees shaped like the ones in real configs - mostly actor value and graph variable comparisons, keyword and equipment checks, some OR blocks and the occasional random condition
+	class ConditionGenerator
+	{
+	public:
+		explicit ConditionGenerator(std::mt19937& a_rng) :
+			_rng(a_rng) {}
+
+		void GenerateConditionSet(MockConditionSet& a_conditionSet, uint32_t a_minCount, uint32_t a_maxCount, uint32_t a_depth)
+		{
+			const uint32_t count = GetRandomInt(_rng, a_minCount, a_maxCount);
+			for (uint32_t i = 0; i < count; ++i) {
+				a_conditionSet.conditions.push_back(GenerateCondition(a_depth));
+			}
+		}
+
+	private:
+		std::unique_ptr<MockCondition> GenerateCondition(uint32_t a_depth)
+		{
+			std::unique_ptr<MockCondition> condition;
+
+			const float roll = GetRandomFloat(_rng, 0.f, 1.f);
+			if (roll < 0.12f && a_depth < 3) {
+				auto orCondition = std::make_unique<ORCondition>();
+				GenerateConditionSet(orCondition->conditionSet, 2, 4, a_depth + 1);
+				condition = std::move(orCondition);
+			} else if (roll < 0.16f && a_depth < 3) {
+				auto andCondition = std::make_unique<ANDCondition>();
+				GenerateConditionSet(andCondition->conditionSet, 2, 3, a_depth + 1);
+				condition = std::move(andCondition);
+			} else if (roll < 0.19f) {
+				auto randomCondition = std::make_unique<RandomCondition>();
+				randomCondition->conditionId = _nextConditionId++;
+				randomCondition->chance = GetRandomFloat(_rng, 0.1f, 0.9f);
+				condition = std::move(randomCondition);
+			} else if (roll < 0.55f) {
+				condition = GenerateCompareValues();
+			} else if (roll < 0.65f) {
+				auto inventoryCount = std::make_unique<InventoryCountCondition>();
+				inventoryCount->itemId = GetRandomInt(_rng, 0, kItemCount - 1);
+				inventoryCount->comparisonOperator = GetRandomChance(_rng, 0.5f) ? ComparisonOperator::kGreaterEqual : ComparisonOperator::kLess;
+				inventoryCount->count.staticValue = static_cast<float>(GetRandomInt(_rng, 1, 3));
+				condition = std::move(inventoryCount);
+			} else if (roll < 0.85f) {
+				auto hasKeyword = std::make_unique<HasKeywordCondition>();
+				hasKeyword->keywordId = GetRandomInt(_rng, 0, kKeywordCount - 1);
+				condition = std::move(hasKeyword);
+			} else {
+				auto isEquipped = std::make_unique<IsEquippedCondition>();
+				isEquipped->itemId = GetRandomInt(_rng, 0, 15);
+				isEquipped->bLeftHand = GetRandomChance(_rng, 0.3f);
+				condition = std::move(isEquipped);
+			}
+
+			condition->bNegated = GetRandomChance(_rng, 0.15f);
+			condition->bDisabled = GetRandomChance(_rng, 0.02f);
+
+			return condition;
+		}
+
+		std::unique_ptr<MockCondition> GenerateCompareValues()
+		{
+			auto compareValues = std::make_unique<CompareValuesCondition>();
+			auto& valueA = compareValues->valueA;
+			auto& valueB = compareValues->valueB;
+
+			// value B is a static value in the range of value A, so the comparison passes some of the time
+			const float typeRoll = GetRandomFloat(_rng, 0.f, 1.f);
+			if (typeRoll < 0.5f) {
+				valueA.type = MockNumericValue::Type::kActorValue;
+				valueA.id = GetRandomInt(_rng, 0, kActorValueCount - 1);
+				valueA.actorValueType = static_cast<ActorValueType>(GetRandomInt(_rng, 0, 3));
+				valueB.staticValue = valueA.actorValueType == ActorValueType::kPercentage ? GetRandomFloat(_rng, 0.f, 1.f) : GetRandomFloat(_rng, 0.f, 100.f);
+			} else if (typeRoll < 0.8f) {
+				valueA.type = MockNumericValue::Type::kGraphVariable;
+				valueA.graphVariableName = kGraphVariableNames[GetRandomInt(_rng, 0, static_cast<uint32_t>(kGraphVariableNames.size() - 1))];
+				valueA.graphVariableType = static_cast<GraphVariableType>(GetRandomInt(_rng, 0, 2));
+				valueB.staticValue = valueA.graphVariableType == GraphVariableType::kBool ? 1.f : static_cast<float>(GetRandomInt(_rng, 0, 4));
+			} else {
+				valueA.type = MockNumericValue::Type::kGlobalVariable;
+				valueA.id = GetRandomInt(_rng, 0, kGlobalCount - 1);
+				valueB.staticValue = GetRandomFloat(_rng, 0.f, 10.f);
+			}
+
+			// only the integer values are compared for equality
+			const bool bInteger = valueA.type == MockNumericValue::Type::kGraphVariable && valueA.graphVariableType != GraphVariableType::kFloat;
+			compareValues->comparisonOperator = bInteger ? static_cast<ComparisonOperator>(GetRandomInt(_rng, 0, 5)) : static_cast<ComparisonOperator>(GetRandomInt(_rng, 2, 5));
+
+			return compareValues;
+		}
+
+		std::mt19937& _rng;
+		uint32_t _nextConditionId = 0;
+	};
+
+	// like AnimationReplacements::Candidate, a submod's condition set is shared by all of its replacement animations
+	struct Candidate
+	{
+		const MockConditionSet* conditionSet;
+		uint32_t subModIndex;
+	};
+
+	// the replacements of one animation, in priority order. Some end with a submod without conditions
+	std::vector<std::vector<Candidate>> GenerateCandidateLists(size_t a_clipCount, const std::vector<MockConditionSet>& a_conditionSets, const MockConditionSet& a_emptySet, std::mt19937& a_rng)
+	{
+		std::vector<std::vector<Candidate>> candidateLists(a_clipCount);
+		for (auto& candidates : candidateLists) {
+			const uint32_t count = GetRandomInt(a_rng, 1, 12);
+			for (uint32_t i = 0; i < count; ++i) {
+				const uint32_t subModIndex = GetRandomInt(a_rng, 0, static_cast<uint32_t>(a_conditionSets.size() - 1));
+				candidates.push_back({ &a_conditionSets[subModIndex], subModIndex });
+			}
+			if (GetRandomChance(a_rng, 0.4f)) {
+				candidates.push_back({ &a_emptySet, static_cast<uint32_t>(a_conditionSets.size()) });
+			}
+		}
+
+		return candidateLists;
+	}
+
+	struct Setup
+	{
+		size_t sets = 200;   // submods
+		size_t clips = 50;   // animations with replacements
+		size_t refrs = 4;    // every condition set and animation is evaluated for each of them
+		size_t passes = 500; // the order is first updated after 2 * ReorderingEvaluator::kUpdateInterval evaluations of a set
+		uint32_t seed = 1;
+		bool bReorder = true;
+	};
+
+	// the machine independent results. The passed evaluations, selections and tested candidates don't depend on the order the conditions are evaluated in, a change means the reordering changed a result
+	struct Result
+	{
+		uint64_t evaluations = 0;
+		uint64_t passedEvaluations = 0;
+		double conditionsPerEvaluation = 0.0;
+		double factReadsPerEvaluation = 0.0;
+
+		uint64_t selections = 0;
+		uint64_t selectionChecksum = 0;  // sum of the submod index + 1 of every selected candidate
+		double candidatesPerSelection = 0.0;
+		double conditionsPerSelection = 0.0;
+		double conditionsPerBatchedSelection = 0.0;
+	};
+
+	struct Baseline
+	{
+		Setup setup;
+		Result result;
+		double tolerance = 0.05;  // the order follows the measured time, so the condition counts vary slightly between runs
+	};
+
+	constexpr const char* kBaselineSection = "ConditionBenchmark";
+
+	bool SaveBaseline(const Baseline& a_baseline, const char* a_path)
+	{
+		BenchmarkBaseline::Section section;
+		section.setup = {
+			{ "sets", static_cast<double>(a_baseline.setup.sets) },
+			{ "clips", static_cast<double>(a_baseline.setup.clips) },
+			{ "refrs", static_cast<double>(a_baseline.setup.refrs) },
+			{ "passes", static_cast<double>(a_baseline.setup.passes) },
+			{ "seed", static_cast<double>(a_baseline.setup.seed) },
+			{ "reorder", a_baseline.setup.bReorder ? 1.0 : 0.0 }
+		};
+		section.tolerance = a_baseline.tolerance;
+		section.metrics = {
+			{ "passedEvaluations", static_cast<double>(a_baseline.result.passedEvaluations) },
+			{ "conditionsPerEvaluation", a_baseline.result.conditionsPerEvaluation },
+			{ "factReadsPerEvaluation", a_baseline.result.factReadsPerEvaluation },
+			{ "selectionChecksum", static_cast<double>(a_baseline.result.selectionChecksum) },
+			{ "candidatesPerSelection", a_baseline.result.candidatesPerSelection },
+			{ "conditionsPerSelection", a_baseline.result.conditionsPerSelection },
+			{ "conditionsPerBatchedSelection", a_baseline.result.conditionsPerBatchedSelection }
+		};
+
+		return BenchmarkBaseline::SaveSection(a_path, kBaselineSection, section);
+	}
+
+	bool LoadBaseline(const char* a_path, Baseline& a_outBaseline)
+	{
+		BenchmarkBaseline::Section section;
+		if (!BenchmarkBaseline::LoadSection(a_path, kBaselineSection, section)) {
+			return false;
+		}
+
+		bool bComplete = true;
+		const auto read = [&](const std::optional<double>& a_value, auto& a_outValue) {
+			if (a_value) {
+				a_outValue = static_cast<std::remove_reference_t<decltype(a_outValue)>>(*a_value);
+			} else {
+				bComplete = false;
+			}
+		};
+
+		read(section.GetSetup("sets"), a_outBaseline.setup.sets);
+		read(section.GetSetup("clips"), a_outBaseline.setup.clips);
+		read(section.GetSetup("refrs"), a_outBaseline.setup.refrs);
+		read(section.GetSetup("passes"), a_outBaseline.setup.passes);
+		read(section.GetSetup("seed"), a_outBaseline.setup.seed);
+		read(section.GetSetup("reorder"), a_outBaseline.setup.bReorder);
+		a_outBaseline.tolerance = section.tolerance;
+		read(section.GetMetric("passedEvaluations"), a_outBaseline.result.passedEvaluations);
+		read(section.GetMetric("conditionsPerEvaluation"), a_outBaseline.result.conditionsPerEvaluation);
+		read(section.GetMetric("factReadsPerEvaluation"), a_outBaseline.result.factReadsPerEvaluation);
+		read(section.GetMetric("selectionChecksum"), a_outBaseline.result.selectionChecksum);
+		read(section.GetMetric("candidatesPerSelection"), a_outBaseline.result.candidatesPerSelection);
+		read(section.GetMetric("conditionsPerSelection"), a_outBaseline.result.conditionsPerSelection);
+		read(section.GetMetric("conditionsPerBatchedSelection"), a_outBaseline.result.conditionsPerBatchedSelection);
+
+		return bComplete;
+	}
+
+	ConditionBenchmark::Comparison Compare(const Result& a_result, const Baseline& a_baseline)
+	{
+		using ConditionBenchmark::CompareMetric;
+
+		const auto& baseline = a_baseline.result;
+		const double tolerance = a_baseline.tolerance;
+
+		ConditionBenchmark::Comparison comparison;
+		comparison.metrics.emplace_back("Passed evaluations", static_cast<double>(baseline.passedEvaluations), static_cast<double>(a_result.passedEvaluations), a_result.passedEvaluations != baseline.passedEvaluations);
+		comparison.metrics.emplace_back(CompareMetric("Conditions per evaluation", baseline.conditionsPerEvaluation, a_result.conditionsPerEvaluation, tolerance, false));
+		comparison.metrics.emplace_back(CompareMetric("Fact reads per evaluation", baseline.factReadsPerEvaluation, a_result.factReadsPerEvaluation, tolerance, false));
+		comparison.metrics.emplace_back("Selection checksum", static_cast<double>(baseline.selectionChecksum), static_cast<double>(a_result.selectionChecksum), a_result.selectionChecksum != baseline.selectionChecksum);
+		comparison.metrics.emplace_back(CompareMetric("Candidates per selection", baseline.candidatesPerSelection, a_result.candidatesPerSelection, tolerance, false));
+		comparison.metrics.emplace_back(CompareMetric("Conditions per selection", baseline.conditionsPerSelection, a_result.conditionsPerSelection, tolerance, false));
+		comparison.metrics.emplace_back(CompareMetric("Conditions per batched", baseline.conditionsPerBatchedSelection, a_result.conditionsPerBatchedSelection, tolerance, false));
+
+		return comparison;
+	}
+
+	uint64_t GetPercentile(std::vector<uint64_t>& a_samples, double a_percentile)
+	{
+		if (a_samples.empty()) {
+			return 0;
+		}
+
+		const auto index = static_cast<size_t>(a_percentile * (a_samples.size() - 1));
+		std::ranges::nth_element(a_samples, a_samples.begin() + static_cast<ptrdiff_t>(index));
+		return a_samples[index];
+	}
+
+	uint64_t GetElapsedNanoseconds(std::chrono::steady_clock::time_point a_startTime)
+	{
+		return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - a_startTime).count());
+	}
+
+	void PrintTimes(const char* a_name, std::vector<uint64_t>& a_samples, double a_totalTime)
+	{
+		const uint64_t maxSample = a_samples.empty() ? 0 : std::ranges::max(a_samples);
+		std::printf("%s: %zu in %.3f s (%.0f/s), p50 %llu ns, p90 %llu ns, p99 %llu ns, max %llu ns\n", a_name, a_samples.size(), a_totalTime, a_samples.size() / a_totalTime, static_cast<unsigned long long>(GetPercentile(a_samples, 0.5)), static_cast<unsigned long long>(GetPercentile(a_samples, 0.9)), static_cast<unsigned long long>(GetPercentile(a_samples, 0.99)), static_cast<unsigned long long>(maxSample));
+	}
+}
+
+int main(int a_argc, char* a_argv[])
+{
+	Setup setup;
+	const char* baselinePath = nullptr;
+	const char* saveBaselinePath = nullptr;
+
+	for (int i = 1; i < a_argc; ++i) {
+		if (std::strcmp(a_argv[i], "--sets") == 0 && i + 1 < a_argc) {
+			setup.sets = std::stoul(a_argv[++i]);
+		} else if (std::strcmp(a_argv[i], "--clips") == 0 && i + 1 < a_argc) {
+			setup.clips = std::stoul(a_argv[++i]);
+		} else if (std::strcmp(a_argv[i], "--passes") == 0 && i + 1 < a_argc) {
+			setup.passes = std::stoul(a_argv[++i]);
+		} else if (std::strcmp(a_argv[i], "--seed") == 0 && i + 1 < a_argc) {
+			setup.seed = static_cast<uint32_t>(std::stoul(a_argv[++i]));
+		} else if (std::strcmp(a_argv[i], "--no-reorder") == 0) {
+			setup.bReorder = false;
+		} else if (std::strcmp(a_argv[i], "--baseline") == 0 && i + 1 < a_argc) {
+			baselinePath = a_argv[++i];
+		} else if (std::strcmp(a_argv[i], "--save-baseline") == 0 && i + 1 < a_argc) {
+			saveBaselinePath = a_argv[++i];
+		} else {
+			std::fprintf(stderr, "Usage: ConditionBenchmark [--sets N] [--clips N] [--passes N] [--seed N] [--no-reorder] [--save-baseline <file>]\n       ConditionBenchmark --baseline <file>\n");
+			return 1;
+		}
+	}
+
+	Baseline baseline;
+	if (baselinePath) {
+		if (!LoadBaseline(baselinePath, baseline)) {
+			std::fprintf(stderr, "Failed to load the baseline: %s\n", baselinePath);
+			return 1;
+		}
+		setup = baseline.setup;
+	}
+
+	if (setup.sets == 0 || setup.clips == 0 || setup.refrs == 0 || setup.passes == 0) {
+		std::fprintf(stderr, "--sets, --clips and --passes must be at least 1\n");
+		return 1;
+	}
+
+	std::mt19937 rng(setup.seed);
+
+	std::vector<MockConditionSet> conditionSets(setup.sets);
+	ConditionGenerator generator(rng);
+	for (auto& conditionSet : conditionSets) {
+		generator.GenerateConditionSet(conditionSet, 1, 8, 0);
+	}
+	const MockConditionSet emptySet;
+	const auto candidateLists = GenerateCandidateLists(setup.clips, conditionSets, emptySet, rng);
+
+	std::vector<MockRefr> refrs(setup.refrs);
+
+	Result result;
+	EvaluationContext context{ setup.bReorder };
+	std::vector<uint64_t> evaluationSamples;
+	std::vector<uint64_t> selectionSamples;
+	std::vector<uint64_t> batchSamples;
+	evaluationSamples.reserve(setup.sets * setup.refrs * setup.passes);
+	selectionSamples.reserve(setup.clips * setup.refrs * setup.passes);
+	batchSamples.reserve(setup.clips * setup.passes);
+	uint64_t evaluationConditions = 0;
+	uint64_t evaluationFactReads = 0;
+	uint64_t selectionConditions = 0;
+	uint64_t batchConditions = 0;
+	uint64_t testedCandidates = 0;
+	double evaluationTime = 0.0;
+	double selectionTime = 0.0;
+	double batchTime = 0.0;
+
+	struct BatchRequest
+	{
+		const MockRefr* refr;
+		const Candidate* result = nullptr;
+	};
+	std::vector<BatchRequest> batchRequests(setup.refrs);
+	std::vector<const Candidate*> selected(setup.refrs);
+
+	for (size_t pass = 0; pass < setup.passes; ++pass) {
+		for (auto& refr : refrs) {
+			refr.Advance(rng);
+		}
+
+		// ConditionSet::EvaluateAll of every submod's conditions
+		{
+			const uint64_t conditionsBefore = context.conditionEvaluations;
+			uint64_t factReadsBefore = 0;
+			for (const auto& refr : refrs) {
+				factReadsBefore += refr.GetFactReads();
+			}
+
+			const auto startTime = std::chrono::steady_clock::now();
+			for (const auto& conditionSet : conditionSets) {
+				for (const auto& refr : refrs) {
+					const auto evaluationStartTime = std::chrono::steady_clock::now();
+					const bool bPassed = conditionSet.EvaluateAll(refr, context);
+					evaluationSamples.push_back(GetElapsedNanoseconds(evaluationStartTime));
+					if (bPassed) {
+						++result.passedEvaluations;
+					}
+				}
+			}
+			evaluationTime += GetElapsedNanoseconds(startTime) / 1e9;
+
+			evaluationConditions += context.conditionEvaluations - conditionsBefore;
+			for (const auto& refr : refrs) {
+				evaluationFactReads += refr.GetFactReads();
+			}
+			evaluationFactReads -= factReadsBefore;
+		}
+
+		// AnimationReplacements::EvaluateConditionsAndGetReplacementAnimation of every animation for every refr
+		{
+			const uint64_t conditionsBefore = context.conditionEvaluations;
+			const auto startTime = std::chrono::steady_clock::now();
+			for (const auto& candidates : candidateLists) {
+				for (size_t i = 0; i < refrs.size(); ++i) {
+					const auto selectionStartTime = std::chrono::steady_clock::now();
+					selected[i] = ReplacementSelection::SelectCandidate(
+						std::span(candidates),
+						[](const Candidate& a_candidate) { return a_candidate.conditionSet->IsEmpty(); },
+						[&](const Candidate& a_candidate) { return a_candidate.conditionSet->EvaluateAll(refrs[i], context); },
+						[&](const Candidate&) { ++testedCandidates; });
+					selectionSamples.push_back(GetElapsedNanoseconds(selectionStartTime));
+
+					if (selected[i]) {
+						result.selectionChecksum += selected[i]->subModIndex + 1;
+					}
+				}
+			}
+			selectionTime += GetElapsedNanoseconds(startTime) / 1e9;
+			selectionConditions += context.conditionEvaluations - conditionsBefore;
+		}
+
+		// AnimationReplacements::EvaluateConditionsForBatch of every animation for all refrs at once, has to pick the same candidates
+		{
+			for (const auto& candidates : candidateLists) {
+				for (size_t i = 0; i < refrs.size(); ++i) {
+					batchRequests[i] = { &refrs[i], nullptr };
+				}
+
+				const uint64_t conditionsBefore = context.conditionEvaluations;
+				const auto batchStartTime = std::chrono::steady_clock::now();
+				ReplacementSelection::SelectCandidatesForBatch(
+					std::span(candidates),
+					std::span(batchRequests),
+					[](const Candidate& a_candidate) { return a_candidate.conditionSet->IsEmpty(); },
+					[&](const Candidate& a_candidate, const BatchRequest& a_request) { return a_candidate.conditionSet->EvaluateAll(*a_request.refr, context); },
+					[](BatchRequest& a_request, const Candidate& a_candidate) { a_request.result = &a_candidate; });
+				batchSamples.push_back(GetElapsedNanoseconds(batchStartTime));
+				batchTime += batchSamples.back() / 1e9;
+				batchConditions += context.conditionEvaluations - conditionsBefore;
+
+				for (size_t i = 0; i < refrs.size(); ++i) {
+					const auto expected = ReplacementSelection::SelectCandidate(
+						std::span(candidates),
+						[](const Candidate& a_candidate) { return a_candidate.conditionSet->IsEmpty(); },
+						[&](const Candidate& a_candidate) {
+							EvaluationContext checkContext{ false };
+							return a_candidate.conditionSet->EvaluateAll(refrs[i], checkContext);
+						},
+						[](const Candidate&) {});
+					if (batchRequests[i].result != expected) {
+						std::fprintf(stderr, "The batched selection picked a different candidate than the single selection (pass %zu)\n", pass);
+						return 1;
+					}
+				}
+			}
+		}
+	}
+
+	result.evaluations = evaluationSamples.size();
+	result.selections = selectionSamples.size();
+	const auto evaluations = static_cast<double>(result.evaluations);
+	const auto selections = static_cast<double>(result.selections);
+	result.conditionsPerEvaluation = evaluationConditions / evaluations;
+	result.factReadsPerEvaluation = evaluationFactReads / evaluations;
+	result.candidatesPerSelection = testedCandidates / selections;
+	result.conditionsPerSelection = selectionConditions / selections;
+	result.conditionsPerBatchedSelection = batchConditions / selections;
+
+	std::printf("%zu submods, %zu animations, %zu refrs, %zu passes, reordering %s, seed %u\n", setup.sets, setup.clips, setup.refrs, setup.passes, setup.bReorder ? "on" : "off", setup.seed);
+	PrintTimes("Condition set evaluations", evaluationSamples, evaluationTime);
+	PrintTimes("Replacement selections", selectionSamples, selectionTime);
+	PrintTimes("Batched selections", batchSamples, batchTime);
+	std::printf("Per evaluation: %.1f%% passed, %.2f conditions, %.2f fact reads\n", 100.0 * result.passedEvaluations / evaluations, result.conditionsPerEvaluation, result.factReadsPerEvaluation);
+	std::printf("Per selection: %.2f candidates, %.2f conditions, %.2f conditions batched\n", result.candidatesPerSelection, result.conditionsPerSelection, result.conditionsPerBatchedSelection);
+
+	if (saveBaselinePath) {
+		if (!SaveBaseline({ setup, result, baseline.tolerance }, saveBaselinePath)) {
+			std::fprintf(stderr, "Failed to save the baseline: %s\n", saveBaselinePath);
+			return 1;
+		}
+		std::printf("Saved the baseline to %s\n", saveBaselinePath);
+	}
+
+	if (baselinePath) {
+		const auto comparison = Compare(result, baseline);
+
+		std::printf("\nCompared to the baseline (tolerance %.0f%%)\n", baseline.tolerance * 100.0);
+		for (const auto& metric : comparison.metrics) {
+			std::printf("%-26s %12.2f %12.2f %+7.1f%%%s\n", metric.name.data(), metric.baseline, metric.current, metric.GetChange() * 100.0, metric.bRegressed ? "  REGRESSED" : "");
+		}
+
+		if (comparison.HasRegressions()) {
+			return 1;
+		}
+	}
+
+	return 0;
+}
@@ -0,0 +1,267 @@
+// Measures the throughput of the legacy _conditions.txt parser (LegacyConditions.h) through ConditionsTxtHarness.h, in MB/s over a corpus
+// The corpus is either generated or every _conditions.txt under a directory, like the meshes folder of a mod list:
+//     ConditionsTxtBenchmark [--files 2000] [--passes 20] [--seed 1] [--save-baseline <file>] [directory]
+//     ConditionsTxtBenchmark --baseline <file>
+// With --baseline, parses the corpus generated with the setup saved in the ConditionsTxtBenchmark section of the baseline (BenchmarkBaseline.json) and exits with 1 if the parse result changed
+// Only the machine independent metrics are compared, the time is too noisy to gate on
+
+#include "BenchmarkBaseline.h"
+#include "ConditionBenchmarkComparison.h"
+#include "ConditionsTxtHarness.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace
+{
+	using namespace std::literals;
+
+	std::vector<std::string> LoadCorpus(const std::filesystem::path& a_directory)
+	{
+		std::vector<std::string> corpus;
+
+		std::error_code errorCode;
+		for (std::filesystem::recursive_directory_iterator it(a_directory, errorCode), end; !errorCode && it != end; it.increment(errorCode)) {
+			if (it->is_regular_file() && it->path().filename() == "_conditions.txt"sv) {
+				std::ifstream stream(it->path(), std::ios::binary);
+				corpus.emplace_back(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+			}
+		}
+
+		return corpus;
+	}
+
+	std::vector<std::string> GenerateCorpus(size_t a_fileCount, uint32_t a_seed)
+	{
+		std::vector<std::string> corpus;
+		corpus.reserve(a_fileCount);
+
+		std::mt19937 rng(a_seed);
+		for (size_t i = 0; i < a_fileCount; ++i) {
+			// most files only have a few conditions
+			const size_t conditionCount = 1 + (rng() % 4 == 0 ? rng() % 60 : rng() % 6);
+			corpus.push_back(ConditionsTxtHarness::GenerateConditionsTxt(rng, conditionCount));
+		}
+
+		return corpus;
+	}
+
+	struct Setup
+	{
+		size_t files = 2000;
+		uint32_t passes = 20;
+		uint32_t seed = 1;
+	};
+
+	// the parse of one pass over the corpus
+	struct Result
+	{
+		uint64_t corpusBytes = 0;
+		uint64_t conditionLines = 0;
+		uint64_t conditions = 0;
+		uint64_t orBlocks = 0;
+		uint64_t invalidConditions = 0;
+		uint64_t invalidArguments = 0;
+		uint64_t incompleteFiles = 0;
+		uint64_t formLookups = 0;
+		uint64_t foundForms = 0;
+	};
+
+	struct Baseline
+	{
+		Setup setup;
+		Result result;
+		double tolerance = 0.0;  // the parse is deterministic, every count has to match
+	};
+
+	constexpr const char* kBaselineSection = "ConditionsTxtBenchmark";
+
+	// the metrics in the order they're saved
+	constexpr std::pair<const char*, uint64_t Result::*> kMetrics[] = {
+		{ "corpusBytes", &Result::corpusBytes },
+		{ "conditionLines", &Result::conditionLines },
+		{ "conditions", &Result::conditions },
+		{ "orBlocks", &Result::orBlocks },
+		{ "invalidConditions", &Result::invalidConditions },
+		{ "invalidArguments", &Result::invalidArguments },
+		{ "incompleteFiles", &Result::incompleteFiles },
+		{ "formLookups", &Result::formLookups },
+		{ "foundForms", &Result::foundForms }
+	};
+
+	bool SaveBaseline(const Baseline& a_baseline, const char* a_path)
+	{
+		BenchmarkBaseline::Section section;
+		section.setup = {
+			{ "files", static_cast<double>(a_baseline.setup.files) },
+			{ "passes", static_cast<double>(a_baseline.setup.passes) },
+			{ "seed", static_cast<double>(a_baseline.setup.seed) }
+		};
+		section.tolerance = a_baseline.tolerance;
+		for (const auto& [name, member] : kMetrics) {
+			section.metrics.emplace_back(name, static_cast<double>(a_baseline.result.*member));
+		}
+
+		return BenchmarkBaseline::SaveSection(a_path, kBaselineSection, section);
+	}
+
+	bool LoadBaseline(const char* a_path, Baseline& a_outBaseline)
+	{
+		BenchmarkBaseline::Section section;
+		if (!BenchmarkBaseline::LoadSection(a_path, kBaselineSection, section)) {
+			return false;
+		}
+
+		const auto files = section.GetSetup("files");
+		const auto passes = section.GetSetup("passes");
+		const auto seed = section.GetSetup("seed");
+		if (!files || !passes || !seed) {
+			return false;
+		}
+		a_outBaseline.setup = { static_cast<size_t>(*files), static_cast<uint32_t>(*passes), static_cast<uint32_t>(*seed) };
+		a_outBaseline.tolerance = section.tolerance;
+
+		for (const auto& [name, member] : kMetrics) {
+			const auto value = section.GetMetric(name);
+			if (!value) {
+				return false;
+			}
+			a_outBaseline.result.*member = static_cast<uint64_t>(*value);
+		}
+
+		return true;
+	}
+
+	ConditionBenchmark::Comparison Compare(const Result& a_result, const Baseline& a_baseline)
+	{
+		ConditionBenchmark::Comparison comparison;
+		for (const auto& [name, member] : kMetrics) {
+			const auto baselineValue = static_cast<double>(a_baseline.result.*member);
+			const auto currentValue = static_cast<double>(a_result.*member);
+			auto metric = ConditionBenchmark::CompareMetric(name, baselineValue, currentValue, a_baseline.tolerance, false);
+			metric.bRegressed = metric.bRegressed || (a_baseline.tolerance == 0.0 && currentValue != baselineValue);
+			comparison.metrics.push_back(metric);
+		}
+
+		return comparison;
+	}
+
+	void PrintUsage()
+	{
+		std::fprintf(stderr, "Usage: ConditionsTxtBenchmark [--files 2000] [--passes 20] [--seed 1] [--save-baseline <file>] [directory]\n       ConditionsTxtBenchmark --baseline <file>\n");
+	}
+}
+
+int main(int a_argc, char* a_argv[])
+{
+	Setup setup;
+	const char* directory = nullptr;
+	const char* baselinePath = nullptr;
+	const char* saveBaselinePath = nullptr;
+
+	for (int i = 1; i < a_argc; ++i) {
+		const std::string_view arg = a_argv[i];
+		if (arg == "--files"sv && i + 1 < a_argc) {
+			setup.files = std::strtoull(a_argv[++i], nullptr, 10);
+		} else if (arg == "--passes"sv && i + 1 < a_argc) {
+			setup.passes = static_cast<uint32_t>(std::strtoul(a_argv[++i], nullptr, 10));
+		} else if (arg == "--seed"sv && i + 1 < a_argc) {
+			setup.seed = static_cast<uint32_t>(std::strtoul(a_argv[++i], nullptr, 10));
+		} else if (arg == "--baseline"sv && i + 1 < a_argc) {
+			baselinePath = a_argv[++i];
+		} else if (arg == "--save-baseline"sv && i + 1 < a_argc) {
+			saveBaselinePath = a_argv[++i];
+		} else if (arg.starts_with("--"sv) || directory) {
+			PrintUsage();
+			return 1;
+		} else {
+			directory = a_argv[i];
+		}
+	}
+
+	// the baseline is of the generated corpus
+	if (directory && (baselinePath || saveBaselinePath)) {
+		PrintUsage();
+		return 1;
+	}
+
+	Baseline baseline;
+	if (baselinePath) {
+		if (!LoadBaseline(baselinePath, baseline)) {
+			std::fprintf(stderr, "Failed to load the baseline: %s\n", baselinePath);
+			return 1;
+		}
+		setup = baseline.setup;
+	}
+
+	const auto corpus = directory ? LoadCorpus(directory) : GenerateCorpus(setup.files, setup.seed);
+	if (corpus.empty() || setup.passes == 0) {
+		std::fprintf(stderr, "Nothing to parse\n");
+		return 1;
+	}
+
+	Result result;
+	for (const auto& text : corpus) {
+		result.corpusBytes += text.size();
+	}
+
+	ConditionsTxtHarness::FormLookup formLookup;
+
+	const auto startTime = std::chrono::steady_clock::now();
+	for (uint32_t pass = 0; pass < setup.passes; ++pass) {
+		for (const auto& text : corpus) {
+			const auto stats = ConditionsTxtHarness::Parse(text, formLookup);
+			if (pass == 0) {
+				result.conditionLines += stats.conditionLines;
+				result.conditions += stats.conditions;
+				result.orBlocks += stats.orBlocks;
+				result.invalidConditions += stats.invalidConditions;
+				result.invalidArguments += stats.invalidArguments;
+				result.incompleteFiles += stats.bComplete ? 0 : 1;
+			}
+		}
+	}
+	const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+	result.formLookups = formLookup.lookups / setup.passes;
+	result.foundForms = formLookup.foundForms / setup.passes;
+
+	const double parsedBytes = static_cast<double>(result.corpusBytes) * setup.passes;
+	std::printf("%zu files, %.2f MB, %u passes\n", corpus.size(), result.corpusBytes / 1e6, setup.passes);
+	std::printf("%llu condition lines, %llu top level conditions, %llu OR blocks, %llu invalid conditions, %llu invalid arguments, %llu files cut off\n",
+		static_cast<unsigned long long>(result.conditionLines), static_cast<unsigned long long>(result.conditions), static_cast<unsigned long long>(result.orBlocks),
+		static_cast<unsigned long long>(result.invalidConditions), static_cast<unsigned long long>(result.invalidArguments), static_cast<unsigned long long>(result.incompleteFiles));
+	std::printf("%llu form lookups, %llu found\n", static_cast<unsigned long long>(result.formLookups), static_cast<unsigned long long>(result.foundForms));
+	std::printf("%.1f MB/s, %.0f files/s, %.0f ns per condition line\n", parsedBytes / 1e6 / seconds, corpus.size() * setup.passes / seconds, seconds * 1e9 / (static_cast<double>(result.conditionLines) * setup.passes));
+
+	if (saveBaselinePath) {
+		if (!SaveBaseline({ setup, result, baseline.tolerance }, saveBaselinePath)) {
+			std::fprintf(stderr, "Failed to save the baseline: %s\n", saveBaselinePath);
+			return 1;
+		}
+		std::printf("Saved the baseline to %s\n", saveBaselinePath);
+	}
+
+	if (baselinePath) {
+		const auto comparison = Compare(result, baseline);
+
+		std::printf("\nCompared to the baseline (tolerance %.0f%%)\n", baseline.tolerance * 100.0);
+		for (const auto& metric : comparison.metrics) {
+			std::printf("%-26s %12.2f %12.2f %+7.1f%%%s\n", metric.name.data(), metric.baseline, metric.current, metric.GetChange() * 100.0, metric.bRegressed ? "  REGRESSED" : "");
+		}
+
+		if (comparison.HasRegressions()) {
+			return 1;
+		}
+	}
+
+	return 0;
+}
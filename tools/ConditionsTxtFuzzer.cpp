@@ -0,0 +1,185 @@
+// Fuzzes the legacy _conditions.txt parser (LegacyConditions.h) through ConditionsTxtHarness.h
+// With clang it's a libFuzzer target (-DOAR_LIBFUZZER, set by tools/CMakeLists.txt):
+//     ConditionsTxtFuzzer [corpus dir]
+// Without libFuzzer it mutates generated and hand written seeds on its own, and is built with the address and undefined behavior sanitizers where the compiler has them:
+//     ConditionsTxtFuzzer [--iterations 20000] [--seed 1] [files to replay...]
+// Any crash, sanitizer report or broken invariant (the builder called out of order, more conditions than kMaxTxtConditionCount) fails it
+
+#include "ConditionsTxtHarness.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace
+{
+	void CheckInvariants(std::string_view a_text)
+	{
+		ConditionsTxtHarness::FormLookup formLookup;
+		const auto stats = ConditionsTxtHarness::Parse(a_text, formLookup);
+
+		const bool bValid = stats.bConsistent &&
+		                    stats.conditionLines <= ConfigLimits::kMaxTxtConditionCount + 1 &&
+		                    stats.conditions <= stats.conditionLines + stats.orBlocks &&  // a comment ending with OR can open an empty OR block
+		                    stats.orBlocks <= stats.conditions &&
+		                    stats.argumentBytes <= a_text.size() &&
+		                    formLookup.foundForms <= formLookup.lookups;
+
+		if (!bValid) {
+			std::fprintf(stderr, "Broken invariant on a %zu byte input: %llu conditions, %llu condition lines, %llu OR blocks%s\n", a_text.size(), static_cast<unsigned long long>(stats.conditions), static_cast<unsigned long long>(stats.conditionLines), static_cast<unsigned long long>(stats.orBlocks), stats.bConsistent ? "" : ", builder called out of order");
+			std::abort();
+		}
+	}
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* a_data, size_t a_size)
+{
+	CheckInvariants(std::string_view(reinterpret_cast<const char*>(a_data), a_size));
+	return 0;
+}
+
+#ifndef OAR_LIBFUZZER
+namespace
+{
+	using namespace std::literals;
+
+	constexpr std::string_view kTokens[] = { "OR"sv, " OR"sv, "NOT "sv, "NOT"sv, "("sv, ")"sv, "|"sv, ","sv, ";"sv, "\n"sv, "\r\n"sv, "\r"sv, " "sv, "\""sv, "0x"sv, "FFFFFFFF"sv, "-1"sv, "1e39"sv, "nan"sv, "\xC3\xA9"sv, "\0"sv };
+
+	std::vector<std::string> MakeSeeds()
+	{
+		std::vector<std::string> seeds = {
+			""s,
+			"\n\n\r\n"s,
+			"OR\nOR\nOR"s,
+			"; comment OR\nIsFemale()\n"s,
+			"NOT\nNOT NOT IsFemale()\n"s,
+			"IsEquipped(\"Skyrim.esm\" | 0x00012EB7)"s,
+			"IsEquipped(\"Skyrim.esm\" | )\nHasKeyword(|)\nFactionRank(,)\nValueEqualTo(,\"Skyrim.esm\" | 0x39)\n"s,
+			"IsActorValueLessThan(24, 0.5) OR\nRandom(0.3)\n"s,
+			"IsForm) (\"Skyrim.esm\" | 0x7)\nIsForm ()\nIsForm(\n"s,
+		};
+
+		std::mt19937 rng(7);
+		for (size_t conditionCount : { 1, 5, 20, 100 }) {
+			seeds.push_back(ConditionsTxtHarness::GenerateConditionsTxt(rng, conditionCount));
+		}
+
+		// the limits
+		seeds.push_back("IsEquipped(\"" + std::string(ConfigLimits::kMaxTxtLineLength, 'A') + "\" | 0x7)\n");
+		seeds.push_back(std::string(ConfigLimits::kMaxTxtConditionCount + 10, '\n') + "IsFemale()");
+		std::string manyConditions;
+		for (size_t i = 0; i < ConfigLimits::kMaxTxtConditionCount + 10; ++i) {
+			manyConditions += "IsFemale() OR\n";
+		}
+		seeds.push_back(std::move(manyConditions));
+
+		return seeds;
+	}
+
+	std::string Mutate(const std::string& a_seed, std::mt19937& a_rng)
+	{
+		std::string text = a_seed;
+		const size_t mutationCount = 1 + a_rng() % 8;
+
+		for (size_t i = 0; i < mutationCount; ++i) {
+			const size_t pos = text.empty() ? 0 : a_rng() % (text.size() + 1);
+
+			switch (a_rng() % 6) {
+			case 0:  // flip a byte
+				if (!text.empty()) {
+					text[pos % text.size()] ^= static_cast<char>(1 << (a_rng() % 8));
+				}
+				break;
+			case 1:  // insert a token
+				text.insert(pos, kTokens[a_rng() % std::size(kTokens)]);
+				break;
+			case 2:  // erase a range
+				text.erase(pos, a_rng() % 16);
+				break;
+			case 3:  // truncate
+				text.resize(pos);
+				break;
+			case 4:  // repeat a range
+				if (pos < text.size()) {
+					const std::string range = text.substr(pos, 1 + a_rng() % 32);
+					for (size_t repeat = a_rng() % 64; repeat > 0; --repeat) {
+						text.insert(pos, range);
+					}
+				}
+				break;
+			case 5:  // a long run of one byte
+				text.insert(pos, 1 + a_rng() % (2 * ConfigLimits::kMaxTxtLineLength), kTokens[a_rng() % std::size(kTokens)][0]);
+				break;
+			}
+		}
+
+		return text;
+	}
+
+	void PrintUsage()
+	{
+		std::fprintf(stderr, "Usage: ConditionsTxtFuzzer [--iterations 20000] [--seed 1] [files to replay...]\n");
+	}
+}
+
+int main(int a_argc, char* a_argv[])
+{
+	uint64_t iterations = 20000;
+	uint32_t seed = 1;
+	std::vector<const char*> files;
+
+	for (int i = 1; i < a_argc; ++i) {
+		const std::string_view arg = a_argv[i];
+		if (arg == "--iterations"sv && i + 1 < a_argc) {
+			iterations = std::strtoull(a_argv[++i], nullptr, 10);
+		} else if (arg == "--seed"sv && i + 1 < a_argc) {
+			seed = static_cast<uint32_t>(std::strtoul(a_argv[++i], nullptr, 10));
+		} else if (arg.starts_with("--"sv)) {
+			PrintUsage();
+			return 1;
+		} else {
+			files.push_back(a_argv[i]);
+		}
+	}
+
+	// replays the given inputs, like a libFuzzer reproducer
+	if (!files.empty()) {
+		for (const auto file : files) {
+			std::ifstream stream(file, std::ios::binary);
+			if (!stream.is_open()) {
+				std::fprintf(stderr, "Can't open %s\n", file);
+				return 1;
+			}
+			const std::string text((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+			CheckInvariants(text);
+		}
+		std::printf("%zu inputs passed\n", files.size());
+		return 0;
+	}
+
+	const auto seeds = MakeSeeds();
+	for (const auto& seedText : seeds) {
+		CheckInvariants(seedText);
+	}
+
+	// too big to be worth mutating
+	CheckInvariants(std::string(ConfigLimits::kMaxTxtFileSize + 1, 'A'));
+
+	std::mt19937 rng(seed);
+	uint64_t bytes = 0;
+	for (uint64_t i = 0; i < iterations; ++i) {
+		const auto text = Mutate(seeds[rng() % seeds.size()], rng);
+		bytes += text.size();
+		CheckInvariants(text);
+	}
+
+	std::printf("%zu seeds and %llu mutated inputs (%.1f MB) passed\n", seeds.size(), static_cast<unsigned long long>(iterations), bytes / 1e6);
+	return 0;
+}
+#endif
@@ -0,0 +1,391 @@
+#pragma once
+
+// Feeds legacy _conditions.txt files through the same grammar as the game (LegacyConditions.h) without the game
+// The builder stands in for ConditionsTxtBuilder in Parsing.cpp, and the arguments are parsed like the InitializeLegacy of the conditions in Conditions.cpp, with the form lookups going to a stub
+// Shared by ConditionsTxtFuzzer.cpp and ConditionsTxtBenchmark.cpp
+
+#include "ConfigLimits.h"
+#include "LegacyConditions.h"
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <string_view>
+
+namespace ConditionsTxtHarness
+{
+	using namespace std::literals;
+
+	// what InitializeLegacy does with the argument
+	enum class ArgumentKind : uint8_t
+	{
+		kNone,           // no InitializeLegacy, the argument is ignored
+		kForm,           // FormValue::ParseLegacy, also keywords and location ref types
+		kNumeric,        // NumericValue::ParseLegacy
+		kCompareValues,  // CompareValues::InitializeLegacy, "A, B"
+		kActorValue,     // CompareValues::InitializeLegacy on an actor value condition, "actor value index, B"
+		kFactionRank     // FactionRankCondition::InitializeLegacy, "rank, faction"
+	};
+
+	struct ConditionType
+	{
+		std::string_view name;
+		ArgumentKind argumentKind;
+	};
+
+	// the conditions a _conditions.txt can use, see OpenAnimationReplacer::InitializeConditionFactories
+	inline constexpr std::array kConditionTypes{
+		ConditionType{ "IsForm"sv, ArgumentKind::kForm },
+		ConditionType{ "IsEquipped"sv, ArgumentKind::kForm },
+		ConditionType{ "IsEquippedType"sv, ArgumentKind::kNumeric },
+		ConditionType{ "IsEquippedHasKeyword"sv, ArgumentKind::kForm },
+		ConditionType{ "IsEquippedPower"sv, ArgumentKind::kForm },
+		ConditionType{ "IsWorn"sv, ArgumentKind::kForm },
+		ConditionType{ "IsWornHasKeyword"sv, ArgumentKind::kForm },
+		ConditionType{ "IsFemale"sv, ArgumentKind::kNone },
+		ConditionType{ "IsChild"sv, ArgumentKind::kNone },
+		ConditionType{ "IsPlayerTeammate"sv, ArgumentKind::kNone },
+		ConditionType{ "IsInInterior"sv, ArgumentKind::kNone },
+		ConditionType{ "IsInFaction"sv, ArgumentKind::kForm },
+		ConditionType{ "HasKeyword"sv, ArgumentKind::kForm },
+		ConditionType{ "HasMagicEffect"sv, ArgumentKind::kForm },
+		ConditionType{ "HasMagicEffectWithKeyword"sv, ArgumentKind::kForm },
+		ConditionType{ "HasPerk"sv, ArgumentKind::kForm },
+		ConditionType{ "HasSpell"sv, ArgumentKind::kForm },
+		ConditionType{ "ValueEqualTo"sv, ArgumentKind::kCompareValues },
+		ConditionType{ "ValueLessThan"sv, ArgumentKind::kCompareValues },
+		ConditionType{ "IsActorValueEqualTo"sv, ArgumentKind::kActorValue },
+		ConditionType{ "IsActorValueLessThan"sv, ArgumentKind::kActorValue },
+		ConditionType{ "IsActorValueBaseEqualTo"sv, ArgumentKind::kActorValue },
+		ConditionType{ "IsActorValueBaseLessThan"sv, ArgumentKind::kActorValue },
+		ConditionType{ "IsActorValueMaxEqualTo"sv, ArgumentKind::kActorValue },
+		ConditionType{ "IsActorValueMaxLessThan"sv, ArgumentKind::kActorValue },
+		ConditionType{ "IsActorValuePercentageEqualTo"sv, ArgumentKind::kActorValue },
+		ConditionType{ "IsActorValuePercentageLessThan"sv, ArgumentKind::kActorValue },
+		ConditionType{ "Level"sv, ArgumentKind::kNumeric },
+		ConditionType{ "IsActorBase"sv, ArgumentKind::kForm },
+		ConditionType{ "IsRace"sv, ArgumentKind::kForm },
+		ConditionType{ "CurrentWeather"sv, ArgumentKind::kForm },
+		ConditionType{ "CurrentGameTime"sv, ArgumentKind::kNone },
+		ConditionType{ "Random"sv, ArgumentKind::kNumeric },
+		ConditionType{ "IsUnique"sv, ArgumentKind::kNone },
+		ConditionType{ "IsClass"sv, ArgumentKind::kForm },
+		ConditionType{ "IsCombatStyle"sv, ArgumentKind::kForm },
+		ConditionType{ "IsVoiceType"sv, ArgumentKind::kForm },
+		ConditionType{ "IsAttacking"sv, ArgumentKind::kNone },
+		ConditionType{ "IsRunning"sv, ArgumentKind::kNone },
+		ConditionType{ "IsSneaking"sv, ArgumentKind::kNone },
+		ConditionType{ "IsSprinting"sv, ArgumentKind::kNone },
+		ConditionType{ "IsInAir"sv, ArgumentKind::kNone },
+		ConditionType{ "IsInCombat"sv, ArgumentKind::kNone },
+		ConditionType{ "IsWeaponDrawn"sv, ArgumentKind::kNone },
+		ConditionType{ "IsInLocation"sv, ArgumentKind::kForm },
+		ConditionType{ "HasRefType"sv, ArgumentKind::kForm },
+		ConditionType{ "IsParentCell"sv, ArgumentKind::kForm },
+		ConditionType{ "IsWorldSpace"sv, ArgumentKind::kForm },
+		ConditionType{ "FactionRank"sv, ArgumentKind::kFactionRank },
+		ConditionType{ "IsMovementDirection"sv, ArgumentKind::kNumeric },
+		ConditionType{ "IsCurrentPackage"sv, ArgumentKind::kForm },
+		ConditionType{ "OR"sv, ArgumentKind::kNone },
+		ConditionType{ "AND"sv, ArgumentKind::kNone }
+	};
+
+	// like Conditions::CorrectLegacyConditionName
+	[[nodiscard]] inline const ConditionType* FindConditionType(std::string_view a_name)
+	{
+		if (a_name == "IsEquippedShout"sv) {
+			a_name = "IsEquippedPower"sv;
+		}
+
+		const auto it = std::ranges::find(kConditionTypes, a_name, &ConditionType::name);
+		return it != kConditionTypes.end() ? &*it : nullptr;
+	}
+
+	// stands in for Utils::LookupForm, a form exists if its plugin is one of the known ones and its local id is in range
+	class FormLookup
+	{
+	public:
+		static constexpr std::array kKnownPlugins{ "Skyrim.esm"sv, "Update.esm"sv, "Dawnguard.esm"sv, "HearthFires.esm"sv, "Dragonborn.esm"sv };
+		static constexpr uint32_t kMaxLocalFormID = 0x1FFFFF;
+
+		bool Lookup(const LegacyConditions::FormReference& a_reference)
+		{
+			++lookups;
+			const bool bFound = (a_reference.formID & 0xFFFFFF) <= kMaxLocalFormID && std::ranges::find(kKnownPlugins, a_reference.pluginName) != kKnownPlugins.end();
+			if (bFound) {
+				++foundForms;
+			}
+			return bFound;
+		}
+
+		uint64_t lookups = 0;
+		uint64_t foundForms = 0;
+	};
+
+	struct Stats
+	{
+		uint64_t conditions = 0;  // top level, an OR block counts as one
+		uint64_t conditionLines = 0;  // every line that became a condition, also the ones in OR blocks
+		uint64_t orBlocks = 0;
+		uint64_t invalidConditions = 0;  // unknown names and lines past the limits
+		uint64_t invalidArguments = 0;   // arguments InitializeLegacy can't make sense of, the condition is still created
+		uint64_t maxOrBlockSize = 0;
+		uint64_t argumentBytes = 0;
+		bool bComplete = true;
+		bool bConsistent = true;  // the parse called the builder in a valid order
+	};
+
+	// stands in for ConditionsTxtBuilder in Parsing.cpp
+	class Builder
+	{
+	public:
+		explicit Builder(FormLookup& a_formLookup, Stats& a_stats) :
+			_formLookup(a_formLookup),
+			_stats(a_stats)
+		{}
+
+		void BeginOrBlock()
+		{
+			if (_bInOrBlock) {
+				_stats.bConsistent = false;
+			}
+			_bInOrBlock = true;
+			_orBlockSize = 0;
+		}
+
+		void EndOrBlock()
+		{
+			if (!_bInOrBlock) {
+				_stats.bConsistent = false;
+			}
+			_bInOrBlock = false;
+			++_stats.orBlocks;
+			++_stats.conditions;
+			_stats.maxOrBlockSize = std::max(_stats.maxOrBlockSize, _orBlockSize);
+		}
+
+		void AddCondition(const LegacyConditions::Line& a_line)
+		{
+			CountCondition();
+			if (a_line.text.size() > ConfigLimits::kMaxTxtLineLength || a_line.argument.size() > a_line.text.size()) {
+				_stats.bConsistent = false;
+			}
+
+			const auto conditionType = FindConditionType(a_line.name);
+			if (!conditionType) {
+				++_stats.invalidConditions;
+				return;
+			}
+
+			_stats.argumentBytes += a_line.argument.size();
+			if (!ParseArgument(conditionType->argumentKind, a_line.argument)) {
+				++_stats.invalidArguments;
+			}
+		}
+
+		void AddInvalidCondition(std::string_view)
+		{
+			CountCondition();
+			++_stats.invalidConditions;
+		}
+
+		[[nodiscard]] bool IsInOrBlock() const { return _bInOrBlock; }
+
+	private:
+		void CountCondition()
+		{
+			++_stats.conditionLines;
+			if (_bInOrBlock) {
+				++_orBlockSize;
+			} else {
+				++_stats.conditions;
+			}
+		}
+
+		bool ParseForm(std::string_view a_argument)
+		{
+			if (const auto reference = LegacyConditions::ParseFormReference(a_argument)) {
+				_formLookup.Lookup(*reference);
+				return true;
+			}
+			return false;
+		}
+
+		// like NumericValue::ParseLegacy
+		bool ParseNumeric(std::string_view a_argument, bool a_bIsActorValue = false)
+		{
+			if (a_bIsActorValue) {
+				int32_t valueInt = -1;
+				const auto [ptr, ec] = std::from_chars(a_argument.data(), a_argument.data() + a_argument.size(), valueInt);
+				return ec == std::errc();
+			}
+
+			float floatValue = 0.f;
+			const auto [ptr, ec] = std::from_chars(a_argument.data(), a_argument.data() + a_argument.size(), floatValue);
+			if (ec == std::errc()) {
+				return true;
+			}
+
+			if (ec == std::errc::invalid_argument) {
+				return ParseForm(a_argument);  // a global variable
+			}
+
+			return false;
+		}
+
+		bool ParseArgument(ArgumentKind a_argumentKind, std::string_view a_argument)
+		{
+			switch (a_argumentKind) {
+			case ArgumentKind::kNone:
+				return true;
+			case ArgumentKind::kForm:
+				return ParseForm(a_argument);
+			case ArgumentKind::kNumeric:
+				return ParseNumeric(a_argument);
+			case ArgumentKind::kCompareValues:
+			case ArgumentKind::kActorValue:
+				if (const auto arguments = LegacyConditions::SplitArguments(a_argument)) {
+					const auto& [firstArg, secondArg] = *arguments;
+					const bool bFirst = ParseNumeric(firstArg, a_argumentKind == ArgumentKind::kActorValue);
+					const bool bSecond = ParseNumeric(secondArg);
+					return bFirst && bSecond;
+				}
+				return false;
+			case ArgumentKind::kFactionRank:
+				if (const auto arguments = LegacyConditions::SplitArguments(a_argument)) {
+					const auto& [firstArg, secondArg] = *arguments;
+					const bool bFirst = ParseNumeric(firstArg);
+					const bool bSecond = ParseForm(secondArg);
+					return bFirst && bSecond;
+				}
+				return false;
+			}
+
+			return false;
+		}
+
+		FormLookup& _formLookup;
+		Stats& _stats;
+		bool _bInOrBlock = false;
+		uint64_t _orBlockSize = 0;
+	};
+
+	// parses a whole file like ParseConditionsTxt, including the file size limit
+	inline Stats Parse(std::string_view a_text, FormLookup& a_formLookup)
+	{
+		Stats stats;
+		Builder builder(a_formLookup, stats);
+
+		if (a_text.size() > ConfigLimits::kMaxTxtFileSize) {
+			builder.AddInvalidCondition("The file is too big"sv);
+			return stats;
+		}
+
+		stats.bComplete = LegacyConditions::Parse(a_text, builder);
+		if (builder.IsInOrBlock()) {
+			stats.bConsistent = false;
+		}
+
+		return stats;
+	}
+
+	// a _conditions.txt like the ones DAR mods ship, with OR blocks, comments, negations, both line endings and some broken lines
+	inline std::string GenerateConditionsTxt(std::mt19937& a_rng, size_t a_conditionCount)
+	{
+		const auto chance = [&](uint32_t a_percent) { return a_rng() % 100 < a_percent; };
+		const auto pick = [&](const auto& a_range) -> const auto& { return a_range[a_rng() % std::size(a_range)]; };
+
+		static constexpr std::array plugins{ "Skyrim.esm"sv, "Update.esm"sv, "Dawnguard.esm"sv, "Dragonborn.esm"sv, "MissingMod.esp"sv };
+
+		std::string text;
+		char buffer[128];
+
+		const auto appendForm = [&]() {
+			const auto& plugin = pick(plugins);
+			std::snprintf(buffer, sizeof(buffer), "\"%.*s\" | 0x%08X", static_cast<int>(plugin.size()), plugin.data(), static_cast<uint32_t>(a_rng() % 0x300000));
+			text += buffer;
+		};
+		const auto appendNumber = [&](float a_value) {
+			std::snprintf(buffer, sizeof(buffer), "%.2f", a_value);
+			text += buffer;
+		};
+
+		const std::string_view lineEnd = chance(50) ? "\r\n"sv : "\n"sv;
+		size_t orBlockRemaining = 0;
+
+		for (size_t i = 0; i < a_conditionCount; ++i) {
+			if (chance(5)) {
+				text += "; "sv;
+				text += pick(kConditionTypes).name;
+				text += " is checked below"sv;
+				text += lineEnd;
+			}
+
+			if (orBlockRemaining == 0 && chance(15)) {
+				orBlockRemaining = 2 + a_rng() % 4;
+			}
+
+			if (chance(3)) {
+				text += "  "sv;
+			}
+			if (chance(20)) {
+				text += "NOT "sv;
+			}
+
+			if (chance(2)) {
+				text += "NotACondition(1)"sv;
+			} else {
+				const auto& conditionType = pick(kConditionTypes);
+				text += conditionType.name;
+				text += chance(10) ? " ("sv : "("sv;
+
+				switch (conditionType.argumentKind) {
+				case ArgumentKind::kNone:
+					break;
+				case ArgumentKind::kForm:
+					appendForm();
+					break;
+				case ArgumentKind::kNumeric:
+					chance(80) ? appendNumber(static_cast<float>(a_rng() % 10000) / 100.f) : appendForm();
+					break;
+				case ArgumentKind::kCompareValues:
+					text += std::to_string(a_rng() % 100);
+					text += ", "sv;
+					chance(50) ? appendNumber(static_cast<float>(a_rng() % 100)) : appendForm();
+					break;
+				case ArgumentKind::kActorValue:
+					text += std::to_string(a_rng() % 160);
+					text += ", "sv;
+					appendNumber(static_cast<float>(a_rng() % 1000) / 10.f);
+					break;
+				case ArgumentKind::kFactionRank:
+					text += std::to_string(a_rng() % 10);
+					text += ", "sv;
+					appendForm();
+					break;
+				}
+
+				if (!chance(2)) {
+					text += ")"sv;
+				}
+			}
+
+			if (orBlockRemaining > 0 && --orBlockRemaining > 0) {
+				text += " OR"sv;
+			} else if (chance(1)) {
+				text += " AND"sv;
+			}
+
+			text += lineEnd;
+			if (chance(5)) {
+				text += lineEnd;
+			}
+		}
+
+		return text;
+	}
+}